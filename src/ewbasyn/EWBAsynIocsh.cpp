@@ -0,0 +1,334 @@
+/*
+ * EWBAsynIocsh.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include <iocsh.h>
+#include <epicsExport.h>
+
+#define EWB_TRACE_MODULE EWB_TRACE_ASYN
+#include "EWBTrace.h"
+#include "EWBBridge.h"
+#include "EWBHeatmap.h"
+#include "EWBAsynPortDrvr.h"
+
+#include <sstream>
+
+/**
+ * Print the runtime trace level of all the modules
+ */
+static void ewbTraceShow()
+{
+	for(int i=0;i<EWB_TRACE_NMODULES;i++)
+		printf("%-8s: %d\n",EWBTrace::getModuleName(i),EWBTrace::getLevel(i));
+}
+
+extern "C" {
+
+/**
+ * Change the runtime trace level of a module from the IOC shell
+ *
+ * \code
+ * epics> ewbTraceLevel bridge 6
+ * epics> ewbTraceLevel bridge 5
+ * \endcode
+ *
+ * \param[in] module The name of the module ("core", "bridge", "asyn", "console" or "all").
+ * When empty we only print the current levels.
+ * \param[in] level The new level from 0 (no trace) to 7 (very verbose debug)
+ * \return 0 if okay, -1 otherwise.
+ */
+int ewbTraceLevel(const char *module, int level)
+{
+	if(module==NULL || module[0]=='\0')
+	{
+		ewbTraceShow();
+		return 0;
+	}
+
+	int m=EWBTrace::findModule(module);
+	if(m<0 || EWBTrace::setLevel(m,level)==false)
+	{
+		printf("Usage: ewbTraceLevel <core|bridge|asyn|console|all> <%d-%d>\n",
+				TRACE_LEVEL_NO_TRACE,TRACE_LEVEL_VVDEBUG);
+		return -1;
+	}
+	if(level>TRACE_LEVEL)
+		printf("Warning: traces above level %d have not been compiled\n",TRACE_LEVEL);
+	ewbTraceShow();
+	return 0;
+}
+
+/**
+ * Print the transactions statistics of the bridges
+ *
+ * \param[in] name The name of the bridge, when empty all the bridges are reported
+ * \param[in] level The level of details (>0 also print the latency distribution)
+ * \return 0 if okay, -1 if the bridge was not found.
+ */
+int ewbBridgeReport(const char *name, int level)
+{
+	std::stringstream ss;
+	int found=0;
+	EWBBridge::forEachInstance([&](EWBBridge *pBgd) {
+		if(name && name[0]!='\0' && pBgd->getName()!=name) return;
+		pBgd->report(ss,level);
+		found++;
+	});
+	printf("%s",ss.str().c_str());
+	if(found==0) printf("No bridge found\n");
+	return (found>0)?0:-1;
+}
+
+/**
+ * Reset the transactions statistics of the bridges
+ *
+ * \param[in] name The name of the bridge, when empty all the bridges are reset
+ * \return 0 if okay, -1 if the bridge was not found.
+ */
+int ewbBridgeReset(const char *name)
+{
+	int found=0;
+	EWBBridge::forEachInstance([&](EWBBridge *pBgd) {
+		if(name && name[0]!='\0' && pBgd->getName()!=name) return;
+		pBgd->getStats().reset();
+		found++;
+	});
+	return (found>0)?0:-1;
+}
+
+/**
+ * Measure the cost of the accesses of a bridge (used to plan the syncs)
+ *
+ * \code
+ * epics> ewbBridgeCalibrate X1052 0x20000 0x1000
+ * \endcode
+ *
+ * \param[in] name The name of the bridge.
+ * \param[in] addr An address where reading has no side effect (i.e. a RAM).
+ * \param[in] nsize The size of the biggest block measured (0x400 when <=0).
+ * \return 0 if okay, -1 otherwise.
+ * \see EWBBridge::calibrate()
+ */
+int ewbBridgeCalibrate(const char *name, int addr, int nsize)
+{
+	EWBBridge *pBgd=(name)?EWBBridge::find(name):NULL;
+	if(pBgd==NULL)
+	{
+		printf("Usage: ewbBridgeCalibrate <bridge> <addr> [nsize]\n");
+		return -1;
+	}
+	if(pBgd->calibrate((uint32_t)addr,(nsize>0)?nsize:0x400)==false) return -1;
+	std::stringstream ss;
+	pBgd->report(ss,0);
+	printf("%s",ss.str().c_str());
+	return 0;
+}
+
+/**
+ * Enable or disable the per-register access heatmap
+ *
+ * \param[in] enable 1 to reset and start recording, 0 to stop.
+ * \return always 0
+ */
+int ewbHeatmapEnable(int enable)
+{
+	if(enable) EWBHeatmap::getInstance().reset();
+	EWBHeatmap::setEnabled(enable!=0);
+	return 0;
+}
+
+/**
+ * Print the hottest registers of the heatmap
+ *
+ * \param[in] ntop Number of registers listed (20 when <=0)
+ * \return always 0
+ */
+int ewbHeatmapReport(int ntop)
+{
+	std::stringstream ss;
+	EWBHeatmap::getInstance().print(ss,(ntop>0)?ntop:20);
+	printf("%s",ss.str().c_str());
+	return 0;
+}
+
+/**
+ * Publish the registers of an EWBAsynPortDrvr in a POSIX shared memory
+ *
+ * \code
+ * epics> ewbMirrorCreate MYPORT /ewb_myioc
+ * \endcode
+ *
+ * \param[in] port The name of the asyn port (after its setup()).
+ * \param[in] shmName The name of the shared memory.
+ * \return 0 if okay, -1 otherwise.
+ */
+int ewbMirrorCreate(const char *port, const char *shmName)
+{
+	EWBAsynPortDrvr *pDrv=(port)?dynamic_cast<EWBAsynPortDrvr*>((asynPortDriver*)findAsynPortDriver(port)):NULL;
+	if(pDrv==NULL || shmName==NULL || shmName[0]=='\0')
+	{
+		printf("Usage: ewbMirrorCreate <port> <shmName>\n");
+		return -1;
+	}
+	return (pDrv->createMirror(shmName)==asynSuccess)?0:-1;
+}
+
+/**
+ * Read the neighbouring registers of a peripheral in one block
+ *
+ * \code
+ * epics> ewbReadAhead MYPORT wrpc 64 1000
+ * \endcode
+ *
+ * \param[in] port The name of the asyn port (after its setup()).
+ * \param[in] periph The name of the peripheral.
+ * \param[in] wsize The size of the window in bytes (0 to disable).
+ * \param[in] valid_us How long the values of the window are used (us).
+ * \return 0 if okay, -1 otherwise.
+ */
+int ewbReadAhead(const char *port, const char *periph, int wsize, int valid_us)
+{
+	EWBAsynPortDrvr *pDrv=(port)?dynamic_cast<EWBAsynPortDrvr*>((asynPortDriver*)findAsynPortDriver(port)):NULL;
+	if(pDrv==NULL || periph==NULL || wsize<0 || valid_us<0)
+	{
+		printf("Usage: ewbReadAhead <port> <periph> <wsize> <valid_us>\n");
+		return -1;
+	}
+	return (pDrv->setReadAhead(periph,wsize,valid_us)==asynSuccess)?0:-1;
+}
+
+/**
+ * Validate the tree of a port once and cache the absolute address of its registers
+ *
+ * \code
+ * epics> ewbFreeze MYPORT
+ * \endcode
+ *
+ * \param[in] port The name of the asyn port (after its setup()).
+ * \return 0 if okay, -1 otherwise.
+ */
+int ewbFreeze(const char *port)
+{
+	EWBAsynPortDrvr *pDrv=(port)?dynamic_cast<EWBAsynPortDrvr*>((asynPortDriver*)findAsynPortDriver(port)):NULL;
+	if(pDrv==NULL)
+	{
+		printf("Usage: ewbFreeze <port>\n");
+		return -1;
+	}
+	return (pDrv->freeze()==asynSuccess)?0:-1;
+}
+
+}
+
+static const iocshArg ewbTraceLevelArg0 = { "module",iocshArgString };
+static const iocshArg ewbTraceLevelArg1 = { "level",iocshArgInt };
+static const iocshArg * const ewbTraceLevelArgs[] = { &ewbTraceLevelArg0, &ewbTraceLevelArg1 };
+static const iocshFuncDef ewbTraceLevelFuncDef = { "ewbTraceLevel",2,ewbTraceLevelArgs };
+
+static void ewbTraceLevelCallFunc(const iocshArgBuf *args)
+{
+	ewbTraceLevel(args[0].sval,args[1].ival);
+}
+
+static const iocshArg ewbBridgeReportArg0 = { "bridge",iocshArgString };
+static const iocshArg ewbBridgeReportArg1 = { "level",iocshArgInt };
+static const iocshArg * const ewbBridgeReportArgs[] = { &ewbBridgeReportArg0, &ewbBridgeReportArg1 };
+static const iocshFuncDef ewbBridgeReportFuncDef = { "ewbBridgeReport",2,ewbBridgeReportArgs };
+
+static void ewbBridgeReportCallFunc(const iocshArgBuf *args)
+{
+	ewbBridgeReport(args[0].sval,args[1].ival);
+}
+
+static const iocshArg ewbBridgeCalibrateArg1 = { "addr",iocshArgInt };
+static const iocshArg ewbBridgeCalibrateArg2 = { "nsize",iocshArgInt };
+static const iocshArg * const ewbBridgeCalibrateArgs[] = { &ewbBridgeReportArg0, &ewbBridgeCalibrateArg1, &ewbBridgeCalibrateArg2 };
+static const iocshFuncDef ewbBridgeCalibrateFuncDef = { "ewbBridgeCalibrate",3,ewbBridgeCalibrateArgs };
+
+static void ewbBridgeCalibrateCallFunc(const iocshArgBuf *args)
+{
+	ewbBridgeCalibrate(args[0].sval,args[1].ival,args[2].ival);
+}
+
+static const iocshArg * const ewbBridgeResetArgs[] = { &ewbBridgeReportArg0 };
+static const iocshFuncDef ewbBridgeResetFuncDef = { "ewbBridgeReset",1,ewbBridgeResetArgs };
+
+static void ewbBridgeResetCallFunc(const iocshArgBuf *args)
+{
+	ewbBridgeReset(args[0].sval);
+}
+
+static const iocshArg ewbHeatmapEnableArg0 = { "enable",iocshArgInt };
+static const iocshArg * const ewbHeatmapEnableArgs[] = { &ewbHeatmapEnableArg0 };
+static const iocshFuncDef ewbHeatmapEnableFuncDef = { "ewbHeatmapEnable",1,ewbHeatmapEnableArgs };
+
+static void ewbHeatmapEnableCallFunc(const iocshArgBuf *args)
+{
+	ewbHeatmapEnable(args[0].ival);
+}
+
+static const iocshArg ewbHeatmapReportArg0 = { "ntop",iocshArgInt };
+static const iocshArg * const ewbHeatmapReportArgs[] = { &ewbHeatmapReportArg0 };
+static const iocshFuncDef ewbHeatmapReportFuncDef = { "ewbHeatmapReport",1,ewbHeatmapReportArgs };
+
+static void ewbHeatmapReportCallFunc(const iocshArgBuf *args)
+{
+	ewbHeatmapReport(args[0].ival);
+}
+
+static const iocshArg ewbMirrorCreateArg0 = { "port",iocshArgString };
+static const iocshArg ewbMirrorCreateArg1 = { "shmName",iocshArgString };
+static const iocshArg * const ewbMirrorCreateArgs[] = { &ewbMirrorCreateArg0, &ewbMirrorCreateArg1 };
+static const iocshFuncDef ewbMirrorCreateFuncDef = { "ewbMirrorCreate",2,ewbMirrorCreateArgs };
+
+static void ewbMirrorCreateCallFunc(const iocshArgBuf *args)
+{
+	ewbMirrorCreate(args[0].sval,args[1].sval);
+}
+
+static const iocshArg ewbReadAheadArg1 = { "periph",iocshArgString };
+static const iocshArg ewbReadAheadArg2 = { "wsize",iocshArgInt };
+static const iocshArg ewbReadAheadArg3 = { "valid_us",iocshArgInt };
+static const iocshArg * const ewbReadAheadArgs[] = { &ewbMirrorCreateArg0, &ewbReadAheadArg1, &ewbReadAheadArg2, &ewbReadAheadArg3 };
+static const iocshFuncDef ewbReadAheadFuncDef = { "ewbReadAhead",4,ewbReadAheadArgs };
+
+static void ewbReadAheadCallFunc(const iocshArgBuf *args)
+{
+	ewbReadAhead(args[0].sval,args[1].sval,args[2].ival,args[3].ival);
+}
+
+static const iocshArg * const ewbFreezeArgs[] = { &ewbMirrorCreateArg0 };
+static const iocshFuncDef ewbFreezeFuncDef = { "ewbFreeze",1,ewbFreezeArgs };
+
+static void ewbFreezeCallFunc(const iocshArgBuf *args)
+{
+	ewbFreeze(args[0].sval);
+}
+
+/**
+ * Register the IOC shell commands of the ewbasyn library
+ *
+ * \note Include ewbasyn.dbd in your IOC to call this registrar.
+ */
+static void ewbAsynRegister(void)
+{
+	iocshRegister(&ewbTraceLevelFuncDef,ewbTraceLevelCallFunc);
+	iocshRegister(&ewbBridgeReportFuncDef,ewbBridgeReportCallFunc);
+	iocshRegister(&ewbBridgeResetFuncDef,ewbBridgeResetCallFunc);
+	iocshRegister(&ewbBridgeCalibrateFuncDef,ewbBridgeCalibrateCallFunc);
+	iocshRegister(&ewbHeatmapEnableFuncDef,ewbHeatmapEnableCallFunc);
+	iocshRegister(&ewbHeatmapReportFuncDef,ewbHeatmapReportCallFunc);
+	iocshRegister(&ewbMirrorCreateFuncDef,ewbMirrorCreateCallFunc);
+	iocshRegister(&ewbReadAheadFuncDef,ewbReadAheadCallFunc);
+	iocshRegister(&ewbFreezeFuncDef,ewbFreezeCallFunc);
+}
+
+extern "C" {
+epicsExportRegistrar(ewbAsynRegister);
+}
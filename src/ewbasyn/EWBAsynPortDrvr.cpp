@@ -10,6 +10,7 @@
 #include <stdio.h>
 #include <errno.h>
 #include <math.h>
+#include <algorithm>
 
 #include <epicsTypes.h>
 #include <epicsTime.h>
@@ -22,9 +23,11 @@
 #include <iocsh.h>
 
 #include "EWBAsynPortDrvr.h"
+#include "EWBBridge.h"
+#include "EWBMirror.h"
+#include "EWBPeriph.h"
+#define EWB_TRACE_MODULE EWB_TRACE_ASYN
 #include "EWBTrace.h"
-#define TRACE_P_VDEBUG(...) //TRACE_P_DEBUG( __VA_ARGS__)
-#define TRACE_P_VVDEBUG(...) //TRACE_P_DEBUG( __VA_ARGS__)
 
 /**
  * Constructor for the asynWBPortDrvr class.
@@ -46,7 +49,7 @@ EWBAsynPortDrvr::EWBAsynPortDrvr(const char *portName,int max_nprm)
 		1, /* Autoconnect */
 		0, /* Default priority */
 		0), /* Default stack size*/
-		pRoot(NULL), driverName(portName)
+		pRoot(NULL), pMirror(NULL), driverName(portName)
 {
 
 
@@ -72,10 +75,79 @@ EWBAsynPortDrvr::~EWBAsynPortDrvr()
 {
 	fprintf(stderr,"0x%x\n", (uint32_t)this);
 
+	if(pMirror) delete pMirror;
+	pMirror=NULL;
 	if(pRoot) delete pRoot;
 	pRoot=NULL;
 }
 
+/**
+ * Publish the registers of the WB tree in a POSIX shared memory
+ *
+ * Once created, each sync of the registers updates the shared memory so that
+ * the tools running on the same host can read them with EWBMirrorReader
+ * without accessing the device.
+ *
+ * \note Must be called after setup() as the layout is built from the WB tree.
+ * \param[in] shmName The name of the shared memory (i.e. "/ewb_myioc").
+ * \return asynSuccess if okay, asynError otherwise.
+ */
+asynStatus EWBAsynPortDrvr::createMirror(const char *shmName)
+{
+	TRACE_CHECK(isValid(),asynError,"setup() has not been called");
+	TRACE_CHECK_PTR(shmName,asynError);
+
+	lock();
+	if(pMirror)
+	{
+		pRoot->setMirror(NULL);
+		delete pMirror;
+	}
+	pMirror=new EWBMirror(pRoot,shmName);
+	if(pMirror->isValid())
+	{
+		pMirror->publishAll();
+		pRoot->setMirror(pMirror);
+	}
+	else
+	{
+		delete pMirror;
+		pMirror=NULL;
+	}
+	unlock();
+	return (pMirror)?asynSuccess:asynError;
+}
+
+/**
+ * Configure the read-ahead window of a peripheral
+ *
+ * \param[in] periph The name of the peripheral in the WB tree.
+ * \param[in] wsize The size of the window in bytes (power of two, 0 to disable).
+ * \param[in] valid_us How long the values of the window are used (us).
+ * \return asynSuccess if okay, asynError otherwise.
+ * \see EWBPeriph::setReadAhead()
+ */
+asynStatus EWBAsynPortDrvr::setReadAhead(const char *periph, uint32_t wsize, uint32_t valid_us)
+{
+	TRACE_CHECK(isValid(),asynError,"setup() has not been called");
+	TRACE_CHECK_PTR(periph,asynError);
+
+	EWBPeriph *pPrh=pRoot->findPeriph(periph);
+	TRACE_CHECK_VA(pPrh,asynError,"Peripheral %s not found",periph);
+	return (pPrh->setReadAhead(wsize,valid_us))?asynSuccess:asynError;
+}
+
+/**
+ * Freeze the tree of the port once it is completely built
+ *
+ * \see EWBBus::freeze()
+ */
+asynStatus EWBAsynPortDrvr::freeze()
+{
+	TRACE_CHECK(isValid(),asynError,"setup() has not been called");
+	return (pRoot->freeze())?asynSuccess:asynError;
+}
+
 /**
  * Synchronize parameters that have been setup internally but not sync to the peripheral
  *
@@ -106,20 +178,30 @@ asynStatus EWBAsynPortDrvr::syncPending(EWBSync::AMode amode)
 		}
 	}
 	//Then obtain the registers of these field params
+	std::vector<EWBReg*> regs;
 	for(size_t i=0;i<tmpList.size();i++)
 	{
 		pFld=fldPrms[tmpList[i]].pPrm->castField();
 		if(pFld)
 		{
 			reg=(EWBReg*)pFld->getReg();
-			//Sync them
-			if(reg->isToSync())
+			if(reg->isToSync() && std::find(regs.begin(),regs.end(),reg)==regs.end())
 			{
 				TRACE_P_DEBUG("Syncing Reg>: %s (@0x%08X) 0x%08x",
 						reg->getCName(),reg->getOffset(true),reg->getData());
-				status&=reg->sync(amode);
-				//Finally update the
+				regs.push_back(reg);
 			}
+		}
+	}
+	//Sync them together with the cheapest accesses (see EWBAccessPlanner)
+	if(regs.size()>0) status&=EWBPeriph::syncRegs(regs,amode);
+
+	//Finally update the params
+	for(size_t i=0;i<tmpList.size();i++)
+	{
+		pFld=fldPrms[tmpList[i]].pPrm->castField();
+		if(pFld)
+		{
 			if(pFld->getType() && EWBField::EWBF_TM_FIXED_POINT)
 				setDoubleParam(tmpList[i],pFld->getFloat());
 			else
@@ -145,18 +227,20 @@ asynStatus EWBAsynPortDrvr::syncPending(EWBSync::AMode amode)
  */
 asynStatus EWBAsynPortDrvr::createParam(EWBField* fld,int *pIndex, int syncmode)
 {
-	std::stringstream ss;
+	static const EWBString sValue("value");
+	EWBString name;
 
 	if(pIndex) *pIndex=-1;
 	TRACE_CHECK_PTR(fld,asynError);
 	TRACE_CHECK_PTR(fld->getReg(),asynError);
 
-	if(fld->getName()==fld->getReg()->getName() || (fld->getName()=="value" && fld->getReg()->getFields().size()==1))
-		ss << fld->getReg()->getName();
+	const EWBString &fname=fld->getNameId(), &rname=fld->getReg()->getNameId();
+	if(fname==rname || (fname==sValue && fld->getReg()->getFields().size()==1))
+		name=rname;
 	else
-		ss << fld->getReg()->getName() << "_" << fld->getName();
+		name=EWBString(rname.str()+"_"+fname.str());	//The same name is generated for each instance
 
-	return this->createParam(ss.str().c_str(),fld, pIndex, syncmode);
+	return this->createParam(name.c_str(),fld, pIndex, syncmode);
 }
 
 
@@ -275,6 +359,28 @@ int EWBAsynPortDrvr::getParamIndex(const char *name)
 	else return -1;
 }
 
+/**
+ * Report the status of the port driver (asynReport)
+ *
+ * When details>=1 we also print the transactions statistics
+ * of the bridge used by this driver.
+ *
+ * \param[in] fp The file where the report is written
+ * \param[in] details The level of details
+ */
+void EWBAsynPortDrvr::report(FILE *fp, int details)
+{
+	asynPortDriver::report(fp,details);
+
+	if(details>=1 && pRoot && pRoot->getBridge())
+	{
+		std::stringstream ss;
+		pRoot->getBridge()->report(ss,details-1);
+		fprintf(fp,"%s",ss.str().c_str());
+	}
+	if(pMirror) fprintf(fp,"Mirror: %s (%d bytes)\n",pMirror->getName().c_str(),pMirror->getSize());
+}
+
 /** Called when asyn clients call pasynInt32->read().
  *
  * For default \ref AsynWBSync Mode we perform:
@@ -20,6 +20,8 @@
 #include "EWBField.h"
 #include <asynPortDriver.h>
 
+class EWBMirror;
+
 //! Type of synchronization between the memory, Wishbone tree and Process variable
 enum AsynWBSync {
 	AWB_SYNC_DEVICE=0,	//!< Sync to/from the device using WBMemCon on the field
@@ -80,7 +82,12 @@ public:
     virtual asynStatus writeOctet(asynUser *pasynUser, const char *value, size_t maxChars,size_t *nActual);
     virtual asynStatus readOctet(asynUser *pasynUser, char *value, size_t maxChars, size_t *nActual, int *eomReason);
 
+    virtual void report(FILE *fp, int details);
+
     bool isValid() { return pRoot!=NULL; } //!< return true if the child class has been properly setup()
+    asynStatus createMirror(const char *shmName);
+    asynStatus setReadAhead(const char *periph, uint32_t wsize, uint32_t valid_us);
+    asynStatus freeze();
 
 protected:
     asynStatus syncPending(EWBSync::AMode amode=EWBSync::EWB_AM_RW);
@@ -92,6 +99,7 @@ protected:
     int getParamIndex(const char *name);
 
     EWBBus *pRoot;			//!< pointer on the WB root tree structure.
+    EWBMirror *pMirror;		//!< Shared-memory mirror of the registers (optional)
 
     std::vector<EWBAsynPrm> fldPrms;
 private:
@@ -0,0 +1,182 @@
+/*
+ * EWBAccessPlanner.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBAccessPlanner.h"
+
+#include <algorithm>
+
+#define EWB_TRACE_MODULE EWB_TRACE_BRIDGE
+#include <EWBTrace.h>
+
+/**
+ * Constructor of the planner
+ *
+ * \param[in] model The cost model of the bridge (only its parameters are copied).
+ */
+EWBAccessPlanner::EWBAccessPlanner(const EWBLatencyModel &model)
+: model(model), pModel(&this->model), align(std::max(model.align,(uint32_t)sizeof(uint32_t)))
+{
+
+}
+
+/**
+ * Constructor of the planner with a custom cost model
+ *
+ * \param[in] pModel The cost model of the bridge (not copied, it must outlive the planner).
+ */
+EWBAccessPlanner::EWBAccessPlanner(const EWBLatencyModel *pModel)
+: pModel(pModel), align(std::max(pModel->align,(uint32_t)sizeof(uint32_t)))
+{
+
+}
+
+EWBAccessPlanner::~EWBAccessPlanner()
+{
+
+}
+
+/**
+ * Add an address to access
+ *
+ * \param[in] addr The address (32-bit aligned).
+ * \param[in] single When true the address is only accessed by a single
+ * access and is never covered by a block (i.e. a volatile register).
+ */
+void EWBAccessPlanner::add(uint32_t addr, bool single)
+{
+	addr&=~0x3;
+	addrs[addr]=addrs[addr] || single;
+}
+
+/**
+ * Exclude an address from the blocks (it is not accessed at all)
+ */
+void EWBAccessPlanner::exclude(uint32_t addr)
+{
+	excluded.insert(addr & ~0x3);
+}
+
+/**
+ * Remove all the addresses
+ */
+void EWBAccessPlanner::clear()
+{
+	addrs.clear();
+	excluded.clear();
+}
+
+/**
+ * Return the cost of accessing all the addresses with single accesses
+ */
+uint64_t EWBAccessPlanner::getSinglesCost(bool to_dev) const
+{
+	return pModel->cost(false,sizeof(uint32_t),to_dev)*addrs.size();
+}
+
+/**
+ * Compute the cheapest accesses that cover all the addresses
+ *
+ * The addresses are sorted and the best cover of the first i addresses is
+ * obtained from the best cover of the previous ones (dynamic programming).
+ * The blocks that end at the address i only start at one of the
+ * previous \ref EWB_PLANNER_LOOKBACK addresses, or at the start of the
+ * last block of the cover of the previous addresses (which is extended), so that the plan of n
+ * addresses is computed in O(n) instead of O(n^2).
+ *
+ * \param[in] to_dev true when writing to the device.
+ * \param[out] pCost The estimated cost of the plan (ns) (optional).
+ * \return the accesses sorted by address.
+ */
+std::vector<EWBAccessPlanner::Access> EWBAccessPlanner::plan(bool to_dev, uint64_t *pCost) const
+{
+	std::vector<uint32_t> a;
+	std::vector<bool> single;
+	a.reserve(addrs.size());
+	single.reserve(addrs.size());
+	for(std::map<uint32_t,bool>::const_iterator ii=addrs.begin();ii!=addrs.end();++ii)
+	{
+		a.push_back(ii->first);
+		single.push_back(ii->second);
+	}
+	size_t n=a.size();
+
+	//best[i]: cost of the first i addresses, from[i]: first address of the last access (-1 for a single)
+	//last[i]: first address of the last block of this cover (-1 when there is none)
+	std::vector<uint64_t> best(n+1,0);
+	std::vector<long> from(n+1,-1), last(n+1,-1);
+	uint64_t c_single=pModel->cost(false,sizeof(uint32_t),to_dev);
+	for(size_t i=0;i<n;i++)
+	{
+		best[i+1]=best[i]+c_single;
+		from[i+1]=-1;
+		last[i+1]=(single[i])?-1:last[i];	//A single address is never covered
+		if(pModel->hasBlock()==false || single[i]) continue;
+
+		//Excluded addresses around the end of the block (a single lookup for all the candidates)
+		uint32_t end=a[i]+sizeof(uint32_t);
+		bool has_prv=false, has_nxt=false;
+		uint32_t prv_excl=0, nxt_excl=0;	//last excluded before end, first one after
+		std::set<uint32_t>::const_iterator ie=excluded.lower_bound(end);
+		if(ie!=excluded.end()) { has_nxt=true; nxt_excl=*ie; }
+		if(ie!=excluded.begin()) { has_prv=true; prv_excl=*(--ie); }
+
+		long jmin=std::max(0L,(long)i-(long)EWB_PLANNER_LOOKBACK+1);
+		long jext=(last[i]<jmin)?last[i]:-1;
+		for(long k=(long)i;k>=jmin-1;k--)
+		{
+			long j=(k<jmin)?jext:k;
+			if(j<0) break;
+			if(k>=jmin)
+			{
+				if(single[j]) break;
+				if(to_dev && j<(long)i && a[j]+sizeof(uint32_t)!=a[j+1]) break;	//No hole when writing
+			}
+			else if(to_dev && (from[i]!=jext || a[i-1]+sizeof(uint32_t)!=a[i])) break;	//No hole when writing
+
+			uint32_t base=a[j] & ~(align-1);
+			uint32_t span=end-base;
+			if(span>pModel->blk_maxb) break;
+			if(has_prv && prv_excl>=base) break;
+			if(has_nxt && nxt_excl<base+pModel->blk_minb) continue;	//The padding would read it, but not a bigger block
+			if(to_dev && (base!=a[j] || span<pModel->blk_minb)) continue;	//Never write the padding
+
+			uint64_t c=best[j]+pModel->cost(true,span,to_dev);
+			if(c<best[i+1])
+			{
+				best[i+1]=c;
+				from[i+1]=j;
+				last[i+1]=j;
+			}
+		}
+	}
+
+	//Rebuild the plan from the end
+	std::vector<Access> res;
+	for(size_t i=n;i>0;)
+	{
+		Access acc;
+		if(from[i]<0)
+		{
+			acc.addr=a[i-1];
+			acc.nsize=sizeof(uint32_t);
+			acc.block=false;
+			i--;
+		}
+		else
+		{
+			acc.addr=a[from[i]] & ~(align-1);
+			acc.nsize=a[i-1]+sizeof(uint32_t)-acc.addr;
+			acc.block=true;
+			i=from[i];
+		}
+		res.push_back(acc);
+	}
+	std::reverse(res.begin(),res.end());
+
+	if(pCost) *pCost=best[n];
+	TRACE_P_VDEBUG("%d addresses in %d accesses (%s, cost=%d ns)",(int)n,(int)res.size(),(to_dev)?"W":"R",(int)best[n]);
+	return res;
+}
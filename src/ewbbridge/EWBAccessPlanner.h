@@ -0,0 +1,70 @@
+/**
+ *  \file
+ *  \brief Contains the class EWBAccessPlanner.
+ *
+ *  \date  Oct 19, 2026
+ */
+
+#ifndef EWBACCESSPLANNER_H_
+#define EWBACCESSPLANNER_H_
+
+#include "EWBLatencyModel.h"
+
+#include <cstddef>
+#include <map>
+#include <set>
+#include <vector>
+
+#define EWB_PLANNER_LOOKBACK 32	//!< Number of previous addresses where a block might start (see EWBAccessPlanner::plan())
+
+/**
+ * Planner that converts a set of addresses into the cheapest accesses
+ *
+ * The addresses are covered by single accesses and block accesses chosen
+ * with the cost model of the bridge (\ref EWBLatencyModel). A block access
+ * might also cover the holes between the addresses, except:
+ * 		- the excluded addresses (i.e. clear-on-read registers that are not synchronized),
+ * 		- the addresses added as single (volatile registers),
+ * 		- when writing, where a block only covers consecutive addresses (and is never padded).
+ *
+ * When both choices have the same cost the single accesses are used.
+ *
+ * \code
+ * EWBAccessPlanner planner(&pBgd->getCostModel());
+ * planner.add(0x1000); planner.add(0x1004); planner.add(0x1010,true);
+ * std::vector<EWBAccessPlanner::Access> plan=planner.plan(false);
+ * \endcode
+ */
+class EWBAccessPlanner {
+public:
+	//! An access of the plan
+	struct Access {
+		uint32_t addr;	//!< Address of the first word
+		uint32_t nsize;	//!< Size of the access (bytes)
+		bool block;		//!< true for a block access, false for a single one
+	};
+
+	EWBAccessPlanner(const EWBLatencyModel &model);
+	EWBAccessPlanner(const EWBLatencyModel *pModel);
+	virtual ~EWBAccessPlanner();
+
+	void add(uint32_t addr, bool single=false);
+	void exclude(uint32_t addr);
+	void clear();
+	size_t size() const { return addrs.size(); }		//!< Number of addresses to access
+
+	std::vector<Access> plan(bool to_dev, uint64_t *pCost=NULL) const;
+	uint64_t getSinglesCost(bool to_dev) const;
+
+private:
+	EWBAccessPlanner(const EWBAccessPlanner&);
+	EWBAccessPlanner& operator=(const EWBAccessPlanner&);
+
+	EWBLatencyModel model;				//!< Copy of the parameters of the cost model
+	const EWBLatencyModel *pModel;		//!< Cost model in use (model or a custom one)
+	uint32_t align;						//!< Alignment of the blocks (at least 32-bit)
+	std::map<uint32_t,bool> addrs;		//!< Addresses to access (true when only a single can be used)
+	std::set<uint32_t> excluded;		//!< Addresses that must not be covered by a block
+};
+
+#endif /* EWBACCESSPLANNER_H_ */
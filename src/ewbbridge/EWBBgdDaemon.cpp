@@ -0,0 +1,304 @@
+/*
+ * EWBBgdDaemon.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBBgdDaemon.h"
+
+#include <cstring>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define EWB_TRACE_MODULE EWB_TRACE_BRIDGE
+#include <EWBTrace.h>
+
+/**
+ * Constructor that connects to the daemon
+ *
+ * \param[in] path The path of the Unix socket of the daemon.
+ * \param[in] blk_maxb The size of the internal block buffer (bytes)
+ */
+EWBMemDaemonCon::EWBMemDaemonCon(const std::string &path, uint32_t blk_maxb)
+: EWBBridge(EWBBridge::DAEMON,path), fd(-1), cycle(0), bsize(blk_maxb)
+{
+	struct sockaddr_un addr;
+	pData=(uint32_t*)malloc(bsize);
+	desc="Daemon "+path;
+
+	memset(&addr,0,sizeof(addr));
+	addr.sun_family=AF_UNIX;
+	strncpy(addr.sun_path,path.c_str(),sizeof(addr.sun_path)-1);
+
+	fd=socket(AF_UNIX,SOCK_STREAM,0);
+	if(fd>=0 && connect(fd,(struct sockaddr*)&addr,sizeof(addr))<0)
+	{
+		TRACE_P_ERROR("Can not connect to %s (%s)",path.c_str(),strerror(errno));
+		close(fd);
+		fd=-1;
+	}
+}
+
+EWBMemDaemonCon::~EWBMemDaemonCon()
+{
+	if(fd>=0) close(fd);
+	free(pData);
+}
+
+/**
+ * Open a cycle owned by the calling thread until closeCycle()
+ */
+bool EWBMemDaemonCon::openCycle()
+{
+	bgd_mtx.lock();
+	cycle++;
+	return true;
+}
+
+bool EWBMemDaemonCon::closeCycle()
+{
+	std::lock_guard<std::recursive_mutex> lock(bgd_mtx);
+	TRACE_CHECK(cycle>0,false,"No cycle opened");
+	bool ret=(--cycle>0)?true:transact();
+	bgd_mtx.unlock();	//Locked by openCycle()
+	return ret;
+}
+
+/**
+ * Return true if the calling thread opened a cycle
+ */
+bool EWBMemDaemonCon::inCycle() const
+{
+	std::unique_lock<std::recursive_mutex> lock(bgd_mtx,std::try_to_lock);
+	return lock.owns_lock() && cycle>0;
+}
+
+void EWBMemDaemonCon::queue(uint32_t type, uint32_t addr, uint32_t nsize, uint32_t *pData32, int stat)
+{
+	Op o;
+	o.op.type=type;
+	o.op.addr=addr;
+	o.op.nsize=nsize;
+	o.pData32=pData32;
+	o.stat=stat;
+	if(type==EWBDaemonOp::WRITE)
+	{
+		//Keep a copy as the caller might modify it before the end of the cycle
+		o.pData32=NULL;
+		wdata.push_back(*pData32);
+	}
+	ops.push_back(o);
+}
+
+/**
+ * Single 32bit access to the daemon
+ *
+ * If a cycle is opened, the access is only queued.
+ */
+bool EWBMemDaemonCon::mem_access(uint32_t addr, uint32_t *data, bool to_dev)
+{
+	TRACE_CHECK_PTR(data,false);
+	int op=(to_dev)?EWBBridgeStats::SINGLE_W:EWBBridgeStats::SINGLE_R;
+	uint32_t type=(to_dev)?EWBDaemonOp::WRITE:EWBDaemonOp::READ;
+	std::lock_guard<std::recursive_mutex> lock(bgd_mtx);
+	if(cycle>0)
+	{
+		queue(type,addr,sizeof(uint32_t),data,op);
+		return true;
+	}
+
+	EWBBridgeStats::Probe probe(stats,op,sizeof(uint32_t));
+	TRACE_CHECK(isValid(),false,"Not connected");
+	queue(type,addr,sizeof(uint32_t),data,-1);
+	return probe.done(transact());
+}
+
+uint32_t EWBMemDaemonCon::get_block_buffer(uint32_t **hBuff, bool /*to_dev*/)
+{
+	*hBuff=pData;
+	return bsize;
+}
+
+bool EWBMemDaemonCon::mem_block_access(uint32_t dev_addr, uint32_t nsize, bool to_dev)
+{
+	TRACE_CHECK_VA(nsize<=bsize,false,"nsize=%d > %d",nsize,bsize);
+	block_busy=true;
+	bool ret=mem_block_xfer(dev_addr,nsize,pData,to_dev);
+	block_busy=false;
+	return ret;
+}
+
+/**
+ * Block access using the buffer of the caller (no size limit)
+ *
+ * The queued accesses of an opened cycle are sent in the same batch.
+ */
+bool EWBMemDaemonCon::mem_block_xfer(uint32_t dev_addr, uint32_t nsize, uint32_t *pData32, bool to_dev)
+{
+	EWBBridgeStats::Probe probe(stats,(to_dev)?EWBBridgeStats::BLOCK_W:EWBBridgeStats::BLOCK_R,nsize);
+	TRACE_CHECK_PTR(pData32,false);
+	TRACE_CHECK(isValid(),false,"Not connected");
+	std::lock_guard<std::recursive_mutex> lock(bgd_mtx);
+	queue((to_dev)?EWBDaemonOp::BLOCK_WRITE:EWBDaemonOp::BLOCK_READ,dev_addr,nsize & ~0x3,pData32,-1);
+	return probe.done(transact());
+}
+
+bool EWBMemDaemonCon::sendAll(const void *buff, size_t size)
+{
+	const uint8_t *p=(const uint8_t*)buff;
+	while(size>0)
+	{
+		ssize_t n=send(fd,p,size,MSG_NOSIGNAL);
+		if(n<0 && errno==EINTR) continue;
+		if(n<=0) return false;
+		p+=n;
+		size-=n;
+	}
+	return true;
+}
+
+bool EWBMemDaemonCon::recvAll(void *buff, size_t size)
+{
+	uint8_t *p=(uint8_t*)buff;
+	while(size>0)
+	{
+		ssize_t n=recv(fd,p,size,0);
+		if(n<0 && errno==EINTR) continue;
+		if(n<=0) return false;
+		p+=n;
+		size-=n;
+	}
+	return true;
+}
+
+/**
+ * Send a request to the daemon and wait for its reply
+ *
+ * \param[inout] tx The request with room for its header at the beginning.
+ * \param[in] nops The number of ops in the request.
+ * \param[in] nrwords The number of words expected in the reply.
+ * \param[out] rx The words of the reply.
+ * \param[out] nerrors The number of ops that failed on the daemon.
+ * \return false if the connection is lost (or the reply is not valid).
+ */
+bool EWBMemDaemonCon::exchange(std::vector<uint8_t> &tx, uint32_t nops, size_t nrwords, std::vector<uint32_t> &rx, uint32_t &nerrors)
+{
+	EWBDaemonHdr hdr={ EWBD_MAGIC, nops, (uint32_t)(tx.size()-sizeof(EWBDaemonHdr)) };
+	memcpy(&tx[0],&hdr,sizeof(hdr));
+
+	bool ret=isValid() && sendAll(&tx[0],tx.size()) && recvAll(&hdr,sizeof(hdr));
+	if(ret && (hdr.magic!=EWBD_MAGIC || hdr.size!=nrwords*sizeof(uint32_t)))
+	{
+		TRACE_P_ERROR("%s: bad reply (magic=0x%08x, size=%d)",name.c_str(),hdr.magic,hdr.size);
+		ret=false;
+	}
+	if(ret)
+	{
+		rx.resize(nrwords);
+		ret=(nrwords==0 || recvAll(&rx[0],hdr.size));
+	}
+	if(ret==false && fd>=0)
+	{
+		TRACE_P_ERROR("%s: connection lost",name.c_str());
+		close(fd);
+		fd=-1;
+		bumpGeneration();
+	}
+
+	nerrors=(ret)?hdr.nops:0;
+	if(nerrors>0) TRACE_P_WARNING("%s: %d operations failed",name.c_str(),nerrors);
+	return ret;
+}
+
+/**
+ * Send the queued operations in one batch and wait for the reply
+ */
+bool EWBMemDaemonCon::transact()
+{
+	bool ret=true;
+	uint64_t t0=EWBBridgeStats::now_ns();
+	if(ops.empty()) return true;
+
+	//Encode the request
+	std::vector<uint8_t> tx(sizeof(EWBDaemonHdr));
+	size_t nrwords=0, iw=0;
+	for(size_t i=0;i<ops.size();i++)
+	{
+		const Op &o=ops[i];
+		const uint8_t *pOp=(const uint8_t*)&o.op;
+		tx.insert(tx.end(),pOp,pOp+sizeof(o.op));
+		if(o.op.type==EWBDaemonOp::WRITE)
+		{
+			const uint8_t *p=(const uint8_t*)&wdata[iw++];
+			tx.insert(tx.end(),p,p+sizeof(uint32_t));
+		}
+		else if(o.op.type==EWBDaemonOp::BLOCK_WRITE)
+		{
+			const uint8_t *p=(const uint8_t*)o.pData32;
+			tx.insert(tx.end(),p,p+o.op.nsize);
+		}
+		else nrwords+=o.op.nsize/sizeof(uint32_t);
+	}
+
+	//Exchange with the daemon
+	std::vector<uint32_t> rx;
+	uint32_t nerrors=0;
+	ret=exchange(tx,ops.size(),nrwords,rx,nerrors);
+
+	//Dispatch the data read
+	if(ret)
+	{
+		size_t ir=0;
+		for(size_t i=0;i<ops.size();i++)
+		{
+			const Op &o=ops[i];
+			if(o.op.type==EWBDaemonOp::READ || o.op.type==EWBDaemonOp::BLOCK_READ)
+			{
+				memcpy(o.pData32,&rx[ir],o.op.nsize);
+				ir+=o.op.nsize/sizeof(uint32_t);
+			}
+		}
+		ret=(nerrors==0);
+	}
+
+	uint64_t ns=EWBBridgeStats::now_ns()-t0;
+	for(size_t i=0;i<ops.size() && stats.isEnabled();i++)
+	{
+		if(ops[i].stat>=0) stats.record(ops[i].stat,sizeof(uint32_t),ret,ns);
+	}
+	ops.clear();
+	wdata.clear();
+	return ret;
+}
+
+/**
+ * Execute the whole sequence on the daemon in one request
+ *
+ * The daemon performs the steps next to the bridge it shares (see EWBDaemon),
+ * so the polls and the read-modify-writes do not need a round trip each.
+ * The accesses queued in an opened cycle are sent before.
+ */
+bool EWBMemDaemonCon::mem_sequence(const std::vector<EWBSeqOp> &ops, std::vector<uint32_t> &rdata)
+{
+	TRACE_CHECK(isValid(),false,"Not connected");
+	std::lock_guard<std::recursive_mutex> lock(bgd_mtx);
+	if(transact()==false) return false;
+
+	size_t nrwords=0;
+	for(size_t i=0;i<ops.size();i++) if(ops[i].hasData()) nrwords++;
+	rdata.assign(nrwords,0);
+	if(ops.empty()) return true;
+
+	EWBDaemonOp op={ EWBDaemonOp::SEQUENCE, 0, (uint32_t)(ops.size()*sizeof(EWBSeqOp)) };
+	std::vector<uint8_t> tx(sizeof(EWBDaemonHdr)+sizeof(op));
+	memcpy(&tx[sizeof(EWBDaemonHdr)],&op,sizeof(op));
+	tx.insert(tx.end(),(const uint8_t*)&ops[0],(const uint8_t*)&ops[0]+op.nsize);
+
+	std::vector<uint32_t> rx;
+	uint32_t nerrors=0;
+	if(exchange(tx,1,nrwords,rx,nerrors)==false) return false;
+	rdata.swap(rx);
+	return (nerrors==0);
+}
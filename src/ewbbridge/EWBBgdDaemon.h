@@ -0,0 +1,63 @@
+/**
+ *  \file
+ *  \brief Contains the class EWBMemDaemonCon.
+ *
+ *  \date  Oct 19, 2026
+ */
+
+#ifndef EWBMEMDAEMONCON_H_
+#define EWBMEMDAEMONCON_H_
+
+#include "EWBBridge.h"
+#include "EWBDaemon.h"
+
+/**
+ * EWB memory connector to a bridge shared by an EWBDaemon
+ *
+ * The single accesses performed between openCycle() and closeCycle()
+ * are sent to the daemon in one batch.
+ *
+ * As an opened cycle holds \ref bgd_mtx, the internal block buffer
+ * is also protected by \ref bgd_mtx (see getBlockMutex()).
+ */
+class EWBMemDaemonCon: public EWBBridge {
+public:
+	EWBMemDaemonCon(const std::string &path=EWBD_SOCKET, uint32_t blk_maxb=0x10000);
+	virtual ~EWBMemDaemonCon();
+
+	bool isValid() { return (fd>=0); }
+	bool mem_access(uint32_t addr, uint32_t *data, bool to_dev);
+	uint32_t get_block_buffer(uint32_t **hBuff, bool to_dev);
+	bool mem_block_access(uint32_t dev_addr, uint32_t nsize, bool to_dev);
+	bool mem_block_xfer(uint32_t dev_addr, uint32_t nsize, uint32_t *pData32, bool to_dev);
+	//! The block buffer is leased with the lock of the cycles (same lock order for both)
+	std::recursive_mutex& getBlockMutex(bool /*to_dev*/) const { return bgd_mtx; }
+
+	bool openCycle();
+	bool closeCycle();
+	bool inCycle() const;
+	bool mem_sequence(const std::vector<EWBSeqOp> &ops, std::vector<uint32_t> &rdata);
+
+private:
+	//! A queued operation
+	struct Op {
+		EWBDaemonOp op;		//!< The operation sent to the daemon
+		uint32_t *pData32;	//!< Data to write or where to store the data read
+		int stat;			//!< Statistic to record or -1
+	};
+
+	void queue(uint32_t type, uint32_t addr, uint32_t nsize, uint32_t *pData32, int stat);
+	bool transact();
+	bool exchange(std::vector<uint8_t> &tx, uint32_t nops, size_t nrwords, std::vector<uint32_t> &rx, uint32_t &nerrors);
+	bool sendAll(const void *buff, size_t size);
+	bool recvAll(void *buff, size_t size);
+
+	int fd;					//!< Socket connected to the daemon
+	int cycle;				//!< Depth of the opened cycles
+	std::vector<Op> ops;	//!< Queued operations
+	std::vector<uint32_t> wdata;	//!< Copy of the single data to write
+	uint32_t *pData;		//!< Internal block buffer
+	uint32_t bsize;			//!< Size of the internal block buffer (bytes)
+};
+
+#endif /* EWBMEMDAEMONCON_H_ */
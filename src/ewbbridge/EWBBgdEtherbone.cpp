@@ -0,0 +1,506 @@
+/*
+ * EWBBgdEtherbone.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBBgdEtherbone.h"
+
+#include <cstring>
+#include <algorithm>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#define EWB_TRACE_MODULE EWB_TRACE_BRIDGE
+#include <EWBTrace.h>
+
+//! Size of the status record appended to each packet
+#define EB_STATUS_RECSIZE 12
+//! Config address of the low word of the error shift register
+#define EB_ESR_LOW 0x4
+//! Number of operations checked by a read of the low word of the error shift register
+#define EB_STATUS_NOPS 32
+//! Encode the return address of a read with the sequence number and its slot
+#define EB_TAG(seq,slot) ((((uint32_t)(seq) & 0x7FF) << 20) | (((slot)*4) & 0xFFFFF))
+
+static void push32(std::vector<uint8_t> &buff, uint32_t val)
+{
+	val=htonl(val);
+	const uint8_t *p=(const uint8_t*)&val;
+	buff.insert(buff.end(),p,p+4);
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+	uint32_t val;
+	memcpy(&val,p,4);
+	return ntohl(val);
+}
+
+/**
+ * Constructor of the Etherbone connector
+ *
+ * \param[in] url The address of the device: "udp/host/port", "host:port" or "host"
+ * \param[in] blk_maxb The size of the internal block buffer (bytes)
+ */
+EWBEtherboneCon::EWBEtherboneCon(const std::string &url, uint32_t blk_maxb)
+: EWBBridge(EWBBridge::ETHERBONE,url), sock(-1), probed(false), mtu(1472), window(8),
+  timeout_ms(100), nretries(3), cycle(0), seq(0), npackets(0), rbuff(0x10000), bsize(blk_maxb)
+{
+	std::string host=url, port;
+	size_t pos;
+
+	pData=(uint32_t*)malloc(bsize);
+	desc="Etherbone "+url;
+
+	if(host.compare(0,4,"udp/")==0) host=host.substr(4);
+	if((pos=host.find_last_of("/:"))!=std::string::npos)
+	{
+		port=host.substr(pos+1);
+		host=host.substr(0,pos);
+	}
+	if(port.empty()) port=EWBTrace::string_format("%d",EB_PORT);
+
+	struct addrinfo hints, *res;
+	memset(&hints,0,sizeof(hints));
+	hints.ai_family=AF_INET;
+	hints.ai_socktype=SOCK_DGRAM;
+	int err=getaddrinfo(host.c_str(),port.c_str(),&hints,&res);
+	if(err)
+	{
+		TRACE_P_ERROR("Can not resolve %s:%s (%s)",host.c_str(),port.c_str(),gai_strerror(err));
+		return;
+	}
+
+	sock=socket(res->ai_family,res->ai_socktype,res->ai_protocol);
+	if(sock>=0 && connect(sock,res->ai_addr,res->ai_addrlen)<0)
+	{
+		TRACE_P_ERROR("Can not connect to %s:%s (%s)",host.c_str(),port.c_str(),strerror(errno));
+		close(sock);
+		sock=-1;
+	}
+	freeaddrinfo(res);
+
+	if(sock>=0) probe();
+}
+
+/**
+ * Destructor that closes the socket
+ */
+EWBEtherboneCon::~EWBEtherboneCon()
+{
+	if(sock>=0) close(sock);
+	free(pData);
+}
+
+/**
+ * Send a probe packet and wait for the response of the device
+ *
+ * \return true if the device answered with 32-bit widths.
+ */
+bool EWBEtherboneCon::probe()
+{
+	uint8_t req[8]={ (uint8_t)(EB_MAGIC>>8), (uint8_t)(EB_MAGIC&0xFF), (uint8_t)((EB_VER<<4) | EB_PF), EB_W32, 0, 0, 0, 0 };
+	probed=false;
+	bumpGeneration();
+	TRACE_CHECK(sock>=0,false,"Socket not opened");
+
+	for(int i=0;i<=nretries && !probed;i++)
+	{
+		if(::send(sock,req,sizeof(req),0)<0) break;
+		struct pollfd pfd={ sock, POLLIN, 0 };
+		if(poll(&pfd,1,timeout_ms)<=0) continue;
+
+		ssize_t n=recv(sock,&rbuff[0],rbuff.size(),0);
+		if(n<4) break;
+		probed=(get32(&rbuff[0])>>16==EB_MAGIC && (rbuff[2] & EB_PR) && (rbuff[3] & EB_W32)==EB_W32);
+	}
+	if(probed) { TRACE_P_INFO("%s: Etherbone device found",name.c_str()); }
+	else { TRACE_P_WARNING("%s: No Etherbone device answered",name.c_str()); }
+	return probed;
+}
+
+/**
+ * Open a cycle where the single accesses are queued
+ *
+ * The other threads wait until the cycle is closed.
+ *
+ * \warning The data read are only valid after closeCycle().
+ */
+bool EWBEtherboneCon::openCycle()
+{
+	bgd_mtx.lock();
+	cycle++;
+	return true;
+}
+
+/**
+ * Close the cycle and perform all the queued accesses
+ *
+ * \return false if any of the accesses failed.
+ */
+bool EWBEtherboneCon::closeCycle()
+{
+	std::lock_guard<std::recursive_mutex> lock(bgd_mtx);
+	TRACE_CHECK(cycle>0,false,"No cycle opened");
+	bool ret=(--cycle>0)?true:flush();
+	bgd_mtx.unlock();	//Locked by openCycle()
+	return ret;
+}
+
+/**
+ * Return true if the calling thread opened a cycle
+ *
+ * The cycle of another thread holds bgd_mtx, so it is never seen.
+ */
+bool EWBEtherboneCon::inCycle() const
+{
+	std::unique_lock<std::recursive_mutex> lock(bgd_mtx,std::try_to_lock);
+	return lock.owns_lock() && cycle>0;
+}
+
+/**
+ * Append an access to the queue
+ */
+void EWBEtherboneCon::queue(uint32_t addr, uint32_t val, uint32_t *pData, bool to_dev, int stat)
+{
+	Op op={ addr, val, pData, to_dev, stat };
+	ops.push_back(op);
+}
+
+/**
+ * Single 32bit access to the device
+ *
+ * If a cycle is opened, the access is only queued.
+ */
+bool EWBEtherboneCon::mem_access(uint32_t addr, uint32_t *data, bool to_dev)
+{
+	TRACE_CHECK_PTR(data,false);
+	int op=(to_dev)?EWBBridgeStats::SINGLE_W:EWBBridgeStats::SINGLE_R;
+	std::lock_guard<std::recursive_mutex> lock(bgd_mtx);
+	if(cycle>0)
+	{
+		queue(addr,*data,data,to_dev,op);
+		return true;
+	}
+
+	EWBBridgeStats::Probe probe(stats,op,sizeof(uint32_t));
+	TRACE_CHECK(isValid(),false,"Not connected");
+	queue(addr,*data,data,to_dev,-1);
+	return probe.done(flush());
+}
+
+/**
+ * Retrieve the internal block buffer (same for read & write)
+ */
+uint32_t EWBEtherboneCon::get_block_buffer(uint32_t **hBuff, bool /*to_dev*/)
+{
+	*hBuff=pData;
+	return bsize;
+}
+
+/**
+ * Block access streamed as Etherbone records
+ *
+ * The queued accesses of an opened cycle are performed before.
+ */
+bool EWBEtherboneCon::mem_block_access(uint32_t dev_addr, uint32_t nsize, bool to_dev)
+{
+	TRACE_CHECK_VA(nsize<=bsize,false,"nsize=%d > %d",nsize,bsize);
+	return mem_block_xfer(dev_addr,nsize,pData,to_dev);
+}
+
+/**
+ * Block access streamed from the buffer of the caller (no size limit)
+ *
+ * Nothing is leased: the words are queued and flushed under bgd_mtx,
+ * so that a transfer inside an opened cycle takes no other lock.
+ * The queued accesses of an opened cycle are performed before.
+ */
+bool EWBEtherboneCon::mem_block_xfer(uint32_t dev_addr, uint32_t nsize, uint32_t *pData32, bool to_dev)
+{
+	EWBBridgeStats::Probe probe(stats,(to_dev)?EWBBridgeStats::BLOCK_W:EWBBridgeStats::BLOCK_R,nsize);
+	TRACE_CHECK_PTR(pData32,false);
+	TRACE_CHECK(isValid(),false,"Not connected");
+	std::lock_guard<std::recursive_mutex> lock(bgd_mtx);
+	block_busy=true;
+
+	for(uint32_t i=0;i<nsize/sizeof(uint32_t);i++)
+	{
+		queue(dev_addr+i*sizeof(uint32_t),pData32[i],pData32+i,to_dev,-1);
+	}
+	bool ret=flush();
+
+	block_busy=false;
+	return probe.done(ret);
+}
+
+/**
+ * Encode the queued accesses into a packet
+ *
+ * \param[in] first The index of the first access to encode
+ * \param[out] pkt The packet that will be filled
+ * \return the index of the next access that has not been encoded
+ */
+size_t EWBEtherboneCon::pack(size_t first, Packet &pkt)
+{
+	size_t i=first, n=ops.size();
+
+	pkt.buff.clear();
+	pkt.slots.clear();
+	pkt.masks.clear();
+	pkt.nerrors=0;
+	pkt.deadline=0;
+	pkt.nretries=0;
+	pkt.writes=pkt.sent=pkt.done=false;
+	push32(pkt.buff,(EB_MAGIC<<16) | (EB_VER<<12) | EB_W32);
+
+	size_t nchk=0;	//Operations since the last status read
+	while(i<n)
+	{
+		size_t room=mtu-EB_STATUS_RECSIZE-pkt.buff.size();
+		if(nchk==EB_STATUS_NOPS)
+		{
+			if(room<EB_STATUS_RECSIZE+12) break;
+			packStatus(pkt,nchk,false);
+			nchk=0;
+			room-=EB_STATUS_RECSIZE;
+		}
+		if(room<12) break;
+		room-=4;
+
+		//A run of writes to consecutive addresses
+		size_t nw=0, nr=0, nmax=std::min((size_t)REC_MAXCOUNT,EB_STATUS_NOPS-nchk);
+		while(i+nw<n && nw<nmax && ops[i+nw].to_dev && ops[i+nw].addr==ops[i].addr+nw*4) nw++;
+		//Followed by reads to any address
+		while(i+nw+nr<n && nw+nr<nmax && !ops[i+nw+nr].to_dev) nr++;
+
+		if(nw>0)
+		{
+			size_t max=(room-4)/4;
+			if(nw>max) { nw=max; nr=0; }
+			room-=4+nw*4;
+		}
+		if(nr>0)
+		{
+			if(room>=8) nr=std::min(nr,(room-4)/4);
+			else nr=0;
+		}
+		if(nw==0 && nr==0) break;
+		nchk+=nw+nr;
+
+		pkt.buff.push_back(0);
+		pkt.buff.push_back(0x0F);
+		pkt.buff.push_back(nw);
+		pkt.buff.push_back(nr);
+		if(nw>0)
+		{
+			pkt.writes=true;
+			push32(pkt.buff,ops[i].addr);
+			for(size_t k=0;k<nw;k++) push32(pkt.buff,ops[i+k].val);
+			i+=nw;
+		}
+		if(nr>0)
+		{
+			push32(pkt.buff,EB_TAG(pkt.seq,pkt.slots.size()));
+			for(size_t k=0;k<nr;k++)
+			{
+				push32(pkt.buff,ops[i+k].addr);
+				pkt.slots.push_back(ops[i+k].pData);
+			}
+			i+=nr;
+		}
+	}
+
+	//Read the status to get a reply and the errors
+	packStatus(pkt,nchk,true);
+	return i;
+}
+
+/**
+ * Append a read of the low word of the error shift register
+ *
+ * \param[out] pkt The packet that will be filled
+ * \param[in] nops The number of operations since the previous status read (up to \ref EB_STATUS_NOPS)
+ * \param[in] last true to end the wishbone cycle after the read
+ */
+void EWBEtherboneCon::packStatus(Packet &pkt, size_t nops, bool last)
+{
+	pkt.buff.push_back(REC_RCA | ((last)?REC_CYC:0));
+	pkt.buff.push_back(0x0F);
+	pkt.buff.push_back(0);
+	pkt.buff.push_back(1);
+	push32(pkt.buff,EB_TAG(pkt.seq,pkt.slots.size()));
+	push32(pkt.buff,EB_ESR_LOW);
+	pkt.masks[pkt.slots.size()]=(nops>=32)?0xFFFFFFFF:((1U<<nops)-1);
+	pkt.slots.push_back(NULL);
+}
+
+/**
+ * Send the encoded packet
+ */
+bool EWBEtherboneCon::send(Packet &pkt)
+{
+	ssize_t n=::send(sock,&pkt.buff[0],pkt.buff.size(),0);
+	TRACE_CHECK_VA(n==(ssize_t)pkt.buff.size(),false,"send() %s",strerror(errno));
+	TRACE_P_VDEBUG("%s: send packet #%d (%d bytes)",name.c_str(),pkt.seq,(int)n);
+	pkt.sent=true;
+	pkt.deadline=EWBBridgeStats::now_ns()+timeout_ms*1000000ULL;
+	npackets++;
+	return true;
+}
+
+/**
+ * Receive a reply and dispatch the values read to their slots
+ *
+ * \return the number of packets completed, or -1 on error.
+ */
+int EWBEtherboneCon::receive(std::vector<Packet> &pkts)
+{
+	ssize_t n=recv(sock,&rbuff[0],rbuff.size(),0);
+	TRACE_CHECK_VA(n>=0,-1,"recv() %s",strerror(errno));
+	if(n<4 || get32(&rbuff[0])>>16!=EB_MAGIC) return 0; //Ignore garbage
+
+	int ndone=0;
+	Packet *pPkt=NULL;
+	const uint8_t *p=&rbuff[4], *end=&rbuff[0]+n;
+	while(p+4<=end)
+	{
+		uint8_t nw=p[2], nr=p[3];
+		p+=4;
+		if(nw>0)
+		{
+			if(p+4+nw*4>end) break;
+			uint32_t base=get32(p);
+			uint16_t s=base>>20;
+			if(pPkt==NULL || pPkt->seq!=s)
+			{
+				pPkt=NULL;
+				for(size_t i=0;i<pkts.size();i++)
+				{
+					if(pkts[i].seq==s && pkts[i].sent && !pkts[i].done) { pPkt=&pkts[i]; break; }
+				}
+			}
+			for(size_t k=0;pPkt && k<nw;k++)
+			{
+				size_t slot=((base & 0xFFFFF)/4)+k;
+				uint32_t val=get32(p+4+k*4);
+				if(slot>=pPkt->slots.size()) continue;
+				if(pPkt->slots[slot]) *(pPkt->slots[slot])=val;
+				else
+				{
+					//The bits of the operations since the previous status read
+					pPkt->nerrors+=__builtin_popcount(val & pPkt->masks[slot]);
+					if(slot+1<pPkt->slots.size()) continue;
+					//The last status read ends the packet
+					pPkt->done=true;
+					ndone++;
+				}
+			}
+			p+=4+nw*4;
+		}
+		if(nr>0) p+=4+nr*4;
+	}
+	return ndone;
+}
+
+/**
+ * Perform all the queued accesses
+ *
+ * The read-only packets are pipelined up to \ref window packets in flight,
+ * a packet with writes is sent alone. A read-only packet without reply after
+ * \ref timeout_ms is retransmitted on its own, and the cycle fails when one
+ * packet reaches \ref nretries. A packet with writes is never retransmitted
+ * (its writes might have been done when only its reply was lost).
+ */
+bool EWBEtherboneCon::flush()
+{
+	bool ret=true;
+	uint64_t t0=EWBBridgeStats::now_ns();
+	if(ops.empty()) return true;
+
+	std::vector<Packet> pkts;
+	if(isValid())
+	{
+		for(size_t i=0;i<ops.size();)
+		{
+			pkts.push_back(Packet());
+			pkts.back().seq=(seq++) & 0x7FF;
+			i=pack(i,pkts.back());
+		}
+	}
+	else ret=false;
+
+	size_t next=0, ndone=0, inflight=0;
+	while(ret && ndone<pkts.size())
+	{
+		while(next<pkts.size() && inflight<window)
+		{
+			//Do not pipeline past an unacknowledged packet with writes
+			if(inflight>0 && (pkts[next].writes || pkts[next-1].writes)) break;
+			ret &= send(pkts[next++]);
+			inflight++;
+		}
+
+		//Wait until the earliest deadline of the packets in flight
+		uint64_t now=EWBBridgeStats::now_ns(), first=UINT64_MAX;
+		for(size_t i=0;i<next;i++)
+		{
+			if(pkts[i].done==false) first=std::min(first,pkts[i].deadline);
+		}
+		int ms=(first>now)?(int)((first-now+999999)/1000000):0;
+
+		struct pollfd pfd={ sock, POLLIN, 0 };
+		int err=poll(&pfd,1,ms);
+		if(err>0)
+		{
+			int nd=receive(pkts);
+			if(nd<0) ret=false;
+			else { ndone+=nd; inflight-=nd; }
+		}
+		else if(err<0) ret=false;
+
+		//Retransmit only the read-only packets whose own deadline has expired
+		now=EWBBridgeStats::now_ns();
+		for(size_t i=0;ret && i<next;i++)
+		{
+			if(pkts[i].done || pkts[i].deadline>now) continue;
+			if(pkts[i].writes)
+			{
+				TRACE_P_WARNING("%s: no reply to packet #%d with writes, not retransmitted (%d/%d packets)",
+						name.c_str(),pkts[i].seq,(int)ndone,(int)pkts.size());
+				ret=false;
+				break;
+			}
+			if(pkts[i].nretries>=nretries)
+			{
+				TRACE_P_WARNING("%s: no reply to packet #%d after %d retries (%d/%d packets)",
+						name.c_str(),pkts[i].seq,nretries,(int)ndone,(int)pkts.size());
+				ret=false;
+				break;
+			}
+			pkts[i].nretries++;
+			stats.addRetry(EWBBridgeStats::SINGLE_R);	//The packet only has reads
+			ret &= send(pkts[i]);
+		}
+	}
+
+	for(size_t i=0;i<pkts.size();i++)
+	{
+		if(pkts[i].nerrors==0) continue;
+		TRACE_P_WARNING("%s: %d access errors in packet #%d",name.c_str(),pkts[i].nerrors,pkts[i].seq);
+		ret=false;
+	}
+
+	uint64_t ns=EWBBridgeStats::now_ns()-t0;
+	for(size_t i=0;i<ops.size() && stats.isEnabled();i++)
+	{
+		if(ops[i].stat>=0) stats.record(ops[i].stat,sizeof(uint32_t),ret,ns);
+	}
+	ops.clear();
+	return ret;
+}
@@ -0,0 +1,139 @@
+/**
+ *  \file
+ *  \brief Contains the class EWBEtherboneCon.
+ *
+ *  \see Etherbone specification (White Rabbit, CERN/GSI)
+ *
+ *  \date  Oct 19, 2026
+ */
+
+#ifndef EWBETHERBONECON_H_
+#define EWBETHERBONECON_H_
+
+#include "EWBBridge.h"
+#include <map>
+
+/**
+ * EWB memory connector using Etherbone over UDP
+ *
+ * The single accesses performed between openCycle() and closeCycle()
+ * are queued and packed into Etherbone records: a record holds a
+ * run of writes to consecutive addresses followed by up to 255 reads.
+ * The records are packed into UDP packets of at most \ref mtu bytes
+ * and up to \ref window packets are in flight at the same time.
+ *
+ * The block accesses are mapped onto the same streaming records,
+ * mem_block_xfer() queues them directly from the buffer of the caller.
+ * As an opened cycle holds \ref bgd_mtx, the internal block buffer
+ * is also protected by \ref bgd_mtx (see getBlockMutex()).
+ *
+ * Each packet ends with a read of the error shift register of the
+ * remote configuration space so that:
+ * 		- every packet (even with only writes) gets a reply,
+ * 		- a failed access is reported by the cycle that contains it.
+ *
+ * The error shift register is shifted by each wishbone operation (its
+ * bit 0 is the error of the last one) and is not cleared by a read. Its
+ * low word is read every 32 operations and only the bits of the
+ * operations of the packet are kept.
+ *
+ * The replies are matched with their packets using the return
+ * address of the reads (sequence number and slot index). A packet
+ * with writes is sent alone (the previous packets are acknowledged and
+ * the next ones wait for it) so that the writes are never reordered.
+ * A packet without reply after \ref timeout_ms fails the cycle, except
+ * the read-only packets that are retransmitted up to \ref nretries times.
+ *
+ * \warning The reads are assumed without side effect when retransmitted,
+ * use setTimeout(ms,0) for a device with clear-on-read or FIFO registers.
+ *
+ * \note Only 32-bit address & data width is supported.
+ */
+class EWBEtherboneCon: public EWBBridge {
+public:
+	//! Constants of the Etherbone protocol
+	enum {
+		EB_MAGIC=0x4E6F,	//!< Magic number of the packet header
+		EB_PORT=0xEBD0,		//!< Default UDP port
+		EB_VER=1,			//!< Version of the protocol
+		EB_PF=0x01,			//!< Probe flag
+		EB_PR=0x02,			//!< Probe response
+		EB_NR=0x04,			//!< No reads
+		EB_W32=0x44,		//!< 32-bit address & port size
+		REC_BCA=0x80,		//!< Base return address is in config space
+		REC_RCA=0x40,		//!< Read addresses are in config space
+		REC_RFF=0x20,		//!< Read results go to a FIFO
+		REC_CYC=0x08,		//!< Drop the wishbone cycle after the record
+		REC_WCA=0x04,		//!< Write addresses are in config space
+		REC_WFF=0x02,		//!< Writes go to a FIFO
+		REC_MAXCOUNT=255,	//!< Maximum number of writes/reads in a record
+	};
+
+	EWBEtherboneCon(const std::string &url, uint32_t blk_maxb=0x10000);
+	virtual ~EWBEtherboneCon();
+
+	bool isValid() { return (sock>=0 && probed); }
+	bool mem_access(uint32_t addr, uint32_t *data, bool to_dev);
+	uint32_t get_block_buffer(uint32_t **hBuff, bool to_dev);
+	bool mem_block_access(uint32_t dev_addr, uint32_t nsize, bool to_dev);
+	bool mem_block_xfer(uint32_t dev_addr, uint32_t nsize, uint32_t *pData32, bool to_dev);
+	//! The block buffer is leased with the lock of the cycles (same lock order for both)
+	std::recursive_mutex& getBlockMutex(bool /*to_dev*/) const { return bgd_mtx; }
+
+	bool openCycle();
+	bool closeCycle();
+	bool inCycle() const;
+
+	bool probe();
+	void setMTU(uint32_t mtu) { this->mtu=(mtu<64)?64:mtu; }	//!< Maximum size of a UDP payload
+	void setWindow(uint32_t npkts) { window=(npkts<1)?1:npkts; }	//!< Maximum number of packets in flight
+	void setTimeout(int ms, int nretries=3) { timeout_ms=ms; this->nretries=nretries; }	//!< Timeout of a reply and retransmissions of the read-only packets
+	uint64_t getNPackets() const { return npackets; }	//!< Number of sent packets (including retries)
+
+protected:
+	//! A queued single access
+	struct Op {
+		uint32_t addr;		//!< Address on the wishbone bus
+		uint32_t val;		//!< Value to write
+		uint32_t *pData;	//!< Where to store the value read
+		bool to_dev;		//!< true for a write
+		int stat;			//!< Statistic to record or -1
+	};
+
+	//! A request packet and where to store its replies
+	struct Packet {
+		uint16_t seq;					//!< Sequence number (used as return address tag)
+		std::vector<uint8_t> buff;		//!< Encoded request
+		std::vector<uint32_t*> slots;	//!< Destination of each read (NULL: error shift register)
+		std::map<size_t,uint32_t> masks;	//!< Bits of the operations checked by each status read (by slot)
+		uint32_t nerrors;				//!< Number of failed operations
+		uint64_t deadline;				//!< Time (ns) after which the packet is retransmitted
+		int nretries;					//!< Number of retransmissions of this packet
+		bool writes;					//!< The packet has writes (never retransmitted)
+		bool sent;
+		bool done;
+	};
+
+	void queue(uint32_t addr, uint32_t val, uint32_t *pData, bool to_dev, int stat);
+	bool flush();
+	size_t pack(size_t first, Packet &pkt);
+	void packStatus(Packet &pkt, size_t nops, bool last);
+	bool send(Packet &pkt);
+	int receive(std::vector<Packet> &pkts);
+
+	int sock;				//!< UDP socket connected to the device
+	bool probed;			//!< true when the device answered to the probe
+	uint32_t mtu;			//!< Maximum size of a packet (bytes)
+	uint32_t window;		//!< Maximum number of packets in flight
+	int timeout_ms;			//!< Time to wait for a reply (ms)
+	int nretries;			//!< Number of retransmissions of a packet before failing
+	int cycle;				//!< Depth of the opened cycles
+	uint16_t seq;			//!< Next sequence number
+	uint64_t npackets;		//!< Number of sent packets
+	std::vector<Op> ops;	//!< Queued accesses
+	std::vector<uint8_t> rbuff;	//!< Reception buffer
+	uint32_t *pData;		//!< Internal block buffer
+	uint32_t bsize;			//!< Size of the internal block buffer (bytes)
+};
+
+#endif /* EWBETHERBONECON_H_ */
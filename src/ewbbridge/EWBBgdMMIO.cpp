@@ -0,0 +1,205 @@
+/*
+ * EWBBgdMMIO.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBBgdMMIO.h"
+
+#include <cstdio>
+#include <cstring>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define EWB_TRACE_MODULE EWB_TRACE_BRIDGE
+#include <EWBTrace.h>
+
+//! Full barrier so that the MMIO accesses are not reordered (compiler & CPU)
+#define EWB_MMIO_BARRIER() __sync_synchronize()
+
+/**
+ * Constructor that maps a PCI resource file or an UIO device
+ *
+ * \param[in] path The sysfs resource file (/sys/bus/pci/devices/0000:01:00.0/resource0)
+ * or the UIO device (/dev/uio0).
+ * \param[in] size The size to map, if 0 it is obtained from the file or the UIO sysfs.
+ * \param[in] wb_base The wishbone address of the start of the BAR.
+ * \param[in] type The type of bridge to report.
+ */
+EWBMemMMIOCon::EWBMemMMIOCon(const std::string &path, size_t size, uint32_t wb_base, int type)
+: EWBBridge(type,path), pBar(NULL), size(size), wb_base(wb_base), bsize(0x8000)
+{
+	int uio=-1;
+	pData=(uint32_t*)malloc(bsize);
+	stats.setEnabled(false);
+	desc="MMIO "+path;
+
+	int fd=open(path.c_str(),O_RDWR | O_SYNC);
+	if(fd<0)
+	{
+		TRACE_P_ERROR("Can not open %s (%s)",path.c_str(),strerror(errno));
+		return;
+	}
+
+	if(sscanf(path.c_str(),"/dev/uio%d",&uio)==1)
+	{
+		//UIO: the first map is at offset 0
+		if(this->size==0) this->size=getUIOMapSize(uio,0);
+	}
+	else if(this->size==0)
+	{
+		struct stat st;
+		if(fstat(fd,&st)==0) this->size=st.st_size;
+	}
+	map(fd,0);
+	close(fd);
+}
+
+/**
+ * Constructor that maps an already opened file descriptor
+ *
+ * This is mainly used with a memfd as stand-in of a PCI BAR.
+ *
+ * \param[in] fd The file descriptor (it can be closed afterwards).
+ * \param[in] size The size to map.
+ * \param[in] name The name of the bridge
+ * \param[in] wb_base The wishbone address of the start of the BAR.
+ */
+EWBMemMMIOCon::EWBMemMMIOCon(int fd, size_t size, const std::string &name, uint32_t wb_base)
+: EWBBridge(EWBBridge::RAWRABBIT,name), pBar(NULL), size(size), wb_base(wb_base), bsize(0x8000)
+{
+	pData=(uint32_t*)malloc(bsize);
+	stats.setEnabled(false);
+	desc="MMIO fd";
+	map(fd,0);
+}
+
+/**
+ * Destructor that unmap the BAR
+ */
+EWBMemMMIOCon::~EWBMemMMIOCon()
+{
+	if(pBar) munmap((void*)pBar,size);
+	free(pData);
+}
+
+/**
+ * Map the file descriptor
+ */
+void EWBMemMMIOCon::map(int fd, off_t offset)
+{
+	if(size==0)
+	{
+		TRACE_P_ERROR("%s: unknown size of the BAR",name.c_str());
+		return;
+	}
+	void *ptr=mmap(NULL,size,PROT_READ | PROT_WRITE,MAP_SHARED,fd,offset);
+	if(ptr==MAP_FAILED)
+	{
+		TRACE_P_ERROR("%s: mmap of 0x%x bytes failed (%s)",name.c_str(),(uint32_t)size,strerror(errno));
+		return;
+	}
+	pBar=(volatile uint32_t*)ptr;
+	TRACE_P_INFO("%s: 0x%x bytes mapped at wishbone 0x%08X",name.c_str(),(uint32_t)size,wb_base);
+}
+
+/**
+ * Obtain the size of a UIO map from sysfs
+ *
+ * \return the size in bytes or 0 on error
+ */
+size_t EWBMemMMIOCon::getUIOMapSize(int uio, int map)
+{
+	unsigned long val=0;
+	std::string fname=EWBTrace::string_format("/sys/class/uio/uio%d/maps/map%d/size",uio,map);
+	FILE *f=fopen(fname.c_str(),"r");
+	if(f==NULL) return 0;
+	if(fscanf(f,"%lx",&val)!=1) val=0;
+	fclose(f);
+	return val;
+}
+
+/**
+ * Single 32bit access to the mapped BAR
+ *
+ * \param[in] addr The wishbone address of the data we want to access.
+ * \param[inout] data the read "read from/write to" the device.
+ * \param[in] to_dev if true we write to the device.
+ */
+bool EWBMemMMIOCon::mem_access(uint32_t addr, uint32_t *data, bool to_dev)
+{
+	EWBBridgeStats::Probe probe(stats,(to_dev)?EWBBridgeStats::SINGLE_W:EWBBridgeStats::SINGLE_R,sizeof(uint32_t));
+	uint32_t off=addr-wb_base;
+	TRACE_CHECK_PTR(data,false);
+	TRACE_CHECK_VA(pBar && addr>=wb_base && (uint64_t)off+sizeof(uint32_t)<=size,false,"@%08X out of BAR",addr);
+
+	if(to_dev)
+	{
+		pBar[off/sizeof(uint32_t)]=*data;
+		EWB_MMIO_BARRIER();
+	}
+	else
+	{
+		EWB_MMIO_BARRIER();
+		*data=pBar[off/sizeof(uint32_t)];
+	}
+	TRACE_P_VDEBUG("%s@%08X %s %08x",(to_dev)?"W":"R", addr,(to_dev)?"=>":"<=",*data);
+	return probe.done(true);
+}
+
+/**
+ * Retrieve the internal block buffer (same for read & write)
+ */
+uint32_t EWBMemMMIOCon::get_block_buffer(uint32_t **hBuff, bool /*to_dev*/)
+{
+	*hBuff=pData;
+	return bsize;
+}
+
+/**
+ * Copy between the mapped BAR and a buffer
+ *
+ * The words are copied one by one with 32-bit accesses
+ * (memcpy() might use other widths). The statistics are recorded by the caller.
+ */
+bool EWBMemMMIOCon::block_copy(uint32_t dev_addr, uint32_t nsize, uint32_t *pBuff, bool to_dev)
+{
+	uint32_t off=dev_addr-wb_base;
+	TRACE_CHECK_VA(pBar && dev_addr>=wb_base && (uint64_t)off+nsize<=size,false,"@%08X+%d out of BAR",dev_addr,nsize);
+
+	volatile uint32_t *pReg=pBar+off/sizeof(uint32_t);
+	uint32_t nwords=nsize/sizeof(uint32_t);
+	EWB_MMIO_BARRIER();
+	if(to_dev) for(uint32_t i=0;i<nwords;i++) pReg[i]=pBuff[i];
+	else for(uint32_t i=0;i<nwords;i++) pBuff[i]=pReg[i];
+	EWB_MMIO_BARRIER();
+
+	TRACE_P_VDEBUG("%s@%08X %s (nsize=%d)",(to_dev)?"W":"R", dev_addr,(to_dev)?"=>":"<=",nsize);
+	return true;
+}
+
+/**
+ * Block access to the mapped BAR using the internal buffer
+ */
+bool EWBMemMMIOCon::mem_block_access(uint32_t dev_addr, uint32_t nsize, bool to_dev)
+{
+	EWBBridgeStats::Probe probe(stats,(to_dev)?EWBBridgeStats::BLOCK_W:EWBBridgeStats::BLOCK_R,nsize);
+	TRACE_CHECK_VA(nsize<=bsize,false,"nsize=%d > %d",nsize,bsize);
+	block_busy=true;
+	bool ret=block_copy(dev_addr,nsize,pData,to_dev);
+	block_busy=false;
+	return probe.done(ret);
+}
+
+/**
+ * Block transfer using directly the buffer of the caller (in one access)
+ */
+bool EWBMemMMIOCon::mem_block_xfer(uint32_t dev_addr, uint32_t nsize, uint32_t *pData32, bool to_dev)
+{
+	EWBBridgeStats::Probe probe(stats,(to_dev)?EWBBridgeStats::BLOCK_W:EWBBridgeStats::BLOCK_R,nsize);
+	TRACE_CHECK_PTR(pData32,false);
+	return probe.done(block_copy(dev_addr,nsize,pData32,to_dev));
+}
@@ -0,0 +1,62 @@
+/**
+ *  \file
+ *  \brief Contains the class EWBMemMMIOCon.
+ *
+ *  \see This class use:
+ *  	- the sysfs PCI resource files (/sys/bus/pci/devices/<BDF>/resource<N>)
+ *  	- or the UIO devices (/dev/uio<N>)
+ *
+ *  \date  Oct 19, 2026
+ */
+
+#ifndef EWBMEMMMIOCON_H_
+#define EWBMEMMMIOCON_H_
+
+#include "EWBBridge.h"
+
+/**
+ * EWB memory connector using a memory mapped PCI BAR
+ *
+ * The BAR is mapped in the process and each wishbone register
+ * is accessed with a 32-bit volatile load/store followed by a
+ * memory barrier, without any syscall or library call.
+ *
+ * The wishbone address \c wb_base is mapped at the beginning of the BAR.
+ *
+ * The accesses do not share any state, so concurrent callers are never
+ * serialized (except for the internal block buffer, see BlockLease).
+ *
+ * The statistics are disabled by default: timing a single access costs
+ * two clock reads, as much as the access itself (see EWBBridgeStats::setEnabled()).
+ *
+ * \note The BAR is expected to be little endian as the host (x86).
+ */
+class EWBMemMMIOCon: public EWBBridge {
+public:
+	EWBMemMMIOCon(const std::string &path, size_t size=0, uint32_t wb_base=0, int type=EWBBridge::RAWRABBIT);
+	EWBMemMMIOCon(int fd, size_t size, const std::string &name, uint32_t wb_base=0);
+	virtual ~EWBMemMMIOCon();
+
+	bool isValid() { return (pBar!=NULL); }
+	bool mem_access(uint32_t addr, uint32_t *data, bool to_dev);
+	uint32_t get_block_buffer(uint32_t **hBuff, bool to_dev);
+	bool mem_block_access(uint32_t dev_addr, uint32_t nsize, bool to_dev);
+	bool mem_block_xfer(uint32_t dev_addr, uint32_t nsize, uint32_t *pData32, bool to_dev);
+
+	size_t getSize() const { return size; }		//!< Size of the mapped BAR (bytes)
+	uint32_t getBase() const { return wb_base; }	//!< Wishbone address of the start of the BAR
+
+	static size_t getUIOMapSize(int uio, int map=0);
+
+private:
+	void map(int fd, off_t offset);
+	bool block_copy(uint32_t dev_addr, uint32_t nsize, uint32_t *pBuff, bool to_dev);
+
+	volatile uint32_t *pBar;	//!< Mapped BAR
+	size_t size;				//!< Size of the mapping (bytes)
+	uint32_t wb_base;			//!< Wishbone address of the start of the BAR
+	uint32_t *pData;			//!< Internal block buffer
+	uint32_t bsize;				//!< Size of the internal block buffer (bytes)
+};
+
+#endif /* EWBMEMMMIOCON_H_ */
@@ -0,0 +1,311 @@
+/*
+ * EWBBgdRAM.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBBgdRAM.h"
+
+#include <cstring>
+#include <algorithm>
+#include <time.h>
+
+#define EWB_TRACE_MODULE EWB_TRACE_BRIDGE
+#include <EWBTrace.h>
+
+/**
+ * Constructor of the EWBMemRAMCon
+ *
+ * \param[in] name The name of the bridge
+ * \param[in] fill The value returned when reading memory that was never written
+ */
+EWBMemRAMCon::EWBMemRAMCon(const std::string &name, uint32_t fill)
+: EWBBridge(EWBBridge::RAM,name), fill(fill), npages(0), duplex(false), sim_ns(0), noverlaps(0)
+{
+	memset(l1,0,sizeof(l1));
+	nblk_busy[0]=0;
+	nblk_busy[1]=0;
+	model=&defModel;
+	pCost=model;
+	bsize=model->blk_maxb;
+	pData=(uint32_t*)malloc(bsize);
+	pDataRd=(uint32_t*)malloc(bsize);
+	desc="In-memory image";
+}
+
+/**
+ * Destructor that frees all the pages
+ */
+EWBMemRAMCon::~EWBMemRAMCon()
+{
+	clear();
+	free(pData);
+	free(pDataRd);
+}
+
+/**
+ * Copy a latency model (the block buffer is resized to its blk_maxb)
+ *
+ * \warning Only while the bridge is idle, see setLatencyModel(EWBLatencyModel*).
+ */
+void EWBMemRAMCon::setLatencyModel(const EWBLatencyModel &m)
+{
+	std::lock_guard<std::recursive_mutex> lock(blk_mtx), lock_rd(blk_rd_mtx), lock_bgd(bgd_mtx);
+	defModel=m;
+	setLatencyModel(&defModel);
+}
+
+/**
+ * Use a custom latency model (not owned by the bridge)
+ *
+ * The block buffers and the page table are locked (in the lock order
+ * of the bridges) while the buffers are resized.
+ *
+ * \warning The latency is applied outside the locks (see wait()), so the
+ * model must only be set while the bridge is idle (no access in progress
+ * nor planned by another thread).
+ * \param[in] pModel The model, or NULL to use the default one (no latency).
+ */
+void EWBMemRAMCon::setLatencyModel(EWBLatencyModel *pModel)
+{
+	std::lock_guard<std::recursive_mutex> lock(blk_mtx), lock_rd(blk_rd_mtx), lock_bgd(bgd_mtx);
+	if(pModel==NULL)
+	{
+		defModel=EWBLatencyModel();
+		pModel=&defModel;
+	}
+	if(pModel->blk_maxb!=bsize)
+	{
+		bsize=pModel->blk_maxb;
+		free(pData);
+		free(pDataRd);
+		pData=(uint32_t*)malloc(bsize);
+		pDataRd=(uint32_t*)malloc(bsize);
+	}
+	model=pModel;
+	pCost=model;	//The planner knows the simulated cost
+}
+
+/**
+ * Simulate a bridge with independent block accesses in each direction
+ *
+ * When enabled, the reads and the writes use their own block buffer
+ * so that a BlockLease of each direction can be held at the same time.
+ */
+void EWBMemRAMCon::setDuplex(bool val)
+{
+	std::lock_guard<std::recursive_mutex> lock(blk_mtx), lock_rd(blk_rd_mtx);
+	duplex=val;
+}
+
+/**
+ * Free all the pages (the memory is back to the fill value)
+ */
+void EWBMemRAMCon::clear()
+{
+	std::lock_guard<std::recursive_mutex> lock(bgd_mtx);
+	for(int i=0;i<(1<<L1_BITS);i++)
+	{
+		if(l1[i]==NULL) continue;
+		for(int j=0;j<(1<<L2_BITS);j++) free(l1[i][j]);
+		free(l1[i]);
+		l1[i]=NULL;
+	}
+	npages=0;
+}
+
+/**
+ * Get the page that contains an address
+ *
+ * \param[in] addr The address on the wishbone space
+ * \param[in] create When true the page is allocated if it does not exist
+ * \return the page or NULL if it does not exist.
+ * \note bgd_mtx must be locked by the caller.
+ */
+uint32_t* EWBMemRAMCon::getPage(uint32_t addr, bool create)
+{
+	uint32_t i1=addr >> (PAGE_BITS+L2_BITS);
+	uint32_t i2=(addr >> PAGE_BITS) & ((1<<L2_BITS)-1);
+
+	if(l1[i1]==NULL)
+	{
+		if(create==false) return NULL;
+		l1[i1]=(uint32_t**)calloc(1<<L2_BITS,sizeof(uint32_t*));
+	}
+	if(l1[i1][i2]==NULL && create)
+	{
+		uint32_t *page=(uint32_t*)malloc(PAGE_WORDS*sizeof(uint32_t));
+		for(int i=0;i<PAGE_WORDS;i++) page[i]=fill;
+		l1[i1][i2]=page;
+		npages++;
+	}
+	return l1[i1][i2];
+}
+
+/**
+ * Return the time used by calibrate()
+ *
+ * In ACCOUNT mode the accesses do not wait, the simulated time is returned.
+ */
+uint64_t EWBMemRAMCon::clock_ns() const
+{
+	if(model->mode==EWBLatencyModel::ACCOUNT) return sim_ns;
+	return EWBBridge::clock_ns();
+}
+
+/**
+ * Apply the latency according to the mode of the model
+ */
+void EWBMemRAMCon::wait(uint64_t ns)
+{
+	sim_ns+=ns;
+	if(ns==0 || model->mode==EWBLatencyModel::ACCOUNT) return;
+
+	if(model->mode==EWBLatencyModel::SLEEP)
+	{
+		struct timespec ts;
+		ts.tv_sec=ns/1000000000ULL;
+		ts.tv_nsec=ns%1000000000ULL;
+		nanosleep(&ts,NULL);
+	}
+	else
+	{
+		uint64_t end=EWBBridgeStats::now_ns()+ns;
+		while(EWBBridgeStats::now_ns()<end);
+	}
+}
+
+/**
+ * Read a word without any latency nor statistics
+ */
+uint32_t EWBMemRAMCon::peek(uint32_t addr) const
+{
+	std::lock_guard<std::recursive_mutex> lock(bgd_mtx);
+	uint32_t i1=addr >> (PAGE_BITS+L2_BITS);
+	uint32_t i2=(addr >> PAGE_BITS) & ((1<<L2_BITS)-1);
+	if(l1[i1]==NULL || l1[i1][i2]==NULL) return fill;
+	return l1[i1][i2][(addr & ((1<<PAGE_BITS)-1))/sizeof(uint32_t)];
+}
+
+/**
+ * Write a word without any latency nor statistics
+ */
+void EWBMemRAMCon::poke(uint32_t addr, uint32_t data)
+{
+	std::lock_guard<std::recursive_mutex> lock(bgd_mtx);
+	getPage(addr,true)[(addr & ((1<<PAGE_BITS)-1))/sizeof(uint32_t)]=data;
+}
+
+/**
+ * Load an image of nwords starting at addr (without latency)
+ */
+void EWBMemRAMCon::load(uint32_t addr, const uint32_t *pData32, uint32_t nwords)
+{
+	std::lock_guard<std::recursive_mutex> lock(bgd_mtx);
+	for(uint32_t i=0;i<nwords;i++) poke(addr+i*sizeof(uint32_t),pData32[i]);
+}
+
+/**
+ * Single 32bit access to the RAM image
+ *
+ * \param[in] addr The address of the data we want to access.
+ * \param[inout] data the read "read from/write to" the image.
+ * \param[in] to_dev if true we write to the image.
+ */
+bool EWBMemRAMCon::mem_access(uint32_t addr, uint32_t *data, bool to_dev)
+{
+	EWBBridgeStats::Probe probe(stats,(to_dev)?EWBBridgeStats::SINGLE_W:EWBBridgeStats::SINGLE_R,sizeof(uint32_t));
+	TRACE_CHECK_PTR(data,false);
+
+	if(to_dev) poke(addr,*data);
+	else *data=peek(addr);
+	wait(model->cost(false,sizeof(uint32_t),to_dev));
+
+	TRACE_P_VDEBUG("%s@%08X %s %08x",(to_dev)?"W":"R", addr,(to_dev)?"=>":"<=",*data);
+	return probe.done(true);
+}
+
+/**
+ * Retrieve the internal block buffer (same for read & write unless duplex)
+ */
+uint32_t EWBMemRAMCon::get_block_buffer(uint32_t **hBuff, bool to_dev)
+{
+	*hBuff=(to_dev || !duplex)?pData:pDataRd;
+	return bsize;
+}
+
+/**
+ * Copy between the RAM image and a buffer, then apply the latency of one block access
+ *
+ * The statistics are recorded by the caller. A block access that starts while
+ * a block access of the other direction is in progress is counted as an
+ * overlap (see getNOverlaps()).
+ *
+ * \param[in] dev_addr The address on the device of the data we want to access.
+ * \param[in] nsize The size in byte that we want to read/write.
+ * \param[inout] pBuff The buffer (internal or from the caller).
+ * \param[in] to_dev if true we write to the image.
+ */
+bool EWBMemRAMCon::block_copy(uint32_t dev_addr, uint32_t nsize, uint32_t *pBuff, bool to_dev)
+{
+	uint32_t nwords=nsize/sizeof(uint32_t);
+	nblk_busy[(to_dev)?1:0]++;
+	if(nblk_busy[(to_dev)?0:1]>0) noverlaps++;
+	{
+		std::lock_guard<std::recursive_mutex> lock(bgd_mtx);
+		for(uint32_t i=0;i<nwords;)
+		{
+			uint32_t addr=dev_addr+i*sizeof(uint32_t);
+			uint32_t woff=(addr & ((1<<PAGE_BITS)-1))/sizeof(uint32_t);
+			uint32_t n=std::min((uint32_t)PAGE_WORDS-woff,nwords-i);
+			uint32_t *page=getPage(addr,to_dev);
+			if(to_dev) memcpy(page+woff,pBuff+i,n*sizeof(uint32_t));
+			else if(page) memcpy(pBuff+i,page+woff,n*sizeof(uint32_t));
+			else for(uint32_t j=0;j<n;j++) pBuff[i+j]=fill;
+			i+=n;
+		}
+	}
+	wait(model->cost(true,nsize,to_dev));
+	nblk_busy[(to_dev)?1:0]--;
+
+	TRACE_P_VDEBUG("%s@%08X %s (nsize=%d)",(to_dev)?"W":"R", dev_addr,(to_dev)?"=>":"<=",nsize);
+	return true;
+}
+
+/**
+ * Block access to the RAM image
+ *
+ * \param[in] dev_addr The address on the device of the data we want to access.
+ * \param[in] nsize The size in byte that we want to read/write.
+ * \param[in] to_dev if true we write to the image.
+ */
+bool EWBMemRAMCon::mem_block_access(uint32_t dev_addr, uint32_t nsize, bool to_dev)
+{
+	EWBBridgeStats::Probe probe(stats,(to_dev)?EWBBridgeStats::BLOCK_W:EWBBridgeStats::BLOCK_R,nsize);
+	TRACE_CHECK_VA(nsize<=bsize,false,"nsize=%d > %d",nsize,bsize);
+	block_busy=true;
+	bool ret=block_copy(dev_addr,nsize,(to_dev || !duplex)?pData:pDataRd,to_dev);
+	block_busy=false;
+	return probe.done(ret);
+}
+
+/**
+ * Block transfer using directly the buffer of the caller
+ *
+ * The transfer is split in accesses of blk_maxb bytes as the default
+ * implementation, but without using (and locking) the internal buffer.
+ */
+bool EWBMemRAMCon::mem_block_xfer(uint32_t dev_addr, uint32_t nsize, uint32_t *pData32, bool to_dev)
+{
+	TRACE_CHECK_PTR(pData32,false);
+	uint32_t csize=model->blk_maxb & ~0x3;
+	TRACE_CHECK_VA(csize>0,false,"%s has no block size",name.c_str());
+
+	for(uint32_t off=0;off<nsize;off+=csize)
+	{
+		uint32_t n=std::min(csize,nsize-off);
+		EWBBridgeStats::Probe probe(stats,(to_dev)?EWBBridgeStats::BLOCK_W:EWBBridgeStats::BLOCK_R,n);
+		if(probe.done(block_copy(dev_addr+off,n,pData32+off/sizeof(uint32_t),to_dev))==false) return false;
+	}
+	return true;
+}
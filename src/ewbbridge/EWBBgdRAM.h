@@ -0,0 +1,79 @@
+/**
+ *  \file
+ *  \brief Contains the class EWBMemRAMCon.
+ *
+ *  \date  Oct 19, 2026
+ */
+
+#ifndef EWBMEMRAMCON_H_
+#define EWBMEMRAMCON_H_
+
+#include "EWBBridge.h"
+#include "EWBLatencyModel.h"
+
+/**
+ * EWB memory connector to an in-process RAM image
+ *
+ * The full 32-bit wishbone space is represented by a sparse page table
+ * (two levels of 1024 entries, 4KiB pages) where pages are allocated
+ * on the first write. Reading a page that has never been written
+ * returns the fill value.
+ *
+ * A \ref EWBLatencyModel can be given to simulate the cost of a real
+ * bridge so that sync strategies can be compared without hardware.
+ *
+ * The page table is locked only during the copies, the simulated latency
+ * is applied outside the lock so that concurrent callers overlap as they
+ * would on a real bus. For this reason the latency model is not locked
+ * by the accesses and must only be changed while the bridge is idle.
+ */
+class EWBMemRAMCon: public EWBBridge {
+public:
+	EWBMemRAMCon(const std::string &name="RAM", uint32_t fill=0);
+	virtual ~EWBMemRAMCon();
+
+	virtual bool isValid() { return true; }
+	bool mem_access(uint32_t addr, uint32_t *data, bool to_dev);
+	uint32_t get_block_buffer(uint32_t **hBuff, bool to_dev);
+	bool mem_block_access(uint32_t dev_addr, uint32_t nsize, bool to_dev);
+	bool mem_block_xfer(uint32_t dev_addr, uint32_t nsize, uint32_t *pData32, bool to_dev);
+
+	bool isDuplex() const { return duplex; }
+	void setDuplex(bool val=true);
+	void setLatencyModel(const EWBLatencyModel &model);
+	void setLatencyModel(EWBLatencyModel *pModel);
+	const EWBLatencyModel& getLatencyModel() const { return *model; }	//!< Get the latency model
+	uint64_t getSimTime() const { return sim_ns; }		//!< Simulated time spent on the bus (ns)
+	uint64_t clock_ns() const;
+	void resetSimTime() { sim_ns=0; }					//!< Reset the simulated time
+	uint64_t getNOverlaps() const { return noverlaps; }	//!< Number of block accesses started during one of the other direction
+
+	uint32_t peek(uint32_t addr) const;
+	void poke(uint32_t addr, uint32_t data);
+	void load(uint32_t addr, const uint32_t *pData32, uint32_t nwords);
+	void clear();
+	size_t getNPages() const { return npages; }		//!< Number of allocated pages
+
+protected:
+	enum { PAGE_BITS=12, L2_BITS=10, L1_BITS=32-PAGE_BITS-L2_BITS,
+		PAGE_WORDS=(1<<PAGE_BITS)/sizeof(uint32_t) };
+
+	uint32_t* getPage(uint32_t addr, bool create);
+	bool block_copy(uint32_t dev_addr, uint32_t nsize, uint32_t *pBuff, bool to_dev);
+	void wait(uint64_t ns);
+
+	uint32_t **l1[1<<L1_BITS];	//!< First level of the page table
+	uint32_t fill;				//!< Value of unallocated memory
+	size_t npages;				//!< Number of allocated pages
+	std::atomic<bool> duplex;	//!< Independent block accesses in each direction
+	uint32_t *pData;			//!< Internal block buffer
+	uint32_t *pDataRd;			//!< Internal from_dev block buffer (duplex)
+	uint32_t bsize;				//!< Size of the internal block buffer (bytes)
+	EWBLatencyModel defModel;	//!< Copy of the default latency model
+	EWBLatencyModel *model;		//!< Latency model in use
+	std::atomic<uint64_t> sim_ns;	//!< Simulated time
+	std::atomic<int> nblk_busy[2];	//!< Block accesses in progress by direction (0: read, 1: write)
+	std::atomic<uint64_t> noverlaps;	//!< Block accesses started while the other direction was in progress
+};
+
+#endif /* EWBMEMRAMCON_H_ */
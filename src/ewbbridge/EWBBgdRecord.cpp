@@ -0,0 +1,375 @@
+/*
+ * EWBBgdRecord.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBBgdRecord.h"
+
+#include <cstring>
+#include <algorithm>
+#include <errno.h>
+#include <time.h>
+
+#define EWB_TRACE_MODULE EWB_TRACE_BRIDGE
+#include <EWBTrace.h>
+
+/**
+ * Constructor that creates the log file
+ *
+ * \param[in] pTarget The bridge to record.
+ * \param[in] fname The path of the log file.
+ */
+EWBMemRecordCon::EWBMemRecordCon(EWBBridge *pTarget, const std::string &fname)
+: EWBBridgeProxy(pTarget,"REC"), t_last(EWBBridgeStats::now_ns()), nentries(0), cycle(0)
+{
+	desc="Record to "+fname;
+	file=fopen(fname.c_str(),"wb");
+	if(file==NULL)
+	{
+		TRACE_P_ERROR("Can not create %s (%s)",fname.c_str(),strerror(errno));
+		return;
+	}
+	setvbuf(file,NULL,_IOFBF,0x10000);
+	put32(EWB_RECLOG_MAGIC);
+	put32(EWB_RECLOG_VER);
+}
+
+/**
+ * Destructor that closes the log file
+ */
+EWBMemRecordCon::~EWBMemRecordCon()
+{
+	if(file) fclose(file);
+}
+
+/**
+ * Write the buffered entries to the file
+ */
+void EWBMemRecordCon::flush()
+{
+	if(file) fflush(file);
+}
+
+void EWBMemRecordCon::put32(uint32_t val)
+{
+	uint8_t b[4]={ (uint8_t)val, (uint8_t)(val>>8), (uint8_t)(val>>16), (uint8_t)(val>>24) };
+	fwrite(b,1,4,file);
+}
+
+//! Write an unsigned value in LEB128 (7 bits per byte)
+void EWBMemRecordCon::putVar(uint64_t val)
+{
+	do
+	{
+		uint8_t b=val & 0x7F;
+		val>>=7;
+		fputc((val)?(b | 0x80):b,file);
+	} while(val);
+}
+
+/**
+ * Write an entry in the log
+ */
+void EWBMemRecordCon::write(uint64_t t, uint8_t flags, uint32_t addr, const uint32_t *pData32, uint32_t nsize)
+{
+	if(file==NULL) return;
+	fputc(flags,file);
+	putVar((t>t_last)?t-t_last:0);
+	t_last=std::max(t,t_last);
+	put32(addr);
+	if(flags & F_BLOCK) putVar(nsize);
+	for(uint32_t i=0;i<nsize/sizeof(uint32_t);i++) put32(pData32[i]);
+	nentries++;
+}
+
+/**
+ * Write the single accesses of the cycle
+ */
+void EWBMemRecordCon::writePending(bool ok)
+{
+	for(size_t i=0;i<pending.size();i++)
+	{
+		Pending &p=pending[i];
+		uint32_t val=(p.to_dev)?p.val:*(p.pData);
+		write(p.t,((p.to_dev)?F_TO_DEV:0) | ((ok)?F_OK:0),p.addr,&val,sizeof(uint32_t));
+	}
+	pending.clear();
+}
+
+/**
+ * Open a cycle owned by the calling thread until closeCycle()
+ */
+bool EWBMemRecordCon::openCycle()
+{
+	bgd_mtx.lock();
+	cycle++;
+	return pTarget->openCycle();
+}
+
+bool EWBMemRecordCon::closeCycle()
+{
+	std::lock_guard<std::recursive_mutex> lock(bgd_mtx);
+	TRACE_CHECK(cycle>0,false,"No cycle opened");
+	bool ret=pTarget->closeCycle();
+	if(--cycle==0) writePending(ret);
+	bgd_mtx.unlock();	//Locked by openCycle()
+	return ret;
+}
+
+/**
+ * Forward the single access and record it
+ */
+bool EWBMemRecordCon::mem_access(uint32_t addr, uint32_t *data, bool to_dev)
+{
+	uint64_t t=EWBBridgeStats::now_ns();
+	TRACE_CHECK_PTR(data,false);
+	std::lock_guard<std::recursive_mutex> lock(bgd_mtx);
+	uint32_t val=*data;
+	bool ret=pTarget->mem_access(addr,data,to_dev);
+
+	if(cycle>0)
+	{
+		Pending p={ t, addr, data, val, to_dev };
+		pending.push_back(p);
+	}
+	else write(t,((to_dev)?F_TO_DEV:0) | ((ret)?F_OK:0),addr,(to_dev)?&val:data,sizeof(uint32_t));
+	return ret;
+}
+
+/**
+ * Forward the block access and record it with the content of the block buffer
+ *
+ * The buffer of the target is also held (after bgd_mtx, as in a cycle).
+ */
+bool EWBMemRecordCon::mem_block_access(uint32_t dev_addr, uint32_t nsize, bool to_dev)
+{
+	uint64_t t=EWBBridgeStats::now_ns();
+	uint32_t *pData32=NULL;
+	std::lock_guard<std::recursive_mutex> lock(bgd_mtx), lock_blk(pTarget->getBlockMutex(to_dev));
+	bool ret=pTarget->mem_block_access(dev_addr,nsize,to_dev);
+
+	if(pTarget->get_block_buffer(&pData32,to_dev)>=nsize && pData32)
+	{
+		write(t,F_BLOCK | ((to_dev)?F_TO_DEV:0) | ((ret)?F_OK:0),dev_addr,pData32,nsize);
+	}
+	return ret;
+}
+
+/**
+ * Forward the block access and record it with the buffer of the caller
+ */
+bool EWBMemRecordCon::mem_block_xfer(uint32_t dev_addr, uint32_t nsize, uint32_t *pData32, bool to_dev)
+{
+	uint64_t t=EWBBridgeStats::now_ns();
+	std::lock_guard<std::recursive_mutex> lock(bgd_mtx);
+	bool ret=pTarget->mem_block_xfer(dev_addr,nsize,pData32,to_dev);
+
+	write(t,F_BLOCK | ((to_dev)?F_TO_DEV:0) | ((ret)?F_OK:0),dev_addr,pData32,nsize);
+	return ret;
+}
+
+//------------------------------------------------------------------------------
+
+/**
+ * Constructor that loads the log file
+ *
+ * \param[in] fname The path of the log file.
+ * \param[in] realtime If true the accesses are replayed at the recorded speed.
+ * \param[in] blk_maxb The size of the internal block buffer (bytes)
+ */
+EWBMemReplayCon::EWBMemReplayCon(const std::string &fname, bool realtime, uint32_t blk_maxb)
+: EWBBridge(EWBBridge::REPLAY,"REPLAY"), valid(false), realtime(realtime), lookahead(256),
+  cursor(0), t0(0), nmatches(0), nmisses(0), nskipped(0), nmismatches(0), bsize(blk_maxb)
+{
+	desc="Replay of "+fname;
+	pData=(uint32_t*)malloc(bsize);
+	valid=load(fname);
+}
+
+EWBMemReplayCon::~EWBMemReplayCon()
+{
+	free(pData);
+}
+
+/**
+ * Parse the full log in memory
+ */
+bool EWBMemReplayCon::load(const std::string &fname)
+{
+	std::vector<uint8_t> raw;
+	FILE *file=fopen(fname.c_str(),"rb");
+	if(file==NULL)
+	{
+		TRACE_P_ERROR("Can not open %s (%s)",fname.c_str(),strerror(errno));
+		return false;
+	}
+	uint8_t tmp[0x10000];
+	size_t n;
+	while((n=fread(tmp,1,sizeof(tmp),file))>0) raw.insert(raw.end(),tmp,tmp+n);
+	fclose(file);
+
+	const uint8_t *p=(raw.empty())?NULL:&raw[0], *end=p+raw.size();
+	struct Reader {
+		const uint8_t *&p, *end;
+		bool ok;
+		uint32_t get32() { if(p+4>end) { ok=false; return 0; } uint32_t v=p[0] | (p[1]<<8) | (p[2]<<16) | ((uint32_t)p[3]<<24); p+=4; return v; }
+		uint64_t getVar() { uint64_t v=0; int s=0; do { if(p>=end || s>63) { ok=false; return 0; } v|=(uint64_t)(*p & 0x7F)<<s; s+=7; } while(*(p++) & 0x80); return v; }
+	} r={ p, end, true };
+
+	TRACE_CHECK_VA(r.get32()==EWB_RECLOG_MAGIC && r.get32()==EWB_RECLOG_VER,false,"%s: not a record log",fname.c_str());
+
+	uint64_t t=0;
+	while(p<end && r.ok)
+	{
+		Entry e;
+		e.flags=*(p++);
+		t+=r.getVar();
+		e.t=t;
+		e.addr=r.get32();
+		e.nsize=(e.flags & EWBMemRecordCon::F_BLOCK)?r.getVar():sizeof(uint32_t);
+		e.doff=pool.size();
+		for(uint32_t i=0;i<e.nsize/sizeof(uint32_t) && r.ok;i++) pool.push_back(r.get32());
+		if(r.ok) entries.push_back(e);
+	}
+	TRACE_CHECK_VA(r.ok,false,"%s: truncated after %d entries",fname.c_str(),(int)entries.size());
+	TRACE_P_INFO("%s: %d entries (%.3f s)",fname.c_str(),(int)entries.size(),getDuration()/1e9);
+	return true;
+}
+
+/**
+ * Restart the replay from the beginning
+ */
+void EWBMemReplayCon::rewind()
+{
+	std::lock_guard<std::recursive_mutex> lock(bgd_mtx);
+	cursor=0;
+	t0=0;
+	image.clear();
+	nmatches=nmisses=nskipped=nmismatches=0;
+}
+
+/**
+ * Update the memory image with an entry
+ */
+void EWBMemReplayCon::apply(const Entry &e)
+{
+	for(uint32_t i=0;i<e.nsize/sizeof(uint32_t);i++) image[e.addr+i*sizeof(uint32_t)]=pool[e.doff+i];
+}
+
+/**
+ * Obtain the value of an address that does not match an entry
+ *
+ * The value is taken from the image, or from the next entries
+ * (up to \c end) when the address was not accessed yet.
+ */
+uint32_t EWBMemReplayCon::lookup(uint32_t addr, size_t end)
+{
+	std::map<uint32_t,uint32_t>::const_iterator ii=image.find(addr);
+	if(ii!=image.end()) return ii->second;
+
+	for(size_t i=cursor;i<end;i++)
+	{
+		const Entry &e=entries[i];
+		if(e.addr<=addr && addr<e.addr+e.nsize) return pool[e.doff+(addr-e.addr)/sizeof(uint32_t)];
+	}
+	return 0;
+}
+
+/**
+ * Replay an access
+ *
+ * \return the recorded status when it matches an entry, true otherwise.
+ */
+bool EWBMemReplayCon::access(uint32_t addr, uint32_t *pData32, uint32_t nsize, bool to_dev, bool block)
+{
+	uint8_t flags=((to_dev)?EWBMemRecordCon::F_TO_DEV:0) | ((block)?EWBMemRecordCon::F_BLOCK:0);
+	uint8_t mask=EWBMemRecordCon::F_TO_DEV | EWBMemRecordCon::F_BLOCK;
+	uint32_t nwords=nsize/sizeof(uint32_t);
+	std::lock_guard<std::recursive_mutex> lock(bgd_mtx);
+	size_t end=std::min(entries.size(),cursor+lookahead), i;
+
+	for(i=cursor;i<end;i++)
+	{
+		const Entry &e=entries[i];
+		if(e.addr==addr && e.nsize==nsize && (e.flags & mask)==flags) break;
+	}
+
+	if(i>=end)
+	{
+		//Not recorded: use the image
+		nmisses++;
+		for(uint32_t k=0;k<nwords;k++)
+		{
+			uint32_t a=addr+k*sizeof(uint32_t);
+			if(to_dev) image[a]=pData32[k];
+			else pData32[k]=lookup(a,end);
+		}
+		return true;
+	}
+
+	nskipped+=i-cursor;
+	for(;cursor<i;cursor++) apply(entries[cursor]);
+	const Entry &e=entries[cursor++];
+
+	if(realtime)
+	{
+		uint64_t now=EWBBridgeStats::now_ns();
+		if(t0==0) t0=now-e.t;
+		if(now-t0<e.t)
+		{
+			uint64_t ns=e.t-(now-t0);
+			struct timespec ts;
+			ts.tv_sec=ns/1000000000ULL;
+			ts.tv_nsec=ns%1000000000ULL;
+			nanosleep(&ts,NULL);
+		}
+	}
+
+	if(to_dev)
+	{
+		if(memcmp(&pool[e.doff],pData32,nsize)!=0)
+		{
+			nmismatches++;
+			TRACE_P_WARNING("W@%08X: 0x%08x != recorded 0x%08x (entry #%d)",addr,pData32[0],pool[e.doff],(int)(cursor-1));
+		}
+		for(uint32_t k=0;k<nwords;k++) image[addr+k*sizeof(uint32_t)]=pData32[k];
+	}
+	else
+	{
+		memcpy(pData32,&pool[e.doff],nsize);
+		apply(e);
+	}
+	nmatches++;
+	return (e.flags & EWBMemRecordCon::F_OK);
+}
+
+bool EWBMemReplayCon::mem_access(uint32_t addr, uint32_t *data, bool to_dev)
+{
+	EWBBridgeStats::Probe probe(stats,(to_dev)?EWBBridgeStats::SINGLE_W:EWBBridgeStats::SINGLE_R,sizeof(uint32_t));
+	TRACE_CHECK_PTR(data,false);
+	TRACE_CHECK(valid,false,"No log loaded");
+	return probe.done(access(addr,data,sizeof(uint32_t),to_dev,false));
+}
+
+uint32_t EWBMemReplayCon::get_block_buffer(uint32_t **hBuff, bool /*to_dev*/)
+{
+	*hBuff=pData;
+	return bsize;
+}
+
+bool EWBMemReplayCon::mem_block_access(uint32_t dev_addr, uint32_t nsize, bool to_dev)
+{
+	EWBBridgeStats::Probe probe(stats,(to_dev)?EWBBridgeStats::BLOCK_W:EWBBridgeStats::BLOCK_R,nsize);
+	TRACE_CHECK(valid,false,"No log loaded");
+	TRACE_CHECK_VA(nsize<=bsize,false,"nsize=%d > %d",nsize,bsize);
+	return probe.done(access(dev_addr,pData,nsize,to_dev,true));
+}
+
+bool EWBMemReplayCon::mem_block_xfer(uint32_t dev_addr, uint32_t nsize, uint32_t *pData32, bool to_dev)
+{
+	EWBBridgeStats::Probe probe(stats,(to_dev)?EWBBridgeStats::BLOCK_W:EWBBridgeStats::BLOCK_R,nsize);
+	TRACE_CHECK_PTR(pData32,false);
+	TRACE_CHECK(valid,false,"No log loaded");
+	return probe.done(access(dev_addr,pData32,nsize,to_dev,true));
+}
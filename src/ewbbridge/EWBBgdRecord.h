@@ -0,0 +1,152 @@
+/**
+ *  \file
+ *  \brief Contains the classes EWBMemRecordCon & EWBMemReplayCon.
+ *
+ *  The log is a binary file composed of a header followed by one
+ *  entry per transaction:
+ *
+ *  	- header: magic "EWBR" (u32), version (u32)
+ *  	- entry:  flags (u8), delta time in ns (LEB128),
+ *  	  address (u32), data (u32) or size (LEB128) + data (u32 x size/4) for a block
+ *
+ *  The words are stored in little endian.
+ *
+ *  \date  Oct 19, 2026
+ */
+
+#ifndef EWBMEMRECORDCON_H_
+#define EWBMEMRECORDCON_H_
+
+#include "EWBBridgeProxy.h"
+
+#include <cstdio>
+#include <map>
+
+#define EWB_RECLOG_MAGIC 0x52425745	//!< "EWBR"
+#define EWB_RECLOG_VER	1			//!< Version of the log format
+
+/**
+ * Decorator that records all the transactions of a bridge into a log
+ *
+ * The single accesses queued during a cycle are written when
+ * the cycle is closed (so that the read values are known), after
+ * the block accesses of the cycle that are written as they are done.
+ *
+ * As an opened cycle holds \ref bgd_mtx, the block buffer (the one of the
+ * target) is leased with \ref bgd_mtx, and the target must only be
+ * accessed through the recorder.
+ */
+class EWBMemRecordCon: public EWBBridgeProxy {
+public:
+	//! Flags of a log entry
+	enum Flags {
+		F_TO_DEV=0x1,	//!< Write to the device
+		F_BLOCK=0x2,	//!< Block transaction
+		F_OK=0x4,		//!< Transaction succeeded
+	};
+
+	EWBMemRecordCon(EWBBridge *pTarget, const std::string &fname);
+	virtual ~EWBMemRecordCon();
+
+	bool isValid() { return (file!=NULL) && EWBBridgeProxy::isValid(); }
+	bool mem_access(uint32_t addr, uint32_t *data, bool to_dev);
+	bool mem_block_access(uint32_t dev_addr, uint32_t nsize, bool to_dev);
+	bool mem_block_xfer(uint32_t dev_addr, uint32_t nsize, uint32_t *pData32, bool to_dev);
+	bool openCycle();
+	bool closeCycle();
+	//! The block buffer is leased with the lock of the cycles (same lock order for both)
+	std::recursive_mutex& getBlockMutex(bool /*to_dev*/) const { return bgd_mtx; }
+	bool isDuplex() const { return false; }
+
+	void flush();
+	uint64_t getNEntries() const { return nentries; }	//!< Number of entries written
+
+private:
+	//! Single access waiting for the end of a cycle
+	struct Pending {
+		uint64_t t;
+		uint32_t addr;
+		uint32_t *pData;
+		uint32_t val;
+		bool to_dev;
+	};
+
+	void write(uint64_t t, uint8_t flags, uint32_t addr, const uint32_t *pData32, uint32_t nsize);
+	void writePending(bool ok);
+	void putVar(uint64_t val);
+	void put32(uint32_t val);
+
+	FILE *file;			//!< The log file
+	uint64_t t_last;	//!< Time of the last entry (ns)
+	uint64_t nentries;	//!< Number of entries written
+	int cycle;			//!< Depth of the opened cycles
+	std::vector<Pending> pending;	//!< Single accesses of the opened cycle
+};
+
+
+/**
+ * Bridge that replays a log recorded by EWBMemRecordCon
+ *
+ * Each access is matched with the next entry of the log that has the same
+ * address, direction and size (looking ahead at most \ref lookahead entries):
+ * 		- the reads return the recorded data.
+ * 		- the writes are compared with the recorded data (see getNMismatches()).
+ *
+ * When no entry matches (i.e. a different sync strategy is used), the access
+ * is served from the memory image built by the entries already replayed
+ * (or by the next entries for the addresses not yet accessed).
+ *
+ * In real-time mode an access is delayed until its recorded time.
+ */
+class EWBMemReplayCon: public EWBBridge {
+public:
+	EWBMemReplayCon(const std::string &fname, bool realtime=false, uint32_t blk_maxb=0x10000);
+	virtual ~EWBMemReplayCon();
+
+	bool isValid() { return valid; }
+	bool mem_access(uint32_t addr, uint32_t *data, bool to_dev);
+	uint32_t get_block_buffer(uint32_t **hBuff, bool to_dev);
+	bool mem_block_access(uint32_t dev_addr, uint32_t nsize, bool to_dev);
+	bool mem_block_xfer(uint32_t dev_addr, uint32_t nsize, uint32_t *pData32, bool to_dev);
+
+	void rewind();
+	bool isDone() const { return cursor>=entries.size(); }		//!< All the entries have been replayed
+	void setRealTime(bool val) { realtime=val; }					//!< Replay at the recorded speed
+	void setLookAhead(uint32_t nentries) { lookahead=nentries; }	//!< Number of entries to look for a match
+
+	size_t getNEntries() const { return entries.size(); }	//!< Number of entries in the log
+	uint64_t getNMatches() const { return nmatches; }		//!< Accesses that matched an entry
+	uint64_t getNMisses() const { return nmisses; }			//!< Accesses served from the image
+	uint64_t getNSkipped() const { return nskipped; }		//!< Entries that were not replayed
+	uint64_t getNMismatches() const { return nmismatches; }	//!< Writes with a different value
+	uint64_t getDuration() const { return (entries.empty())?0:entries.back().t; }	//!< Recorded duration (ns)
+
+private:
+	//! An entry of the log
+	struct Entry {
+		uint64_t t;			//!< Time since the beginning of the log (ns)
+		uint32_t addr;		//!< Address on the wishbone bus
+		uint32_t nsize;		//!< Size (bytes)
+		uint8_t flags;		//!< \ref EWBMemRecordCon::Flags
+		size_t doff;		//!< Offset of the data in the pool (words)
+	};
+
+	bool load(const std::string &fname);
+	bool access(uint32_t addr, uint32_t *pData32, uint32_t nsize, bool to_dev, bool block);
+	void apply(const Entry &e);
+	uint32_t lookup(uint32_t addr, size_t end);
+
+	bool valid;
+	bool realtime;
+	uint32_t lookahead;
+	std::vector<Entry> entries;		//!< All the entries of the log
+	std::vector<uint32_t> pool;		//!< Data of the entries
+	std::map<uint32_t,uint32_t> image;	//!< Memory image at the cursor
+	size_t cursor;					//!< Next entry to replay
+	uint64_t t0;					//!< Time when the replay started (ns)
+	uint64_t nmatches, nmisses, nskipped, nmismatches;
+	uint32_t *pData;				//!< Internal block buffer
+	uint32_t bsize;					//!< Size of the internal block buffer (bytes)
+};
+
+#endif /* EWBMEMRECORDCON_H_ */
@@ -8,15 +8,12 @@
 #include "EWBBgdTestFile.h"
 #include <cstring>
 
+#define EWB_TRACE_MODULE EWB_TRACE_BRIDGE
 #include <EWBTrace.h>
 #include <EWBPeriph.h>
 #include <EWBReg.h>
 #include <EWBBus.h>
 
-
-#define TRACE_P_VDEBUG(...) //TRACE_P_DEBUG( __VA_ARGS__)
-#define TRACE_P_VVDEBUG(...) //TRACE_P_DEBUG( __VA_ARGS__)
-
 #define BUFF_MAX_SIZEB 4096 //Size in bytes
 
 
@@ -28,8 +25,9 @@
  * It will also try to open the file.
  */
 EWBMemTestFileCon::EWBMemTestFileCon(const std::string& fname)
-: EWBBridge(EWBBridge::TFILE), fname(fname), lastpos(0)
+: EWBBridge(EWBBridge::TFILE,"TFILE"), fname(fname), lastpos(0)
 {
+	desc=fname;
 	o_file.open(fname.c_str(),std::fstream::out|std::fstream::in);
 	TRACE_P_INFO("tfile=%d (%s)",o_file.is_open(),fname.c_str());
 
@@ -73,7 +71,7 @@ void EWBMemTestFileCon::generate(EWBBus* pBus)
 	{
 		EWBPeriph *pPrh=periphs[i];
 		if(pPrh==NULL) continue;
-		TRACE_P_DEBUG("%d %s (0x%08x)",i,pPrh->getCName(), pPrh->getOffset(true));
+		TRACE_P_DEBUG("%d %s (0x%08x)",(int)i,pPrh->getCName(), pPrh->getOffset(true));
 
 		while( (reg=pPrh->getNextReg(reg)) != NULL)
 		{
@@ -101,8 +99,10 @@ bool EWBMemTestFileCon::mem_access(uint32_t wb_addr, uint32_t* data, bool to_dev
 	char buff[50];
 	std::string line;
 	//std::fstream tfile(fname.c_str(), std::ios::in|std::ios::out);
+	EWBBridgeStats::Probe probe(stats,(to_dev)?EWBBridgeStats::SINGLE_W:EWBBridgeStats::SINGLE_R,sizeof(uint32_t));
 
 	TRACE_CHECK(isValid(),false,"Not valid file");
+	std::lock_guard<std::recursive_mutex> lock(bgd_mtx);
 	o_file.sync();
 
 	//first seek position
@@ -136,7 +136,7 @@ bool EWBMemTestFileCon::mem_access(uint32_t wb_addr, uint32_t* data, bool to_dev
 	TRACE_P_VDEBUG("%s@%08X %s %08x (%d)",(to_dev)?"W":"R", wb_addr,(to_dev)?"=>":"<=",*data, pos);
 	o_file.sync();
 	o_file.flush();
-	return true;
+	return probe.done(true);
 }
 
 uint32_t EWBMemTestFileCon::get_block_buffer(uint32_t** hDma, bool to_dev)
@@ -167,6 +167,8 @@ bool EWBMemTestFileCon::mem_block_access(uint32_t dev_addr, uint32_t nsize,bool
 	char buff[50], *p;
 	std::string line;
 	uint32_t defdata=0xDA1AFEED;
+	EWBBridgeStats::Probe probe(stats,(to_dev)?EWBBridgeStats::BLOCK_W:EWBBridgeStats::BLOCK_R,nsize);
+	std::lock_guard<std::recursive_mutex> lock(bgd_mtx);
 	block_busy=true;
 	std::fstream tfile(fname.c_str(), std::ios::in|std::ios::out);
 
@@ -191,17 +193,17 @@ bool EWBMemTestFileCon::mem_block_access(uint32_t dev_addr, uint32_t nsize,bool
 			pData[i]=defdata;
 			if(pos>0 && getline (tfile,line))
 			{
-				snprintf(buff,50,"0x%08X",dev_addr+i*sizeof(uint32_t));
+				snprintf(buff,50,"0x%08X",(uint32_t)(dev_addr+i*sizeof(uint32_t)));
 				if(strncmp(buff,line.substr(0,10).c_str(),10)==0)
 					pData[i]= strtoul( line.substr(12,8).c_str(), & p, 16 );
 
 				TRACE_P_VDEBUG("#%03d@0x%08X : 0x%8x (%s)",
-						i,dev_addr+i*sizeof(uint32_t),pData[i],line.c_str());
+						(int)i,(uint32_t)(dev_addr+i*sizeof(uint32_t)),pData[i],line.c_str());
 			}
 		}
 	}
 	block_busy=false;
-	return true;
+	return probe.done(true);
 
 }
 
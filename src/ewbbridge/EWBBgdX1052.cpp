@@ -16,10 +16,10 @@
 #endif
 
 #include "EWBBgdX1052.h"
+
+#define EWB_TRACE_MODULE EWB_TRACE_BRIDGE
 #include "EWBTrace.h"
 
-#define TRACE_P_VDEBUG(...) //TRACE_P_DEBUG( __VA_ARGS__)
-#define TRACE_P_VVDEBUG(...) //TRACE_P_DEBUG( __VA_ARGS__)
 int EWBMemX1052Con::nHandles = -1; //!< Initiate static nHandles to count number of PCIe slot opened
 
 
@@ -36,6 +36,7 @@ EWBMemX1052Con::EWBMemX1052Con(int idxPCIe,uint32_t magic_addr, uint32_t magic_v
 :EWBBridge(EWBBridge::X1052,"X1052"), hDev(NULL), hBiDma(NULL)
 {
 	uint32_t dwStatus, tmp;
+	cost=EWBLatencyModel::X1052();	//DMA padded to 0x80 bytes
 	if(nHandles<0)
 	{
 		dwStatus = X1052_LibInit();
@@ -140,13 +141,15 @@ bool EWBMemX1052Con::isValid()
 bool EWBMemX1052Con::mem_access(uint32_t addr, uint32_t* data, bool to_dev)
 {
 	int status;
+	EWBBridgeStats::Probe probe(stats,(to_dev)?EWBBridgeStats::SINGLE_W:EWBBridgeStats::SINGLE_R,sizeof(uint32_t));
 	TRACE_CHECK_PTR(hDev,false);
+	std::lock_guard<std::recursive_mutex> lock(bgd_mtx);	//The X1052 library is not reentrant
 
 	status=X1052_Wishbone_CSR(hDev,addr,data,(int)to_dev);
 	TRACE_CHECK_VA(status==S_OK,false,"%s@%08X %s %08x (%d)",(to_dev)?"W":"R", addr,(to_dev)?"=>":"<=",*data,status);
 	TRACE_P_VDEBUG("%s@%08X %s %08x (%d)",(to_dev)?"W":"R", addr,(to_dev)?"=>":"<=",*data,status);
 
-	return (status==S_OK);
+	return probe.done(status==S_OK);
 }
 
 
@@ -164,14 +167,14 @@ bool EWBMemX1052Con::mem_access(uint32_t addr, uint32_t* data, bool to_dev)
 bool EWBMemX1052Con::mem_block_access(uint32_t dev_addr, uint32_t nsize,bool to_dev)
 {
 	int mbps;
+	EWBBridgeStats::Probe probe(stats,(to_dev)?EWBBridgeStats::BLOCK_W:EWBBridgeStats::BLOCK_R,nsize);
 	TRACE_CHECK_PTR(hDev,false);
+	TRACE_CHECK_VA(nsize<=X1052_DMA_TRANSFER_MAXB,false,
+			"@0x%08X: buffer size %d > %d bytes (use mem_block_xfer())",dev_addr,nsize, X1052_DMA_TRANSFER_MAXB);
+	std::lock_guard<std::recursive_mutex> lock(bgd_mtx);
 	block_busy=true;
 
 	if(nsize<0x80) nsize=X1052_DMA_TRANSFER_MINB;
-	if(nsize>X1052_DMA_TRANSFER_MAXB)
-	{
-		TRACE_P_WARNING("@0x%08X: buffer size %d truncated to %d bytes",dev_addr,nsize, X1052_DMA_TRANSFER_MAXB);
-	}
 
 	mbps=X1052_DMATransfer(hBiDma, to_dev,0,dev_addr, nsize);
 
@@ -183,7 +186,7 @@ bool EWBMemX1052Con::mem_block_access(uint32_t dev_addr, uint32_t nsize,bool to_
 			mbps,X1052_GetLastErr(),
 			(to_dev)?"W":"R", dev_addr,(to_dev)?"=>":"<=",nsize);
 
-	return true;
+	return probe.done(true);
 }
 
 /**
@@ -7,3 +7,257 @@
 
 #include "EWBBridge.h"
 
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <chrono>
+
+#define EWB_TRACE_MODULE EWB_TRACE_BRIDGE
+#include <EWBTrace.h>
+
+//! List of all the bridges that are alive
+static std::vector<EWBBridge*>& instances()
+{
+	static std::vector<EWBBridge*> list;
+	return list;
+}
+
+//! Protect the list of the bridges (they are created and destroyed by several threads)
+static std::recursive_mutex& instances_mtx()
+{
+	static std::recursive_mutex mtx;
+	return mtx;
+}
+
+/**
+ * Constructor where we only give the type
+ *
+ * The bridge is registered so that it can be found by
+ * the IOC shell commands (see \ref forEachInstance()).
+ */
+EWBBridge::EWBBridge(int type,const std::string &name)
+: type(type),name(name),block_busy(false),generation(0),pGen(&generation),cost(EWBLatencyModel::singles()),pCost(&cost)
+{
+	std::lock_guard<std::recursive_mutex> lock(instances_mtx());
+	instances().push_back(this);
+}
+
+/**
+ * Destructor that unregister the bridge
+ */
+EWBBridge::~EWBBridge()
+{
+	std::lock_guard<std::recursive_mutex> lock(instances_mtx());
+	std::vector<EWBBridge*> &list=instances();
+	list.erase(std::remove(list.begin(),list.end(),this),list.end());
+}
+
+/**
+ * Block access using a buffer of the caller
+ *
+ * The transfer is split in chunks of the size of the internal
+ * block buffer, each chunk being copied from/to the caller buffer.
+ * Overload this method when the bridge can use the caller buffer
+ * directly (so that the transfers of several callers are not serialized
+ * by the lease of the internal buffer).
+ *
+ * \param[in] dev_addr The address on the device of the data we want to access.
+ * \param[in] nsize The size in byte that we want to read/write.
+ * \param[inout] pData32 The buffer of the caller (at least nsize bytes).
+ * \param[in] to_dev if true we write to the device.
+ * \return true if all the chunks were transfered.
+ */
+bool EWBBridge::mem_block_xfer(uint32_t dev_addr, uint32_t nsize, uint32_t *pData32, bool to_dev)
+{
+	BlockLease lease(this,to_dev);
+	uint32_t *pBuff=lease.get();
+	uint32_t bsize=lease.size() & ~0x3;
+	TRACE_CHECK_PTR(pData32,false);
+	TRACE_CHECK_VA(pBuff && bsize>0,false,"%s has no block buffer",name.c_str());
+
+	uint8_t *pData8=(uint8_t*)pData32;
+	for(uint32_t off=0;off<nsize;off+=bsize)
+	{
+		uint32_t n=std::min(bsize,nsize-off);
+		if(to_dev) memcpy(pBuff,pData8+off,n);
+		if(mem_block_access(dev_addr+off,n,to_dev)==false) return false;
+		if(!to_dev) memcpy(pData8+off,pBuff,n);
+	}
+	return true;
+}
+
+/**
+ * Execute a sequence of steps locally
+ *
+ * The consecutive writes and reads are performed in the same cycle
+ * (i.e. a single packet on Etherbone), the cycle is only closed before
+ * the steps that need the data read (WRITE_MASK, POLL) or that wait (DELAY).
+ * Overload this method when the bridge can execute the whole sequence
+ * near the device.
+ *
+ * \note The accesses of other threads might be performed between two cycles.
+ * \param[in] ops The steps of the sequence.
+ * \param[out] rdata The data returned by the READ and POLL steps (in order).
+ * \return false if an access failed or a POLL timed out (the next steps are not executed).
+ */
+bool EWBBridge::mem_sequence(const std::vector<EWBSeqOp> &ops, std::vector<uint32_t> &rdata)
+{
+	std::vector<uint32_t> wdata(ops.size());
+	size_t nwords=0, ir=0;
+	bool ret=true, opened=false;
+
+	for(size_t i=0;i<ops.size();i++) if(ops[i].hasData()) nwords++;
+	rdata.assign(nwords,0);
+
+	for(size_t i=0;i<ops.size() && ret;i++)
+	{
+		const EWBSeqOp &op=ops[i];
+		bool batched=(op.type==EWBSeqOp::WRITE || op.type==EWBSeqOp::READ);
+		if(opened && !batched)
+		{
+			opened=false;
+			if((ret=closeCycle())==false) break;
+		}
+		if(batched && !opened) opened=openCycle();
+
+		switch(op.type)
+		{
+		case EWBSeqOp::WRITE:
+			wdata[i]=op.value;
+			ret=mem_access(op.addr,&wdata[i],true);
+			break;
+		case EWBSeqOp::READ:
+			ret=mem_access(op.addr,&rdata[ir++],false);
+			break;
+		case EWBSeqOp::WRITE_MASK:
+			ret=mem_access(op.addr,&wdata[i],false);
+			wdata[i]=(wdata[i] & ~op.mask) | (op.value & op.mask);
+			ret=ret && mem_access(op.addr,&wdata[i],true);
+			break;
+		case EWBSeqOp::POLL:
+		{
+			uint32_t *pData32=&rdata[ir++];
+			uint64_t t_end=EWBBridgeStats::now_ns()+(uint64_t)op.timeout_us*1000;
+			while((ret=mem_access(op.addr,pData32,false)) && (*pData32 & op.mask)!=op.value)
+			{
+				if(EWBBridgeStats::now_ns()>=t_end)
+				{
+					TRACE_P_WARNING("%s: poll of @0x%08X timed out (0x%x & 0x%x != 0x%x)",name.c_str(),op.addr,*pData32,op.mask,op.value);
+					ret=false;
+					break;
+				}
+				std::this_thread::yield();
+			}
+			break;
+		}
+		case EWBSeqOp::DELAY:
+			std::this_thread::sleep_for(std::chrono::microseconds(op.timeout_us));
+			break;
+		default:
+			TRACE_P_ERROR("%s: unknown step type %d",name.c_str(),op.type);
+			ret=false;
+			break;
+		}
+	}
+	if(opened) ret=closeCycle() && ret;
+	return ret;
+}
+
+/**
+ * Measure the cost of the accesses with a quick probe
+ *
+ * A few single reads and block reads of two sizes are performed at addr
+ * (nothing is written), the fastest run of each is kept to estimate
+ * op_ns, blk_op_ns and byte_ns. The minimum, maximum size and alignment
+ * of the block accesses are kept from the current model.
+ *
+ * \note The singles are measured one by one, outside any cycle.
+ * \note The time is given by clock_ns().
+ * \param[in] addr An address where reading nsize bytes has no side effect (i.e. a RAM).
+ * \param[in] nsize The size of the big block (bytes), limited to blk_maxb.
+ * \param[in] nruns The number of measurements of each access.
+ * \note The result is set with setCostModel(), a custom model is replaced by a copy of its parameters.
+ * \return false if any of the accesses failed (the model is not modified).
+ */
+bool EWBBridge::calibrate(uint32_t addr, uint32_t nsize, int nruns)
+{
+	EWBLatencyModel m=getCostModel();
+	uint64_t t_single=UINT64_MAX, t_small=UINT64_MAX, t_big=UINT64_MAX;
+	uint32_t small=std::max((uint32_t)sizeof(uint32_t),m.blk_minb);
+	nsize=std::min(nsize,m.blk_maxb) & ~0x3;
+	std::vector<uint32_t> buff(std::max(nsize,small)/sizeof(uint32_t));
+	TRACE_CHECK_VA(nruns>0,false,"%s: nruns=%d",name.c_str(),nruns);
+
+	for(int i=0;i<nruns;i++)
+	{
+		uint64_t t0=clock_ns();
+		TRACE_CHECK_VA(mem_access(addr,&buff[0],false),false,"%s: calibration of singles failed",name.c_str());
+		t_single=std::min(t_single,clock_ns()-t0);
+	}
+	m.op_ns=t_single;
+
+	if(m.hasBlock() && nsize>small)
+	{
+		for(int i=0;i<nruns;i++)
+		{
+			uint64_t t0=clock_ns();
+			TRACE_CHECK_VA(mem_block_xfer(addr,small,&buff[0],false),false,"%s: calibration of blocks failed",name.c_str());
+			uint64_t t1=clock_ns();
+			TRACE_CHECK_VA(mem_block_xfer(addr,nsize,&buff[0],false),false,"%s: calibration of blocks failed",name.c_str());
+			t_small=std::min(t_small,t1-t0);
+			t_big=std::min(t_big,clock_ns()-t1);
+		}
+		m.byte_ns=(t_big>t_small)?(float)(t_big-t_small)/(nsize-small):0;
+		m.blk_op_ns=(uint32_t)std::max(0.0f,t_small-m.byte_ns*small);
+	}
+	TRACE_P_INFO("%s: single=%d ns, block=%d ns + %.2f ns/B",name.c_str(),m.op_ns,m.blk_op_ns,m.byte_ns);
+	setCostModel(m);
+	return true;
+}
+
+/**
+ * Call fn on all the bridges that are alive
+ *
+ * The list is locked during the calls, so that a bridge can not be
+ * destroyed by another thread before fn returns.
+ *
+ * \param[in] fn The function called on each bridge.
+ */
+void EWBBridge::forEachInstance(const std::function<void(EWBBridge*)> &fn)
+{
+	std::lock_guard<std::recursive_mutex> lock(instances_mtx());
+	std::vector<EWBBridge*> &list=instances();
+	for(size_t i=0;i<list.size();i++) fn(list[i]);
+}
+
+/**
+ * Find a bridge by its name
+ *
+ * \return the first bridge with this name or NULL
+ */
+EWBBridge* EWBBridge::find(const std::string &name)
+{
+	std::lock_guard<std::recursive_mutex> lock(instances_mtx());
+	std::vector<EWBBridge*> &list=instances();
+	for(size_t i=0;i<list.size();i++)
+	{
+		if(list[i]->getName()==name) return list[i];
+	}
+	return NULL;
+}
+
+/**
+ * Print a report of the bridge and its transactions statistics
+ *
+ * \param[inout] o the stream that will be modified
+ * \param[in] level The level of details
+ */
+void EWBBridge::report(std::ostream &o, int level) const
+{
+	o << "Bridge: " << getName() << " (type=" << type << ") " << getDesc() << "\n";
+	const EWBLatencyModel &m=getCostModel();
+	o << "Cost: single=" << m.op_ns << "ns";
+	if(m.hasBlock()) o << ", block=" << m.blk_op_ns << "ns + " << m.byte_ns << "ns/B [0x" << std::hex << m.blk_minb << ",0x" << m.blk_maxb << "]" << std::dec;
+	o << "\n";
+	stats.print(o,level);
+}
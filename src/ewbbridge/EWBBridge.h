@@ -11,6 +11,39 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string>
+#include <vector>
+#include <iostream>
+#include <atomic>
+#include <mutex>
+#include <functional>
+
+#include "EWBBridgeStats.h"
+#include "EWBLatencyModel.h"
+
+/**
+ * Step of a sequence of accesses executed by EWBBridge::mem_sequence()
+ *
+ * The structure only contains 32bit words so that it can be sent as it is
+ * to the bridges that execute the sequence remotely (i.e. EWBDaemon).
+ */
+struct EWBSeqOp {
+	//! Type of step
+	enum Type {
+		WRITE=0,	//!< Write value
+		WRITE_MASK,	//!< Write the bits of mask with value (read-modify-write)
+		READ,		//!< Read a word
+		POLL,		//!< Read until (data & mask)==value or timeout_us
+		DELAY		//!< Wait timeout_us
+	};
+	uint32_t type;			//!< \ref Type
+	uint32_t addr;			//!< Address on the wishbone bus
+	uint32_t mask;			//!< Bits written (WRITE_MASK) or compared (POLL)
+	uint32_t value;			//!< Value written or expected
+	uint32_t timeout_us;	//!< Timeout of POLL or duration of DELAY (us)
+
+	//! Return true if the step returns a word (READ and POLL)
+	bool hasData() const { return (type==READ || type==POLL); }
+};
 
 /**
  * Polymorphic & abstract class memory bridge to a EWB device.
@@ -20,21 +53,60 @@
  * 		- might overload DMA access to the memory
  *
  * 	The child class will be defined for each type of physical driver used to access to our EWB board.
+ *
+ * 	The bridges can be used by several threads at the same time:
+ * 		- the state shared by the accesses of a bridge (file, socket, queue of a cycle)
+ * 		is protected by \ref bgd_mtx, the bridges where the backend allows it (i.e. MMIO)
+ * 		perform the single accesses in parallel without locking.
+ * 		- the block buffer is shared by all the callers, a caller must lease it
+ * 		(see BlockLease) between get_block_buffer() and the end of its use.
+ * 		The duplex bridges (see isDuplex()) have one buffer per direction.
+ * 		- mem_block_xfer() uses the buffer of the caller and can always be called concurrently.
+ * 		- a cycle is owned by the thread that opened it: the others wait for closeCycle().
+ * 		- the lock order is the block mutex then \ref bgd_mtx: a bridge that holds \ref bgd_mtx
+ * 		during a cycle must return it from getBlockMutex() (the lease inside a cycle takes no other lock).
  */
 class EWBBridge {
 public:
+	/**
+	 * Exclusive use of the block buffer of a bridge during its lifetime
+	 *
+	 * \code
+	 * EWBBridge::BlockLease lease(pBgd,true);
+	 * fill(lease.get(),lease.size());
+	 * lease.access(dev_addr,nsize);
+	 * \endcode
+	 */
+	class BlockLease {
+	public:
+		BlockLease(EWBBridge *pBgd, bool to_dev)
+		: pBgd(pBgd), lock(pBgd->getBlockMutex(to_dev)), to_dev(to_dev), pBuff(NULL) { bsize=pBgd->get_block_buffer(&pBuff,to_dev); }
+		uint32_t* get() const { return pBuff; }		//!< The block buffer
+		uint32_t size() const { return bsize; }		//!< The size of the block buffer (bytes)
+		//! Transfer the first nsize bytes of the block buffer
+		bool access(uint32_t dev_addr, uint32_t nsize) { return pBgd->mem_block_access(dev_addr,nsize,to_dev); }
+	private:
+		EWBBridge *pBgd;
+		std::lock_guard<std::recursive_mutex> lock;
+		bool to_dev;
+		uint32_t *pBuff;
+		uint32_t bsize;
+	};
+
 	//! The type of the overridden class
 	enum Type {
 		TFILE=0,	//!< Connector to a test file
 		X1052,		//!< Connector to the X1052 driver
 		RAWRABBIT,	//!< Connector to the RawRabbit driver
-		ETHERBONE	//!< Connector to the Etherbone driver
+		ETHERBONE,	//!< Connector to the Etherbone driver
+		RAM,		//!< Connector to an in-memory image (tests & benchmarks)
+		PROXY,		//!< Decorator of another bridge
+		REPLAY,		//!< Connector replaying a recorded log
+		DAEMON		//!< Connector to a bridge shared by EWBDaemon
 	};
 
-	//! Constructor where we only give the type
-	EWBBridge(int type,const std::string &name =""): type(type),name(name),block_busy(false) {};
-	//! Empty destructor
-	virtual ~EWBBridge() {};
+	EWBBridge(int type,const std::string &name ="");
+	virtual ~EWBBridge();
 	//! Return true if the handler of the overridden class if true, otherwise false.
 	virtual bool isValid() { return false; }
 	//! Generic single access to the wishbone memory of the device
@@ -43,21 +115,69 @@ public:
 	virtual uint32_t get_block_buffer(uint32_t **hBuff, bool to_dev) { return 0; };
 	//! Generic block access to the wishbone memory of the device
 	virtual bool mem_block_access(uint32_t dev_addr, uint32_t nsize, bool to_dev) { return false; };
+	//! Block access using a buffer of the caller (split in chunks of the internal buffer size)
+	virtual bool mem_block_xfer(uint32_t dev_addr, uint32_t nsize, uint32_t *pData32, bool to_dev);
+	//! Open a cycle: the single accesses might be queued (data read valid after closeCycle())
+	virtual bool openCycle() { return true; }
+	//! Close the cycle and perform the queued single accesses
+	virtual bool closeCycle() { return true; }
+	//! Return true if the calling thread opened a cycle where the single accesses are queued
+	virtual bool inCycle() const { return false; }
+	//! Execute a sequence of steps with one call (see EWBSequence)
+	virtual bool mem_sequence(const std::vector<EWBSeqOp> &ops, std::vector<uint32_t> &rdata);
 	//! Return which type of EWBBrdige overridden class we are using (force casting)
 	int getType() { return type; }
 	//! Return true if the block access is busy.
-	bool isBlockBusy() { return block_busy; }
+	bool isBlockBusy() const { return block_busy; }
+	//! Return true if the block accesses to and from the device can be performed at the same time
+	virtual bool isDuplex() const { return false; }
+	//! Return the mutex that protects the buffer of get_block_buffer() (see BlockLease)
+	virtual std::recursive_mutex& getBlockMutex(bool to_dev) const { return (to_dev || !isDuplex())?blk_mtx:blk_rd_mtx; }
+
+	//! Return the cost of the accesses used to plan them (see EWBAccessPlanner)
+	virtual const EWBLatencyModel& getCostModel() const { return *pCost; }
+	//! Set the cost of the accesses (i.e. from the datasheet of the bridge), only the parameters are copied
+	virtual void setCostModel(const EWBLatencyModel &model) { cost=model; pCost=&cost; }
+	//! Use a custom cost model (not owned by the bridge), NULL to use the parameters of setCostModel()
+	virtual void setCostModel(const EWBLatencyModel *pModel) { pCost=(pModel)?pModel:&cost; }
+	bool calibrate(uint32_t addr, uint32_t nsize=0x400, int nruns=8);
+	//! Return the time used to measure the accesses by calibrate() (ns)
+	virtual uint64_t clock_ns() const { return EWBBridgeStats::now_ns(); }
+
+	//! Return the generation of the connection, incremented when the bridge (re)connects (see EWBBus::freeze())
+	uint32_t getGeneration() const { return pGen->load(std::memory_order_acquire); }
+	//! Invalidate the validity checks cached by the frozen trees (i.e. on reconnection)
+	void bumpGeneration() { (*pGen)++; }
 
 	virtual const std::string& getName() const { return name; }
 	virtual const std::string& getVer() const { return ver; }
 	virtual const std::string& getDesc() const { return desc; }
 
+	//! Return the transactions statistics of this bridge
+	EWBBridgeStats& getStats() { return stats; }
+	const EWBBridgeStats& getStats() const { return stats; }
+	void report(std::ostream &o, int level=0) const;
+
+	static void forEachInstance(const std::function<void(EWBBridge*)> &fn);
+	static EWBBridge* find(const std::string &name);
+
 protected:
+	//! Use the generation of the connection of another bridge (i.e. the target of a proxy)
+	void shareGeneration(EWBBridge *pOther) { pGen=pOther->pGen; }
+
 	int type; //!< type of the overridden class.
 	std::string name;
 	std::string desc;
 	std::string ver;
-    bool block_busy;
+    std::atomic<bool> block_busy;	//!< true while a block access is performed
+    std::atomic<uint32_t> generation;	//!< Generation of the connection
+    std::atomic<uint32_t> *pGen;	//!< Generation in use (generation or the one of the target of a proxy)
+    mutable std::recursive_mutex bgd_mtx;	//!< Protect the state shared by the accesses (and the opened cycle)
+    mutable std::recursive_mutex blk_mtx;	//!< Protect the block buffer (see BlockLease)
+    mutable std::recursive_mutex blk_rd_mtx;	//!< Protect the from_dev block buffer of a duplex bridge
+    EWBBridgeStats stats; //!< Statistics of the transactions
+    EWBLatencyModel cost; //!< Cost of the accesses (only singles by default)
+    const EWBLatencyModel *pCost; //!< Cost model in use (cost or a custom one)
 };
 
 
@@ -0,0 +1,170 @@
+/*
+ * EWBBridgeDedup.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBBridgeDedup.h"
+
+#define EWB_TRACE_MODULE EWB_TRACE_BRIDGE
+#include <EWBTrace.h>
+
+/**
+ * Constructor of the decorator
+ *
+ * \param[in] pTarget The bridge that is decorated (not owned).
+ * \param[in] window_us The freshness window in microseconds (0: only share the reads in flight).
+ */
+EWBBridgeDedup::EWBBridgeDedup(EWBBridge *pTarget, uint32_t window_us)
+: EWBBridgeProxy(pTarget), window_ns((uint64_t)window_us*1000), nforwarded(0), nshared(0), nfresh(0)
+{
+	if(pTarget) desc="Read dedup of "+pTarget->getName();
+}
+
+EWBBridgeDedup::~EWBBridgeDedup()
+{
+
+}
+
+/**
+ * Single access where the reads of the same address are shared
+ */
+bool EWBBridgeDedup::mem_access(uint32_t addr, uint32_t *data, bool to_dev)
+{
+	TRACE_CHECK_PTR(data,false);
+	std::unique_lock<std::mutex> lock(mtx);
+	std::map<std::thread::id,Cycle>::iterator ic=cycles.find(std::this_thread::get_id());
+	if(ic!=cycles.end())
+	{
+		entries.erase(addr);
+		if(to_dev) ic->second.written=true;
+		lock.unlock();
+		return pTarget->mem_access(addr,data,to_dev);
+	}
+	if(to_dev)
+	{
+		entries.erase(addr);
+		lock.unlock();
+		bool ret=pTarget->mem_access(addr,data,to_dev);
+		//The reads started during the write might have the previous value
+		invalidate(addr,sizeof(uint32_t));
+		return ret;
+	}
+
+	std::map<uint32_t,EntryPtr>::iterator ii=entries.find(addr);
+	if(ii!=entries.end())
+	{
+		EntryPtr e=ii->second;
+		if(e->inflight)
+		{
+			nshared++;
+			cv.wait(lock,[&e]() { return !e->inflight; });
+			*data=e->val;
+			return e->ok;
+		}
+		if(e->ok && EWBBridgeStats::now_ns()-e->t_done<=window_ns)
+		{
+			nfresh++;
+			*data=e->val;
+			return true;
+		}
+	}
+
+	//We are the one performing the read
+	EntryPtr e(new Entry());
+	entries[addr]=e;
+	nforwarded++;
+	lock.unlock();
+
+	uint32_t val=0;
+	bool ret=pTarget->mem_access(addr,&val,false);
+
+	lock.lock();
+	e->val=val;
+	e->ok=ret;
+	e->inflight=false;
+	e->t_done=EWBBridgeStats::now_ns();
+	//Do not keep a failed read
+	if(ret==false)
+	{
+		ii=entries.find(addr);
+		if(ii!=entries.end() && ii->second==e) entries.erase(ii);
+	}
+	lock.unlock();
+	cv.notify_all();
+
+	*data=val;
+	return ret;
+}
+
+/**
+ * Block access that invalidates the reads of the written addresses
+ */
+bool EWBBridgeDedup::mem_block_access(uint32_t dev_addr, uint32_t nsize, bool to_dev)
+{
+	if(to_dev) invalidate(dev_addr,nsize);
+	bool ret=pTarget->mem_block_access(dev_addr,nsize,to_dev);
+	if(to_dev) invalidate(dev_addr,nsize);
+	return ret;
+}
+
+/**
+ * Block transfer that invalidates the reads of the written addresses
+ */
+bool EWBBridgeDedup::mem_block_xfer(uint32_t dev_addr, uint32_t nsize, uint32_t *pData32, bool to_dev)
+{
+	if(to_dev) invalidate(dev_addr,nsize);
+	bool ret=pTarget->mem_block_xfer(dev_addr,nsize,pData32,to_dev);
+	if(to_dev) invalidate(dev_addr,nsize);
+	return ret;
+}
+
+/**
+ * Open a cycle: the accesses of the calling thread are forwarded until closeCycle()
+ */
+bool EWBBridgeDedup::openCycle()
+{
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		cycles[std::this_thread::get_id()].depth++;
+	}
+	return pTarget->openCycle();
+}
+
+/**
+ * Close the cycle of the calling thread
+ *
+ * The queued writes are performed now, so they invalidate all the reads.
+ */
+bool EWBBridgeDedup::closeCycle()
+{
+	bool ret=pTarget->closeCycle();
+	std::lock_guard<std::mutex> lock(mtx);
+	std::map<std::thread::id,Cycle>::iterator ic=cycles.find(std::this_thread::get_id());
+	if(ic!=cycles.end() && --(ic->second.depth)==0)
+	{
+		if(ic->second.written) entries.clear();
+		cycles.erase(ic);
+	}
+	return ret;
+}
+
+/**
+ * Invalidate the reads of a range of addresses
+ *
+ * The reads in flight are still shared with the threads already waiting for them.
+ */
+void EWBBridgeDedup::invalidate(uint32_t addr, uint32_t nsize)
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	entries.erase(entries.lower_bound(addr),(addr+nsize<addr)?entries.end():entries.lower_bound(addr+nsize));
+}
+
+/**
+ * Invalidate all the reads so that the next ones access the device
+ */
+void EWBBridgeDedup::invalidate()
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	entries.clear();
+}
@@ -0,0 +1,88 @@
+/**
+ *  \file
+ *  \brief Contains the class EWBBridgeDedup.
+ *
+ *  \date  Oct 19, 2026
+ */
+
+#ifndef EWBBRIDGEDEDUP_H_
+#define EWBBRIDGEDEDUP_H_
+
+#include "EWBBridgeProxy.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+/**
+ * Decorator that deduplicates the single reads of the same address
+ *
+ * When several EWBField of the same EWBReg are synchronized together,
+ * each of them reads the same address. With this decorator:
+ * 		- a read of an address already in flight waits for it and shares its result (single-flight),
+ * 		- a read of an address completed less than \ref window_ns ago returns the same value.
+ *
+ * A write (single or block) to an address invalidates its previous read
+ * when it starts and when it ends, so the reads performed after a write
+ * always access the device. The accesses performed inside a cycle of
+ * the calling thread are not deduplicated (the value of a read is only
+ * valid once the cycle is closed) and the writes of a cycle invalidate
+ * all the reads when it is closed.
+ *
+ * \warning A freshness window greater than zero must only be used
+ * when the registers are not modified by the device in the meantime
+ * (i.e. not with clear-on-read or fast changing status registers).
+ *
+ * \note The target bridge must accept concurrent accesses to different
+ * addresses (i.e. decorate a EWBBridgeQoS).
+ */
+class EWBBridgeDedup: public EWBBridgeProxy {
+public:
+	EWBBridgeDedup(EWBBridge *pTarget, uint32_t window_us=0);
+	virtual ~EWBBridgeDedup();
+
+	bool mem_access(uint32_t addr, uint32_t *data, bool to_dev);
+	bool mem_block_access(uint32_t dev_addr, uint32_t nsize, bool to_dev);
+	bool mem_block_xfer(uint32_t dev_addr, uint32_t nsize, uint32_t *pData32, bool to_dev);
+	bool openCycle();
+	bool closeCycle();
+
+	void setWindow(uint32_t window_us) { window_ns=(uint64_t)window_us*1000; }	//!< Freshness window (0: only share the reads in flight)
+	uint32_t getWindow() const { return window_ns/1000; }
+	void invalidate();
+
+	uint64_t getNForwarded() const { return nforwarded; }	//!< Number of reads performed on the target
+	uint64_t getNShared() const { return nshared; }			//!< Number of reads that waited for a read in flight
+	uint64_t getNFresh() const { return nfresh; }			//!< Number of reads served within the window
+
+private:
+	//! The last read of an address
+	struct Entry {
+		uint32_t val;		//!< Value read
+		bool ok;			//!< true if the read succeeded
+		bool inflight;		//!< true while the read is performed
+		uint64_t t_done;	//!< When the read completed (ns)
+		Entry(): val(0), ok(false), inflight(true), t_done(0) {};
+	};
+	typedef std::shared_ptr<Entry> EntryPtr;
+
+	//! The cycle opened by a thread
+	struct Cycle {
+		int depth;		//!< Number of cycles opened
+		bool written;	//!< A write was performed in the cycle
+		Cycle(): depth(0), written(false) {};
+	};
+
+	void invalidate(uint32_t addr, uint32_t nsize);
+
+	std::mutex mtx;
+	std::condition_variable cv;
+	std::map<uint32_t,EntryPtr> entries;	//!< Last read of each address
+	uint64_t window_ns;		//!< Freshness window (ns)
+	std::map<std::thread::id,Cycle> cycles;	//!< Cycles opened by each thread
+	uint64_t nforwarded, nshared, nfresh;
+};
+
+#endif /* EWBBRIDGEDEDUP_H_ */
@@ -0,0 +1,28 @@
+/*
+ * EWBBridgeProxy.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBBridgeProxy.h"
+
+/**
+ * Constructor of the decorator
+ *
+ * \param[in] pTarget The bridge that is decorated.
+ * \param[in] name The name of the proxy, if empty the name of the target is used.
+ */
+EWBBridgeProxy::EWBBridgeProxy(EWBBridge *pTarget, const std::string &name)
+: EWBBridge(EWBBridge::PROXY,(name.empty() && pTarget)?pTarget->getName():name), pTarget(pTarget)
+{
+	if(pTarget)
+	{
+		desc="Proxy of "+pTarget->getName();
+		shareGeneration(pTarget);	//The connection is the one of the target
+	}
+}
+
+EWBBridgeProxy::~EWBBridgeProxy()
+{
+
+}
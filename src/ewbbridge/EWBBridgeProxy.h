@@ -0,0 +1,49 @@
+/**
+ *  \file
+ *  \brief Contains the class EWBBridgeProxy.
+ *
+ *  \date  Oct 19, 2026
+ */
+
+#ifndef EWBBRIDGEPROXY_H_
+#define EWBBRIDGEPROXY_H_
+
+#include "EWBBridge.h"
+
+/**
+ * Decorator of a bridge
+ *
+ * By default all the accesses are forwarded to the target bridge,
+ * the inherited class only overloads the methods it needs to modify.
+ *
+ * \note The proxy does not own the target bridge.
+ */
+class EWBBridgeProxy: public EWBBridge {
+public:
+	EWBBridgeProxy(EWBBridge *pTarget, const std::string &name="");
+	virtual ~EWBBridgeProxy();
+
+	virtual bool isValid() { return pTarget && pTarget->isValid(); }
+	virtual bool mem_access(uint32_t addr, uint32_t *data, bool to_dev) { return pTarget->mem_access(addr,data,to_dev); }
+	virtual uint32_t get_block_buffer(uint32_t **hBuff, bool to_dev) { return pTarget->get_block_buffer(hBuff,to_dev); }
+	virtual bool mem_block_access(uint32_t dev_addr, uint32_t nsize, bool to_dev) { return pTarget->mem_block_access(dev_addr,nsize,to_dev); }
+	virtual bool mem_block_xfer(uint32_t dev_addr, uint32_t nsize, uint32_t *pData32, bool to_dev) { return pTarget->mem_block_xfer(dev_addr,nsize,pData32,to_dev); }
+	virtual bool openCycle() { return pTarget->openCycle(); }
+	virtual bool closeCycle() { return pTarget->closeCycle(); }
+	virtual bool inCycle() const { return pTarget->inCycle(); }
+	//! The block buffers are the ones of the target
+	virtual bool isDuplex() const { return pTarget->isDuplex(); }
+	virtual std::recursive_mutex& getBlockMutex(bool to_dev) const { return pTarget->getBlockMutex(to_dev); }
+	//! The accesses cost as the ones of the target
+	virtual const EWBLatencyModel& getCostModel() const { return pTarget->getCostModel(); }
+	virtual void setCostModel(const EWBLatencyModel &model) { pTarget->setCostModel(model); }
+	virtual void setCostModel(const EWBLatencyModel *pModel) { pTarget->setCostModel(pModel); }
+	virtual uint64_t clock_ns() const { return pTarget->clock_ns(); }
+
+	EWBBridge* getTarget() { return pTarget; }	//!< Get the decorated bridge
+
+protected:
+	EWBBridge *pTarget;	//!< The decorated bridge
+};
+
+#endif /* EWBBRIDGEPROXY_H_ */
@@ -0,0 +1,207 @@
+/*
+ * EWBBridgeQoS.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBBridgeQoS.h"
+
+#include <algorithm>
+#include <iomanip>
+
+#define EWB_TRACE_MODULE EWB_TRACE_BRIDGE
+#include <EWBTrace.h>
+
+thread_local EWBBridgeQoS::Lane EWBBridgeQoS::forced=EWBBridgeQoS::LANE_AUTO;
+
+static const char *laneNames[EWBBridgeQoS::NLANES]={ "write", "read", "bulk" };
+
+/**
+ * Constructor of the scheduler
+ *
+ * \param[in] pTarget The bridge shared by the threads (not owned).
+ * \param[in] csize The size of the chunks of the block transfers (bytes).
+ * \param[in] blk_maxb The size of the block buffer given to the caller (bytes).
+ */
+EWBBridgeQoS::EWBBridgeQoS(EWBBridge *pTarget, uint32_t csize, uint32_t blk_maxb)
+: EWBBridgeProxy(pTarget), busy(false), depth(0), npreempted(0), csize(0), pData(NULL), bsize(blk_maxb & ~0x3)
+{
+	for(int i=0;i<NLANES;i++) waiting[i]=0;
+	setChunkSize(csize);
+	if(bsize) pData=new uint32_t[bsize/sizeof(uint32_t)];
+	if(pTarget) desc="QoS of "+pTarget->getName();
+}
+
+EWBBridgeQoS::~EWBBridgeQoS()
+{
+	delete[] pData;
+}
+
+/**
+ * Return true when an access more urgent than the lane is waiting
+ *
+ * \note must be called with mtx locked
+ */
+bool EWBBridgeQoS::urgent(Lane lane) const
+{
+	for(int i=0;i<lane;i++) if(waiting[i]>0) return true;
+	return false;
+}
+
+/**
+ * Wait until the target is free and no access more urgent is waiting
+ *
+ * The owner can acquire the target again (i.e. a single access in a cycle).
+ */
+void EWBBridgeQoS::acquire(Lane lane)
+{
+	std::unique_lock<std::mutex> lock(mtx);
+	if(busy && owner==std::this_thread::get_id())
+	{
+		depth++;
+		return;
+	}
+
+	uint64_t t0=EWBBridgeStats::now_ns();
+	waiting[lane]++;
+	cv.wait(lock,[this,lane]() { return !busy && !urgent(lane); });
+	waiting[lane]--;
+	busy=true;
+	owner=std::this_thread::get_id();
+	depth=1;
+
+	uint64_t ns=EWBBridgeStats::now_ns()-t0;
+	lstats[lane].count++;
+	lstats[lane].wait_ns+=ns;
+	lstats[lane].max_ns=std::max(lstats[lane].max_ns,ns);
+}
+
+/**
+ * Release the target and wake up the waiting accesses
+ */
+void EWBBridgeQoS::release()
+{
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		TRACE_CHECK(busy && owner==std::this_thread::get_id(),,"Released by a thread that is not the owner");
+		if(--depth>0) return;
+		busy=false;
+		owner=std::thread::id();
+	}
+	cv.notify_all();
+}
+
+/**
+ * Single access scheduled in the write or read lane
+ */
+bool EWBBridgeQoS::mem_access(uint32_t addr, uint32_t *data, bool to_dev)
+{
+	acquire((forced!=LANE_AUTO)?forced:((to_dev)?LANE_WRITE:LANE_READ));
+	bool ret=pTarget->mem_access(addr,data,to_dev);
+	release();
+	return ret;
+}
+
+/**
+ * Get the block buffer of the scheduler (the one of the target is not used)
+ */
+uint32_t EWBBridgeQoS::get_block_buffer(uint32_t **hBuff, bool /*to_dev*/)
+{
+	TRACE_CHECK_PTR(hBuff,0);
+	*hBuff=pData;
+	return bsize;
+}
+
+/**
+ * Block access using the buffer of get_block_buffer()
+ *
+ * \ref mem_block_xfer()
+ */
+bool EWBBridgeQoS::mem_block_access(uint32_t dev_addr, uint32_t nsize, bool to_dev)
+{
+	TRACE_CHECK_VA(nsize<=bsize,false,"Size 0x%x bigger than the buffer (0x%x)",nsize,bsize);
+	return mem_block_xfer(dev_addr,nsize,pData,to_dev);
+}
+
+/**
+ * Block transfer split in preemptible chunks scheduled in the bulk lane
+ *
+ * Between two chunks, the single accesses that are waiting are
+ * performed first.
+ */
+bool EWBBridgeQoS::mem_block_xfer(uint32_t dev_addr, uint32_t nsize, uint32_t *pData32, bool to_dev)
+{
+	bool ret=true;
+	Lane lane=(forced!=LANE_AUTO)?forced:LANE_BULK;
+	TRACE_CHECK_PTR(pData32,false);
+
+	for(uint32_t off=0;off<nsize;off+=csize)
+	{
+		acquire(lane);
+		ret &= pTarget->mem_block_xfer(dev_addr+off,std::min(csize,nsize-off),pData32+off/sizeof(uint32_t),to_dev);
+		if(off+csize<nsize)
+		{
+			//Checked before releasing, the waiting access might be served before we look again
+			std::lock_guard<std::mutex> lock(mtx);
+			if(urgent(lane)) npreempted++;
+		}
+		release();
+	}
+	return ret;
+}
+
+/**
+ * Open a cycle and hold the target until closeCycle()
+ */
+bool EWBBridgeQoS::openCycle()
+{
+	acquire((forced!=LANE_AUTO)?forced:LANE_READ);
+	bool ret=pTarget->openCycle();
+	if(ret==false) release();
+	return ret;
+}
+
+/**
+ * Close the cycle and release the target
+ */
+bool EWBBridgeQoS::closeCycle()
+{
+	bool ret=pTarget->closeCycle();
+	release();
+	return ret;
+}
+
+/**
+ * Get a copy of the statistics of a lane
+ */
+EWBBridgeQoS::LaneStats EWBBridgeQoS::getLaneStats(Lane lane) const
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	return (lane<NLANES)?lstats[lane]:LaneStats();
+}
+
+/**
+ * Reset the statistics of all the lanes
+ */
+void EWBBridgeQoS::resetLaneStats()
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	for(int i=0;i<NLANES;i++) lstats[i]=LaneStats();
+	npreempted=0;
+}
+
+/**
+ * Print the waiting time of each lane
+ */
+void EWBBridgeQoS::printLanes(std::ostream &o) const
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	o << "Lanes of " << getName() << " (chunk=" << csize << "B, preempted=" << npreempted << ")\n";
+	for(int i=0;i<NLANES;i++)
+	{
+		const LaneStats &s=lstats[i];
+		o << "  " << std::setw(6) << laneNames[i] << ": " << std::setw(10) << s.count
+				<< " avg_wait=" << ((s.count)?s.wait_ns/s.count/1000.0:0) << "us"
+				<< " max_wait=" << s.max_ns/1000.0 << "us\n";
+	}
+}
@@ -0,0 +1,106 @@
+/**
+ *  \file
+ *  \brief Contains the class EWBBridgeQoS.
+ *
+ *  \date  Oct 19, 2026
+ */
+
+#ifndef EWBBRIDGEQOS_H_
+#define EWBBRIDGEQOS_H_
+
+#include "EWBBridgeProxy.h"
+
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+/**
+ * Decorator that schedules the accesses of several threads by priority
+ *
+ * Each access is assigned to a lane:
+ * 		- \ref LANE_WRITE: the single writes (i.e. a setpoint from writeInt32()),
+ * 		- \ref LANE_READ: the single reads,
+ * 		- \ref LANE_BULK: the block transfers (i.e. a peripheral scan).
+ *
+ * Only one access is performed at a time on the target bridge and
+ * when it is released the waiting access of the highest lane goes first.
+ * The block transfers are split in chunks of \ref csize bytes that are
+ * scheduled one by one, so a single access waits at most for one chunk
+ * even while a big scan is running.
+ *
+ * A thread can force the lane of its accesses with a Scope (i.e. a
+ * background thread that reads registers one by one for a scan).
+ *
+ * The single accesses of a cycle are executed while the cycle is opened,
+ * so the target is held from openCycle() until closeCycle().
+ */
+class EWBBridgeQoS: public EWBBridgeProxy {
+public:
+	//! The priority lanes (lower is more urgent)
+	enum Lane {
+		LANE_WRITE=0,	//!< Interactive single write
+		LANE_READ,		//!< Interactive single read
+		LANE_BULK,		//!< Block transfers
+		LANE_AUTO,		//!< Select the lane from the kind of access
+		NLANES=LANE_AUTO
+	};
+
+	//! Statistics of a lane
+	struct LaneStats {
+		uint64_t count;		//!< Number of scheduled accesses (chunks for bulk)
+		uint64_t wait_ns;	//!< Cumulated time waiting for the target
+		uint64_t max_ns;	//!< Longest time waiting for the target
+		LaneStats(): count(0), wait_ns(0), max_ns(0) {};
+	};
+
+	//! Force the lane of the accesses of the current thread during its lifetime
+	class Scope {
+	public:
+		Scope(Lane lane): prev(forced) { forced=lane; }
+		~Scope() { forced=prev; }
+	private:
+		Lane prev;
+	};
+
+	EWBBridgeQoS(EWBBridge *pTarget, uint32_t csize=0x1000, uint32_t blk_maxb=0x10000);
+	virtual ~EWBBridgeQoS();
+
+	bool mem_access(uint32_t addr, uint32_t *data, bool to_dev);
+	uint32_t get_block_buffer(uint32_t **hBuff, bool to_dev);
+	bool mem_block_access(uint32_t dev_addr, uint32_t nsize, bool to_dev);
+	bool mem_block_xfer(uint32_t dev_addr, uint32_t nsize, uint32_t *pData32, bool to_dev);
+	bool openCycle();
+	bool closeCycle();
+	//! The lanes serialize the block accesses in both directions
+	bool isDuplex() const { return false; }
+	//! The block buffer is the one of the scheduler
+	std::recursive_mutex& getBlockMutex(bool /*to_dev*/) const { return blk_mtx; }
+
+	void setChunkSize(uint32_t nbytes) { csize=(nbytes<4)?4:(nbytes & ~0x3); }	//!< Size of the preemptible chunks
+	uint32_t getChunkSize() const { return csize; }
+	LaneStats getLaneStats(Lane lane) const;
+	uint64_t getNPreempted() const { return npreempted; }	//!< Number of chunks delayed by a more urgent access
+	void resetLaneStats();
+	void printLanes(std::ostream &o) const;
+
+private:
+	void acquire(Lane lane);
+	void release();
+	bool urgent(Lane lane) const;
+
+	mutable std::mutex mtx;
+	std::condition_variable cv;
+	uint32_t waiting[NLANES];		//!< Number of threads waiting in each lane
+	bool busy;						//!< true when an access is performed on the target
+	std::thread::id owner;			//!< Thread that performs the access
+	int depth;						//!< Depth of the acquisitions of the owner (cycles)
+	LaneStats lstats[NLANES];
+	uint64_t npreempted;
+	uint32_t csize;					//!< Size of the chunks (bytes)
+	uint32_t *pData;				//!< Internal block buffer
+	uint32_t bsize;					//!< Size of the internal block buffer (bytes)
+
+	static thread_local Lane forced;	//!< Lane forced by a Scope
+};
+
+#endif /* EWBBRIDGEQOS_H_ */
@@ -0,0 +1,192 @@
+/*
+ * EWBBridgeStats.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBBridgeStats.h"
+
+#include <EWBTrace.h>
+
+#include <time.h>
+
+/**
+ * Return the index of the bucket corresponding to a value
+ */
+int EWBHistogram::index(uint64_t value)
+{
+	if(value<NSUB) return (int)value;
+	int exp=63-__builtin_clzll(value);	//Position of highest bit (>=SUB_BITS)
+	int sub=(int)(value >> (exp-SUB_BITS)) & (NSUB-1);
+	return (exp-SUB_BITS+1)*NSUB+sub;
+}
+
+/**
+ * Return the lowest value that belongs to a bucket
+ */
+uint64_t EWBHistogram::lowest(int idx)
+{
+	if(idx<NSUB) return (uint64_t)idx;
+	int exp=idx/NSUB-1+SUB_BITS;
+	return (1ULL << exp) | ((uint64_t)(idx%NSUB) << (exp-SUB_BITS));
+}
+
+/**
+ * Return the highest value that belongs to a bucket
+ */
+uint64_t EWBHistogram::highest(int idx)
+{
+	if(idx<NSUB) return (uint64_t)idx;
+	int exp=idx/NSUB-1+SUB_BITS;
+	return lowest(idx) + ((1ULL << (exp-SUB_BITS))-1);
+}
+
+/**
+ * Record a value in the histogram
+ */
+void EWBHistogram::record(uint64_t value)
+{
+	buckets[index(value)].fetch_add(1,std::memory_order_relaxed);
+	uint64_t v=vmin.load(std::memory_order_relaxed);
+	while(value<v && !vmin.compare_exchange_weak(v,value,std::memory_order_relaxed));
+	v=vmax.load(std::memory_order_relaxed);
+	while(value>v && !vmax.compare_exchange_weak(v,value,std::memory_order_relaxed));
+	sum.fetch_add(value,std::memory_order_relaxed);
+	count.fetch_add(1,std::memory_order_relaxed);
+}
+
+/**
+ * Remove all the recorded values
+ */
+void EWBHistogram::reset()
+{
+	for(int i=0;i<NBUCKETS;i++) buckets[i]=0;
+	count=0;
+	sum=0;
+	vmin=UINT64_MAX;
+	vmax=0;
+}
+
+/**
+ * Return the value at a given percentile
+ *
+ * \param[in] pct The percentile in [0-100]
+ * \return the highest value of the bucket that contains the percentile
+ * (clipped to the max recorded value), 0 when the histogram is empty.
+ */
+uint64_t EWBHistogram::getPercentile(double pct) const
+{
+	uint64_t count=getCount(), vmax=getMax();
+	if(count==0) return 0;
+	if(pct<0) pct=0;
+	if(pct>100) pct=100;
+
+	uint64_t target=(uint64_t)(pct*count/100.0+0.5);
+	if(target<1) target=1;
+
+	uint64_t acc=0;
+	for(int i=0;i<NBUCKETS;i++)
+	{
+		acc+=getBucket(i);
+		if(acc>=target)
+		{
+			uint64_t val=highest(i);
+			return (val>vmax)?vmax:val;
+		}
+	}
+	return vmax;
+}
+
+//------------------------------------------------------------------------------
+
+/**
+ * Return a monotonic timestamp in nanoseconds
+ */
+uint64_t EWBBridgeStats::now_ns()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return (uint64_t)ts.tv_sec*1000000000ULL+ts.tv_nsec;
+}
+
+/**
+ * Return the short name of an operation
+ */
+const char* EWBBridgeStats::getOpName(int op)
+{
+	static const char* names[NOPS] = { "single-R", "single-W", "block-R", "block-W" };
+	return (op>=0 && op<NOPS)?names[op]:"unknown";
+}
+
+/**
+ * Record a transaction
+ *
+ * \param[in] op The type of operation (\ref Op)
+ * \param[in] nbytes The number of bytes transfered
+ * \param[in] ok The status of the transaction
+ * \param[in] ns The duration of the transaction in nanoseconds
+ */
+void EWBBridgeStats::record(int op, uint32_t nbytes, bool ok, uint64_t ns)
+{
+	if(op<0 || op>=NOPS) return;
+	hist[op].record(ns);
+	if(ok) bytes[op].fetch_add(nbytes,std::memory_order_relaxed);
+	else errors[op].fetch_add(1,std::memory_order_relaxed);
+}
+
+/**
+ * Reset all counters and histograms
+ *
+ * \note The transactions recorded at the same time might be partially counted.
+ */
+void EWBBridgeStats::reset()
+{
+	for(int i=0;i<NOPS;i++)
+	{
+		errors[i]=0;
+		retries[i]=0;
+		bytes[i]=0;
+		hist[i].reset();
+	}
+}
+
+/**
+ * Print the statistics in a stream
+ *
+ * \param[inout] o the stream that will be modified
+ * \param[in] level When >0 the latency distribution (per power of two) is also printed
+ */
+void EWBBridgeStats::print(std::ostream &o, int level) const
+{
+	EWBTrace::stream_format(o,"  %-8s %10s %8s %8s %12s %9s %9s %9s %9s %9s\n",
+			"op","count","errors","retries","bytes","mean[us]","p50[us]","p99[us]","p999[us]","max[us]");
+	for(int i=0;i<NOPS;i++)
+	{
+		const EWBHistogram &h=hist[i];
+		EWBTrace::stream_format(o,"  %-8s %10llu %8llu %8llu %12llu %9.2f %9.2f %9.2f %9.2f %9.2f\n",
+				getOpName(i),
+				(unsigned long long)h.getCount(),(unsigned long long)getErrors(i),
+				(unsigned long long)getRetries(i),(unsigned long long)getBytes(i),
+				h.getMean()/1000.0,h.getPercentile(50)/1000.0,h.getPercentile(99)/1000.0,
+				h.getPercentile(99.9)/1000.0,h.getMax()/1000.0);
+	}
+
+	if(level<=0) return;
+	for(int i=0;i<NOPS;i++)
+	{
+		const EWBHistogram &h=hist[i];
+		if(h.getCount()==0) continue;
+		o << "  " << getOpName(i) << " latency distribution:\n";
+
+		//Merge the sub-buckets of each power of two
+		for(int g=0;g<EWBHistogram::NBUCKETS;g+=EWBHistogram::NSUB)
+		{
+			uint64_t n=0;
+			for(int b=g;b<g+EWBHistogram::NSUB;b++) n+=h.getBucket(b);
+			if(n==0) continue;
+			EWBTrace::stream_format(o,"    [%12.3f - %12.3f] us: %10llu (%5.1f%%)\n",
+					EWBHistogram::lowest(g)/1000.0,EWBHistogram::highest(g+EWBHistogram::NSUB-1)/1000.0,
+					(unsigned long long)n,100.0*n/h.getCount());
+		}
+	}
+}
@@ -0,0 +1,129 @@
+/*
+ * EWBBridgeStats.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef EWBBRIDGESTATS_H_
+#define EWBBRIDGESTATS_H_
+
+#include <stdint.h>
+#include <iostream>
+#include <atomic>
+
+/**
+ * Latency histogram with a logarithmic bucket scale (HDR-style)
+ *
+ * Each power of two is split in 2^SUB_BITS linear sub-buckets so that the
+ * relative error of any recorded value is below 1/2^SUB_BITS (12.5%),
+ * on the full uint64_t range and with a fixed memory footprint.
+ *
+ * Values are usually given in nanoseconds.
+ *
+ * The values can be recorded by several threads without lock: the
+ * counters are atomic, so a reader might only see a value counted in
+ * the buckets and not yet in the sum (or the other way).
+ */
+class EWBHistogram {
+public:
+	enum {
+		SUB_BITS=3,						//!< Number of bits of precision
+		NSUB=(1<<SUB_BITS),				//!< Sub-buckets per power of two
+		NBUCKETS=(64-SUB_BITS+1)*NSUB	//!< Total number of buckets
+	};
+
+	EWBHistogram() { reset(); }
+
+	void record(uint64_t value);
+	void reset();
+
+	uint64_t getCount() const { return count.load(std::memory_order_relaxed); }	//!< Number of recorded values
+	uint64_t getMin() const { return (getCount())?vmin.load(std::memory_order_relaxed):0; }	//!< Lowest recorded value
+	uint64_t getMax() const { return vmax.load(std::memory_order_relaxed); }	//!< Highest recorded value
+	double getMean() const { uint64_t n=getCount(); return (n)?(double)sum.load(std::memory_order_relaxed)/n:0.0; }	//!< Mean of recorded values
+	uint64_t getPercentile(double pct) const;
+	uint32_t getBucket(int idx) const { return buckets[idx].load(std::memory_order_relaxed); }	//!< Number of values in a bucket
+
+	static int index(uint64_t value);
+	static uint64_t lowest(int idx);
+	static uint64_t highest(int idx);
+
+private:
+	std::atomic<uint32_t> buckets[NBUCKETS];
+	std::atomic<uint64_t> count;
+	std::atomic<uint64_t> sum;
+	std::atomic<uint64_t> vmin, vmax;
+};
+
+
+/**
+ * Statistics of the transactions performed by a EWBBridge
+ *
+ * Counters (operations, errors, retries, bytes) and latency histogram
+ * are kept for each type of operations (\ref Op). They are atomic so
+ * recording a transaction does not serialize the callers of a bridge.
+ *
+ * The bridges record their transactions using the Probe helper:
+ * \code
+ * bool EWBMyBridge::mem_access(uint32_t addr, uint32_t *data, bool to_dev)
+ * {
+ * 		EWBBridgeStats::Probe probe(stats,(to_dev)?EWBBridgeStats::SINGLE_W:EWBBridgeStats::SINGLE_R,4);
+ * 		...
+ * 		return probe.done(ret);
+ * }
+ * \endcode
+ */
+class EWBBridgeStats {
+public:
+	//! Type of operation
+	enum Op { SINGLE_R=0, SINGLE_W, BLOCK_R, BLOCK_W, NOPS };
+
+	/**
+	 * Helper that measures the time of a transaction
+	 *
+	 * When the probe is destroyed before calling done(), the
+	 * transaction is recorded as an error.
+	 */
+	class Probe {
+	public:
+		Probe(EWBBridgeStats &s, int op, uint32_t nbytes)
+		: s(s), op(op), nbytes(nbytes), t0((s.isEnabled())?now_ns():0), pending(true) {};
+		~Probe() { if(pending) done(false); }
+		//! Record the transaction and return its status
+		bool done(bool ok) { pending=false; if(t0) s.record(op,nbytes,ok,now_ns()-t0); return ok; }
+	private:
+		EWBBridgeStats &s;
+		int op;
+		uint32_t nbytes;
+		uint64_t t0;
+		bool pending;
+	};
+
+	EWBBridgeStats(): enabled(true) { reset(); }
+
+	void record(int op, uint32_t nbytes, bool ok, uint64_t ns);
+	void addRetry(int op) { if(op>=0 && op<NOPS) retries[op].fetch_add(1,std::memory_order_relaxed); }	//!< Count a retry of the operation
+	void reset();
+	void setEnabled(bool val=true) { enabled=val; }		//!< Enable or disable the statistics
+	bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+	uint64_t getCount(int op) const { return hist[op].getCount(); }	//!< Number of operations
+	uint64_t getErrors(int op) const { return errors[op].load(std::memory_order_relaxed); }		//!< Number of failed operations
+	uint64_t getRetries(int op) const { return retries[op].load(std::memory_order_relaxed); }	//!< Number of retries
+	uint64_t getBytes(int op) const { return bytes[op].load(std::memory_order_relaxed); }		//!< Number of bytes transfered
+	const EWBHistogram& getHisto(int op) const { return hist[op]; }	//!< Latency histogram (ns)
+
+	void print(std::ostream &o, int level=0) const;
+
+	static uint64_t now_ns();
+	static const char* getOpName(int op);
+
+private:
+	std::atomic<bool> enabled;
+	std::atomic<uint64_t> errors[NOPS];
+	std::atomic<uint64_t> retries[NOPS];
+	std::atomic<uint64_t> bytes[NOPS];
+	EWBHistogram hist[NOPS];
+};
+
+#endif /* EWBBRIDGESTATS_H_ */
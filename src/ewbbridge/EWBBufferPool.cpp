@@ -0,0 +1,151 @@
+/*
+ * EWBBufferPool.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBBufferPool.h"
+
+#include <stdlib.h>
+#include <sys/mman.h>
+
+#define EWB_TRACE_MODULE EWB_TRACE_BRIDGE
+#include <EWBTrace.h>
+
+/**
+ * Constructor of a pool
+ *
+ * \param[in] huge if true the buffers are allocated in hugepages (when available).
+ */
+EWBBufferPool::EWBBufferPool(bool huge)
+: huge(huge)
+{
+
+}
+
+/**
+ * Destructor that frees all the memory
+ *
+ * \warning The buffers must not be leased anymore.
+ */
+EWBBufferPool::~EWBBufferPool()
+{
+	if(leased.size()>0) TRACE_P_WARNING("%d buffers are still leased",(int)leased.size());
+	for(size_t i=0;i<chunks.size();i++)
+	{
+		if(chunks[i].mapped) munmap(chunks[i].ptr,chunks[i].size);
+		else free(chunks[i].ptr);
+	}
+}
+
+/**
+ * Return the pool shared by the library
+ */
+EWBBufferPool& EWBBufferPool::getDefault()
+{
+	static EWBBufferPool pool;
+	return pool;
+}
+
+/**
+ * Allocate the free buffers of a size
+ *
+ * A hugepage is split in several buffers when they are smaller than it.
+ */
+bool EWBBufferPool::grow(uint32_t bsize)
+{
+	Chunk c={ NULL, 0, false };
+	if(huge)
+	{
+		c.size=((bsize+EWB_BUFFPOOL_HUGEB-1)/EWB_BUFFPOOL_HUGEB)*EWB_BUFFPOOL_HUGEB;
+		c.ptr=mmap(NULL,c.size,PROT_READ | PROT_WRITE,MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,-1,0);
+		c.mapped=(c.ptr!=MAP_FAILED);
+		if(c.mapped==false) TRACE_P_DEBUG("No hugepage available for %d bytes",bsize);
+	}
+	if(c.mapped==false)
+	{
+		c.size=bsize;
+		if(posix_memalign(&c.ptr,EWB_BUFFPOOL_MINB,c.size)!=0) c.ptr=NULL;
+		TRACE_CHECK_VA(c.ptr,false,"Can not allocate %d bytes",bsize);
+	}
+	chunks.push_back(c);
+
+	std::vector<uint32_t*> &list=freed[bsize];
+	for(size_t off=0;off+bsize<=c.size;off+=bsize) list.push_back((uint32_t*)((uint8_t*)c.ptr+off));
+	return true;
+}
+
+/**
+ * Lease a buffer (use Lease to release it automatically)
+ *
+ * \param[in] nsize The minimum size of the buffer (bytes).
+ * \param[out] pBSize If not NULL, the real size of the buffer (bytes).
+ * \return the buffer aligned on \ref EWB_BUFFPOOL_MINB or NULL if the allocation failed.
+ */
+uint32_t* EWBBufferPool::acquire(uint32_t nsize, uint32_t *pBSize)
+{
+	uint32_t bsize=EWB_BUFFPOOL_MINB;
+	while(bsize<nsize && bsize<0x80000000) bsize<<=1;
+	if(pBSize) *pBSize=0;
+	TRACE_CHECK_VA(bsize>=nsize,NULL,"Can not lease %u bytes",nsize);
+
+	std::lock_guard<std::mutex> lock(mtx);
+	std::vector<uint32_t*> &list=freed[bsize];
+	if(list.empty() && grow(bsize)==false) return NULL;
+	uint32_t *pBuff=list.back();
+	list.pop_back();
+	leased[pBuff]=bsize;
+	if(pBSize) *pBSize=bsize;
+	return pBuff;
+}
+
+/**
+ * Give back a leased buffer to the pool
+ */
+void EWBBufferPool::release(uint32_t *pBuff)
+{
+	if(pBuff==NULL) return;
+	std::lock_guard<std::mutex> lock(mtx);
+	std::map<uint32_t*,uint32_t>::iterator ii=leased.find(pBuff);
+	if(ii==leased.end())
+	{
+		TRACE_P_WARNING("%p was not leased from this pool",pBuff);
+		return;
+	}
+	freed[ii->second].push_back(pBuff);
+	leased.erase(ii);
+}
+
+//! Number of buffers currently leased
+size_t EWBBufferPool::getNLeased() const
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	return leased.size();
+}
+
+//! Number of buffers ready to be leased
+size_t EWBBufferPool::getNFree() const
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	size_t n=0;
+	for(std::map<uint32_t,std::vector<uint32_t*> >::const_iterator ii=freed.begin();ii!=freed.end();++ii) n+=ii->second.size();
+	return n;
+}
+
+//! Number of hugepages allocated
+size_t EWBBufferPool::getNHugePages() const
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	size_t n=0;
+	for(size_t i=0;i<chunks.size();i++) if(chunks[i].mapped) n+=chunks[i].size/EWB_BUFFPOOL_HUGEB;
+	return n;
+}
+
+//! Size of the memory allocated by the pool (bytes)
+uint64_t EWBBufferPool::getAllocated() const
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	uint64_t n=0;
+	for(size_t i=0;i<chunks.size();i++) n+=chunks[i].size;
+	return n;
+}
@@ -0,0 +1,91 @@
+/**
+ *  \file
+ *  \brief Contains the class EWBBufferPool.
+ *
+ *  \date  Oct 19, 2026
+ */
+
+#ifndef EWBBUFFERPOOL_H_
+#define EWBBUFFERPOOL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <map>
+#include <vector>
+#include <mutex>
+
+#define EWB_BUFFPOOL_MINB	0x1000		//!< Smallest buffer (and alignment) of the pool
+#define EWB_BUFFPOOL_HUGEB	0x200000	//!< Size of a hugepage
+
+/**
+ * Pool of aligned buffers leased by the callers of the block transfers
+ *
+ * The buffers are given to EWBBridge::mem_block_xfer() so that several
+ * block transfers can be in progress at the same time (the internal buffer
+ * of a bridge only allows one), and the bridges that use the buffer of the
+ * caller (RAM, MMIO, daemon) do not copy the data.
+ *
+ * The sizes are rounded up to a power of two (at least \ref EWB_BUFFPOOL_MINB)
+ * and a released buffer is kept for the next lease of the same size.
+ * When hugepages are enabled, the buffers are carved from hugepages
+ * (MAP_HUGETLB), the pool falls back to posix_memalign() when the system
+ * has no hugepage available.
+ *
+ * \code
+ * EWBBufferPool::Lease buff(nsize);
+ * pBgd->mem_block_xfer(dev_addr,nsize,buff.get(),false);
+ * \endcode
+ */
+class EWBBufferPool {
+public:
+	/**
+	 * Buffer leased from a pool during the lifetime of the object
+	 */
+	class Lease {
+	public:
+		Lease(uint32_t nsize) : pool(EWBBufferPool::getDefault()) { pBuff=pool.acquire(nsize,&bsize); }
+		Lease(EWBBufferPool &pool, uint32_t nsize) : pool(pool) { pBuff=pool.acquire(nsize,&bsize); }
+		~Lease() { pool.release(pBuff); }
+		uint32_t* get() const { return pBuff; }		//!< The buffer (NULL if the allocation failed)
+		uint32_t size() const { return bsize; }		//!< The size of the buffer (bytes)
+	private:
+		Lease(const Lease&);
+		Lease& operator=(const Lease&);
+		EWBBufferPool &pool;
+		uint32_t *pBuff;
+		uint32_t bsize;
+	};
+
+	EWBBufferPool(bool huge=false);
+	virtual ~EWBBufferPool();
+
+	uint32_t* acquire(uint32_t nsize, uint32_t *pBSize=NULL);
+	void release(uint32_t *pBuff);
+
+	void setHuge(bool val) { huge=val; }		//!< Use hugepages for the next allocations
+	bool isHuge() const { return huge; }		//!< Return true when hugepages are used (if available)
+	size_t getNLeased() const;
+	size_t getNFree() const;
+	size_t getNHugePages() const;
+	uint64_t getAllocated() const;
+
+	static EWBBufferPool& getDefault();
+
+private:
+	//! Memory allocated by the pool
+	struct Chunk {
+		void *ptr;		//!< The memory
+		size_t size;	//!< Its size (bytes)
+		bool mapped;	//!< true if it is a hugepage (mmap), false if allocated by posix_memalign()
+	};
+
+	bool grow(uint32_t bsize);
+
+	mutable std::mutex mtx;
+	bool huge;
+	std::vector<Chunk> chunks;							//!< All the allocated memory
+	std::map<uint32_t,std::vector<uint32_t*> > freed;	//!< The free buffers by size
+	std::map<uint32_t*,uint32_t> leased;				//!< The leased buffers and their size
+};
+
+#endif /* EWBBUFFERPOOL_H_ */
@@ -0,0 +1,499 @@
+/*
+ * EWBDaemon.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBDaemon.h"
+
+#include <map>
+#include <cstring>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define EWB_TRACE_MODULE EWB_TRACE_BRIDGE
+#include <EWBTrace.h>
+
+/**
+ * Constructor that creates the listening Unix socket
+ *
+ * \param[in] pBridge The bridge that will be shared (not owned).
+ * \param[in] path The path of the Unix socket.
+ */
+EWBDaemon::EWBDaemon(EWBBridge *pBridge, const std::string &path)
+: pBridge(pBridge), path(path), lfd(-1), nextid(0), running(false), nrounds(0), nops(0), ncoalesced(0), nsequences(0),
+  seq_quit(false), efd(-1)
+{
+	struct sockaddr_un addr;
+	memset(&addr,0,sizeof(addr));
+	addr.sun_family=AF_UNIX;
+	if(pBridge==NULL || path.size()>=sizeof(addr.sun_path))
+	{
+		TRACE_P_ERROR("Invalid bridge or socket path %s",path.c_str());
+		return;
+	}
+	strncpy(addr.sun_path,path.c_str(),sizeof(addr.sun_path)-1);
+
+	lfd=socket(AF_UNIX,SOCK_STREAM | SOCK_NONBLOCK,0);
+	unlink(path.c_str());
+	if(lfd<0 || bind(lfd,(struct sockaddr*)&addr,sizeof(addr))<0 || listen(lfd,16)<0)
+	{
+		TRACE_P_ERROR("Can not listen on %s (%s)",path.c_str(),strerror(errno));
+		if(lfd>=0) close(lfd);
+		lfd=-1;
+		return;
+	}
+	efd=eventfd(0,EFD_NONBLOCK);
+	if(efd<0)
+	{
+		TRACE_P_ERROR("Can not create the event of the sequences (%s)",strerror(errno));
+		close(lfd);
+		lfd=-1;
+		return;
+	}
+	seq_th=std::thread(&EWBDaemon::runSequences,this);
+	TRACE_P_INFO("Sharing %s on %s",pBridge->getName().c_str(),path.c_str());
+}
+
+/**
+ * Destructor that disconnects all the clients and removes the socket
+ */
+EWBDaemon::~EWBDaemon()
+{
+	stop();
+	{
+		std::lock_guard<std::mutex> lock(seq_mtx);
+		seq_quit=true;
+	}
+	seq_cv.notify_all();
+	if(seq_th.joinable()) seq_th.join();
+	if(efd>=0) close(efd);
+	for(size_t i=0;i<clients.size();i++) if(clients[i].fd>=0) close(clients[i].fd);
+	if(lfd>=0)
+	{
+		close(lfd);
+		unlink(path.c_str());
+	}
+}
+
+/**
+ * Serve the clients in a thread
+ */
+bool EWBDaemon::start()
+{
+	TRACE_CHECK(isValid(),false,"Not listening");
+	if(running) return true;
+	running=true;
+	th=std::thread([this]() { while(running) runOnce(50); });
+	return true;
+}
+
+/**
+ * Stop the thread started by start()
+ */
+void EWBDaemon::stop()
+{
+	running=false;
+	if(th.joinable()) th.join();
+}
+
+/**
+ * Accept all the pending connections
+ */
+void EWBDaemon::acceptClient()
+{
+	for(;;)
+	{
+		Client c;
+		c.fd=accept4(lfd,NULL,NULL,SOCK_NONBLOCK);
+		c.txoff=0;
+		c.busy=false;
+		if(c.fd<0) return;
+		c.id=nextid++;
+		clients.push_back(c);
+		TRACE_P_DEBUG("Client #%d connected (%d clients)",c.fd,(int)clients.size());
+	}
+}
+
+/**
+ * Read all the data available from a client
+ *
+ * \return false if the client has disconnected.
+ */
+bool EWBDaemon::receive(Client &c)
+{
+	uint8_t buff[0x4000];
+	for(;;)
+	{
+		ssize_t n=recv(c.fd,buff,sizeof(buff),MSG_DONTWAIT);
+		if(n>0) c.rx.insert(c.rx.end(),buff,buff+n);
+		else if(n<0 && (errno==EAGAIN || errno==EWOULDBLOCK)) return true;
+		else if(n<0 && errno==EINTR) continue;
+		else return false;
+	}
+}
+
+/**
+ * Extract the next complete request of a client
+ *
+ * \return true if a request was extracted.
+ */
+bool EWBDaemon::extract(Client &c, Batch &b)
+{
+	EWBDaemonHdr hdr;
+	if(c.rx.size()<sizeof(hdr)) return false;
+	memcpy(&hdr,&c.rx[0],sizeof(hdr));
+	if(hdr.magic!=EWBD_MAGIC)
+	{
+		TRACE_P_WARNING("Client #%d: bad magic 0x%08x",c.fd,hdr.magic);
+		close(c.fd);
+		c.fd=-1;
+		return false;
+	}
+	if(hdr.size>EWBD_MAXPAYLOAD)
+	{
+		TRACE_P_WARNING("Client #%d: payload of %u bytes > %u",c.fd,hdr.size,EWBD_MAXPAYLOAD);
+		close(c.fd);
+		c.fd=-1;
+		return false;
+	}
+	if(c.rx.size()<sizeof(hdr)+hdr.size) return false;
+
+	b.req.assign(c.rx.begin(),c.rx.begin()+sizeof(hdr)+hdr.size);
+	c.rx.erase(c.rx.begin(),c.rx.begin()+sizeof(hdr)+hdr.size);
+	b.id=c.id;
+	b.fd=c.fd;
+	b.nerrors=0;
+	b.singles=false;
+	return true;
+}
+
+/**
+ * Return true if the batch is a sequence (executed by runSequences())
+ */
+bool EWBDaemon::isSequence(const Batch &b) const
+{
+	EWBDaemonHdr hdr;
+	EWBDaemonOp op;
+	if(b.req.size()<sizeof(hdr)+sizeof(op)) return false;
+	memcpy(&hdr,&b.req[0],sizeof(hdr));
+	memcpy(&op,&b.req[sizeof(hdr)],sizeof(op));
+	return (hdr.nops==1 && op.type==EWBDaemonOp::SEQUENCE);
+}
+
+/**
+ * Execute the batches of a round in a single bridge cycle
+ *
+ * \note The sequences are not in the batches, see runSequences().
+ */
+void EWBDaemon::execute(std::vector<Batch> &batches)
+{
+	std::map<uint32_t,uint32_t*> lastRead;	//Where the value of an address read in this round is
+	std::vector<std::pair<uint32_t*,uint32_t*> > copies;
+	EWBDaemonHdr hdr;
+	EWBDaemonOp op;
+
+	pBridge->openCycle();
+	for(size_t i=0;i<batches.size();i++)
+	{
+		Batch &b=batches[i];
+		memcpy(&hdr,&b.req[0],sizeof(hdr));
+		const uint8_t *p, *end=&b.req[0]+b.req.size();
+
+		//First check all the ops and obtain the size of the reply
+		size_t nwords=0;
+		uint32_t k;
+		p=&b.req[0]+sizeof(hdr);
+		for(k=0;k<hdr.nops;k++)
+		{
+			if((size_t)(end-p)<sizeof(op)) break;
+			memcpy(&op,p,sizeof(op));
+			p+=sizeof(op);
+			bool to_dev=(op.type==EWBDaemonOp::WRITE || op.type==EWBDaemonOp::BLOCK_WRITE);
+			if(op.type==EWBDaemonOp::READ || op.type==EWBDaemonOp::WRITE)
+			{
+				if(op.nsize!=sizeof(uint32_t)) break;
+			}
+			else if(op.type==EWBDaemonOp::BLOCK_READ || op.type==EWBDaemonOp::BLOCK_WRITE)
+			{
+				if(op.nsize==0 || (op.nsize & 0x3)) break;
+			}
+			else break;
+
+			if(to_dev)
+			{
+				if(op.nsize>(size_t)(end-p)) break;
+				p+=op.nsize;
+			}
+			else
+			{
+				nwords+=op.nsize/sizeof(uint32_t);
+				if(nwords*sizeof(uint32_t)>EWBD_MAXPAYLOAD) break;
+			}
+		}
+		if(k<hdr.nops)
+		{
+			TRACE_P_WARNING("Client #%d: bad op #%d (type=%d, nsize=%d)",b.fd,k,op.type,op.nsize);
+			b.nerrors++;
+			continue;
+		}
+		b.rdata.assign(nwords,0);
+
+		//Then execute the ops in order
+		size_t roff=0;
+		p=&b.req[0]+sizeof(hdr);
+		for(k=0;k<hdr.nops;k++)
+		{
+			memcpy(&op,p,sizeof(op));
+			p+=sizeof(op);
+			bool to_dev=(op.type==EWBDaemonOp::WRITE || op.type==EWBDaemonOp::BLOCK_WRITE);
+
+			uint32_t *pData32=(to_dev)?(uint32_t*)p:&b.rdata[roff];
+			switch(op.type)
+			{
+			case EWBDaemonOp::READ:
+			{
+				std::map<uint32_t,uint32_t*>::iterator ii=lastRead.find(op.addr);
+				if(ii!=lastRead.end())
+				{
+					copies.push_back(std::make_pair(pData32,ii->second));
+					ncoalesced++;
+				}
+				else
+				{
+					if(!pBridge->mem_access(op.addr,pData32,false)) b.nerrors++;
+					lastRead[op.addr]=pData32;
+				}
+				b.singles=true;
+				break;
+			}
+			case EWBDaemonOp::WRITE:
+				if(!pBridge->mem_access(op.addr,pData32,true)) b.nerrors++;
+				lastRead.erase(op.addr);
+				b.singles=true;
+				break;
+			case EWBDaemonOp::BLOCK_READ:
+				if(!pBridge->mem_block_xfer(op.addr,op.nsize,pData32,false)) b.nerrors++;
+				break;
+			case EWBDaemonOp::BLOCK_WRITE:
+				if(!pBridge->mem_block_xfer(op.addr,op.nsize,pData32,true)) b.nerrors++;
+				lastRead.erase(lastRead.lower_bound(op.addr),lastRead.lower_bound(op.addr+op.nsize));
+				break;
+			}
+			if(to_dev) p+=op.nsize;
+			else roff+=op.nsize/sizeof(uint32_t);
+		}
+		nops+=hdr.nops;
+	}
+
+	//The singles are only done when the cycle is closed
+	if(pBridge->closeCycle()==false)
+	{
+		for(size_t i=0;i<batches.size();i++) if(batches[i].singles) batches[i].nerrors++;
+	}
+	for(size_t i=0;i<copies.size();i++) *(copies[i].first)=*(copies[i].second);
+}
+
+/**
+ * Execute the sequence of a batch on the shared bridge
+ */
+void EWBDaemon::execSequence(Batch &b)
+{
+	EWBDaemonOp op;
+	memcpy(&op,&b.req[sizeof(EWBDaemonHdr)],sizeof(op));
+	size_t off=sizeof(EWBDaemonHdr)+sizeof(op);
+	if((op.nsize % sizeof(EWBSeqOp)) || off+op.nsize>b.req.size())
+	{
+		TRACE_P_WARNING("Client #%d: bad sequence (%d bytes)",b.fd,op.nsize);
+		b.nerrors++;
+		return;
+	}
+
+	std::vector<EWBSeqOp> ops(op.nsize/sizeof(EWBSeqOp));
+	if(ops.size()>0) memcpy(&ops[0],&b.req[off],op.nsize);
+	if(pBridge->mem_sequence(ops,b.rdata)==false) b.nerrors++;
+	nops+=ops.size();
+	nsequences++;
+}
+
+/**
+ * Thread that executes the queued sequences one by one
+ *
+ * The executed sequences are replied by runOnce(), which is woken up by efd.
+ */
+void EWBDaemon::runSequences()
+{
+	std::unique_lock<std::mutex> lock(seq_mtx);
+	while(true)
+	{
+		seq_cv.wait(lock,[this]() { return seq_quit || seq_todo.empty()==false; });
+		if(seq_quit) return;
+		Batch b=seq_todo.front();
+		seq_todo.pop_front();
+		lock.unlock();
+		execSequence(b);
+		lock.lock();
+		seq_done.push_back(b);
+		uint64_t one=1;
+		if(write(efd,&one,sizeof(one))<0) TRACE_P_WARNING("Can not notify the end of a sequence (%s)",strerror(errno));
+	}
+}
+
+/**
+ * Reply the executed sequences and release their clients
+ */
+void EWBDaemon::replySequences()
+{
+	std::deque<Batch> done;
+	uint64_t cnt;
+	{
+		std::lock_guard<std::mutex> lock(seq_mtx);
+		done.swap(seq_done);
+		if(read(efd,&cnt,sizeof(cnt))<0 && errno!=EAGAIN) TRACE_P_WARNING("Can not read the event (%s)",strerror(errno));
+	}
+	//The reply of a client that has disconnected is dropped
+	for(size_t i=0;i<done.size();i++)
+	{
+		for(size_t k=0;k<clients.size();k++)
+		{
+			Client &c=clients[k];
+			if(c.fd<0 || c.id!=done[i].id) continue;
+			c.busy=false;
+			done[i].client=k;
+			if(reply(done[i])==false) { close(c.fd); c.fd=-1; }
+			break;
+		}
+	}
+}
+
+/**
+ * Queue the reply of a batch and send what the socket of its client accepts
+ *
+ * \return false if the client has disconnected.
+ */
+bool EWBDaemon::reply(Batch &b)
+{
+	Client &c=clients[b.client];
+	EWBDaemonHdr hdr={ EWBD_MAGIC, b.nerrors, (uint32_t)(b.rdata.size()*sizeof(uint32_t)) };
+	const uint8_t *p=(const uint8_t*)&hdr;
+	c.tx.insert(c.tx.end(),p,p+sizeof(hdr));
+	p=(const uint8_t*)b.rdata.data();
+	c.tx.insert(c.tx.end(),p,p+hdr.size);
+	return drain(c);
+}
+
+/**
+ * Send the pending replies of a client until its socket is full
+ *
+ * \return false if the client has disconnected.
+ */
+bool EWBDaemon::drain(Client &c)
+{
+	while(c.txoff<c.tx.size())
+	{
+		ssize_t n=send(c.fd,&c.tx[c.txoff],c.tx.size()-c.txoff,MSG_NOSIGNAL | MSG_DONTWAIT);
+		if(n>0) c.txoff+=n;
+		else if(n<0 && (errno==EAGAIN || errno==EWOULDBLOCK)) return true;	//Sent on POLLOUT
+		else if(n<0 && errno==EINTR) continue;
+		else return false;
+	}
+	c.tx.clear();
+	c.txoff=0;
+	return true;
+}
+
+/**
+ * Perform one round: receive the requests and execute one batch per client
+ *
+ * The sequences are only queued to runSequences(), their replies are sent
+ * by the round that follows their execution.
+ *
+ * \param[in] timeout_ms The maximum time to wait for a request.
+ * \return the number of batches executed (or sequences queued), or -1 on error.
+ */
+int EWBDaemon::runOnce(int timeout_ms)
+{
+	TRACE_CHECK(isValid(),-1,"Not listening");
+	std::vector<struct pollfd> pfds(clients.size()+2);
+	bool pending=false;
+	EWBDaemonHdr hdr;
+
+	pfds[0].fd=lfd;
+	pfds[0].events=POLLIN;
+	pfds[1].fd=efd;
+	pfds[1].events=POLLIN;
+	for(size_t i=0;i<clients.size();i++)
+	{
+		Client &c=clients[i];
+		bool ready=(c.busy==false && c.tx.empty());	//The requests of a client in a sequence or with replies to send wait
+		pfds[i+2].fd=c.fd;	//A client in a sequence is still watched for a hangup (always reported)
+		pfds[i+2].events=((ready)?POLLIN:0) | ((c.tx.empty())?0:POLLOUT);
+		//Do not wait when a request is already buffered
+		if(ready && c.rx.size()>=sizeof(hdr))
+		{
+			memcpy(&hdr,&c.rx[0],sizeof(hdr));
+			pending|=(c.rx.size()>=sizeof(hdr)+hdr.size);
+		}
+	}
+
+	int n=poll(&pfds[0],pfds.size(),(pending)?0:timeout_ms);
+	if(n<0) return (errno==EINTR)?0:-1;
+
+	//The clients released by a sequence might have requests already received
+	if(pfds[1].revents & POLLIN) replySequences();
+
+	//The new clients might have already sent a request
+	size_t nold=clients.size();
+	if(pfds[0].revents & POLLIN) acceptClient();
+	for(size_t i=0;i<clients.size();i++)
+	{
+		if((i<nold && (pfds[i+2].revents & POLLOUT) && drain(clients[i])==false)
+				|| ((i>=nold || (pfds[i+2].revents & (POLLIN | POLLHUP | POLLERR))) && receive(clients[i])==false))
+		{
+			close(clients[i].fd);
+			clients[i].fd=-1;
+		}
+	}
+
+	std::vector<Batch> batches;
+	size_t nseqs=0;
+	for(size_t i=0;i<clients.size();i++)
+	{
+		Batch b;
+		if(clients[i].fd>=0 && clients[i].busy==false && clients[i].tx.empty() && extract(clients[i],b))
+		{
+			b.client=i;
+			if(isSequence(b))
+			{
+				clients[i].busy=true;
+				std::lock_guard<std::mutex> lock(seq_mtx);
+				seq_todo.push_back(b);
+				nseqs++;
+			}
+			else batches.push_back(b);
+		}
+	}
+	if(nseqs) seq_cv.notify_all();
+
+	if(batches.size()>0) execute(batches);
+	if(batches.size()+nseqs>0)
+	{
+		nrounds++;	//Before the replies so that a client always sees its round counted
+		for(size_t i=0;i<batches.size();i++)
+		{
+			Client &c=clients[batches[i].client];
+			if(reply(batches[i])==false) { close(c.fd); c.fd=-1; }
+		}
+	}
+
+	//Remove the disconnected clients
+	for(size_t i=clients.size();i>0;i--)
+	{
+		if(clients[i-1].fd<0) clients.erase(clients.begin()+i-1);
+	}
+	return batches.size()+nseqs;
+}
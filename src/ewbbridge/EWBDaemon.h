@@ -0,0 +1,134 @@
+/**
+ *  \file
+ *  \brief Contains the class EWBDaemon and its local protocol.
+ *
+ *  The messages exchanged on the Unix socket use the host endianness:
+ *  	- request: EWBDaemonHdr + nops * (EWBDaemonOp + data to write)
+ *  	- reply:   EWBDaemonHdr (nerrors) + data read (in the order of the ops)
+ *
+ *  A request with a SEQUENCE op only contains this op, its data are the
+ *  EWBSeqOp of the sequence and its reply the words of the READ and POLL steps.
+ *
+ *  \date  Oct 19, 2026
+ */
+
+#ifndef EWBDAEMON_H_
+#define EWBDAEMON_H_
+
+#include "EWBBridge.h"
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+#define EWBD_MAGIC	0x44425745	//!< "EWBD"
+#define EWBD_SOCKET	"/tmp/ewbd.sock"	//!< Default path of the socket
+#define EWBD_MAXPAYLOAD	0x1000000	//!< Maximum size of the payload of a request or a reply (bytes)
+
+//! Header of a request or a reply
+struct EWBDaemonHdr {
+	uint32_t magic;		//!< \ref EWBD_MAGIC
+	uint32_t nops;		//!< Number of ops (request) or of errors (reply)
+	uint32_t size;		//!< Size of the payload that follows (bytes)
+};
+
+//! Operation of a request
+struct EWBDaemonOp {
+	//! Type of operation
+	enum Type { READ=0, WRITE, BLOCK_READ, BLOCK_WRITE, SEQUENCE };
+	uint32_t type;		//!< \ref Type
+	uint32_t addr;		//!< Address on the wishbone bus
+	uint32_t nsize;		//!< Size of the data (bytes)
+};
+
+/**
+ * Daemon that shares a bridge between several local processes
+ *
+ * The clients (see EWBMemDaemonCon) send batches of operations on a
+ * Unix socket. At each round, the daemon takes the next batch of each
+ * client and executes them in a single bridge cycle:
+ * 		- the ops of a client are executed in order (writes are never reordered)
+ * 		- a single read of an address already read in the round (without
+ * 		write in between) is coalesced and served with the same value.
+ *
+ * The sequences (see EWBBridge::mem_sequence()) need the data read during
+ * their execution, they are executed one by one by a thread of the daemon
+ * so that their POLL and DELAY steps do not stall the rounds of the other
+ * clients. The next requests of a client wait for the end of its sequence.
+ *
+ * The replies are sent without blocking the rounds: what does not fit in
+ * the socket is kept and sent when the client is ready, and the next
+ * requests of this client wait until its replies have been sent.
+ */
+class EWBDaemon {
+public:
+	EWBDaemon(EWBBridge *pBridge, const std::string &path=EWBD_SOCKET);
+	virtual ~EWBDaemon();
+
+	bool isValid() const { return (lfd>=0); }
+	bool start();
+	void stop();
+	int runOnce(int timeout_ms);
+
+	const std::string& getPath() const { return path; }
+	size_t getNClients() const { return clients.size(); }	//!< Number of connected clients
+	uint64_t getNRounds() const { return nrounds; }			//!< Number of executed rounds
+	uint64_t getNOps() const { return nops; }				//!< Number of ops received
+	uint64_t getNCoalesced() const { return ncoalesced; }	//!< Number of reads coalesced
+	uint64_t getNSequences() const { return nsequences; }	//!< Number of sequences executed
+
+private:
+	//! A connected client
+	struct Client {
+		int fd;
+		uint64_t id;				//!< Unique identifier (the fd is reused by the next clients)
+		std::vector<uint8_t> rx;	//!< Received data not yet processed
+		std::vector<uint8_t> tx;	//!< Replies not yet sent (drained on POLLOUT)
+		size_t txoff;				//!< Size of tx already sent
+		bool busy;					//!< A sequence of the client is being executed
+	};
+
+	//! A batch of a client being executed
+	struct Batch {
+		size_t client;					//!< Index of the client
+		uint64_t id;					//!< Identifier of the client (its index might change during a sequence)
+		int fd;							//!< Socket of the client (for the traces)
+		std::vector<uint8_t> req;		//!< The request
+		std::vector<uint32_t> rdata;	//!< Data of the reply
+		uint32_t nerrors;				//!< Number of failed ops
+		bool singles;					//!< true if the batch has single ops
+	};
+
+	void acceptClient();
+	bool receive(Client &c);
+	bool extract(Client &c, Batch &b);
+	bool isSequence(const Batch &b) const;
+	void execute(std::vector<Batch> &batches);
+	void execSequence(Batch &b);
+	void runSequences();
+	void replySequences();
+	bool reply(Batch &b);
+	bool drain(Client &c);
+
+	EWBBridge *pBridge;		//!< The bridge shared by the clients
+	std::string path;		//!< Path of the Unix socket
+	int lfd;				//!< Listening socket
+	std::vector<Client> clients;
+	uint64_t nextid;		//!< Identifier of the next connected client
+	std::thread th;
+	std::atomic<bool> running;
+	std::atomic<uint64_t> nrounds, nops, ncoalesced, nsequences;	//!< Statistics (read by the other threads)
+
+	std::thread seq_th;				//!< Thread that executes the sequences
+	std::mutex seq_mtx;				//!< Protect the queues of sequences
+	std::condition_variable seq_cv;	//!< Notified when a sequence is queued
+	std::deque<Batch> seq_todo;		//!< Sequences to execute
+	std::deque<Batch> seq_done;		//!< Sequences executed and not yet replied
+	bool seq_quit;					//!< Stop the thread of the sequences
+	int efd;						//!< Event notified when a sequence is executed (wakes up runOnce())
+};
+
+#endif /* EWBDAEMON_H_ */
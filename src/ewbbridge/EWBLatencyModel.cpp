@@ -0,0 +1,52 @@
+/*
+ * EWBLatencyModel.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBLatencyModel.h"
+
+/**
+ * Return the simulated time of an access
+ *
+ * \param[in] block true for a block access, false for a single one.
+ * \param[in] nbytes The number of bytes of the access
+ * \param[in] to_dev true when writing to the device (same cost in both directions here)
+ * \return the time in nanoseconds
+ */
+uint64_t EWBLatencyModel::cost(bool block, uint32_t nbytes, bool /*to_dev*/) const
+{
+	if(block==false) return op_ns;
+	if(nbytes<blk_minb) nbytes=blk_minb;
+	return blk_op_ns+(uint64_t)(byte_ns*nbytes);
+}
+
+/**
+ * Return true when all the parameters of the models are the same
+ *
+ * \note The overloaded cost() are not compared.
+ */
+bool EWBLatencyModel::operator==(const EWBLatencyModel &o) const
+{
+	return op_ns==o.op_ns && blk_op_ns==o.blk_op_ns && byte_ns==o.byte_ns && blk_minb==o.blk_minb
+			&& blk_maxb==o.blk_maxb && mode==o.mode && align==o.align;
+}
+
+/**
+ * Return an approximated model of the X1052 bridge
+ *
+ * Around 2us per CSR access and a DMA with 10us of setup,
+ * ~200MB/s and padded to 0x80 bytes.
+ */
+EWBLatencyModel EWBLatencyModel::X1052(int mode)
+{
+	return EWBLatencyModel(2000,10000,5.0,0x80,0x8000,mode);
+}
+
+/**
+ * Return a model of a bridge that only performs single accesses
+ */
+EWBLatencyModel EWBLatencyModel::singles()
+{
+	return EWBLatencyModel(1,0,0,0,0);
+}
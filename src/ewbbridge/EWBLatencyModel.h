@@ -0,0 +1,61 @@
+/**
+ *  \file
+ *  \brief Contains the class EWBLatencyModel.
+ *
+ *  \date  Oct 19, 2026
+ */
+
+#ifndef EWBLATENCYMODEL_H_
+#define EWBLATENCYMODEL_H_
+
+#include <stdint.h>
+
+/**
+ * Model of the time taken by the accesses of a bridge
+ *
+ * It is used to simulate a bridge (EWBMemRAMCon) and as the cost descriptor
+ * of each bridge (EWBBridge::getCostModel()) from which EWBAccessPlanner
+ * chooses between single and block accesses.
+ *
+ * The default model is:
+ * 	- single access: op_ns
+ * 	- block access:  blk_op_ns + byte_ns * max(nbytes,blk_minb)
+ *
+ * Inherit from this class and overload cost() to use another model, it
+ * must be given by pointer (EWBMemRAMCon::setLatencyModel(EWBLatencyModel*),
+ * EWBBridge::setCostModel(const EWBLatencyModel*)) as the copies only keep
+ * the parameters.
+ */
+class EWBLatencyModel {
+public:
+	//! How the latency is applied by the bridge
+	enum Mode {
+		ACCOUNT=0,	//!< Only account the simulated time (deterministic, no wait)
+		SPIN,		//!< Busy wait during the simulated time (accurate)
+		SLEEP		//!< Sleep during the simulated time (coarse, does not use CPU)
+	};
+
+	EWBLatencyModel(uint32_t op_ns=0, uint32_t blk_op_ns=0, float byte_ns=0,
+			uint32_t blk_minb=0, uint32_t blk_maxb=0x8000, int mode=ACCOUNT, uint32_t align=sizeof(uint32_t))
+	: op_ns(op_ns), blk_op_ns(blk_op_ns), byte_ns(byte_ns), blk_minb(blk_minb), blk_maxb(blk_maxb), mode(mode), align(align) {};
+	virtual ~EWBLatencyModel() {};
+
+	virtual uint64_t cost(bool block, uint32_t nbytes, bool to_dev) const;
+
+	bool operator==(const EWBLatencyModel &o) const;
+	bool operator!=(const EWBLatencyModel &o) const { return !(*this==o); }	//!< Return true when a parameter differs
+	bool hasBlock() const { return blk_maxb>=sizeof(uint32_t); }	//!< Return true if the bridge performs block accesses
+
+	static EWBLatencyModel X1052(int mode=ACCOUNT);
+	static EWBLatencyModel singles();
+
+	uint32_t op_ns;		//!< Cost of a single access (ns)
+	uint32_t blk_op_ns;	//!< Fixed cost of a block access (ns)
+	float byte_ns;		//!< Cost per byte of a block access (ns)
+	uint32_t blk_minb;	//!< Minimum size of a block access (bytes), smaller are padded
+	uint32_t blk_maxb;	//!< Maximum size of a block access (bytes)
+	int mode;			//!< How the latency is applied (\ref Mode)
+	uint32_t align;		//!< Alignment of the start of a block access (bytes)
+};
+
+#endif /* EWBLATENCYMODEL_H_ */
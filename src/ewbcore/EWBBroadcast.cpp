@@ -0,0 +1,166 @@
+/*
+ * EWBBroadcast.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBBroadcast.h"
+
+#include "EWBBus.h"
+#include "EWBPeriph.h"
+#include "EWBReg.h"
+#include "EWBField.h"
+#include "EWBTrace.h"
+
+#include <sstream>
+#include <thread>
+
+EWBBroadcast::EWBBroadcast()
+: concurrent(true)
+{
+
+}
+
+EWBBroadcast::~EWBBroadcast()
+{
+
+}
+
+/**
+ * Add a board to the group
+ *
+ * \param[in] pBus The root bus of the board (not owned).
+ * \param[in] name The name of the board used in the results (its index when empty).
+ * \return false if the bus is NULL or already in the group.
+ */
+bool EWBBroadcast::add(EWBBus *pBus, const std::string &name)
+{
+	TRACE_CHECK_PTR(pBus,false);
+	for(size_t i=0;i<members.size();i++)
+	{
+		TRACE_CHECK_VA(members[i].pBus!=pBus,false,"%s is already in the group",members[i].name.c_str());
+	}
+
+	Member m;
+	m.pBus=pBus;
+	m.name=name;
+	if(name.empty())
+	{
+		std::stringstream ss;
+		ss << "#" << members.size();
+		m.name=ss.str();
+	}
+	members.push_back(m);
+	return true;
+}
+
+/**
+ * Find a field in a bus using its path
+ *
+ * \param[in] pBus The bus where the peripheral is searched (including its sub-buses).
+ * \param[in] path The path of the field: "<periph>.<reg>.<field>"
+ * \return the field or NULL if not found.
+ */
+EWBField* EWBBroadcast::findField(EWBBus *pBus, const std::string &path)
+{
+	TRACE_CHECK_PTR(pBus,NULL);
+	size_t p1=path.find('.');
+	size_t p2=(p1==std::string::npos)?p1:path.find('.',p1+1);
+	TRACE_CHECK_VA(p2!=std::string::npos,NULL,"Bad path '%s' (periph.reg.field)",path.c_str());
+
+	EWBPeriph *pPrh=pBus->findPeriph(path.substr(0,p1));
+	if(pPrh==NULL || pPrh->getLastReg()==NULL) return NULL;
+
+	std::string rname=path.substr(p1+1,p2-p1-1), fname=path.substr(p2+1);
+	EWBReg *pReg=NULL;
+	while((pReg=pPrh->getNextReg(pReg))!=NULL)
+	{
+		if(pReg->getName()!=rname) continue;
+		std::vector<EWBField*> fields=pReg->getFields();
+		for(size_t j=0;j<fields.size();j++)
+		{
+			if(fields[j] && fields[j]->getName()==fname) return fields[j];
+		}
+		return NULL;
+	}
+	return NULL;
+}
+
+/**
+ * Write the same value to the field of all the boards
+ *
+ * \param[in] path The path of the field: "<periph>.<reg>.<field>"
+ * \param[in] value The value to write (converted with EWBField::convert()).
+ * \param[in] amode The access mode of the sync (EWB_AM_RW to read back the value).
+ * \return the status of each board (in the order they were added).
+ */
+std::vector<EWBBroadcast::Result> EWBBroadcast::write(const std::string &path, uint32_t value, EWBSync::AMode amode)
+{
+	return broadcast(path,value,amode);
+}
+
+/**
+ * \copydoc write(const std::string&,uint32_t,EWBSync::AMode)
+ */
+std::vector<EWBBroadcast::Result> EWBBroadcast::write(const std::string &path, float value, EWBSync::AMode amode)
+{
+	return broadcast(path,value,amode);
+}
+
+/**
+ * Perform the writes (one thread per board)
+ */
+template<typename T>
+std::vector<EWBBroadcast::Result> EWBBroadcast::broadcast(const std::string &path, T value, EWBSync::AMode amode)
+{
+	std::vector<Result> res(members.size());
+	std::vector<std::thread> ths;
+
+	for(size_t i=0;i<members.size();i++)
+	{
+		res[i].name=members[i].name;
+		res[i].status=NOT_FOUND;
+		EWBField *pFld=findField(members[i].pBus,path);
+		if(pFld==NULL) continue;
+
+		int *pStatus=&(res[i].status);
+		auto job=[pFld,pStatus,value,amode]() {
+			T val=value;
+			bool ok=pFld->convert(&val,false) && pFld->sync(amode);
+			*pStatus=(ok)?OK:FAILED;
+		};
+		if(concurrent) ths.push_back(std::thread(job));
+		else job();
+	}
+	for(size_t i=0;i<ths.size();i++) ths[i].join();
+
+	for(size_t i=0;i<res.size();i++)
+	{
+		if(res[i].status!=OK)
+			TRACE_P_WARNING("%s: %s on %s",path.c_str(),getStatusName(res[i].status),res[i].name.c_str());
+	}
+	return res;
+}
+
+/**
+ * Return true if the access succeeded on all the boards
+ */
+bool EWBBroadcast::isOK(const std::vector<Result> &res)
+{
+	for(size_t i=0;i<res.size();i++) if(res[i].status!=OK) return false;
+	return true;
+}
+
+/**
+ * Return the name of a \ref Status
+ */
+const char* EWBBroadcast::getStatusName(int status)
+{
+	switch(status)
+	{
+	case OK: return "OK";
+	case NOT_FOUND: return "not found";
+	case FAILED: return "failed";
+	default: return "unknown";
+	}
+}
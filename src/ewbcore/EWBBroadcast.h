@@ -0,0 +1,75 @@
+/*
+ * EWBBroadcast.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef EWBBROADCAST_H_
+#define EWBBROADCAST_H_
+
+#include "EWBSync.h"
+
+#include <string>
+#include <vector>
+
+class EWBBus;
+class EWBField;
+
+/**
+ * Group of identical boards that receive the same writes
+ *
+ * Each member is the root EWBBus of a board (with its own bridge). A field
+ * is designated by its path "<periph>.<reg>.<field>" and the writes to
+ * all the members are performed concurrently (one thread per board), so
+ * pushing a configuration takes about the time of a single board.
+ *
+ * \code
+ * EWBBroadcast grp;
+ * grp.add(pBusSlot2,"slot2");
+ * grp.add(pBusSlot3,"slot3");
+ * std::vector<EWBBroadcast::Result> res=grp.write("wrpc.ctrl.enable",1);
+ * \endcode
+ */
+class EWBBroadcast {
+public:
+	//! Status of the access to a member
+	enum Status {
+		OK=0,		//!< The field has been synchronized
+		NOT_FOUND,	//!< The path does not exist on this board
+		FAILED,		//!< The conversion or the access to the device failed
+	};
+
+	//! Result of the access to a member
+	struct Result {
+		std::string name;	//!< Name of the member
+		int status;			//!< \ref Status
+	};
+
+	EWBBroadcast();
+	virtual ~EWBBroadcast();
+
+	bool add(EWBBus *pBus, const std::string &name="");
+	size_t size() const { return members.size(); }		//!< Number of members
+	void setConcurrent(bool val) { concurrent=val; }	//!< Access the members concurrently (default) or in sequence
+
+	std::vector<Result> write(const std::string &path, uint32_t value, EWBSync::AMode amode=EWBSync::EWB_AM_W);
+	std::vector<Result> write(const std::string &path, float value, EWBSync::AMode amode=EWBSync::EWB_AM_W);
+
+	static EWBField* findField(EWBBus *pBus, const std::string &path);
+	static bool isOK(const std::vector<Result> &res);
+	static const char* getStatusName(int status);
+
+private:
+	//! A board of the group
+	struct Member {
+		EWBBus *pBus;
+		std::string name;
+	};
+
+	template<typename T> std::vector<Result> broadcast(const std::string &path, T value, EWBSync::AMode amode);
+
+	std::vector<Member> members;
+	bool concurrent;
+};
+
+#endif /* EWBBROADCAST_H_ */
@@ -11,7 +11,7 @@
 #include "ewbbridge/EWBBridge.h"
 
 EWBBus::EWBBus(EWBBridge *b, uint32_t base_offset, EWBBus *parent)
-: b(b), base_offset(base_offset), parent(parent)
+: b(b), base_offset(base_offset), parent(parent), pMirror(NULL)
 {
 	if(parent)
 	{
@@ -42,12 +42,83 @@ bool EWBBus::isValid(int level) const
 	return ((level!=0)? (b && b->isValid()) : (b!=NULL) );
 }
 
+/**
+ * Validate the tree once and cache the absolute address of the registers
+ *
+ * Call it when the tree is completely built: the accesses to the registers of
+ * this bus and its sub-buses do not check the whole tree anymore. The registers
+ * are validated again after a reconnection of the bridge (EWBBridge::getGeneration()).
+ *
+ * \return false if the bus or one of its registers is not valid.
+ * \see EWBReg::freeze()
+ */
+bool EWBBus::freeze()
+{
+	TRACE_CHECK(isValid(),false,"EWBBus is not valid");
+	bool ret=true;
+	for(size_t j=0;j<periphs.size();j++)
+	{
+		if(periphs[j] && periphs[j]->freeze()==false) ret=false;
+	}
+	for(size_t j=0;j<children.size();j++)
+	{
+		if(children[j] && children[j]->freeze()==false) ret=false;
+	}
+	return ret;
+}
+
+/**
+ * Unfreeze the registers (before modifying the tree)
+ */
+void EWBBus::unfreeze()
+{
+	for(size_t j=0;j<periphs.size();j++)
+	{
+		if(periphs[j]) periphs[j]->unfreeze();
+	}
+	for(size_t j=0;j<children.size();j++)
+	{
+		if(children[j]) children[j]->unfreeze();
+	}
+}
+
+/**
+ * Publish the registers of this bus and its sub-buses (see EWBMirror)
+ *
+ * The mirror is cached by the peripherals, the sub-buses that have their
+ * own mirror keep it.
+ *
+ * \param[in] pMirror The mirror (not owned) or NULL to use the one of the parent.
+ */
+void EWBBus::setMirror(EWBMirror *pMirror)
+{
+	this->pMirror=pMirror;
+	updateMirror();
+}
+
+/**
+ * Cache the mirror of this bus in its peripherals and sub-buses
+ */
+void EWBBus::updateMirror()
+{
+	EWBMirror *pM=getMirror();
+	for(size_t j=0;j<periphs.size();j++)
+	{
+		if(periphs[j]) periphs[j]->setMirror(pM);
+	}
+	for(size_t j=0;j<children.size();j++)
+	{
+		if(children[j]) children[j]->updateMirror();
+	}
+}
+
 bool EWBBus::appendPeriph(EWBPeriph *pPrh)
 {
 	if(pPrh)
 	{
 		//Adding to vector
 		periphs.push_back(pPrh);
+		pPrh->setMirror(getMirror());
 		return true;
 	}
 	return false;
@@ -61,6 +132,7 @@ bool EWBBus::appendChild(EWBBus *pBus)
 
 		//Adding to vector
 		children.push_back(pBus);
+		pBus->updateMirror();
 		return true;
 	}
 	return false;
@@ -68,3 +140,33 @@ bool EWBBus::appendChild(EWBBus *pBus)
 
 
 
+
+/**
+ * Find a peripheral by its name in this bus and its sub-buses
+ *
+ * \return the first peripheral found or NULL.
+ */
+EWBPeriph* EWBBus::findPeriph(const std::string &name) const
+{
+	EWBString id;
+	return (EWBString::find(name,&id))?findPeriph(id):NULL;
+}
+
+/**
+ * Find a peripheral by its interned name (compared by pointer)
+ *
+ * \return the first peripheral found or NULL.
+ */
+EWBPeriph* EWBBus::findPeriph(const EWBString &name) const
+{
+	for(size_t j=0;j<periphs.size();j++)
+	{
+		if(periphs[j] && periphs[j]->getNameId()==name) return periphs[j];
+	}
+	for(size_t j=0;j<children.size();j++)
+	{
+		EWBPeriph *pPrh=(children[j])?children[j]->findPeriph(name):NULL;
+		if(pPrh) return pPrh;
+	}
+	return NULL;
+}
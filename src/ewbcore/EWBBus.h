@@ -11,9 +11,12 @@
 #include <stdint.h>
 #include <cstddef>
 #include <vector>
+#include <string>
 
 class EWBBridge;
 class EWBPeriph;
+class EWBMirror;
+class EWBString;
 
 /**
  * Simple class that help us connecting different peripheral to a bus or a sub bus.
@@ -27,17 +30,28 @@ public:
 	EWBBridge* getBridge()  { return b; }
 	uint32_t getOffset() const { return base_offset; }
 	bool isValid(int level=-1) const;
+	bool freeze();
+	void unfreeze();
 	const std::vector<EWBBus*>& getChildren() const { return children; }
 	const std::vector<EWBPeriph*>& getPeripherals() const { return periphs; }
 
+	void setMirror(EWBMirror *pMirror);
+	EWBMirror* getMirror() const { return (pMirror || parent==NULL)?pMirror:parent->getMirror(); }	//!< Get the mirror of this bus or its parents
+
+	EWBPeriph* findPeriph(const std::string &name) const;
+	EWBPeriph* findPeriph(const EWBString &name) const;
+	EWBPeriph* findPeriph(const char *name) const { return findPeriph(std::string(name)); }	//!< \ref findPeriph()
+
 	bool appendPeriph(EWBPeriph *pPrh);
 	bool appendChild(EWBBus *bus);
 
 protected:
+	void updateMirror();
 
 	EWBBridge *b;
 	uint32_t base_offset;
 	EWBBus *parent;
+	EWBMirror *pMirror;
 	std::vector<EWBBus *> children;
 	std::vector<EWBPeriph *> periphs;
 };
@@ -10,6 +10,8 @@
 #include "EWBReg.h"
 #include "EWBPeriph.h"
 #include "EWBTrace.h"
+#include "EWBHeatmap.h"
+#include "EWBMirror.h"
 
 #include "ewbbridge/EWBBridge.h"
 
@@ -30,10 +32,6 @@ value == std::numeric_limits<T>::infinity();
 }
 #endif
 
-
-#define TRACE_P_VDEBUG(...) //TRACE_P_DEBUG( __VA_ARGS__)
-#define TRACE_P_VVDEBUG(...) //TRACE_P_DEBUG( __VA_ARGS__)
-
 /**
  * Default constructor of the EWBField
  *
@@ -55,44 +53,47 @@ EWBField::EWBField(EWBReg *pReg,
 		const std::string &name, uint8_t width,
 		uint8_t shift, uint8_t mode, const std::string &desc,
 		uint8_t signess, uint8_t nfb, int index, double iniVal):
-		EWBParam(name,EWBF_TM_TYPE_FIELD,mode,desc)
+		EWBParam(std::make_shared<EWBFieldLayout>(name,width,shift,mode,desc,signess,nfb,index,iniVal),EWBF_TM_TYPE_FIELD,mode)
 
 {
-	if((width+shift)>32) TRACE_P_WARNING("width (%d) + shift (%d) <= 32 bits",width,shift);
+	init(pReg);
+}
 
-	if(this->type==EWBF_32FP) {
-		if((width > nfb)==false)
-			TRACE_P_WARNING("%s Width (%d) must be superior than nbfp (%d)",getCName(),width,nfb);
-	}
-	else {
-		if((width >= nfb)==false)
-			TRACE_P_WARNING("%s Width (%d) must be superior or equal than nbfp (%d)",getCName(),width,nfb);
-	}
+/**
+ * Constructor of a EWBField that shares its layout with the other instances
+ *
+ * \param[in] pReg Belonging EWBReg
+ * \param[in] pLayout The layout of the field (see EWBLayout).
+ */
+EWBField::EWBField(EWBReg *pReg,const EWBFieldLayoutPtr &pLayout):
+		EWBParam(pLayout,pLayout->type,pLayout->mode)
+{
+	init(pReg);
+}
 
+/**
+ * Initialize the state of the instance and append it to its register
+ */
+void EWBField::init(EWBReg *pReg)
+{
+	const EWBFieldLayout &l=layout();
 	this->pReg=pReg;
-	this->width=width;
-	this->shift=shift;
-	this->type |=(signess & EWBF_TM_SIGNESS);
-	if(nfb>0) this->type|=EWBF_TM_FIXED_POINT;
-	this->nfb=nfb;
+	this->type=l.type;
 	this->forceSync=false;
 	this->checkOverflow=true;
-	this->mask = (((1ULL<<width)-1) << shift);
-
-	getLimit(vmin,vmax);
 
-	if(nfb>0) { TRACE_P_DEBUG("%s type=0x%0x nfb=%d, dVal=%f (x%08x) [%f,%15f]",name.c_str(),type,nfb,iniVal,mask,vmin,vmax); }
-	else { TRACE_P_DEBUG("%s type=0x%0x nfb=%d, dVal=%f (x%08x) [%d,%d]",name.c_str(),type,nfb,iniVal,mask,(uint32_t)vmin,(uint32_t)vmax); }
+	if(l.nfb>0) { TRACE_P_DEBUG("%s type=0x%0x nfb=%d, dVal=%f (x%08x) [%f,%15f]",getCName(),type,l.nfb,l.iniVal,l.mask,l.vmin,l.vmax); }
+	else { TRACE_P_DEBUG("%s type=0x%0x nfb=%d, dVal=%f (x%08x) [%d,%d]",getCName(),type,l.nfb,l.iniVal,l.mask,(uint32_t)l.vmin,(uint32_t)l.vmax); }
 
 	if(pReg)
 	{
 		bool added;
-		if(isinf(iniVal)) added=pReg->addField(this,index);
+		if(isinf(l.iniVal)) added=pReg->addField(this,l.index);
 		else
 		{
-			float dVal32=(float)iniVal;
+			float dVal32=(float)l.iniVal;
 			this->convert(&dVal32,false);
-			added=pReg->addField(this,index,true);
+			added=pReg->addField(this,l.index,true);
 		}
 		if(added==false) this->pReg=NULL; //Remove linking
 	}
@@ -102,7 +103,7 @@ EWBField::EWBField(EWBReg *pReg,
 //{
 //	int i = 1;
 //	for (; mask; mask >>= 1, i++)
-//		this->width=i-shift;
+//		l.width=i-shift;
 //}
 
 
@@ -114,51 +115,6 @@ EWBField::~EWBField()
 
 }
 
-void EWBField::getLimit(float &fmin, float &fmax)
-{
-	float ftmp;
-	uint32_t data, val;
-	bool checkOF_old;
-	switch(type)
-	{
-	case EWBF_32U:				//Unsigned integer
-		fmin=0.f;
-		fmax=(float)((1ULL<<width)-1);
-		if(width>30) fmax=(float)((1ULL<<30)-1);
-		break;
-	case EWBF_32I:				//MSB Signed Integer
-		fmin=-((float)(1ULL<<(width-1))-1);
-		fmax=(float)(1ULL<<(width-1))-1;
-		break;
-	case EWBF_32I2C:	//2C Signed Integer
-		fmin=-(float)(1ULL<<(width-1));
-		fmax=(float)(1ULL<<(width-1))-1;
-		break;
-	case EWBF_32FPU: 	//Unsigned Fixed Point
-		fmin=0;
-		fmax=(float)(1ULL<<(width-nfb));
-		fmax-=1.f/(1ULL<<nfb);
-		break;
-	case EWBF_32FP: 			//MSB Signed Fixed point (0x5)
-		fmax=(float)(1ULL<<(width-1-nfb));
-		fmax-=1.f/(1ULL<<nfb);
-		fmin=-fmax;
-		break;
-	case EWBF_32F2C:			//2C Signed Fixed point (0x6)
-		checkOF_old=checkOverflow;
-		checkOverflow=false;
-		val=(1ULL<<(width-1));
-		this->regCvt(&val,&data,false);
-		if(this->regCvt(&ftmp,&data,true)) fmin=ftmp;
-		val--;
-		this->regCvt(&val,&data,false);
-		if(this->regCvt(&ftmp,&data,true)) fmax=ftmp;
-		checkOverflow=checkOF_old;
-		break;
-	}
-}
-
-
 /**
  * Generic function to convert an integer value to/from a reg_data
  *
@@ -173,13 +129,14 @@ void EWBField::getLimit(float &fmin, float &fmax)
  */
 bool EWBField::regCvt(uint32_t *value, uint32_t *reg_data, bool to_value) const
 {
+	const EWBFieldLayout &l=layout();
 	if(to_value)
 	{
-		*value=(*reg_data&mask) >> shift;
+		*value=(*reg_data&l.mask) >> l.shift;
 	}
 	else
 	{
-		*reg_data=((*value << shift) & mask) | (*reg_data & ~mask);
+		*reg_data=((*value << l.shift) & l.mask) | (*reg_data & ~l.mask);
 	}
 	return true;
 }
@@ -207,15 +164,16 @@ bool EWBField::regCvt(float *value, uint32_t *reg_data, bool to_value) const
 	bool ret=false;
 	uint32_t fixed, utmp;
 	float ftmp;
+	const EWBFieldLayout &l=layout();
 	if(to_value==false)
 	{
 		if(checkOverflow==false) ftmp=*value;
 		else
 		{
-			if(*value>vmax)
-				ftmp=vmax;
-			else if(*value<vmin)
-				ftmp=vmin;
+			if(*value>l.vmax)
+				ftmp=l.vmax;
+			else if(*value<l.vmin)
+				ftmp=l.vmin;
 			else
 				ftmp=*value;
 		}
@@ -237,7 +195,7 @@ bool EWBField::regCvt(float *value, uint32_t *reg_data, bool to_value) const
 		}
 		break;
 	case EWBF_32I:
-		utmp=(1<<(this->width-1));
+		utmp=(1<<(l.width-1));
 		if(to_value)
 		{
 			ret=this->regCvt(&fixed,reg_data,to_value);
@@ -255,9 +213,9 @@ bool EWBField::regCvt(float *value, uint32_t *reg_data, bool to_value) const
 		if(to_value)
 		{
 			ret=this->regCvt(&fixed,reg_data,to_value);
-			if (fixed & (1 << (this->width-1))) //Negative 2C
+			if (fixed & (1 << (l.width-1))) //Negative 2C
 			{
-				fixed=((~fixed)+1) & (this->mask >> this->shift);
+				fixed=((~fixed)+1) & (l.mask >> l.shift);
 				*value=-1.f*(float)fixed;
 			}
 			else
@@ -274,25 +232,25 @@ bool EWBField::regCvt(float *value, uint32_t *reg_data, bool to_value) const
 		if(to_value)
 		{
 			ret=this->regCvt(&fixed,reg_data,to_value);
-			*value=(float)(fixed/pow(2,this->nfb));
+			*value=(float)(fixed/pow(2,l.nfb));
 		}
 		else
 		{
-			fixed=(uint32_t)(round(ftmp * pow(2,this->nfb)));
+			fixed=(uint32_t)(round(ftmp * pow(2,l.nfb)));
 			ret=this->regCvt(&fixed,reg_data,to_value);
 		}
 		break;
 	case EWBF_32FP: 			//Signed Fixed point conversion
-		utmp=(1<<(this->width-1));
+		utmp=(1<<(l.width-1));
 		if(to_value)
 		{
 			ret=this->regCvt(&fixed,reg_data,to_value);
-			if(fixed & utmp) *value=-1.f*(float)((fixed & ~utmp)/pow(2,this->nfb));
-			else *value=(float)(fixed/pow(2,this->nfb));
+			if(fixed & utmp) *value=-1.f*(float)((fixed & ~utmp)/pow(2,l.nfb));
+			else *value=(float)(fixed/pow(2,l.nfb));
 		}
 		else
 		{
-			fixed=(uint32_t)(round(fabs(ftmp) * pow(2,this->nfb))) & ~utmp;
+			fixed=(uint32_t)(round(fabs(ftmp) * pow(2,l.nfb))) & ~utmp;
 			if(ftmp<0) fixed |=utmp;
 			ret=this->regCvt(&fixed,reg_data,to_value);
 		}
@@ -301,17 +259,17 @@ bool EWBField::regCvt(float *value, uint32_t *reg_data, bool to_value) const
 		if(to_value)
 		{
 			ret=this->regCvt(&fixed,reg_data,to_value);
-			if (fixed & (1 << (this->width-1)))
+			if (fixed & (1 << (l.width-1)))
 			{
-				fixed=((~fixed)+1) & (this->mask >> this->shift) ; //Convert negative 2C to negative Fixed Point
-				*value=(-1.f / (float)(1ULL<<this->nfb)) * (float)fixed; // then to floating
+				fixed=((~fixed)+1) & (l.mask >> l.shift) ; //Convert negative 2C to negative Fixed Point
+				*value=(-1.f / (float)(1ULL<<l.nfb)) * (float)fixed; // then to floating
 			}
 			else
-				*value= (1.f / (float)(1ULL<<this->nfb)) * (float)fixed;			//Convert directly Fixed Point to Floating Point
+				*value= (1.f / (float)(1ULL<<l.nfb)) * (float)fixed;			//Convert directly Fixed Point to Floating Point
 		}
 		else
 		{
-			fixed=round((double)fabs(ftmp) * (double)(1ULL << this->nfb)); //convert to signed fixed point using absolute value
+			fixed=round((double)fabs(ftmp) * (double)(1ULL << l.nfb)); //convert to signed fixed point using absolute value
 			if(ftmp<0) fixed=(~(fixed))+1; 				//convert absolute signed fixed point to 2C fixed point when value <0
 			ret=this->regCvt(&fixed,reg_data,to_value);
 		}
@@ -403,6 +361,9 @@ uint32_t EWBField::getU32() const
  * 		- Reading: Only update the corresponding bit.
  *
  * \note in R/W mode we first perform write so that we can check back the value we have wrote.
+ * \warning It must not be called inside a cycle of the bridge (see EWBBridge::openCycle()):
+ * the value read would only be known at the end of the cycle, so the read-modify-write
+ * can not be performed.
  *
  * \param[in] con A pointer to a valid Memory Connector object.
  * \param[in] amode Access mode (R, W, R/W)
@@ -414,30 +375,45 @@ bool EWBField::sync(EWBSync::AMode amode)
 	uint32_t oldval, value;
 
 	//Perform some check
-	if(!isValid(true)) return false;
-
-	EWBBridge *b=pReg->getPeriph()->getBridge();
+	EWBBridge *b;
+	uint32_t addr;
+	if(pReg==NULL || pReg->resolve(&b,&addr)==false) return false;
+	TRACE_CHECK_VA(b->inCycle()==false,false,"%s: can not sync inside a cycle",getCName());
+	uint64_t t0=(EWBHeatmap::isEnabled())?EWBBridgeStats::now_ns():0;
+	int nreads=0, nwrites=0;
 
 	//first write to dev
 	if(amode & EWB_AM_W)
 	{
-		//Get current value
-		ret &=b->mem_access(pReg->getOffset(true),&oldval,false); //Read EWB from dev
-		value=(pReg->data & mask) | (oldval & ~mask); //Update only our field
-		TRACE_P_DEBUG("%-10s (@0x%08X) ret=%d old=0x%x new=0x%x",getCName(),pReg->getOffset(true),ret,oldval,value);
+		//Get current value (never from the read-ahead window)
+		ret &=b->mem_access(addr,&oldval,false); //Read EWB from dev
+		nreads++;
+		value=(pReg->data & getMask()) | (oldval & ~getMask()); //Update only our field
+		TRACE_P_DEBUG("%-10s (@0x%08X) ret=%d old=0x%x new=0x%x",getCName(),addr,ret,oldval,value);
 		if(oldval != value || forceSync)
 		{
-			ret &=b->mem_access(pReg->getOffset(true),&value,true); //Write EWB to dev
-			TRACE_P_DEBUG("%-10s (@0x%08X) ret=%d value=0x%0x",getCName(),pReg->getOffset(true),ret,value);
+			ret &=b->mem_access(addr,&value,true); //Write EWB to dev
+			nwrites++;
+			TRACE_P_DEBUG("%-10s (@0x%08X) ret=%d value=0x%0x",getCName(),addr,ret,value);
 		}
+		if(nwrites) pReg->getPeriph()->invalidateReadAhead();
+		if(t0) EWBHeatmap::getInstance().recordFieldWrite(pReg,addr,nwrites==0);
 	}
 	//then read from dev
 	if(amode & EWB_AM_R)
 	{
-		ret &=b->mem_access(pReg->getOffset(true),&value,false); //Read EWB from dev
-		pReg->data = (pReg->data & ~mask) | (value & mask); //update only our field
+		if(pReg->getPeriph()->readAhead(pReg,&value)==false)
+		{
+			ret &=b->mem_access(addr,&value,false); //Read EWB from dev
+			nreads++;
+		}
+		pReg->data = (pReg->data & ~getMask()) | (value & getMask()); //update only our field
 	}
 
+	EWBMirror *pMirror=pReg->getPeriph()->getMirror();
+	if(pMirror && ret) pMirror->publish(pReg);
+
+	if(t0) EWBHeatmap::getInstance().record(pReg,addr,nreads,nwrites,EWBBridgeStats::now_ns()-t0);
 	return ret;
 }
 
@@ -464,9 +440,9 @@ bool EWBField::isValid(int level) const
  */
 std::ostream & operator<<(std::ostream & o, const EWBField &f)
 {
-	o << EWBTrace::string_format("0x%08X ",f.mask) << f.name;
+	EWBTrace::stream_format(o,"0x%08X ",f.getMask()) << f.getName();
 	o << " (" << ((f.mode & EWBSync::EWB_AM_R)?"R":"") << ((f.mode & EWBSync::EWB_AM_W)?"W":"") << ")";
 	if(f.type==EWBField::EWBF_32F2C)
-		o << " FixedPoint with 2comp (nfb=" << std::dec << (int)f.nfb << ")";
+		o << " FixedPoint with 2comp (nfb=" << std::dec << (int)f.getNOfFractionBit() << ")";
 	return o;
 }
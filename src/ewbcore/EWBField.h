@@ -67,6 +67,7 @@ public:
 	EWBField(EWBReg *pReg,const std::string &name, uint8_t width, uint8_t shift,
 			uint8_t mode=EWB_AM_RW, const std::string &desc="",
 			uint8_t signess=0, uint8_t nfb=0, int index=-1, double defVal=(1.0/0.0));
+	EWBField(EWBReg *pReg,const EWBFieldLayoutPtr &pLayout);
 
 	virtual ~EWBField();
 
@@ -84,22 +85,18 @@ public:
 
 	bool sync(EWBSync::AMode amode=EWB_AM_RW);
 
-	uint32_t getMask() const { return mask; }				//!< Get the bit mask
-	uint8_t getNOfFractionBit() const { return nfb; }		//!< Get the number of fractional bit (0 for EWBF_32U)
+	uint32_t getMask() const { return layout().mask; }				//!< Get the bit mask
+	uint8_t getNOfFractionBit() const { return layout().nfb; }		//!< Get the number of fractional bit (0 for EWBF_32U)
+	const EWBFieldLayout& layout() const { return *static_cast<const EWBFieldLayout*>(pDesc.get()); }	//!< Get the layout (shared by the instances of a peripheral type)
 	const EWBReg* getReg() const { return pReg; }			//!< Get the linked register (RO)
 	EWBReg* getReg() { return pReg; }						//!< Get the linked register
 	bool isOverflowPrevented() const { return checkOverflow; }	//!< When true prevent overflow during FP conversion \ref regCvt(), \ ref convert()
 	bool isValid(int level=-1) const;
 
 protected:
-	void getLimit(float &fmin, float &fmax);
+	void init(EWBReg *pReg);
 
-	uint32_t mask;		//!< Corresponding mask
-	uint8_t shift;		//!< Number of bit to be shift
-	uint8_t width;		//!< Width of the field
-	uint8_t nfb;		//!< Number of fraction bits
 	bool checkOverflow;	//!< Limit overflow during FP conversion
-	float vmin,vmax;		//!< Range that the user can use for this value
 
 private:
 	EWBReg *pReg; //! parent register which belong this field
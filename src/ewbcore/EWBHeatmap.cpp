@@ -0,0 +1,141 @@
+/*
+ * EWBHeatmap.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBHeatmap.h"
+
+#include "EWBReg.h"
+#include "EWBTrace.h"
+
+#include <algorithm>
+
+std::atomic<bool> EWBHeatmap::enabled(false);
+
+//! Sort the entries from the highest to the lowest bus time
+static bool hotter(const std::pair<uint32_t,EWBHeatmap::Entry> &a, const std::pair<uint32_t,EWBHeatmap::Entry> &b)
+{
+	return a.second.ns > b.second.ns;
+}
+
+/**
+ * Get the entry of an address (must be called with mtx locked)
+ */
+EWBHeatmap::Entry& EWBHeatmap::getOrCreate(const EWBReg *pReg, uint32_t addr)
+{
+	Entry &e=entries[addr];
+	if(e.name.empty() && pReg)
+	{
+		const EWBPeriph *pPrh=pReg->getPrtNode();
+		e.name=(pPrh)?(pPrh->getName()+"."+pReg->getName()):pReg->getName();
+	}
+	return e;
+}
+
+/**
+ * Record the accesses performed on a register
+ *
+ * \param[in] pReg The register (used to name the address)
+ * \param[in] addr The absolute address
+ * \param[in] nreads Number of reads performed
+ * \param[in] nwrites Number of writes performed
+ * \param[in] ns Time spent on the bus in nanoseconds
+ */
+void EWBHeatmap::record(const EWBReg *pReg, uint32_t addr, int nreads, int nwrites, uint64_t ns)
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	Entry &e=getOrCreate(pReg,addr);
+	e.reads+=nreads;
+	e.writes+=nwrites;
+	e.ns+=ns;
+}
+
+/**
+ * Record a write performed by EWBField::sync()
+ *
+ * \param[in] pReg The register of the field
+ * \param[in] addr The absolute address
+ * \param[in] noop true when the register already had the value (no write performed)
+ */
+void EWBHeatmap::recordFieldWrite(const EWBReg *pReg, uint32_t addr, bool noop)
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	Entry &e=getOrCreate(pReg,addr);
+	e.fld_writes++;
+	if(noop) e.fld_noops++;
+}
+
+/**
+ * Remove all the recorded entries
+ */
+void EWBHeatmap::reset()
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	entries.clear();
+}
+
+/**
+ * Return a copy of the entry of an address (empty if never accessed)
+ */
+EWBHeatmap::Entry EWBHeatmap::getEntry(uint32_t addr) const
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	std::map<uint32_t,Entry>::const_iterator ii=entries.find(addr);
+	return (ii!=entries.end())?ii->second:Entry();
+}
+
+/**
+ * Return the registers that have spent the most time on the bus
+ *
+ * \param[in] ntop The maximum number of entries returned
+ * \return a vector of (address,entry) sorted from the hottest
+ */
+std::vector<std::pair<uint32_t,EWBHeatmap::Entry> > EWBHeatmap::getHottest(size_t ntop) const
+{
+	std::vector<std::pair<uint32_t,Entry> > vec;
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		vec.assign(entries.begin(),entries.end());
+	}
+	std::sort(vec.begin(),vec.end(),hotter);
+	if(vec.size()>ntop) vec.resize(ntop);
+	return vec;
+}
+
+/**
+ * Print the hottest registers and the global ratio of no-op field writes
+ *
+ * \param[inout] o the stream that will be modified
+ * \param[in] ntop The number of registers listed
+ */
+void EWBHeatmap::print(std::ostream &o, size_t ntop) const
+{
+	uint64_t reads=0, writes=0, fld_writes=0, fld_noops=0, ns=0;
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		for(std::map<uint32_t,Entry>::const_iterator ii=entries.begin(); ii!=entries.end(); ++ii)
+		{
+			reads+=ii->second.reads;
+			writes+=ii->second.writes;
+			fld_writes+=ii->second.fld_writes;
+			fld_noops+=ii->second.fld_noops;
+			ns+=ii->second.ns;
+		}
+	}
+
+	EWBTrace::stream_format(o,"Heatmap (%s): %llu reads, %llu writes, %.3f ms on bus, %llu/%llu no-op field writes (%.1f%%)\n",
+			(isEnabled())?"enabled":"disabled",(unsigned long long)reads,(unsigned long long)writes,ns/1e6,
+			(unsigned long long)fld_noops,(unsigned long long)fld_writes,(fld_writes)?100.0*fld_noops/fld_writes:0.0);
+
+	std::vector<std::pair<uint32_t,Entry> > vec=getHottest(ntop);
+	EWBTrace::stream_format(o,"  %-10s %-32s %10s %10s %12s %6s %10s\n",
+			"address","register","reads","writes","bus[ms]","bus%","noop-wr");
+	for(size_t i=0;i<vec.size();i++)
+	{
+		const Entry &e=vec[i].second;
+		EWBTrace::stream_format(o,"  0x%08X %-32s %10llu %10llu %12.3f %5.1f%% %4llu/%-5llu\n",
+				vec[i].first,e.name.c_str(),(unsigned long long)e.reads,(unsigned long long)e.writes,
+				e.ns/1e6,(ns)?100.0*e.ns/ns:0.0,(unsigned long long)e.fld_noops,(unsigned long long)e.fld_writes);
+	}
+}
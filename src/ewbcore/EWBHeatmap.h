@@ -0,0 +1,70 @@
+/*
+ * EWBHeatmap.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef EWBHEATMAP_H_
+#define EWBHEATMAP_H_
+
+#include <stdint.h>
+#include <map>
+#include <vector>
+#include <string>
+#include <iostream>
+#include <mutex>
+#include <atomic>
+
+class EWBReg;
+
+/**
+ * Singleton that counts the accesses of each register (heatmap)
+ *
+ * When enabled, EWBReg::sync() and EWBField::sync() record for each absolute
+ * address the number of reads/writes and the cumulated time spent on the bus.
+ * The field writes that did not change the register (same value read from
+ * the device) are also counted as no-op.
+ *
+ * This tells which registers are worth to be block-scanned or cached.
+ * When disabled (default) the cost is a single branch per sync.
+ */
+class EWBHeatmap {
+public:
+	//! Statistics of an address
+	struct Entry {
+		std::string name;		//!< Name of the register
+		uint64_t reads;			//!< Number of reads from the device
+		uint64_t writes;		//!< Number of writes to the device
+		uint64_t fld_writes;	//!< Number of EWBField::sync() in write mode
+		uint64_t fld_noops;		//!< Number of field writes where the register was not modified
+		uint64_t ns;			//!< Cumulated time on the bus in nanoseconds
+		Entry(): reads(0), writes(0), fld_writes(0), fld_noops(0), ns(0) {};
+	};
+
+	static EWBHeatmap& getInstance()
+	{
+		static EWBHeatmap    instance; // Guaranteed to be destroyed.
+		return instance;
+	}
+
+	static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }		//!< Return true when the accesses are recorded
+	static void setEnabled(bool val=true) { enabled.store(val,std::memory_order_relaxed); }	//!< Enable or disable the recording
+
+	void record(const EWBReg *pReg, uint32_t addr, int nreads, int nwrites, uint64_t ns);
+	void recordFieldWrite(const EWBReg *pReg, uint32_t addr, bool noop);
+	void reset();
+
+	std::vector<std::pair<uint32_t,Entry> > getHottest(size_t ntop) const;
+	Entry getEntry(uint32_t addr) const;
+	void print(std::ostream &o, size_t ntop=20) const;
+
+private:
+	EWBHeatmap() {};                   // Forbidden Constructor
+	Entry& getOrCreate(const EWBReg *pReg, uint32_t addr);
+
+	static std::atomic<bool> enabled;	//!< Toggled by the IOC shell while read by all the syncs
+	std::map<uint32_t,Entry> entries;
+	mutable std::mutex mtx;
+};
+
+#endif /* EWBHEATMAP_H_ */
@@ -0,0 +1,191 @@
+/*
+ * EWBLayout.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBLayout.h"
+
+#include "EWBPeriph.h"
+#include "EWBReg.h"
+#include "EWBField.h"
+#include "EWBTrace.h"
+
+#include <map>
+#include <mutex>
+
+namespace {
+
+//! The layouts registered by type
+struct Registry {
+	std::mutex mtx;
+	std::map<std::string,EWBLayoutPtr> layouts;
+};
+
+//! Return the registry (created at its first use so that the static layouts can use it)
+Registry& registry()
+{
+	static Registry r;
+	return r;
+}
+
+} // namespace
+
+/**
+ * Constructor of a field layout
+ *
+ * The mask, the type and the range are computed once for all the instances.
+ *
+ * \see EWBField::EWBField() for the parameters.
+ */
+EWBFieldLayout::EWBFieldLayout(const std::string &name, uint8_t width, uint8_t shift,
+		uint8_t mode, const std::string &desc, uint8_t signess, uint8_t nfb, int index, double iniVal)
+: EWBParamDesc(name,desc), shift(shift), width(width), nfb(nfb), type(EWBParam::EWBF_TM_TYPE_FIELD), mode(mode), index(index), iniVal(iniVal)
+{
+	if((width+shift)>32) TRACE_P_WARNING("width (%d) + shift (%d) <= 32 bits",width,shift);
+	if((width >= nfb)==false)
+		TRACE_P_WARNING("%s Width (%d) must be superior or equal than nbfp (%d)",name.c_str(),width,nfb);
+
+	this->type |=(signess & EWBParam::EWBF_TM_SIGNESS);
+	if(nfb>0) this->type|=EWBParam::EWBF_TM_FIXED_POINT;
+	this->mask = (((1ULL<<width)-1) << shift);
+
+	switch(type)
+	{
+	case EWBParam::EWBF_32U:				//Unsigned integer
+		vmin=0.f;
+		vmax=(float)((1ULL<<width)-1);
+		if(width>30) vmax=(float)((1ULL<<30)-1);
+		break;
+	case EWBParam::EWBF_32I:				//MSB Signed Integer
+		vmin=-((float)(1ULL<<(width-1))-1);
+		vmax=(float)(1ULL<<(width-1))-1;
+		break;
+	case EWBParam::EWBF_32I2C:	//2C Signed Integer
+		vmin=-(float)(1ULL<<(width-1));
+		vmax=(float)(1ULL<<(width-1))-1;
+		break;
+	case EWBParam::EWBF_32FPU: 	//Unsigned Fixed Point
+		vmin=0;
+		vmax=(float)(1ULL<<(width-nfb));
+		vmax-=1.f/(1ULL<<nfb);
+		break;
+	case EWBParam::EWBF_32FP: 			//MSB Signed Fixed point (0x5)
+		vmax=(float)(1ULL<<(width-1-nfb));
+		vmax-=1.f/(1ULL<<nfb);
+		vmin=-vmax;
+		break;
+	case EWBParam::EWBF_32F2C:			//2C Signed Fixed point (0x6)
+		vmin=(-1.f / (float)(1ULL<<nfb)) * (float)(1ULL<<(width-1));
+		vmax=(1.f / (float)(1ULL<<nfb)) * (float)((1ULL<<(width-1))-1);
+		break;
+	default:
+		vmin=vmax=0;
+		break;
+	}
+}
+
+/**
+ * Constructor of an empty layout
+ *
+ * \param[in] type The type of the peripheral (i.e. the prefix of its wbgen2 header).
+ */
+EWBLayout::EWBLayout(const std::string &type)
+: type(type), sealed(false), ninstances(0)
+{
+
+}
+
+/**
+ * Append a register to the layout
+ *
+ * \see EWBReg::EWBReg() for the parameters.
+ * \return false if the layout has already been instantiated or the offset is already used.
+ */
+bool EWBLayout::addReg(const std::string &name, uint32_t offset, int nfields, const std::string &desc)
+{
+	TRACE_CHECK_VA(sealed==false,false,"%s: layout already instantiated",type.c_str());
+	for(size_t i=0;i<regs.size();i++)
+	{
+		TRACE_CHECK_VA(regs[i]->offset!=offset,false,"%s: offset 0x%x of %s is already used by %s",
+				type.c_str(),offset,name.c_str(),regs[i]->name.c_str());
+	}
+	pLast=std::make_shared<EWBRegLayout>(name,offset,nfields,desc);
+	regs.push_back(pLast);
+	return true;
+}
+
+/**
+ * Append a field to the last register added
+ *
+ * \see EWBField::EWBField() for the parameters.
+ * \return false if the layout has already been instantiated, there is no register or the mask is already used.
+ */
+bool EWBLayout::addField(const std::string &name, uint8_t width, uint8_t shift,
+		uint8_t mode, const std::string &desc, uint8_t signess, uint8_t nfb, int index, double iniVal)
+{
+	TRACE_CHECK_VA(sealed==false,false,"%s: layout already instantiated",type.c_str());
+	TRACE_CHECK_VA(pLast,false,"%s: no register for %s",type.c_str(),name.c_str());
+
+	EWBFieldLayoutPtr pFld=std::make_shared<EWBFieldLayout>(name,width,shift,mode,desc,signess,nfb,index,iniVal);
+	for(size_t i=0;i<pLast->fields.size();i++)
+	{
+		TRACE_CHECK_VA((pLast->fields[i]->mask & pFld->mask)==0,false,"%s: mask of %s is already used in %s",
+				type.c_str(),name.c_str(),pLast->name.c_str());
+	}
+	pLast->fields.push_back(pFld);
+	return true;
+}
+
+/**
+ * Create the registers and fields of a peripheral from the layout
+ *
+ * The created objects share the layout: only their offset and their data
+ * belong to the instance.
+ *
+ * \param[in] pPrh The peripheral (without registers).
+ * \return false if one of the registers or fields could not be added.
+ */
+bool EWBLayout::instantiate(EWBPeriph *pPrh)
+{
+	TRACE_CHECK_PTR(pPrh,false);
+	bool ret=true;
+	sealed=true;
+	for(size_t i=0;i<regs.size();i++)
+	{
+		EWBReg *pReg=new EWBReg(pPrh,regs[i]);
+		if(pReg->getPrtNode()==NULL)
+		{
+			delete pReg;
+			ret=false;
+			continue;
+		}
+		for(size_t j=0;j<regs[i]->fields.size();j++)
+		{
+			EWBField *pFld=new EWBField(pReg,regs[i]->fields[j]);
+			if(pFld->getReg()==NULL)
+			{
+				delete pFld;
+				ret=false;
+			}
+		}
+	}
+	ninstances++;
+	if(ret==false) TRACE_P_WARNING("%s: %s not fully instantiated",type.c_str(),pPrh->getCName());
+	return ret;
+}
+
+/**
+ * Get the layout of a peripheral type (created empty the first time)
+ *
+ * \param[in] type The type of the peripheral.
+ * \return the layout shared by all the peripherals of this type.
+ */
+EWBLayoutPtr EWBLayout::get(const std::string &type)
+{
+	Registry &r=registry();
+	std::lock_guard<std::mutex> lock(r.mtx);
+	EWBLayoutPtr &pL=r.layouts[type];
+	if(!pL) pL=std::make_shared<EWBLayout>(type);
+	return pL;
+}
@@ -0,0 +1,103 @@
+/*
+ * EWBLayout.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef EWBLAYOUT_H_
+#define EWBLAYOUT_H_
+
+#include "EWBParam.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+class EWBPeriph;
+
+/**
+ * Immutable description of a field shared by all its instances
+ */
+struct EWBFieldLayout: public EWBParamDesc {
+	EWBFieldLayout(const std::string &name, uint8_t width, uint8_t shift,
+			uint8_t mode=EWBSync::EWB_AM_RW, const std::string &desc="",
+			uint8_t signess=0, uint8_t nfb=0, int index=-1, double iniVal=(1.0/0.0));
+
+	uint32_t mask;		//!< Corresponding mask
+	uint8_t shift;		//!< Number of bit to be shift
+	uint8_t width;		//!< Width of the field
+	uint8_t nfb;		//!< Number of fraction bits
+	uint8_t type;		//!< Type of data (see EWBParam::Type)
+	uint8_t mode;		//!< Access mode (see EWBSync::AMode)
+	int index;			//!< Index of the field in the register (-1: appended)
+	double iniVal;		//!< Value at creation (inf: keep 0)
+	float vmin,vmax;	//!< Range that the user can use for this value
+};
+
+typedef std::shared_ptr<const EWBFieldLayout> EWBFieldLayoutPtr;	//!< Shared field layout
+
+/**
+ * Immutable description of a register (and its fields) shared by all its instances
+ */
+struct EWBRegLayout: public EWBParamDesc {
+	EWBRegLayout(const std::string &name, uint32_t offset, int nfields=-1, const std::string &desc="")
+	: EWBParamDesc(name,desc), offset(offset), nfields(nfields) {};
+
+	uint32_t offset;		//!< The offset relative to the peripheral
+	int nfields;			//!< The number of field defined (-1: not fixed)
+	std::vector<EWBFieldLayoutPtr> fields;	//!< The fields of the register
+};
+
+typedef std::shared_ptr<const EWBRegLayout> EWBRegLayoutPtr;	//!< Shared register layout
+
+/**
+ * Layout of the registers of a peripheral type shared by all its instances (flyweight)
+ *
+ * A board often instantiates the same peripheral (same wbgen2 header) many times
+ * at different offsets. Its layout is described once, then each instance only holds
+ * its offset and the data of its registers: the names, descriptions, masks and
+ * limits are shared.
+ *
+ * \code
+ * EWBLayoutPtr pL=EWBLayout::get("adc_chan");
+ * if(pL->isEmpty())
+ * {
+ * 	pL->addReg(WB2_REG_ARGS(ADC,CTRL));
+ * 	pL->addField(WB2_FIELD_ARGS(ADC,CTRL,EN));
+ * }
+ * for(int i=0;i<nchans;i++) pL->instantiate(new EWBPeriph(pBus,"chan",0x1000*i,venID,devID));
+ * \endcode
+ *
+ * \note The layout can not be modified anymore once it has been instantiated.
+ */
+class EWBLayout {
+public:
+	EWBLayout(const std::string &type);
+	virtual ~EWBLayout() {};
+
+	bool addReg(const std::string &name, uint32_t offset, int nfields=-1, const std::string &desc="");
+	bool addField(const std::string &name, uint8_t width, uint8_t shift,
+			uint8_t mode=EWBSync::EWB_AM_RW, const std::string &desc="",
+			uint8_t signess=0, uint8_t nfb=0, int index=-1, double iniVal=(1.0/0.0));
+	bool instantiate(EWBPeriph *pPrh);
+
+	const std::string& getType() const { return type; }				//!< Get the peripheral type
+	const std::vector<EWBRegLayoutPtr>& getRegs() const { return regs; }	//!< Get the registers
+	bool isEmpty() const { return regs.empty(); }					//!< Return true when no register has been added
+	bool isSealed() const { return sealed; }						//!< Return true once it has been instantiated
+	size_t getNInstances() const { return ninstances; }				//!< Number of peripherals using the layout
+
+	static std::shared_ptr<EWBLayout> get(const std::string &type);
+
+private:
+	std::string type;
+	std::vector<EWBRegLayoutPtr> regs;
+	std::shared_ptr<EWBRegLayout> pLast;	//!< The register where the fields are added
+	std::atomic<bool> sealed;			//!< Set by the first instantiate() (of any thread)
+	std::atomic<size_t> ninstances;
+};
+
+typedef std::shared_ptr<EWBLayout> EWBLayoutPtr;	//!< Layout registered by type
+
+#endif /* EWBLAYOUT_H_ */
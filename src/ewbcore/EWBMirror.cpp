@@ -0,0 +1,391 @@
+/*
+ * EWBMirror.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBMirror.h"
+
+#include "EWBBus.h"
+#include "EWBPeriph.h"
+#include "EWBReg.h"
+#include "EWBTrace.h"
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define EWB_MIRROR_ALIGN 64	//!< Each slot starts on its own cache line
+
+//! Return the name with the leading '/' required by shm_open()
+static std::string shmName(const std::string &name)
+{
+	return (name.size()>0 && name[0]=='/')?name:"/"+name;
+}
+
+//! Copy a name in a descriptor
+static void setName(char *dst, const std::string &src)
+{
+	strncpy(dst,src.c_str(),EWB_MIRROR_NAMELEN-1);
+	dst[EWB_MIRROR_NAMELEN-1]='\0';
+}
+
+/**
+ * Constructor that creates the shared memory from the tree of a bus
+ *
+ * \param[in] pRoot The bus (and its sub-buses) to publish.
+ * \param[in] name The name of the POSIX shared memory (i.e. "/ewb_myioc").
+ */
+EWBMirror::EWBMirror(EWBBus *pRoot, const std::string &name)
+: name(shmName(name)), pBase(NULL), size(0)
+{
+	TRACE_CHECK_PTR(pRoot,);
+
+	//First obtain the static layout
+	std::vector<EWBPeriph*> periphs;
+	std::vector<EWBBus*> stack(1,pRoot);
+	while(stack.size()>0)
+	{
+		EWBBus *pBus=stack.back();
+		stack.pop_back();
+		periphs.insert(periphs.end(),pBus->getPeripherals().begin(),pBus->getPeripherals().end());
+		stack.insert(stack.end(),pBus->getChildren().rbegin(),pBus->getChildren().rend());
+	}
+
+	std::vector<std::vector<EWBReg*> > regs(periphs.size());
+	uint32_t nregs=0;
+	for(size_t i=0;i<periphs.size();i++)
+	{
+		EWBReg *pReg=NULL;
+		if(periphs[i]->getLastReg()==NULL) continue;
+		while((pReg=periphs[i]->getNextReg(pReg))!=NULL) regs[i].push_back(pReg);
+		nregs+=regs[i].size();
+	}
+
+	uint32_t periph_off=sizeof(EWBMirrorHdr);
+	uint32_t reg_off=periph_off+periphs.size()*sizeof(EWBMirrorPeriph);
+	uint32_t slot_off=(reg_off+nregs*sizeof(EWBMirrorReg)+EWB_MIRROR_ALIGN-1) & ~(EWB_MIRROR_ALIGN-1);
+	size=slot_off;
+	for(size_t i=0;i<periphs.size();i++)
+	{
+		size+=(offsetof(EWBMirrorSlot,data)+regs[i].size()*sizeof(uint32_t)+EWB_MIRROR_ALIGN-1) & ~(EWB_MIRROR_ALIGN-1);
+	}
+
+	//Then create the shared memory
+	int fd=shm_open(this->name.c_str(),O_CREAT | O_RDWR | O_TRUNC,0644);
+	TRACE_CHECK_VA(fd>=0,,"Can not create %s (%s)",this->name.c_str(),strerror(errno));
+	if(ftruncate(fd,size)==0)
+	{
+		void *p=mmap(NULL,size,PROT_READ | PROT_WRITE,MAP_SHARED,fd,0);
+		if(p!=MAP_FAILED) pBase=(uint8_t*)p;
+	}
+	close(fd);
+	if(pBase==NULL)
+	{
+		TRACE_P_ERROR("Can not map %s (%s)",this->name.c_str(),strerror(errno));
+		shm_unlink(this->name.c_str());
+		return;
+	}
+
+	//Finally write the descriptors
+	EWBMirrorPeriph *pDP=(EWBMirrorPeriph*)(pBase+periph_off);
+	EWBMirrorReg *pDR=(EWBMirrorReg*)(pBase+reg_off);
+	uint32_t ireg=0;
+	for(size_t i=0;i<periphs.size();i++)
+	{
+		setName(pDP[i].name,periphs[i]->getName());
+		pDP[i].addr=periphs[i]->getOffset(true);
+		pDP[i].first_reg=ireg;
+		pDP[i].nregs=regs[i].size();
+		pDP[i].slot_off=slot_off;
+
+		EWBMirrorSlot *pSlot=(EWBMirrorSlot*)(pBase+slot_off);
+		slots[periphs[i]]=pSlot;
+		for(size_t j=0;j<regs[i].size();j++,ireg++)
+		{
+			setName(pDR[ireg].name,regs[i][j]->getName());
+			pDR[ireg].addr=regs[i][j]->getOffset(true);
+			pDR[ireg].periph=i;
+			pSlot->data[j]=regs[i][j]->getData();
+			Loc loc={ pSlot, (uint32_t)j };
+			locs[regs[i][j]]=loc;
+		}
+		slot_off+=(offsetof(EWBMirrorSlot,data)+regs[i].size()*sizeof(uint32_t)+EWB_MIRROR_ALIGN-1) & ~(EWB_MIRROR_ALIGN-1);
+	}
+
+	EWBMirrorHdr *pHdr=(EWBMirrorHdr*)pBase;
+	pHdr->version=EWB_MIRROR_VER;
+	pHdr->size=size;
+	pHdr->nperiphs=periphs.size();
+	pHdr->nregs=nregs;
+	pHdr->periph_off=periph_off;
+	pHdr->reg_off=reg_off;
+	pHdr->pid=getpid();
+	//The magic tells the readers that the layout is complete
+	__atomic_store_n(&pHdr->magic,EWB_MIRROR_MAGIC,__ATOMIC_RELEASE);
+
+	TRACE_P_INFO("%s: %d peripherals, %d registers (%d bytes)",this->name.c_str(),(int)periphs.size(),nregs,size);
+}
+
+/**
+ * Destructor that removes the shared memory
+ */
+EWBMirror::~EWBMirror()
+{
+	if(pBase)
+	{
+		munmap(pBase,size);
+		shm_unlink(name.c_str());
+	}
+}
+
+/**
+ * Start an update of a slot (the sequence becomes odd)
+ */
+void EWBMirror::begin(EWBMirrorSlot *pSlot)
+{
+	__atomic_store_n(&pSlot->seq,pSlot->seq+1,__ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+/**
+ * End an update of a slot (the sequence becomes even)
+ */
+void EWBMirror::end(EWBMirrorSlot *pSlot)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME,&ts);
+	__atomic_store_n(&pSlot->stamp_ns,(uint64_t)ts.tv_sec*1000000000ULL+ts.tv_nsec,__ATOMIC_RELAXED);
+	__atomic_store_n(&pSlot->nupdates,pSlot->nupdates+1,__ATOMIC_RELAXED);
+	__atomic_store_n(&pSlot->seq,pSlot->seq+1,__ATOMIC_RELEASE);
+}
+
+/**
+ * Publish the value of all the registers of a peripheral
+ *
+ * Only the registers that existed when the mirror was created are published.
+ *
+ * \return false if the peripheral is not part of the mirror.
+ */
+bool EWBMirror::publish(const EWBPeriph *pPrh)
+{
+	std::map<const EWBPeriph*,EWBMirrorSlot*>::iterator ii=slots.find(pPrh);
+	if(ii==slots.end()) return false;
+
+	EWBMirrorSlot *pSlot=ii->second;
+	EWBReg *pReg=NULL;
+	std::lock_guard<std::mutex> lock(mtx);
+	begin(pSlot);
+	//The layout is static: the registers appended after the creation are skipped
+	if(pPrh->getLastReg())
+	{
+		while((pReg=const_cast<EWBPeriph*>(pPrh)->getNextReg(pReg))!=NULL)
+		{
+			std::map<const EWBReg*,Loc>::iterator jj=locs.find(pReg);
+			if(jj==locs.end()) continue;
+			__atomic_store_n(&pSlot->data[jj->second.index],pReg->getData(),__ATOMIC_RELAXED);
+		}
+	}
+	end(pSlot);
+	return true;
+}
+
+/**
+ * Publish the value of a register
+ *
+ * \return false if the register is not part of the mirror.
+ */
+bool EWBMirror::publish(const EWBReg *pReg)
+{
+	std::map<const EWBReg*,Loc>::iterator ii=locs.find(pReg);
+	if(ii==locs.end()) return false;
+
+	std::lock_guard<std::mutex> lock(mtx);
+	begin(ii->second.pSlot);
+	__atomic_store_n(&ii->second.pSlot->data[ii->second.index],pReg->getData(),__ATOMIC_RELAXED);
+	end(ii->second.pSlot);
+	return true;
+}
+
+/**
+ * Publish the value of all the registers (without accessing the device)
+ */
+void EWBMirror::publishAll()
+{
+	for(std::map<const EWBPeriph*,EWBMirrorSlot*>::iterator ii=slots.begin();ii!=slots.end();++ii)
+	{
+		publish(ii->first);
+	}
+}
+
+
+/**
+ * Constructor that maps an existing mirror in read-only
+ *
+ * \param[in] name The name of the POSIX shared memory.
+ */
+EWBMirrorReader::EWBMirrorReader(const std::string &name)
+: pHdr(NULL), size(0)
+{
+	std::string sname=shmName(name);
+	int fd=shm_open(sname.c_str(),O_RDONLY,0);
+	TRACE_CHECK_VA(fd>=0,,"Can not open %s (%s)",sname.c_str(),strerror(errno));
+
+	struct stat st;
+	if(fstat(fd,&st)==0 && st.st_size>=(off_t)sizeof(EWBMirrorHdr))
+	{
+		void *p=mmap(NULL,st.st_size,PROT_READ,MAP_SHARED,fd,0);
+		if(p!=MAP_FAILED)
+		{
+			pHdr=(const EWBMirrorHdr*)p;
+			size=st.st_size;
+		}
+	}
+	close(fd);
+	TRACE_CHECK_VA(pHdr,,"Can not map %s",sname.c_str());
+
+	if(__atomic_load_n(&pHdr->magic,__ATOMIC_ACQUIRE)!=EWB_MIRROR_MAGIC || pHdr->version!=EWB_MIRROR_VER || pHdr->size>size)
+	{
+		TRACE_P_WARNING("%s: bad magic 0x%08x or version %d",sname.c_str(),pHdr->magic,pHdr->version);
+		munmap((void*)pHdr,size);
+		pHdr=NULL;
+	}
+}
+
+EWBMirrorReader::~EWBMirrorReader()
+{
+	if(pHdr) munmap((void*)pHdr,size);
+}
+
+/**
+ * Get the descriptor of a peripheral
+ */
+const EWBMirrorPeriph* EWBMirrorReader::getPeriph(uint32_t index) const
+{
+	if(index>=getNPeriphs()) return NULL;
+	return (const EWBMirrorPeriph*)((const uint8_t*)pHdr+pHdr->periph_off)+index;
+}
+
+/**
+ * Get the descriptor of a register
+ */
+const EWBMirrorReg* EWBMirrorReader::getReg(uint32_t index) const
+{
+	if(index>=getNRegs()) return NULL;
+	return (const EWBMirrorReg*)((const uint8_t*)pHdr+pHdr->reg_off)+index;
+}
+
+/**
+ * Get the slot of a peripheral
+ */
+const EWBMirrorSlot* EWBMirrorReader::getSlot(uint32_t periph) const
+{
+	const EWBMirrorPeriph *pDP=getPeriph(periph);
+	return (pDP)?(const EWBMirrorSlot*)((const uint8_t*)pHdr+pDP->slot_off):NULL;
+}
+
+/**
+ * Find a peripheral by its name
+ *
+ * \return the index of the peripheral or -1 if not found.
+ */
+int EWBMirrorReader::findPeriph(const std::string &name) const
+{
+	for(uint32_t i=0;i<getNPeriphs();i++)
+	{
+		if(name.compare(0,EWB_MIRROR_NAMELEN-1,getPeriph(i)->name)==0) return i;
+	}
+	return -1;
+}
+
+/**
+ * Find a register by its name and the name of its peripheral
+ *
+ * \return the index of the register or -1 if not found.
+ */
+int EWBMirrorReader::findReg(const std::string &periph, const std::string &reg) const
+{
+	int p=findPeriph(periph);
+	if(p<0) return -1;
+	const EWBMirrorPeriph *pDP=getPeriph(p);
+	for(uint32_t i=pDP->first_reg;i<pDP->first_reg+pDP->nregs;i++)
+	{
+		if(reg.compare(0,EWB_MIRROR_NAMELEN-1,getReg(i)->name)==0) return i;
+	}
+	return -1;
+}
+
+/**
+ * Read a consistent snapshot of the registers of a peripheral
+ *
+ * \param[in] periph The index of the peripheral.
+ * \param[out] values Where the values are copied.
+ * \param[in] nvalues The maximum number of values to copy.
+ * \param[out] stamp_ns Time of the last update (optional).
+ * \return the number of values copied or -1 on error (or when the slot
+ * stays locked by a writer, see \ref EWB_MIRROR_MAXRETRIES).
+ */
+int EWBMirrorReader::read(uint32_t periph, uint32_t *values, uint32_t nvalues, uint64_t *stamp_ns) const
+{
+	const EWBMirrorSlot *pSlot=getSlot(periph);
+	TRACE_CHECK_PTR(pSlot,-1);
+	uint32_t n=std::min(nvalues,getPeriph(periph)->nregs);
+
+	for(int retry=0;retry<EWB_MIRROR_MAXRETRIES;retry++)
+	{
+		uint32_t s1=__atomic_load_n(&pSlot->seq,__ATOMIC_ACQUIRE);
+		if((s1 & 1)==0)
+		{
+			for(uint32_t i=0;i<n;i++) values[i]=__atomic_load_n(&pSlot->data[i],__ATOMIC_RELAXED);
+			uint64_t stamp=__atomic_load_n(&pSlot->stamp_ns,__ATOMIC_RELAXED);
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+			if(__atomic_load_n(&pSlot->seq,__ATOMIC_RELAXED)==s1)
+			{
+				if(stamp_ns) *stamp_ns=stamp;
+				return n;
+			}
+		}
+		//Let the writer finish when it has been preempted
+		if(retry>100) sched_yield();
+	}
+	TRACE_P_WARNING("%s: slot locked by a writer",getPeriph(periph)->name);
+	return -1;
+}
+
+/**
+ * Read the value of a single register
+ *
+ * \param[in] reg The index of the register.
+ * \param[out] value The value of the register.
+ * \return true if the register exists and has been read.
+ */
+bool EWBMirrorReader::readReg(uint32_t reg, uint32_t *value) const
+{
+	const EWBMirrorReg *pDR=getReg(reg);
+	TRACE_CHECK_PTR(pDR,false);
+	TRACE_CHECK_PTR(value,false);
+	const EWBMirrorSlot *pSlot=getSlot(pDR->periph);
+	uint32_t index=reg-getPeriph(pDR->periph)->first_reg;
+
+	for(int retry=0;retry<EWB_MIRROR_MAXRETRIES;retry++)
+	{
+		uint32_t s1=__atomic_load_n(&pSlot->seq,__ATOMIC_ACQUIRE);
+		if((s1 & 1)==0)
+		{
+			*value=__atomic_load_n(&pSlot->data[index],__ATOMIC_RELAXED);
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+			if(__atomic_load_n(&pSlot->seq,__ATOMIC_RELAXED)==s1) return true;
+		}
+		if(retry>100) sched_yield();
+	}
+	TRACE_P_WARNING("%s: slot locked by a writer",pDR->name);
+	return false;
+}
@@ -0,0 +1,149 @@
+/*
+ * EWBMirror.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef EWBMIRROR_H_
+#define EWBMIRROR_H_
+
+#include <stdint.h>
+#include <string>
+#include <map>
+#include <mutex>
+
+class EWBBus;
+class EWBPeriph;
+class EWBReg;
+
+#define EWB_MIRROR_MAGIC	0x4D425745	//!< "EWBM"
+#define EWB_MIRROR_VER		1			//!< Version of the layout
+#define EWB_MIRROR_NAMELEN	32			//!< Maximum size of a name (including '\0')
+#define EWB_MIRROR_MAXRETRIES	10000	//!< Maximum number of tries of a reader on a slot being updated
+
+/**
+ * Header at the beginning of the shared-memory segment.
+ *
+ * The segment is composed of:
+ * 		- the header
+ * 		- nperiphs EWBMirrorPeriph descriptors (at periph_off)
+ * 		- nregs EWBMirrorReg descriptors (at reg_off)
+ * 		- one EWBMirrorSlot per peripheral (at EWBMirrorPeriph::slot_off)
+ *
+ * The descriptors are written once when the segment is created and
+ * never change afterward (static layout).
+ */
+struct EWBMirrorHdr {
+	uint32_t magic;		//!< \ref EWB_MIRROR_MAGIC
+	uint32_t version;	//!< \ref EWB_MIRROR_VER
+	uint32_t size;		//!< Size of the segment (bytes)
+	uint32_t nperiphs;	//!< Number of peripherals
+	uint32_t nregs;		//!< Number of registers
+	uint32_t periph_off;	//!< Offset of the peripheral descriptors (bytes)
+	uint32_t reg_off;		//!< Offset of the register descriptors (bytes)
+	uint32_t pid;		//!< Process that publishes the values
+};
+
+//! Descriptor of a peripheral
+struct EWBMirrorPeriph {
+	char name[EWB_MIRROR_NAMELEN];	//!< Name of the peripheral
+	uint32_t addr;		//!< Absolute address on the wishbone bus
+	uint32_t first_reg;	//!< Index of its first EWBMirrorReg
+	uint32_t nregs;		//!< Number of registers
+	uint32_t slot_off;	//!< Offset of its EWBMirrorSlot (bytes)
+};
+
+//! Descriptor of a register
+struct EWBMirrorReg {
+	char name[EWB_MIRROR_NAMELEN];	//!< Name of the register
+	uint32_t addr;		//!< Absolute address on the wishbone bus
+	uint32_t periph;	//!< Index of its EWBMirrorPeriph
+};
+
+/**
+ * Values of the registers of a peripheral protected by a seqlock
+ *
+ * The sequence is odd while the values are updated: a reader must
+ * retry when it reads an odd sequence or when the sequence has changed
+ * after reading the values. It gives up after \ref EWB_MIRROR_MAXRETRIES
+ * tries (i.e. the writer died during an update).
+ */
+struct EWBMirrorSlot {
+	uint32_t seq;		//!< Sequence of the seqlock
+	uint32_t nupdates;	//!< Number of updates (wraps)
+	uint64_t stamp_ns;	//!< Time of the last update (CLOCK_REALTIME)
+	uint32_t data[1];	//!< Values of the registers (nregs words)
+};
+
+
+/**
+ * Publish the value of the registers of a bus into a POSIX shared-memory
+ *
+ * When a mirror is attached to a bus (EWBBus::setMirror()) each sync of a
+ * register or a peripheral publishes the latest EWBReg::data in the shared
+ * memory. The external processes (monitoring tools, archivers) can then
+ * read them using EWBMirrorReader without any access to the bus.
+ *
+ * The layout is built from the tree when the mirror is created: the
+ * peripherals or registers added afterward are not published.
+ */
+class EWBMirror {
+public:
+	EWBMirror(EWBBus *pRoot, const std::string &name);
+	virtual ~EWBMirror();
+
+	bool isValid() const { return pBase!=NULL; }
+	const std::string& getName() const { return name; }		//!< Name of the shared memory
+	uint32_t getSize() const { return size; }					//!< Size of the shared memory (bytes)
+
+	bool publish(const EWBPeriph *pPrh);
+	bool publish(const EWBReg *pReg);
+	void publishAll();
+
+private:
+	//! Where a register is stored
+	struct Loc {
+		EWBMirrorSlot *pSlot;
+		uint32_t index;
+	};
+
+	void begin(EWBMirrorSlot *pSlot);
+	void end(EWBMirrorSlot *pSlot);
+
+	std::string name;	//!< Name of the shared memory
+	uint8_t *pBase;		//!< Mapped segment
+	uint32_t size;		//!< Size of the segment (bytes)
+	std::map<const EWBPeriph*,EWBMirrorSlot*> slots;
+	std::map<const EWBReg*,Loc> locs;
+	std::mutex mtx;		//!< Serialize the writers of this process
+};
+
+
+/**
+ * Read the values published by an EWBMirror (in another process)
+ */
+class EWBMirrorReader {
+public:
+	EWBMirrorReader(const std::string &name);
+	virtual ~EWBMirrorReader();
+
+	bool isValid() const { return pHdr!=NULL; }
+	uint32_t getNPeriphs() const { return (pHdr)?pHdr->nperiphs:0; }
+	uint32_t getNRegs() const { return (pHdr)?pHdr->nregs:0; }
+	const EWBMirrorPeriph* getPeriph(uint32_t index) const;
+	const EWBMirrorReg* getReg(uint32_t index) const;
+
+	int findPeriph(const std::string &name) const;
+	int findReg(const std::string &periph, const std::string &reg) const;
+
+	int read(uint32_t periph, uint32_t *values, uint32_t nvalues, uint64_t *stamp_ns=NULL) const;
+	bool readReg(uint32_t reg, uint32_t *value) const;
+
+private:
+	const EWBMirrorSlot* getSlot(uint32_t periph) const;
+
+	const EWBMirrorHdr *pHdr;	//!< Mapped segment (read-only)
+	uint32_t size;				//!< Size of the mapping (bytes)
+};
+
+#endif /* EWBMIRROR_H_ */
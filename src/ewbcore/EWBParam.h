@@ -9,12 +9,29 @@
 #define EWBPARAM_H_
 
 #include "EWBSync.h"
+#include "EWBString.h"
 
 #include <string>
+#include <memory>
 
 class EWBField; //!< Forward declaration
 class EWBParamStr; //!< Forward declaration
 
+/**
+ * Name and description of a parameter
+ *
+ * It is shared by all the instances created from the same layout (see EWBLayout).
+ */
+struct EWBParamDesc {
+	EWBParamDesc(const std::string &name, const std::string &desc=""): name(name), desc(desc) {};
+	virtual ~EWBParamDesc() {};
+
+	EWBString name;	//!< Name (interned)
+	EWBString desc;	//!< Description (interned)
+};
+
+typedef std::shared_ptr<const EWBParamDesc> EWBParamDescPtr;	//!< Shared (immutable) name and description
+
 
 /**
  * Generic class that represent a parameter that need to
@@ -23,7 +40,8 @@ class EWBParamStr; //!< Forward declaration
  */
 class EWBParam: public EWBSync {
 public:
-	EWBParam(std::string name, uint8_t type, uint8_t mode, std::string desc=""): EWBSync(mode), name(name), type(type),  desc(desc) {};
+	EWBParam(std::string name, uint8_t type, uint8_t mode, std::string desc=""): EWBSync(mode), pDesc(std::make_shared<EWBParamDesc>(name,desc)), type(type) {};
+	EWBParam(const EWBParamDescPtr &pDesc, uint8_t type, uint8_t mode): EWBSync(mode), pDesc(pDesc), type(type) {};
 	virtual ~EWBParam() {};
 
 
@@ -61,17 +79,17 @@ public:
 		EWBF_STRING = EWBF_TM_TYPE_STRING,
 	};
 
-	const std::string& getName() const { return name; }		//!< Get the name
-	const char *getCName() const { return name.c_str(); } 	//!< Get the name in "C" format for printf function
-	const std::string& getDesc() const { return desc; }		//!< Get the description
+	const std::string& getName() const { return pDesc->name.str(); }	//!< Get the name
+	const EWBString& getNameId() const { return pDesc->name; }		//!< Get the interned name (compared by pointer)
+	const char *getCName() const { return pDesc->name.c_str(); } 	//!< Get the name in "C" format for printf function
+	const std::string& getDesc() const { return pDesc->desc.str(); }	//!< Get the description
 	uint8_t getType() const { return type; }				//!< Get the type of field
 	EWBField* castField() { return ((type&EWBF_TM_TYPENESS)==EWBF_TM_TYPE_FIELD)?(EWBField*)this:NULL; } //!< Cast to EWBField* if possible otherwise return NULL
 	EWBParamStr* castParamStr() { return ((type&EWBF_TM_TYPENESS)==EWBF_TM_TYPE_STRING)?(EWBParamStr*)this:NULL; } //!< Cast to EWBParamStr* if possible otherwise return NULL
 
 protected:
-	std::string name;	//!< Name of the EWBField
+	EWBParamDescPtr pDesc;	//!< Name and description (shared by the instances of a layout)
 	uint8_t type;		//!< Type of data
-	std::string desc;	//!< Description
 };
 
 
@@ -9,6 +9,9 @@
 
 #include "ewbbridge/EWBCmdConsole.h"
 
+#define EWB_TRACE_MODULE EWB_TRACE_CONSOLE
+#include "EWBTrace.h"
+
 #include <iostream>
 #include <string>
 
@@ -30,7 +33,7 @@ EWBParamStrCmd::EWBParamStrCmd(EWBCmdConsole *pConsole,const std::string& name,
 
 	int reti = regcomp(&rgxpR, eStrR.c_str(),  REG_EXTENDED);
 	if (reti) {
-	    fprintf(stderr, "ERROR: Could not compile regex\n");
+	    TRACE_P_ERROR("%s: Could not compile regex '%s'",getCName(),eStrR.c_str());
 	}
 
 
@@ -12,17 +12,99 @@
 #include "EWBReg.h"
 #include "EWBBus.h"
 #include "EWBBridge.h"
+#include "EWBAccessPlanner.h"
+#include "EWBBufferPool.h"
+#include "EWBMirror.h"
+#include "EWBHeatmap.h"
 
 
 #include <string>
 #include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
 
 
-int EWBPeriph::sCount=0;
+namespace {
+
+/**
+ * Long-lived thread that performs the transfers of syncChunks()
+ *
+ * Each calling thread has its own worker (created at its first chunked
+ * sync and joined when the calling thread exits), so a chunk is transfered
+ * while the caller (de)codes the other one without starting a thread per chunk.
+ */
+class ChunkWorker {
+public:
+	ChunkWorker() : pending(false), busy(false), quit(false), ret(true), th(&ChunkWorker::run,this) {};
+	~ChunkWorker()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			quit=true;
+		}
+		cv.notify_all();
+		th.join();
+	}
+
+	//! Start a transfer (the previous one must be waited)
+	void start(const std::function<bool()> &xfer)
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		job=xfer;
+		pending=busy=true;
+		cv.notify_all();
+	}
+
+	//! Wait the end of the transfer and return its result
+	bool wait()
+	{
+		std::unique_lock<std::mutex> lock(mtx);
+		cv.wait(lock,[this]() { return busy==false; });
+		return ret;
+	}
+
+	//! Return the worker of the calling thread
+	static ChunkWorker& get()
+	{
+		static thread_local ChunkWorker worker;
+		return worker;
+	}
+
+private:
+	void run()
+	{
+		std::unique_lock<std::mutex> lock(mtx);
+		while(true)
+		{
+			cv.wait(lock,[this]() { return pending || quit; });
+			if(quit) return;
+			pending=false;
+			std::function<bool()> xfer=job;
+			lock.unlock();
+			bool r=xfer();
+			lock.lock();
+			ret=r;
+			busy=false;
+			cv.notify_all();
+		}
+	}
 
+	std::mutex mtx;
+	std::condition_variable cv;
+	std::function<bool()> job;	//!< The transfer to perform
+	bool pending;				//!< A transfer was started and not yet taken by the thread
+	bool busy;					//!< A transfer is not finished
+	bool quit;					//!< Stop the thread
+	bool ret;					//!< Result of the last transfer
+	std::thread th;				//!< The thread (started last)
+};
 
-#define TRACE_P_VDEBUG(...) //TRACE_P_DEBUG( __VA_ARGS__)
-#define TRACE_P_VVDEBUG(...) //TRACE_P_DEBUG( __VA_ARGS__)
+} // namespace
+
+int EWBPeriph::sCount=0;
 
 /**
  * Constructor for a EWBPeriph
@@ -33,9 +115,10 @@ int EWBPeriph::sCount=0;
  * \param[in] desc A description of this peripheral (optional)
  */
 EWBPeriph::EWBPeriph(EWBBus *bus,const std::string &name, uint32_t offset, uint64_t venID, uint32_t devID, const std::string &desc)
-: EWBSync(EWB_AM_RW)
+: EWBSync(EWB_AM_RW), ra_wsize(0), ra_base(0), ra_valid_ns(0), ra_t(0), ra_nhits(0), ra_nfetches(0), pl_nplans(0)
 {
 	this->bus=bus;
+	this->pMirror=(bus)?bus->getMirror():NULL;
 	this->name=name;
 	this->desc=desc;
 
@@ -74,6 +157,7 @@ bool EWBPeriph::appendReg(EWBReg *pReg)
 		ret = registers.insert(std::pair<uint32_t,EWBReg*>(pReg->getOffset(),pReg));
 		TRACE_CHECK_VA(ret.second,false,"Could not append '%s' because offset @x%0x is already used by '%s'",
 				pReg->getCName(),pReg->getOffset(),ret.first->second->getCName());
+		invalidatePlans();
 		return ret.second;
 	}
 	return false;
@@ -138,13 +222,132 @@ uint32_t EWBPeriph::getOffset(bool absolute) const
 	}
 }
 
+/**
+ * Freeze all the registers of the peripheral
+ *
+ * The mirror of the bus is also cached again.
+ *
+ * \return false if one of the registers is not valid.
+ * \see EWBReg::freeze()
+ */
+bool EWBPeriph::freeze()
+{
+	TRACE_CHECK_VA(isValid(),false,"%s is not valid",getCName());
+	bool ret=true;
+	pMirror=bus->getMirror();
+	std::map<uint32_t,EWBReg*>::iterator ii;
+	for(ii=registers.begin();ii!=registers.end();++ii)
+	{
+		if(ii->second && ii->second->freeze()==false) ret=false;
+	}
+	return ret;
+}
+
+//! Validate again the registers at each access
+void EWBPeriph::unfreeze()
+{
+	std::map<uint32_t,EWBReg*>::iterator ii;
+	for(ii=registers.begin();ii!=registers.end();++ii)
+	{
+		if(ii->second) ii->second->unfreeze();
+	}
+}
+
+/**
+ * Configure the read-ahead of the registers
+ *
+ * When a register is read (EWBReg::sync() or EWBField::sync()) the aligned
+ * window that contains it is fetched in one block transfer, and the next reads
+ * in this window are served from it during valid_us. The window is invalidated
+ * by the writes performed through this peripheral. It is never used for the
+ * registers flagged volatile (EWBReg::setVolatile()), nor when the window
+ * contains one of them.
+ *
+ * \param[in] wsize The size of the window in bytes (power of two, 0 to disable).
+ * \param[in] valid_us How long the values of the window are used (us).
+ * \return false if the size is not valid.
+ */
+bool EWBPeriph::setReadAhead(uint32_t wsize, uint32_t valid_us)
+{
+	TRACE_CHECK_VA(wsize==0 || (wsize>=sizeof(uint32_t) && (wsize & (wsize-1))==0),false,
+			"%s: read-ahead of %d bytes is not a power of two",getCName(),wsize);
+	std::lock_guard<std::mutex> lock(ra_mtx);
+	ra_wsize=wsize;
+	ra_valid_ns=(uint64_t)valid_us*1000;
+	ra_t=0;
+	return true;
+}
+
+/**
+ * Read a register from the read-ahead window
+ *
+ * The window is fetched when the register is not in the current one
+ * or when it has expired.
+ *
+ * \param[in] pReg The register of this peripheral.
+ * \param[out] pData The value of the register.
+ * \return true if the value was obtained from the window, false when the
+ * register must be read with a single access (disabled, volatile or error).
+ */
+bool EWBPeriph::readAhead(const EWBReg *pReg, uint32_t *pData)
+{
+	if(ra_wsize==0 || pReg==NULL || pReg->isVolatile()) return false;
+	EWBBridge *pBgd=getBridge();
+	if(pBgd==NULL) return false;
+
+	uint32_t off=pReg->getOffset();
+	uint64_t now=EWBBridgeStats::now_ns();
+	std::lock_guard<std::mutex> lock(ra_mtx);
+	if(ra_t && now-ra_t<=ra_valid_ns && off>=ra_base && off<ra_base+ra_buff.size()*sizeof(uint32_t))
+	{
+		ra_nhits++;
+		*pData=ra_buff[(off-ra_base)/sizeof(uint32_t)];
+		return true;
+	}
+
+	//The window stops at the last register of the peripheral
+	uint32_t base=off & ~(ra_wsize-1);
+	uint32_t end=std::min(base+ra_wsize,getLastReg()->getOffset()+(uint32_t)sizeof(uint32_t));
+	std::map<uint32_t,EWBReg*>::const_iterator ii=registers.lower_bound(base);
+	for(; ii!=registers.end() && (*ii).first<end; ++ii)
+	{
+		if((*ii).second->isVolatile()) return false;
+	}
+
+	ra_t=0;
+	ra_buff.resize((end-base)/sizeof(uint32_t));
+	if(pBgd->mem_block_xfer(getOffset(true)+base,end-base,&ra_buff[0],false)==false) return false;
+	ra_base=base;
+	ra_t=now;
+	ra_nfetches++;
+	*pData=ra_buff[(off-base)/sizeof(uint32_t)];
+	TRACE_P_VDEBUG("%s read-ahead [0x%x,0x%x] for %s",getCName(),base,end,pReg->getCName());
+	return true;
+}
+
+/**
+ * Invalidate the read-ahead window (the next read fetches it again)
+ */
+void EWBPeriph::invalidateReadAhead()
+{
+	if(ra_wsize==0) return;
+	std::lock_guard<std::mutex> lock(ra_mtx);
+	ra_t=0;
+}
+
 /**
  * Sync all registers in this EWBPeriph with the devices
  *
- * This method just iterate over each register to
- * call their sync() method.
+ * The accesses are planned with the cost model of the bridge
+ * (see syncRegs()): the single accesses are enclosed in a
+ * bridge cycle so that they can be packed, and the neighbouring
+ * registers might be accessed with a block.
+ *
+ * The plan of each direction is only computed once and is kept until
+ * a register is appended, the volatility of a register changes or
+ * the bridge (or its cost model) is not the same (see getPlans()).
  *
- * \ref EWBReg::sync()
+ * \ref EWBAccessPlanner, EWBBridge::openCycle()
  *
  * \param[in] con   An abstract class to connect to the memory.
  * \param[in] amode The operation mode (R,W,RW)
@@ -152,12 +355,249 @@ uint32_t EWBPeriph::getOffset(bool absolute) const
  */
 bool EWBPeriph::sync(EWBSync::AMode amode) {
 
+	EWBBridge *pBgd=this->getBridge();
+	TRACE_CHECK_PTR(pBgd,false);
+
+	PlanPtr plans[2];
+	getPlans(pBgd,amode,plans);
+	const PlanPtr &pPlan=plans[(amode & EWB_AM_W)?1:0];
+	TRACE_CHECK_PTR(pPlan,false);
+	bool ret=syncPlanned(pBgd,pPlan->regs,amode,plans);
+
+	//The values read in the cycle are only known now
+	EWBMirror *pMirror=getMirror();
+	if(pMirror && ret) pMirror->publish(this);
+	return ret;
+}
+
+/**
+ * Sync a set of registers with the devices
+ *
+ * The registers are grouped by bridge and the accesses of each group
+ * are planned with EWBAccessPlanner according to the cost model of
+ * the bridge. A block never spans two peripherals. The volatile
+ * registers are always accessed alone and are never covered by the
+ * block of another register.
+ *
+ * \param[in] regs The registers (of any peripheral).
+ * \param[in] amode The operation mode (R,W,RW)
+ * \return true if everything ok, false otherwise.
+ */
+bool EWBPeriph::syncRegs(const std::vector<EWBReg*> &regs, EWBSync::AMode amode)
+{
 	bool ret=true;
-	for(std::map<uint32_t,EWBReg*>::iterator ii=registers.begin(); ii!=registers.end(); ++ii)
+	std::map<EWBBridge*,std::map<uint32_t,EWBReg*> > groups;
+	for(size_t i=0;i<regs.size();i++)
+	{
+		EWBBridge *pBgd;
+		uint32_t addr;
+		if(regs[i]==NULL || regs[i]->resolve(&pBgd,&addr)==false) { ret=false; continue; }
+		groups[pBgd][addr]=regs[i];
+	}
+
+	std::map<EWBBridge*,std::map<uint32_t,EWBReg*> >::iterator gg;
+	for(gg=groups.begin();gg!=groups.end();++gg)
+	{
+		bool gret=syncPlanned(gg->first,gg->second,amode);
+		std::map<uint32_t,EWBReg*>::iterator ii;
+		for(ii=gg->second.begin();ii!=gg->second.end();++ii)
+		{
+			EWBMirror *pMirror=ii->second->getPeriph()->getMirror();
+			if(pMirror && gret) pMirror->publish(ii->second);
+		}
+		ret &= gret;
+	}
+	return ret;
+}
+
+/**
+ * Plan and perform the accesses of registers sharing the same bridge
+ *
+ * \param[in] pBgd The bridge of the registers.
+ * \param[in] regs The registers by absolute address.
+ * \param[in] amode The operation mode (R,W,RW)
+ * \param[in] plans The plans of regs (0: read, 1: write) kept by the
+ * peripheral (see getPlans()), NULL to compute them each time.
+ * \return false if any block or any cycle of single accesses failed
+ * (the errors are not known per register, see execPlan()).
+ */
+bool EWBPeriph::syncPlanned(EWBBridge *pBgd, const std::map<uint32_t,EWBReg*> &regs, EWBSync::AMode amode, const PlanPtr *plans)
+{
+	bool ret=true;
+	TRACE_CHECK_PTR(pBgd,false);
+	uint64_t t0=(EWBHeatmap::isEnabled())?EWBBridgeStats::now_ns():0;
+
+	std::vector<EWBAccessPlanner::Access> plan;
+	if(amode & EWB_AM_W)
+	{
+		if(plans==NULL) plan=makePlan(pBgd,regs,true);
+		ret &= execPlan(pBgd,regs,(plans)?plans[1]->accesses:plan,true);
+	}
+	if(amode & EWB_AM_R)
+	{
+		if(plans==NULL) plan=makePlan(pBgd,regs,false);
+		ret &= execPlan(pBgd,regs,(plans)?plans[0]->accesses:plan,false);
+	}
+
+	std::map<uint32_t,EWBReg*>::const_iterator ii;
+	for(ii=regs.begin();ii!=regs.end();++ii)
+	{
+		EWBReg *pReg=ii->second;
+		if(pReg->toSync) pReg->toSync=(ret==false); //Keep trying to sync if return was false
+		if(amode & EWB_AM_W) pReg->getPeriph()->invalidateReadAhead();
+		if(t0) EWBHeatmap::getInstance().record(pReg,ii->first,(amode & EWB_AM_R)?1:0,(amode & EWB_AM_W)?1:0,
+				(EWBBridgeStats::now_ns()-t0)/regs.size());
+	}
+	return ret;
+}
+
+/**
+ * Get the cached plans of sync()
+ *
+ * The plan of a direction is computed again when it was invalidated (see
+ * invalidatePlans()) or when the bridge, its cost model or the offset of
+ * the peripheral changed since it was computed. A plan is never modified,
+ * the caller keeps it alive while it is replaced by another thread.
+ *
+ * \param[in] pBgd The bridge of the peripheral.
+ * \param[in] amode The directions of the plans to get (R,W,RW)
+ * \param[out] plans The plans (0: read, 1: write), NULL when not in amode.
+ */
+void EWBPeriph::getPlans(EWBBridge *pBgd, EWBSync::AMode amode, PlanPtr plans[2])
+{
+	std::lock_guard<std::mutex> lock(pl_mtx);
+	uint32_t base=getOffset(true);
+	const EWBLatencyModel &model=pBgd->getCostModel();
+	for(int d=0;d<2;d++)
+	{
+		if((amode & ((d)?EWB_AM_W:EWB_AM_R))==0) continue;
+		PlanPtr &pc=pl_cache[d];
+		if(!pc || pc->pBgd!=pBgd || pc->base!=base || pc->pModel!=&model || pc->model!=model)
+		{
+			std::shared_ptr<Plan> pPlan=std::make_shared<Plan>();
+			pPlan->pBgd=pBgd;
+			pPlan->base=base;
+			pPlan->pModel=&model;
+			pPlan->model=model;
+			for(std::map<uint32_t,EWBReg*>::iterator ii=registers.begin(); ii!=registers.end(); ++ii)
+			{
+				pPlan->regs[base+(*ii).first]=(*ii).second;
+			}
+			pPlan->accesses=makePlan(pBgd,pPlan->regs,d==1);
+			pc=pPlan;
+			pl_nplans++;
+		}
+		plans[d]=pc;
+	}
+}
+
+/**
+ * Invalidate the plans of sync()
+ *
+ * It is called when a register is appended or when the volatility of
+ * a register changes (EWBReg::setVolatile()).
+ */
+void EWBPeriph::invalidatePlans()
+{
+	std::lock_guard<std::mutex> lock(pl_mtx);
+	pl_cache[0].reset();
+	pl_cache[1].reset();
+}
+
+/**
+ * Plan the accesses of one direction
+ *
+ * Each peripheral is planned alone so that a block only covers addresses
+ * of its own peripheral (the gap between two peripherals can be unmapped
+ * or belong to a peripheral that is not synchronized). The volatile
+ * registers are accessed alone and the volatile registers of the involved
+ * peripherals that are not in regs are never covered by a block.
+ */
+std::vector<EWBAccessPlanner::Access> EWBPeriph::makePlan(EWBBridge *pBgd, const std::map<uint32_t,EWBReg*> &regs, bool to_dev)
+{
+	std::map<EWBPeriph*,std::map<uint32_t,EWBReg*> > periphs;
+	for(std::map<uint32_t,EWBReg*>::const_iterator ii=regs.begin();ii!=regs.end();++ii)
+	{
+		periphs[ii->second->getPeriph()][ii->first]=ii->second;
+	}
+
+	std::vector<EWBAccessPlanner::Access> plan;
+	for(std::map<EWBPeriph*,std::map<uint32_t,EWBReg*> >::iterator pp=periphs.begin();pp!=periphs.end();++pp)
+	{
+		EWBPeriph *pPrh=pp->first;
+		EWBAccessPlanner planner(&pBgd->getCostModel());
+		for(std::map<uint32_t,EWBReg*>::iterator ii=pp->second.begin();ii!=pp->second.end();++ii)
+		{
+			planner.add(ii->first,ii->second->isVolatile());
+		}
+		//The volatile registers that are not synchronized must not be read by a block
+		for(std::map<uint32_t,EWBReg*>::iterator ii=pPrh->registers.begin();ii!=pPrh->registers.end();++ii)
+		{
+			if(ii->second->isVolatile()) planner.exclude(pPrh->getOffset(true)+ii->first);
+		}
+		std::vector<EWBAccessPlanner::Access> acc=planner.plan(to_dev);
+		plan.insert(plan.end(),acc.begin(),acc.end());
+	}
+	//The plan is executed by address
+	std::sort(plan.begin(),plan.end(),[](const EWBAccessPlanner::Access &a, const EWBAccessPlanner::Access &b) { return a.addr<b.addr; });
+	return plan;
+}
+
+/**
+ * Perform the accesses of one direction
+ *
+ * When writing, the blocks and the single accesses are performed in the
+ * order of the plan (by address) inside one cycle. When reading, the blocks
+ * are transfered first, then the single accesses are enclosed in a cycle
+ * (their values are only known at its end).
+ *
+ * \note The errors of the single accesses are reported per cycle: when
+ * one of them fails, closeCycle() fails and all the registers of regs are
+ * kept to sync (see syncPlanned()), not only the one that failed.
+ * \note The blocks written inside the cycle rely on the lock order of the
+ * bridges (see EWBBridge), a lease of another thread can not deadlock them.
+ */
+bool EWBPeriph::execPlan(EWBBridge *pBgd, const std::map<uint32_t,EWBReg*> &regs, const std::vector<EWBAccessPlanner::Access> &plan, bool to_dev)
+{
+	bool ret=true;
+	//Only grows with the biggest block of the thread
+	static thread_local std::vector<uint32_t> buff;
+
+	if(to_dev) ret &= pBgd->openCycle();
+	for(size_t i=0;i<plan.size();i++)
+	{
+		uint32_t addr=plan[i].addr, nsize=plan[i].nsize;
+		if(plan[i].block==false)
+		{
+			if(to_dev) ret &= pBgd->mem_access(addr,&(regs.find(addr)->second->data),true);
+			continue;
+		}
+		if(buff.size()<nsize/sizeof(uint32_t)) buff.resize(nsize/sizeof(uint32_t));
+		std::map<uint32_t,EWBReg*>::const_iterator ii, ie=regs.lower_bound(addr+nsize);
+		if(to_dev)
+		{
+			for(ii=regs.lower_bound(addr);ii!=ie;++ii) buff[(ii->first-addr)/sizeof(uint32_t)]=ii->second->data;
+		}
+		ret &= pBgd->mem_block_xfer(addr,nsize,&buff[0],to_dev);
+		if(to_dev==false)
+		{
+			for(ii=regs.lower_bound(addr);ii!=ie;++ii) ii->second->data=buff[(ii->first-addr)/sizeof(uint32_t)];
+		}
+	}
+	if(to_dev)
+	{
+		ret &= pBgd->closeCycle();
+		return ret;
+	}
+
+	//All the single accesses can be packed by the bridge
+	ret &= pBgd->openCycle();
+	for(size_t i=0;i<plan.size();i++)
 	{
-		EWBReg* pReg = (*ii).second;
-		ret &= pReg->sync(amode);
+		if(plan[i].block) continue;
+		ret &= pBgd->mem_access(plan[i].addr,&(regs.find(plan[i].addr)->second->data),false);
 	}
+	ret &= pBgd->closeCycle();
 	return ret;
 }
 
@@ -170,6 +610,9 @@ bool EWBPeriph::sync(EWBSync::AMode amode) {
  *   - In read mode: we get a specific piece of memory using DMA and we then
  *   extract the value from the buffer to the EWBPeriph structure
  *
+ * When the peripheral is bigger than the buffer of the bridge, the
+ * transfer is split in chunks (see syncChunks()).
+ *
  * \param[in] con   An abstract class to connect to the memory.
  * \param[in] amode The operation mode (R,W,RW)
  * \param[in] dma_dev_offset The position on the device where we are going to
@@ -182,7 +625,7 @@ bool EWBPeriph::sync(EWBSync::AMode amode, uint32_t dma_dev_offset)
 {
 	bool ret=true;
 	uint32_t *pData32, prh_bsize, ker_bsize;
-	TRACE_CHECK(isValid(),"isValid()",false);
+	TRACE_CHECK(isValid(),false,"isValid()");
 	if(dma_dev_offset==EWB_NODE_MEMBCK_OWNADDR) dma_dev_offset=this->getOffset(true);
 
 	//Check if the latest register has the latest size.
@@ -194,39 +637,203 @@ bool EWBPeriph::sync(EWBSync::AMode amode, uint32_t dma_dev_offset)
 	//first write to dev
 	if(amode & EWB_AM_W)
 	{
-		//Get the internal to_dev buffer
-		ker_bsize=pBgd->get_block_buffer(&pData32,true);
-		if(prh_bsize>ker_bsize) return false;
-
-		//Fill it with the data of all registers
-		for(std::map<uint32_t,EWBReg*>::iterator ii=registers.begin(); ii!=registers.end(); ++ii)
 		{
-			pData32[(*ii).first/sizeof(uint32_t)]=((*ii).second)->getData();
+			//Lease the internal to_dev buffer (released before the chunks that use our own buffers)
+			EWBBridge::BlockLease lease(pBgd,true);
+			ker_bsize=lease.size();
+			pData32=lease.get();
+			if(prh_bsize<=ker_bsize)
+			{
+				//Fill it with the data of all registers
+				for(std::map<uint32_t,EWBReg*>::iterator ii=registers.begin(); ii!=registers.end(); ++ii)
+				{
+					pData32[(*ii).first/sizeof(uint32_t)]=((*ii).second)->getData();
+				}
+
+				//send it to the device
+				ret &= lease.access(dma_dev_offset,prh_bsize); //Write buffer to dev
+			}
+		}
+		if(prh_bsize>ker_bsize)
+		{
+			ret &= syncChunks(true,dma_dev_offset,prh_bsize,ker_bsize);
 		}
-
-		//send it to the device
-		ret &= pBgd->mem_block_access(dma_dev_offset,prh_bsize,true); //Write buffer to dev
+		invalidateReadAhead();
 	}
 
 	//then read from dev
 	if(amode & EWB_AM_R)
 	{
-		//fill the user space buffer from the memory device
-		ret &= pBgd->mem_block_access(dma_dev_offset,prh_bsize,false); //Read buffer from dev
+		{
+			//Lease the internal from_dev kernel buffer
+			EWBBridge::BlockLease lease(pBgd,false);
+			ker_bsize=lease.size();
+			pData32=lease.get();
+			if(prh_bsize<=ker_bsize)
+			{
+				//fill the user space buffer from the memory device
+				ret &= lease.access(dma_dev_offset,prh_bsize); //Read buffer from dev
+
+				//Extract each value to the corresponding register
+				for(std::map<uint32_t,EWBReg*>::iterator ii=registers.begin(); ii!=registers.end(); ++ii)
+				{
+					((*ii).second)->data=pData32[(*ii).first/sizeof(uint32_t)];
+					TRACE_P_VDEBUG("%20s @0x%08X (%02d) <= 0x%x",((*ii).second)->getCName(),
+							((*ii).second)->getOffset(true),(int)((*ii).first/sizeof(uint32_t)),
+							((*ii).second)->getData());
+				}
+			}
+		}
+		if(prh_bsize>ker_bsize)
+		{
+			ret &= syncChunks(false,dma_dev_offset,prh_bsize,ker_bsize);
+		}
+	}
+	if(getMirror() && ret) getMirror()->publish(this);
+	return ret;
+}
+
+/**
+ * Write some peripherals and read others using DMA
+ *
+ * When all the peripherals are on a bridge that performs the block accesses
+ * of each direction independently (see EWBBridge::isDuplex()), the writes
+ * are performed by a worker of the calling thread (see ChunkWorker, distinct
+ * from the one used by the chunks of the reads) while the reads are performed
+ * by the caller, so that pushing a configuration overlaps with a status scan.
+ * Otherwise, or inside a cycle opened by the calling thread, the writes are
+ * performed before the reads.
+ *
+ * \note A peripheral in both lists is read after all the writes.
+ * \param[in] wr The peripherals to write.
+ * \param[in] rd The peripherals to read.
+ * \return true if all the peripherals were synchronized.
+ */
+bool EWBPeriph::syncBlocks(const std::vector<EWBPeriph*> &wr, const std::vector<EWBPeriph*> &rd)
+{
+	bool ret=true, wret=true, duplex=true;
+	EWBBridge *pBgd=NULL;
+	std::vector<EWBPeriph*> rnow, rafter;
 
-		//Get the internal from_dev kernel buffer
-		ker_bsize=pBgd->get_block_buffer(&pData32,false);
-		TRACE_CHECK_VA(prh_bsize<=ker_bsize,false,"size of periph is %d bytes (max=%d)",prh_bsize,ker_bsize);
+	for(size_t i=0;i<wr.size()+rd.size();i++)
+	{
+		EWBPeriph *pPrh=(i<wr.size())?wr[i]:rd[i-wr.size()];
+		TRACE_CHECK_PTR(pPrh,false);
+		if(pBgd==NULL) pBgd=pPrh->getBridge();
+		else if(pPrh->getBridge()!=pBgd) duplex=false;
+	}
+	duplex=duplex && pBgd && pBgd->isDuplex() && wr.size()>0 && pBgd->inCycle()==false;
+	for(size_t i=0;i<rd.size();i++)
+	{
+		bool written=(std::find(wr.begin(),wr.end(),rd[i])!=wr.end());
+		if(duplex && !written) rnow.push_back(rd[i]);
+		else rafter.push_back(rd[i]);
+	}
 
-		//Extract each value to the corresponding register
-		for(std::map<uint32_t,EWBReg*>::iterator ii=registers.begin(); ii!=registers.end(); ++ii)
+	//The worker of ChunkWorker::get() is used by the chunks of the reads
+	ChunkWorker *pWriter=NULL;
+	if(duplex)
+	{
+		static thread_local ChunkWorker writer;
+		pWriter=&writer;
+	}
+	std::function<bool()> writes=[&wr]() {
+		bool r=true;
+		for(size_t i=0;i<wr.size();i++) r &= wr[i]->sync(EWB_AM_W,EWB_NODE_MEMBCK_OWNADDR);
+		return r;
+	};
+	if(pWriter) pWriter->start(writes);
+	else wret=writes();
+	for(size_t i=0;i<rnow.size();i++) ret &= rnow[i]->sync(EWB_AM_R,EWB_NODE_MEMBCK_OWNADDR);
+	if(pWriter) wret=pWriter->wait();
+	for(size_t i=0;i<rafter.size();i++) ret &= rafter[i]->sync(EWB_AM_R,EWB_NODE_MEMBCK_OWNADDR);
+	return ret && wret;
+}
+
+/**
+ * Copy the registers of a chunk from/to a buffer
+ *
+ * \param[inout] pChunk The buffer that contains the chunk.
+ * \param[in] doffset The offset of the chunk in the peripheral (bytes).
+ * \param[in] nsize The size of the chunk (bytes).
+ * \param[in] to_buff if true the registers are copied to the buffer.
+ */
+void EWBPeriph::copyChunk(uint32_t *pChunk, uint32_t doffset, uint32_t nsize, bool to_buff)
+{
+	std::map<uint32_t,EWBReg*>::iterator ii=registers.lower_bound(doffset);
+	for(; ii!=registers.end() && (*ii).first<doffset+nsize; ++ii)
+	{
+		uint32_t i=((*ii).first-doffset)/sizeof(uint32_t);
+		if(to_buff) pChunk[i]=((*ii).second)->getData();
+		else ((*ii).second)->data=pChunk[i];
+	}
+}
+
+/**
+ * Sync EWBPeriph using DMA in chunks
+ *
+ * The peripheral is transfered in chunks of the size of the bridge buffer
+ * using two buffers leased from EWBBufferPool: the (de)coding of the registers
+ * of one chunk is done while the other chunk is transfered by the worker
+ * of the calling thread (see ChunkWorker). Inside a cycle opened by the
+ * calling thread the chunks are transfered by the caller, as the worker
+ * would wait for the end of the cycle.
+ *
+ * \param[in] to_dev if true we write to the device.
+ * \param[in] dev_offset The position on the device of the peripheral.
+ * \param[in] prh_bsize The size of the peripheral (bytes).
+ * \param[in] csize The size of a chunk (bytes).
+ * \return true if everything ok, false otherwise.
+ */
+bool EWBPeriph::syncChunks(bool to_dev, uint32_t dev_offset, uint32_t prh_bsize, uint32_t csize)
+{
+	bool ret=true;
+	EWBBridge *pBgd=this->getBridge();
+	csize&=~0x3;
+	TRACE_CHECK_VA(csize>0,false,"%s: bridge without block buffer",getCName());
+
+	uint32_t nchunks=(prh_bsize+csize-1)/csize;
+	EWBBufferPool::Lease lease0(csize), lease1(csize);
+	uint32_t *pBuff[2]={ lease0.get(), lease1.get() };
+	TRACE_CHECK_VA(pBuff[0] && pBuff[1],false,"%s: can not lease the buffers",getCName());
+	TRACE_P_DEBUG("%s 0x%08X + 0x%X in %d chunks of 0x%X",getCName(),dev_offset,prh_bsize,nchunks,csize);
+
+	ChunkWorker *pWorker=(pBgd->inCycle())?NULL:&ChunkWorker::get();
+	if(to_dev)
+	{
+		copyChunk(pBuff[0],0,std::min(csize,prh_bsize),true);
+		for(uint32_t k=0;k<nchunks;k++)
 		{
-			((*ii).second)->data=pData32[(*ii).first/sizeof(uint32_t)];
-			TRACE_P_VDEBUG("%20s @0x%08X (%02d) <= 0x%x",((*ii).second)->getCName(),
-					((*ii).second)->getOffset(true),(*ii).first/sizeof(uint32_t),
-					((*ii).second)->getData());
+			uint32_t off=k*csize;
+			uint32_t *pChunk=pBuff[k&1];
+			std::function<bool()> xfer=[=]() {
+				return pBgd->mem_block_xfer(dev_offset+off,std::min(csize,prh_bsize-off),pChunk,true);
+			};
+			if(pWorker) pWorker->start(xfer);
+			else ret &= xfer();
+			if(k+1<nchunks) copyChunk(pBuff[(k+1)&1],off+csize,std::min(csize,prh_bsize-off-csize),true);
+			if(pWorker) ret &= pWorker->wait();
+		}
+	}
+	else
+	{
+		ret &= pBgd->mem_block_xfer(dev_offset,std::min(csize,prh_bsize),pBuff[0],false);
+		for(uint32_t k=0;k<nchunks;k++)
+		{
+			uint32_t off=k*csize;
+			bool next=(k+1<nchunks);
+			if(next)
+			{
+				uint32_t *pChunk=pBuff[(k+1)&1];
+				std::function<bool()> xfer=[=]() {
+					return pBgd->mem_block_xfer(dev_offset+off+csize,std::min(csize,prh_bsize-off-csize),pChunk,false);
+				};
+				if(pWorker) pWorker->start(xfer);
+				else ret &= xfer();
+			}
+			copyChunk(pBuff[k&1],off,std::min(csize,prh_bsize-off),false);
+			if(next && pWorker) ret &= pWorker->wait();
 		}
-
 	}
 	return ret;
 }
@@ -295,7 +902,7 @@ bool EWBPeriph::sync(uint32_t* pData32, uint32_t bsize, EWBSync::AMode amode,  u
 			{
 				((*ii).second)->data=pData32[(*ii).first/sizeof(uint32_t)];
 				TRACE_P_VDEBUG("%20s @0x%08X (%02d) <= 0x%x",((*ii).second)->getCName(),
-						((*ii).second)->getOffset(true),(*ii).first/sizeof(uint32_t),
+						((*ii).second)->getOffset(true),(int)((*ii).first/sizeof(uint32_t)),
 						((*ii).second)->getData());
 			}
 		}
@@ -317,11 +924,12 @@ bool EWBPeriph::sync(uint32_t* pData32, uint32_t bsize, EWBSync::AMode amode,  u
 void EWBPeriph::print(std::ostream & o, int level) const
 {
 	int i;
-	char pre[255];
-	for(i=0;i<level;i++) pre[i]='\t';
+	char pre[32];
+	for(i=0;i<level && i<(int)sizeof(pre)-1;i++) pre[i]='\t';
 	pre[i]='\0';
 
-	o << pre << "Periph: " << this->name << EWBTrace::string_format(" @0x%08X (%4x:%08x #%d)",this->offset,(uint32_t)this->venID,this->devID,this->index) << std::endl;
+	o << pre << "Periph: " << this->name;
+	EWBTrace::stream_format(o," @0x%08X (%4x:%08x #%d)",this->offset,(uint32_t)this->venID,this->devID,this->index) << '\n';
 
 	EWBReg * reg=NULL;
 	for(std::map<uint32_t,EWBReg*>::const_iterator ii=this->registers.begin(); ii!=this->registers.end(); ++ii)
@@ -329,13 +937,14 @@ void EWBPeriph::print(std::ostream & o, int level) const
 		if((*ii).second==NULL) continue;
 		else reg=(*ii).second;
 
-		o << pre << "   " << *reg << std::endl;
+		o << pre << "   " << *reg << '\n';
 
-		const std::vector<EWBField*> f = reg->getFields();
+		//Use a reference to not copy the vector & '\n' to not flush each line
+		const std::vector<EWBField*> &f = reg->fields;
 		for(size_t j=0;j<f.size();j++)
 		{
 			if(f[j]==NULL) continue;
-			o << pre << "     " << *(f[j]) << std::endl;
+			o << pre << "     " << *(f[j]) << '\n';
 		}
 	}
 
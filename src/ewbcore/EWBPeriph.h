@@ -10,9 +10,14 @@
 
 #include "EWBSync.h"
 #include "EWBBus.h"
+#include "EWBString.h"
+#include "EWBAccessPlanner.h"
 
 #include <map>
 #include <string>
+#include <vector>
+#include <mutex>
+#include <memory>
 
 //Forward declaration to improve compilation
 class EWBBridge;
@@ -51,39 +56,87 @@ public:
 	EWBReg* getLastReg() const { return (registers.size()>0)?registers.rbegin()->second:NULL; }	//!< Get the highest WBReg in the node.
 
 	bool sync(EWBSync::AMode amode=EWB_AM_RW);
-	bool sync(EWBSync::AMode amode, uint32_t dma_dev_offset=EWB_NODE_MEMBCK_OWNADDR);
+	bool sync(EWBSync::AMode amode, uint32_t dma_dev_offset);
 	bool sync(uint32_t* pData32, uint32_t length, EWBSync::AMode amode, uint32_t doffset=0);
+	static bool syncRegs(const std::vector<EWBReg*> &regs, EWBSync::AMode amode);
+	static bool syncBlocks(const std::vector<EWBPeriph*> &wr, const std::vector<EWBPeriph*> &rd);
 
 	bool isValid(int level=-1) const { return (level!=0)?(bus && bus->isValid(level-1)):bus!=NULL; } 	//!< Return true when all pointers are defined
+	bool freeze();
+	void unfreeze();
 	bool isID(uint64_t venID, uint32_t devID) const { return (venID==this->venID && devID==this->devID); }
 
 	uint32_t getDeviceID() const { return this->devID; }	//!< Get the Device ID of this WBPeriph
 	uint64_t getVendorID() const { return this->venID; }	//!< Get the Device ID of this WBPeriph
 	int getIndex() const { return this->index; }	//!< Get unique index of WBPeriph
-	const std::string& getName() const { return this->name; }	//!< Get the name
+	const std::string& getName() const { return this->name.str(); }	//!< Get the name
+	const EWBString& getNameId() const { return this->name; }		//!< Get the interned name (compared by pointer)
 	const char *getCName() const { return this->name.c_str(); }	//!< Get the name in "C" format for printf function
-	const std::string& getDesc() const { return this->desc; }	//!< Get the description
+	const std::string& getDesc() const { return this->desc.str(); }	//!< Get the description
 	const EWBBridge* getBridge() const { return (bus)?bus->getBridge():0; }
 	EWBBridge* getBridge()  { return (bus)?bus->getBridge():0; }
+	EWBMirror* getMirror() const { return pMirror; }	//!< Get the mirror where the registers are published
+	void setMirror(EWBMirror *pMirror) { this->pMirror=pMirror; }	//!< Cache the mirror of the bus (see EWBBus::setMirror())
+
+	bool setReadAhead(uint32_t wsize=64, uint32_t valid_us=1000);
+	uint32_t getReadAhead() const { return ra_wsize; }			//!< Size of the read-ahead window (0: disabled)
+	uint64_t getReadAheadHits() const { return ra_nhits; }		//!< Number of reads served from the window
+	uint64_t getReadAheadFetches() const { return ra_nfetches; }	//!< Number of windows fetched
+	bool readAhead(const EWBReg *pReg, uint32_t *pData);
+	void invalidateReadAhead();
+	void invalidatePlans();
+	uint64_t getNPlans() const { return pl_nplans; }		//!< Number of plans computed by sync()
 
 	uint32_t getOffset(bool absolute) const;
 	void print(std::ostream & o, int level=0) const;
 	friend std::ostream & operator<<(std::ostream & o, const EWBPeriph &p) { p.print(o); return o; } //!< \ref print()
 
 protected:
-	std::string name;	//!< Name of the peripheral node
-	std::string desc;	//!< Description of the peripheral node
+	EWBString name;		//!< Name of the peripheral node (interned)
+	EWBString desc;		//!< Description of the peripheral node (interned)
 	uint32_t offset;	//!< Address of the peripheral node
 	uint32_t devID;		//!< Device ID (SDB) of this peripheral
 	uint64_t venID;		//!< Vendor ID (SDB) of this peripheral
 
+	bool syncChunks(bool to_dev, uint32_t dev_offset, uint32_t prh_bsize, uint32_t csize);
+	//! Plan of sync() kept for a direction
+	struct Plan {
+		const EWBBridge *pBgd;			//!< Bridge used to compute the plan
+		uint32_t base;					//!< Absolute offset of the peripheral when the plan was computed
+		const EWBLatencyModel *pModel;	//!< Cost model used to compute the plan
+		EWBLatencyModel model;			//!< Parameters of the cost model when the plan was computed
+		std::map<uint32_t,EWBReg*> regs;	//!< All the registers by absolute address
+		std::vector<EWBAccessPlanner::Access> accesses;	//!< The planned accesses
+	};
+	typedef std::shared_ptr<const Plan> PlanPtr;	//!< Plan shared with the sync() in progress
+
+	static bool syncPlanned(EWBBridge *pBgd, const std::map<uint32_t,EWBReg*> &regs, EWBSync::AMode amode, const PlanPtr *plans=NULL);
+	static std::vector<EWBAccessPlanner::Access> makePlan(EWBBridge *pBgd, const std::map<uint32_t,EWBReg*> &regs, bool to_dev);
+	static bool execPlan(EWBBridge *pBgd, const std::map<uint32_t,EWBReg*> &regs, const std::vector<EWBAccessPlanner::Access> &plan, bool to_dev);
+	void getPlans(EWBBridge *pBgd, EWBSync::AMode amode, PlanPtr plans[2]);
+	void copyChunk(uint32_t *pChunk, uint32_t doffset, uint32_t nsize, bool to_buff);
+
 private:
 
 	EWBBus *bus;
+	EWBMirror *pMirror;		//!< Mirror of the bus (cached)
 	static int sCount;
 	int index;
 	std::map<uint32_t,EWBReg*> registers;
 	std::map<uint32_t,EWBReg*>::iterator ii_nxtreg;
+
+	std::mutex ra_mtx;				//!< Protect the read-ahead window
+	std::vector<uint32_t> ra_buff;	//!< Content of the read-ahead window
+	uint32_t ra_wsize;				//!< Size of the read-ahead window (bytes)
+	uint32_t ra_base;				//!< Offset of the window in the peripheral
+	uint64_t ra_valid_ns;			//!< Validity of the window after it was fetched
+	uint64_t ra_t;					//!< Time when the window was fetched (0: invalid)
+	uint64_t ra_nhits;				//!< Number of reads served from the window
+	uint64_t ra_nfetches;			//!< Number of windows fetched
+
+	std::mutex pl_mtx;				//!< Protect the cached plans
+	PlanPtr pl_cache[2];			//!< Cached plans of sync() (0: read, 1: write), NULL when invalid
+	uint64_t pl_nplans;				//!< Number of plans computed by sync()
 };
 
 
@@ -10,6 +10,8 @@
 #include "EWBField.h"
 #include "EWBPeriph.h"
 #include "EWBTrace.h"
+#include "EWBHeatmap.h"
+#include "EWBMirror.h"
 
 #include "ewbbridge/EWBBridge.h"
 
@@ -22,10 +24,6 @@
 #include <ctype.h>
 
 
-#define TRACE_P_VDEBUG(...) //TRACE_P_DEBUG( __VA_ARGS__)
-#define TRACE_P_VVDEBUG(...) //TRACE_P_DEBUG( __VA_ARGS__)
-
-
 
 /**
  * Constructor of a EWBReg
@@ -37,19 +35,41 @@
  * \param[in] desc a description of what does this registers in case it is needed.
  */
 EWBReg::EWBReg(EWBPeriph *pPrtPeriph,const std::string &name, uint32_t offset, int nfields, const std::string &desc)
-:EWBSync(EWB_AM_RW)
+:EWBSync(EWB_AM_RW), pLayout(std::make_shared<EWBRegLayout>(name,offset,nfields,desc))
 {
-	this->pPeriph=pPrtPeriph;
-	this->name=name;
-	this->desc=desc;
+	init(pPrtPeriph);
+}
+
+/**
+ * Constructor of a EWBReg that shares its layout with the other instances
+ *
+ * The fields are not created (see EWBLayout::instantiate()).
+ *
+ * \param[in] pPrtPeriph if valid, we will append this register to the EWBNode.
+ * \param[in] pLayout The layout of the register.
+ */
+EWBReg::EWBReg(EWBPeriph *pPrtPeriph,const EWBRegLayoutPtr &pLayout)
+:EWBSync(EWB_AM_RW), pLayout(pLayout)
+{
+	init(pPrtPeriph);
+}
 
-	this->offset=offset;
+/**
+ * Initialize the state of the instance and append it to its peripheral
+ */
+void EWBReg::init(EWBPeriph *pPrtPeriph)
+{
+	this->pPeriph=pPrtPeriph;
 	this->used_mask=0;
 	this->data=0;
 	this->toSync=false;
-	this->nfields=nfields;
+	this->volat=false;
+	this->frozen=false;
+	this->abs_addr=0;
+	this->gen=0;
+	this->pBgd=NULL;
 
-	if(nfields>0) fields.resize(nfields,NULL);
+	if(pLayout->nfields>0) fields.resize(pLayout->nfields,NULL);
 	bool added=false;
 	if(this->pPeriph) added=this->pPeriph->appendReg(this);
 	if(added==false) {
@@ -98,13 +118,13 @@ bool EWBReg::addField(EWBField *fld, int index, bool toSyncInit)
 				fld->getCName(), fld->getMask(),this->getCName(),this->used_mask);
 		return false;
 	}
-	if(index>0 && nfields>0 && (size_t)index>=fields.size())
+	if(index>0 && pLayout->nfields>0 && (size_t)index>=fields.size())
 	{
 		TRACE_P_WARNING("This field index %s (%d) >= nfields %d\n",
-				fld->getCName(),index,fields.size());
+				fld->getCName(),index,(int)fields.size());
 		return false;
 	}
-	if(index>0 && nfields>0 && fields[index]!=NULL)
+	if(index>0 && pLayout->nfields>0 && fields[index]!=NULL)
 	{
 		TRACE_P_WARNING("This field index already exists %s. It can not be replaced by %s\n",
 				fields[index]->getCName(),fld->getCName());
@@ -112,7 +132,7 @@ bool EWBReg::addField(EWBField *fld, int index, bool toSyncInit)
 	}
 
 
-	if(index>=0 && nfields>0) fields[index]=fld;
+	if(index>=0 && pLayout->nfields>0) fields[index]=fld;
 	else fields.push_back(fld); //Append the field to the vector
 
 	//append field mask to used mask of the whole register
@@ -128,12 +148,23 @@ bool EWBReg::addField(EWBField *fld, int index, bool toSyncInit)
  * \return A pointer on EWBField or NULL if it was not found
  */
 const EWBField* EWBReg::getField(const std::string& name) const
+{
+	EWBString id;
+	return (EWBString::find(name,&id))?getField(id):NULL;
+}
+
+/**
+ * Get a pointer on the corresponding field (the names are compared by pointer)
+ *
+ * \return A pointer on EWBField or NULL if it was not found
+ */
+const EWBField* EWBReg::getField(const EWBString& name) const
 {
 	EWBField *f;
 	for(size_t j=0;j<fields.size();j++)
 	{
 		f=fields[j];
-		if(f && f->getName()==name) return f;
+		if(f && f->getNameId()==name) return f;
 	}
 	return NULL;
 }
@@ -150,21 +181,29 @@ const EWBField* EWBReg::getField(const std::string& name) const
 bool EWBReg::sync(EWBSync::AMode amode)
 {
 	bool ret=true;
-	if(!isValid()) return false;
+	EWBBridge *b;
+	uint32_t addr;
+	if(resolve(&b,&addr)==false) return false;
 
-	EWBBridge *b=pPeriph->getBridge();
+	uint64_t t0=(EWBHeatmap::isEnabled())?EWBBridgeStats::now_ns():0;
 
 	//first write to dev
 	if(amode & EWB_AM_W)
 	{
-		ret &= b->mem_access(this->getOffset(true),&data,true); //Write EWB to dev
+		ret &= b->mem_access(addr,&data,true); //Write EWB to dev
+		pPeriph->invalidateReadAhead();
 	}
-	//then read from dev
+	//then read from dev (from the read-ahead window when possible)
 	if(amode & EWB_AM_R)
 	{
-		ret &= b->mem_access(this->getOffset(true),&data,false); //Read EWB from dev
+		if(pPeriph->readAhead(this,&data)==false)
+			ret &= b->mem_access(addr,&data,false); //Read EWB from dev
 	}
 	if(toSync) toSync=(ret==false); //Keep trying to sync if return was false
+
+	EWBMirror *pMirror=pPeriph->getMirror();
+	if(pMirror && ret) pMirror->publish(this);
+	if(t0) EWBHeatmap::getInstance().record(this,addr,(amode & EWB_AM_R)?1:0,(amode & EWB_AM_W)?1:0,EWBBridgeStats::now_ns()-t0);
 	return ret;
 }
 
@@ -195,11 +234,62 @@ bool EWBReg::isValid(int level) const
  */
 uint32_t EWBReg::getOffset(bool absolute) const
 {
+	if(absolute && frozen) return abs_addr;
 	if(absolute && isValid())
 	{
-		return pPeriph->getOffset(absolute)+offset;
+		return pPeriph->getOffset(absolute)+pLayout->offset;
 	}
-	return offset;
+	return pLayout->offset;
+}
+
+/**
+ * Validate the register once and cache its bridge and absolute address
+ *
+ * The following accesses do not check the tree again (see EWBBus::freeze()).
+ * When the generation of the bridge changes (reconnection) the register is
+ * validated again at its next access.
+ *
+ * \warning The tree must not be modified while it is frozen.
+ * \return false if the register is not valid (it is then checked at each access).
+ */
+bool EWBReg::freeze()
+{
+	frozen=validate();
+	return frozen;
+}
+
+/**
+ * Check the whole tree and refresh the cached values
+ */
+bool EWBReg::validate()
+{
+	EWBBridge *b=(pPeriph)?pPeriph->getBridge():NULL;
+	if(b==NULL) return false;
+	uint32_t g=b->getGeneration();	//Read before the check so that a reconnection is never missed
+	if(!isValid()) return false;
+	//Several threads might refresh it: the generation is published after the bridge and the address
+	pBgd.store(b,std::memory_order_relaxed);
+	abs_addr.store(pPeriph->getOffset(true)+pLayout->offset,std::memory_order_relaxed);
+	gen.store(g,std::memory_order_release);
+	return true;
+}
+
+/**
+ * Get the bridge and the absolute address used to access the register
+ *
+ * \param[out] hBgd The bridge.
+ * \param[out] pAddr The absolute address.
+ * \return false if the register is not valid.
+ */
+bool EWBReg::resolve(EWBBridge **hBgd, uint32_t *pAddr)
+{
+	//The generation is read first, the bridge and the address published with it are then seen
+	uint32_t g=gen.load(std::memory_order_acquire);
+	EWBBridge *b=pBgd.load(std::memory_order_relaxed);
+	if((frozen==false || b==NULL || b->getGeneration()!=g) && validate()==false) return false;
+	*hBgd=pBgd.load(std::memory_order_relaxed);
+	*pAddr=abs_addr.load(std::memory_order_relaxed);
+	return true;
 }
 
 /**
@@ -207,6 +297,6 @@ uint32_t EWBReg::getOffset(bool absolute) const
  */
 std::ostream & operator<<(std::ostream & o, const EWBReg &r)
 {
-	o << EWBTrace::string_format("@0x%08X (%s) : 0x%x",r.getOffset(true),r.getCName(),r.getData());
+	EWBTrace::stream_format(o,"@0x%08X (%s) : 0x%x",r.getOffset(true),r.getCName(),r.getData());
 	return o;
 }
@@ -10,10 +10,12 @@
 
 #include "EWBSync.h"
 #include "EWBPeriph.h"
+#include "EWBLayout.h"
 
 class EWBField;
 
 #include <vector>
+#include <atomic>
 
 /**
  * Class to manipulate Wishbone register with various EWBField
@@ -26,9 +28,12 @@ public:
 
 	friend class EWBField;
 	friend class EWBPeriph;
+	friend class EWBSequence;
+	friend class EWBWait;
 	friend std::ostream & operator<<(std::ostream & output, const EWBReg &r);
 
 	EWBReg(EWBPeriph *pPrtNode,const std::string &name, uint32_t offset, int nfields = -1, const std::string &desc="");
+	EWBReg(EWBPeriph *pPrtNode,const EWBRegLayoutPtr &pLayout);
 	virtual ~EWBReg();
 
 	uint32_t getOffset(bool absolute=false) const;
@@ -36,6 +41,8 @@ public:
 
 	bool addField(EWBField *fld, int index=-1, bool toSyncInit=false);
 	const EWBField* getField(const std::string& name) const;
+	const EWBField* getField(const EWBString& name) const;
+	const EWBField* getField(const char* name) const { return this->getField(std::string(name)); }	//!< \ref getField()
 	const EWBField* operator[](const std::string& name) const { return this->getField(name); }
 
 	std::vector<EWBField*> getFields() { return fields; }
@@ -44,24 +51,36 @@ public:
 
 	void 	setToSync() { toSync=true; }						//!< Set this register to be sync ASAP
 	bool 	isToSync() const { return toSync; }					//!< Check if the register need to be sync ASAP
+	void 	setVolatile(bool val=true) { volat=val; if(pPeriph) pPeriph->invalidatePlans(); }	//!< Flag the register as volatile (i.e. clear-on-read), it is never read ahead
+	bool 	isVolatile() const { return volat; }				//!< Check if reading the register has side effects
 	uint32_t getData() const { return data; }					//!< Get the data
-	const std::string& getName() const { return this->name; }	//!< Get the name
-	const char *getCName() const { return this->name.c_str(); }	//!< Get the name in "C" format for printf function
-	const std::string& getDesc() const { return this->desc; }	//!< Get the description
+	const std::string& getName() const { return pLayout->name.str(); }	//!< Get the name
+	const EWBString& getNameId() const { return pLayout->name; }	//!< Get the interned name (compared by pointer)
+	const char *getCName() const { return pLayout->name.c_str(); }	//!< Get the name in "C" format for printf function
+	const std::string& getDesc() const { return pLayout->desc.str(); }	//!< Get the description
+	const EWBRegLayoutPtr& getLayout() const { return pLayout; }	//!< Get the layout (shared by the instances of a peripheral type)
 	bool isValid(int level=-1) const;
+	bool freeze();
+	void unfreeze() { frozen=false; }				//!< Validate the register at each access
+	bool isFrozen() const { return frozen; }		//!< Check if the validity and the address are cached
 
 protected:
 	EWBPeriph* getPeriph() { return pPeriph; }
+	bool resolve(EWBBridge **hBgd, uint32_t *pAddr);
+	bool validate();
+	void init(EWBPeriph *pPrtPeriph);
 
 
 	std::vector<EWBField*> fields;	//!< A list of the relative EWBFields
-	std::string name;		//!< The name
-	std::string desc;		//!< A description
-	uint32_t offset;		//!< The offset relative to EWBNode
+	EWBRegLayoutPtr pLayout;	//!< The name, description and offset relative to EWBNode (shared)
 	uint32_t data;			//!< The corresponding data
 	uint32_t used_mask;		//!< The mask used by other EWBField
-	int nfields;			//!< The number of field defined
 	bool toSync;			//!< Boolean that tell if this register need to be sync ASAP
+	bool volat;				//!< The value changes by itself or when it is read (never cached)
+	std::atomic<bool> frozen;			//!< The validity check and the absolute address are cached (see freeze())
+	std::atomic<uint32_t> abs_addr;		//!< The cached absolute address
+	std::atomic<uint32_t> gen;			//!< The generation of the bridge when the register was validated (published last)
+	std::atomic<EWBBridge*> pBgd;		//!< The cached bridge
 
 private:
 	EWBPeriph *pPeriph;	//!< Parent Peripheral
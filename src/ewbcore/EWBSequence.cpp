@@ -0,0 +1,208 @@
+/*
+ * EWBSequence.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBSequence.h"
+
+#include "EWBPeriph.h"
+#include "EWBReg.h"
+#include "EWBField.h"
+#include "EWBMirror.h"
+#include "EWBTrace.h"
+
+#include <set>
+#include <thread>
+#include <chrono>
+
+EWBSequence::EWBSequence()
+: pBgd(NULL), gen(0), compiled(false), valid(true)
+{
+
+}
+
+EWBSequence::~EWBSequence()
+{
+
+}
+
+EWBSequence& EWBSequence::append(uint32_t type, EWBReg *pReg, uint32_t mask, uint32_t value, uint32_t timeout_us)
+{
+	Step s={ type, pReg, mask, value, timeout_us };
+	if(pReg==NULL && type!=EWBSeqOp::DELAY)
+	{
+		TRACE_P_ERROR("Step #%d: NULL handle",(int)steps.size());
+		valid=false;
+	}
+	steps.push_back(s);
+	compiled=false;
+	return *this;
+}
+
+/**
+ * Append the write of a whole register
+ */
+EWBSequence& EWBSequence::write(EWBReg *pReg, uint32_t value)
+{
+	return append(EWBSeqOp::WRITE,pReg,0xFFFFFFFF,value,0);
+}
+
+/**
+ * Append the write of a field (read-modify-write of its register)
+ *
+ * \param[in] pFld The field.
+ * \param[in] value The raw value of the field (not shifted).
+ */
+EWBSequence& EWBSequence::write(EWBField *pFld, uint32_t value)
+{
+	uint32_t rdata=0;
+	if(pFld) pFld->regCvt(&value,&rdata,false);
+	return append(EWBSeqOp::WRITE_MASK,(pFld)?pFld->getReg():NULL,(pFld)?pFld->getMask():0,rdata,0);
+}
+
+/**
+ * Append the write of the bits of mask in a register (read-modify-write)
+ */
+EWBSequence& EWBSequence::writeMasked(EWBReg *pReg, uint32_t mask, uint32_t value)
+{
+	if(mask==0xFFFFFFFF) return write(pReg,value);
+	return append(EWBSeqOp::WRITE_MASK,pReg,mask,value & mask,0);
+}
+
+/**
+ * Append the read of a register (its data is updated by run())
+ */
+EWBSequence& EWBSequence::read(EWBReg *pReg)
+{
+	return append(EWBSeqOp::READ,pReg,0xFFFFFFFF,0,0);
+}
+
+/**
+ * Append the read of a field (only its bits are updated in the register)
+ */
+EWBSequence& EWBSequence::read(EWBField *pFld)
+{
+	return append(EWBSeqOp::READ,(pFld)?pFld->getReg():NULL,(pFld)?pFld->getMask():0,0,0);
+}
+
+/**
+ * Append a poll of a register until (data & mask)==value
+ *
+ * \param[in] pReg The register.
+ * \param[in] mask The bits compared.
+ * \param[in] value The expected value of these bits.
+ * \param[in] timeout_us The sequence fails when the value is not reached within this time.
+ */
+EWBSequence& EWBSequence::poll(EWBReg *pReg, uint32_t mask, uint32_t value, uint32_t timeout_us)
+{
+	return append(EWBSeqOp::POLL,pReg,mask,value & mask,timeout_us);
+}
+
+/**
+ * Append a poll of a field until it is equal to value (raw, not shifted)
+ */
+EWBSequence& EWBSequence::poll(EWBField *pFld, uint32_t value, uint32_t timeout_us)
+{
+	uint32_t rdata=0;
+	if(pFld) pFld->regCvt(&value,&rdata,false);
+	return append(EWBSeqOp::POLL,(pFld)?pFld->getReg():NULL,(pFld)?pFld->getMask():0,rdata,timeout_us);
+}
+
+/**
+ * Append a delay between two steps
+ */
+EWBSequence& EWBSequence::delay(uint32_t us)
+{
+	return append(EWBSeqOp::DELAY,NULL,0,0,us);
+}
+
+/**
+ * Resolve the handles into the list of EWBSeqOp
+ *
+ * This is done automatically by the first run() after a modification
+ * or after a reconnection of the bridge.
+ * \return false if a handle is not valid or if the registers are not on the same bridge.
+ */
+bool EWBSequence::compile()
+{
+	ops.clear();
+	pBgd=NULL;
+	compiled=false;
+	TRACE_CHECK(valid,false,"The sequence has a NULL handle");
+
+	for(size_t i=0;i<steps.size();i++)
+	{
+		const Step &s=steps[i];
+		EWBSeqOp op={ s.type, 0, s.mask, s.value, s.timeout_us };
+		if(s.pReg)
+		{
+			EWBBridge *pB=(s.pReg->getPeriph())?s.pReg->getPeriph()->getBridge():NULL;
+			if(pBgd==NULL && pB) gen=pB->getGeneration();	//Read before the check so that a reconnection is never missed
+			TRACE_CHECK_VA(s.pReg->resolve(&pB,&op.addr),false,"Step #%d: %s is not valid",(int)i,s.pReg->getCName());
+			TRACE_CHECK_VA(pBgd==NULL || pBgd==pB,false,"Step #%d: %s is on another bridge",(int)i,s.pReg->getCName());
+			pBgd=pB;
+		}
+		ops.push_back(op);
+	}
+	compiled=true;
+	return true;
+}
+
+/**
+ * Execute the sequence with one call to the bridge
+ *
+ * When the sequence succeeds, the data of the registers read, polled or
+ * written are updated (only the bits of the field for a field).
+ * \return false if the sequence can not be compiled, if an access failed or a poll timed out.
+ */
+bool EWBSequence::run()
+{
+	if(isCompiled()==false && compile()==false) return false;
+	if(pBgd==NULL)
+	{
+		//Only delays: they are waited locally
+		for(size_t i=0;i<ops.size();i++)
+		{
+			if(ops[i].type==EWBSeqOp::DELAY) std::this_thread::sleep_for(std::chrono::microseconds(ops[i].timeout_us));
+		}
+		return true;
+	}
+
+	bool ret=pBgd->mem_sequence(ops,rdata);
+
+	std::set<EWBPeriph*> written;
+	size_t ir=0;
+	for(size_t i=0;i<steps.size();i++)
+	{
+		const Step &s=steps[i];
+		if(s.type==EWBSeqOp::WRITE || s.type==EWBSeqOp::WRITE_MASK)
+		{
+			written.insert(s.pReg->getPeriph());
+			if(ret) s.pReg->data=(s.pReg->data & ~s.mask) | s.value;
+		}
+		else if(ops[i].hasData() && ir<rdata.size())
+		{
+			uint32_t val=rdata[ir++];
+			if(ret==false) continue;
+			s.pReg->data=(s.pReg->data & ~s.mask) | (val & s.mask);
+			EWBMirror *pMirror=s.pReg->getPeriph()->getMirror();
+			if(pMirror) pMirror->publish(s.pReg);
+		}
+	}
+	for(std::set<EWBPeriph*>::iterator ii=written.begin();ii!=written.end();++ii) (*ii)->invalidateReadAhead();
+	return ret;
+}
+
+/**
+ * Remove all the steps
+ */
+void EWBSequence::clear()
+{
+	steps.clear();
+	ops.clear();
+	rdata.clear();
+	pBgd=NULL;
+	compiled=false;
+	valid=true;
+}
@@ -0,0 +1,82 @@
+/*
+ * EWBSequence.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef EWBSEQUENCE_H_
+#define EWBSEQUENCE_H_
+
+#include "EWBBridge.h"
+
+#include <vector>
+
+class EWBReg;
+class EWBField;
+
+/**
+ * Scripted sequence of accesses to the registers of a device
+ *
+ * The steps are built from the EWBReg and EWBField handles, then compiled
+ * once into a list of EWBSeqOp (absolute addresses and masks) that is
+ * executed with a single call to EWBBridge::mem_sequence(): the bridges
+ * that can execute it remotely (i.e. EWBMemDaemonCon) do it in one request,
+ * the others batch the consecutive writes and reads in the same cycle.
+ *
+ * \code
+ * EWBSequence seq;
+ * seq.write(pFldReset,1).poll(pFldReady,1,1000).write(pFldReset,0).read(pRegStatus);
+ * if(seq.run()) printf("status=0x%x\n",pRegStatus->getData());
+ * \endcode
+ *
+ * \note All the handles of a sequence must be on the same bridge.
+ * \note The sequence is compiled again after a reconnection of the bridge
+ * (EWBBridge::getGeneration()).
+ */
+class EWBSequence {
+public:
+	EWBSequence();
+	virtual ~EWBSequence();
+
+	EWBSequence& write(EWBReg *pReg, uint32_t value);
+	EWBSequence& write(EWBField *pFld, uint32_t value);
+	EWBSequence& writeMasked(EWBReg *pReg, uint32_t mask, uint32_t value);
+	EWBSequence& read(EWBReg *pReg);
+	EWBSequence& read(EWBField *pFld);
+	EWBSequence& poll(EWBReg *pReg, uint32_t mask, uint32_t value, uint32_t timeout_us);
+	EWBSequence& poll(EWBField *pFld, uint32_t value, uint32_t timeout_us);
+	EWBSequence& delay(uint32_t us);
+
+	bool compile();
+	bool run();
+	void clear();
+
+	size_t size() const { return steps.size(); }				//!< Number of steps
+	//! true when the steps are compiled for the current connection of the bridge
+	bool isCompiled() const { return compiled && (pBgd==NULL || pBgd->getGeneration()==gen); }
+	const std::vector<EWBSeqOp>& getOps() const { return ops; }	//!< The compiled steps
+	const std::vector<uint32_t>& getData() const { return rdata; }	//!< The words read by the last run (READ & POLL)
+	EWBBridge* getBridge() const { return pBgd; }				//!< The bridge of the compiled sequence
+
+private:
+	//! A step of the sequence
+	struct Step {
+		uint32_t type;		//!< \ref EWBSeqOp::Type
+		EWBReg *pReg;		//!< The register accessed (NULL for DELAY)
+		uint32_t mask;		//!< The bits accessed
+		uint32_t value;		//!< The value written or expected
+		uint32_t timeout_us;	//!< Timeout of POLL or duration of DELAY
+	};
+
+	EWBSequence& append(uint32_t type, EWBReg *pReg, uint32_t mask, uint32_t value, uint32_t timeout_us);
+
+	std::vector<Step> steps;		//!< Steps with their handles
+	std::vector<EWBSeqOp> ops;		//!< Compiled steps
+	std::vector<uint32_t> rdata;	//!< Words read by the last run
+	EWBBridge *pBgd;				//!< Bridge of the compiled steps
+	uint32_t gen;					//!< Generation of the bridge when the steps were compiled
+	bool compiled;					//!< true when ops corresponds to steps
+	bool valid;						//!< false when a step was appended with a NULL handle
+};
+
+#endif /* EWBSEQUENCE_H_ */
@@ -0,0 +1,83 @@
+/*
+ * EWBString.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBString.h"
+
+#include <mutex>
+#include <unordered_set>
+
+namespace {
+
+//! The table of the interned strings (the elements are never moved)
+struct Table {
+	std::mutex mtx;
+	std::unordered_set<std::string> strs;
+	size_t nbytes;
+	Table(): nbytes(0) {};
+};
+
+//! Return the table (created at its first use so that the static handles can use it)
+Table& table()
+{
+	static Table t;
+	return t;
+}
+
+} // namespace
+
+/**
+ * Default constructor on the empty string
+ */
+EWBString::EWBString()
+{
+	static const std::string *pEmpty=intern("");
+	p=pEmpty;
+}
+
+/**
+ * Return the entry of a string in the table (inserted when not found)
+ */
+const std::string* EWBString::intern(const std::string &str)
+{
+	Table &t=table();
+	std::lock_guard<std::mutex> lock(t.mtx);
+	std::pair<std::unordered_set<std::string>::iterator,bool> ret=t.strs.insert(str);
+	if(ret.second) t.nbytes+=str.size()+1;
+	return &(*ret.first);
+}
+
+/**
+ * Look for a string without interning it
+ *
+ * \param[in] str The string to look for.
+ * \param[out] pStr If not NULL, the handle on the interned string.
+ * \return false when the string has never been interned (it can not be the name of any object).
+ */
+bool EWBString::find(const std::string &str, EWBString *pStr)
+{
+	Table &t=table();
+	std::lock_guard<std::mutex> lock(t.mtx);
+	std::unordered_set<std::string>::iterator ii=t.strs.find(str);
+	if(ii==t.strs.end()) return false;
+	if(pStr) pStr->p=&(*ii);
+	return true;
+}
+
+//! Number of strings in the table
+size_t EWBString::getNStrings()
+{
+	Table &t=table();
+	std::lock_guard<std::mutex> lock(t.mtx);
+	return t.strs.size();
+}
+
+//! Number of characters stored in the table (bytes)
+size_t EWBString::getNBytes()
+{
+	Table &t=table();
+	std::lock_guard<std::mutex> lock(t.mtx);
+	return t.nbytes;
+}
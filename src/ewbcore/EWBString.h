@@ -0,0 +1,52 @@
+/*
+ * EWBString.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef EWBSTRING_H_
+#define EWBSTRING_H_
+
+#include <string>
+#include <cstddef>
+#include <ostream>
+
+/**
+ * Handle on a string interned in a table shared by the whole library
+ *
+ * The names and descriptions of the tree are stored once in the table
+ * (the wbgen2 descriptions are the same for all the instances of a
+ * peripheral) and each object only keeps a pointer on it. Two handles
+ * are equal when they point to the same entry, so comparing them does
+ * not compare the characters.
+ *
+ * \note The interned strings are never freed: the table only grows with
+ * the number of distinct names.
+ */
+class EWBString {
+public:
+	EWBString();
+	EWBString(const std::string &str) : p(intern(str)) {};	//!< Intern a string
+	EWBString(const char *str) : p(intern((str)?str:"")) {};	//!< Intern a "C" string
+
+	const std::string& str() const { return *p; }			//!< Get the interned string
+	const char *c_str() const { return p->c_str(); }		//!< Get the string in "C" format for printf function
+	operator const std::string&() const { return *p; }		//!< Use the handle as a string
+	const void* id() const { return p; }					//!< Unique identifier of the string
+	bool empty() const { return p->empty(); }				//!< Return true for the empty string
+
+	bool operator==(const EWBString &o) const { return p==o.p; }	//!< Compare the pointers
+	bool operator!=(const EWBString &o) const { return p!=o.p; }	//!< Compare the pointers
+	friend std::ostream & operator<<(std::ostream & o, const EWBString &s) { return o << *s.p; } //!< Print the string
+
+	static bool find(const std::string &str, EWBString *pStr);
+	static size_t getNStrings();
+	static size_t getNBytes();
+
+private:
+	static const std::string* intern(const std::string &str);
+
+	const std::string *p;	//!< The entry in the table
+};
+
+#endif /* EWBSTRING_H_ */
@@ -13,24 +13,172 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 
+//! Runtime level of each module, all starting at TRACE_LEVEL_DEFAULT
+std::atomic<int> ewbTraceLevels[EWB_TRACE_NMODULES] = {
+		{TRACE_LEVEL_DEFAULT}, {TRACE_LEVEL_DEFAULT}, {TRACE_LEVEL_DEFAULT}, {TRACE_LEVEL_DEFAULT} };
 
+//! Names of the modules used by the IOC shell (same order as EWBTraceModule)
+static const char* traceModuleNames[EWB_TRACE_NMODULES] = { "core", "bridge", "asyn", "console" };
 
+
+//! Thread-local buffer used by tls_format()
+static __thread char tlsBuff[EWBTRACE_TLS_BSIZE];
+
+/**
+ * Format a string like printf() and return it as std::string
+ *
+ * \note This function allocates the returned string, prefer
+ * buff_format(), tls_format() or stream_format() in the hot paths.
+ */
 std::string EWBTrace::string_format(const std::string &fmt, ...) {
-	int size = 512;
-	char* buffer = 0;
-	buffer = new char[size];
-	va_list vl;
+	char buffer[EWBTRACE_TLS_BSIZE];
+	va_list vl, vl2;
 	va_start(vl, fmt);
-	int nsize = vsnprintf(buffer, size, fmt.c_str(), vl);
-	if(size<=nsize){ //fail delete buffer and try again
-		delete[] buffer;
-		buffer = 0;
-		buffer = new char[nsize+1]; //+1 for /0
-		nsize = vsnprintf(buffer, size, fmt.c_str(), vl);
-	}
-	std::string ret(buffer);
+	va_copy(vl2, vl);
+	int nsize = vsnprintf(buffer, sizeof(buffer), fmt.c_str(), vl);
 	va_end(vl);
-	delete[] buffer;
+	if(nsize<0) nsize=0;
+	if((size_t)nsize<sizeof(buffer))
+	{
+		va_end(vl2);
+		return std::string(buffer,nsize);
+	}
+
+	//Too long: format directly in the string (+1 for /0)
+	std::string ret(nsize+1,'\0');
+	vsnprintf(&ret[0], nsize+1, fmt.c_str(), vl2);
+	va_end(vl2);
+	ret.resize(nsize);
 	return ret;
 }
+
+/**
+ * Format a string like printf() in a caller-supplied buffer
+ *
+ * \param[out] buff The buffer where the string is written (always null terminated)
+ * \param[in] size The size of the buffer in bytes
+ * \param[in] fmt The printf() format
+ * \return the number of characters written (without the null character),
+ * the string is truncated when it does not fit.
+ */
+int EWBTrace::buff_format(char *buff, size_t size, const char *fmt, ...)
+{
+	if(buff==NULL || size==0) return 0;
+	va_list vl;
+	va_start(vl, fmt);
+	int nsize = vsnprintf(buff, size, fmt, vl);
+	va_end(vl);
+	if(nsize<0) { buff[0]='\0'; return 0; }
+	return ((size_t)nsize<size)?nsize:(int)(size-1);
+}
+
+/**
+ * Format a string like printf() in a thread-local buffer
+ *
+ * \warning The returned pointer is only valid until the next call
+ * to tls_format() from the same thread. The string is truncated to
+ * EWBTRACE_TLS_BSIZE-1 characters.
+ */
+const char* EWBTrace::tls_format(const char *fmt, ...)
+{
+	va_list vl;
+	va_start(vl, fmt);
+	int nsize = vsnprintf(tlsBuff, sizeof(tlsBuff), fmt, vl);
+	va_end(vl);
+	if(nsize<0) tlsBuff[0]='\0';
+	return tlsBuff;
+}
+
+/**
+ * Format a string like printf() directly into a stream
+ *
+ * The string is formatted on the stack and written to the stream
+ * so that no allocation is performed for lines shorter than
+ * EWBTRACE_TLS_BSIZE.
+ *
+ * \param[inout] o The output stream
+ * \param[in] fmt The printf() format
+ * \return the given stream
+ */
+std::ostream& EWBTrace::stream_format(std::ostream &o, const char *fmt, ...)
+{
+	char buffer[EWBTRACE_TLS_BSIZE];
+	va_list vl, vl2;
+	va_start(vl, fmt);
+	va_copy(vl2, vl);
+	int nsize = vsnprintf(buffer, sizeof(buffer), fmt, vl);
+	va_end(vl);
+	if(nsize>0 && (size_t)nsize<sizeof(buffer))
+	{
+		o.write(buffer,nsize);
+	}
+	else if(nsize>0)
+	{
+		//Rare case of a very long line
+		std::vector<char> big(nsize+1);
+		vsnprintf(&big[0], big.size(), fmt, vl2);
+		o.write(&big[0],nsize);
+	}
+	va_end(vl2);
+	return o;
+}
+
+/**
+ * Set the runtime trace level of a module
+ *
+ * The traces above TRACE_LEVEL have not been compiled and
+ * will never be output even if the runtime level is higher.
+ *
+ * \param[in] module One of the \ref EWBTraceModule or EWB_TRACE_NMODULES to set all of them.
+ * \param[in] level The new level (TRACE_LEVEL_NO_TRACE to TRACE_LEVEL_VVDEBUG)
+ * \return true if the module and the level are valid, false otherwise.
+ */
+bool EWBTrace::setLevel(int module, int level)
+{
+	if(level<TRACE_LEVEL_NO_TRACE || level>TRACE_LEVEL_VVDEBUG) return false;
+	if(module==EWB_TRACE_NMODULES)
+	{
+		for(int i=0;i<EWB_TRACE_NMODULES;i++) ewbTraceLevels[i].store(level,std::memory_order_relaxed);
+		return true;
+	}
+	if(module<0 || module>=EWB_TRACE_NMODULES) return false;
+	ewbTraceLevels[module].store(level,std::memory_order_relaxed);
+	return true;
+}
+
+/**
+ * Get the runtime trace level of a module (-1 if the module does not exist)
+ */
+int EWBTrace::getLevel(int module)
+{
+	if(module<0 || module>=EWB_TRACE_NMODULES) return -1;
+	return ewbTraceLevels[module].load(std::memory_order_relaxed);
+}
+
+/**
+ * Find a module by its name
+ *
+ * \param[in] name The name of the module ("core", "bridge", "asyn", "console") or "all"
+ * \return the \ref EWBTraceModule, EWB_TRACE_NMODULES for "all" or -1 if not found.
+ */
+int EWBTrace::findModule(const char *name)
+{
+	if(name==NULL) return -1;
+	if(strcmp(name,"all")==0) return EWB_TRACE_NMODULES;
+	for(int i=0;i<EWB_TRACE_NMODULES;i++)
+	{
+		if(strcmp(name,traceModuleNames[i])==0) return i;
+	}
+	return -1;
+}
+
+/**
+ * Get the name of a module (NULL if the module does not exist)
+ */
+const char* EWBTrace::getModuleName(int module)
+{
+	if(module<0 || module>=EWB_TRACE_NMODULES) return NULL;
+	return traceModuleNames[module];
+}
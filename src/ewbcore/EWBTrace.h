@@ -19,6 +19,8 @@
 //         Global Definitions
 //------------------------------------------------------------------------------
 
+#define TRACE_LEVEL_VVDEBUG    7
+#define TRACE_LEVEL_VDEBUG     6
 #define TRACE_LEVEL_DEBUG      5
 #define TRACE_LEVEL_INFO       4
 #define TRACE_LEVEL_WARNING    3
@@ -26,14 +28,39 @@
 #define TRACE_LEVEL_FATAL      1
 #define TRACE_LEVEL_NO_TRACE   0
 
-// By default, all traces are output except the debug one.
+// By default, trace level is dynamic (can be changed at runtime per module)
+#if !defined(DYN_TRACES)
+#define DYN_TRACES 1
+#endif
+
+// TRACE_LEVEL is the highest level compiled in the binary:
+// all levels when dynamic, all except the verbose ones when static.
 #if !defined(TRACE_LEVEL)
+#if (DYN_TRACES==1)
+#define TRACE_LEVEL TRACE_LEVEL_VVDEBUG
+#else
 #define TRACE_LEVEL TRACE_LEVEL_DEBUG
 #endif
+#endif
 
-// By default, trace level is static (not dynamic)
-#if !defined(DYN_TRACES)
-#define DYN_TRACES 0
+// Runtime level given to each module at startup (dynamic only)
+#if !defined(TRACE_LEVEL_DEFAULT)
+#define TRACE_LEVEL_DEFAULT TRACE_LEVEL_DEBUG
+#endif
+
+//! Modules that have their own runtime trace level
+enum EWBTraceModule {
+	EWB_TRACE_CORE=0,	//!< ewbcore library (tree, fields, sync)
+	EWB_TRACE_BRIDGE,	//!< ewbbridge library (memory access to the device)
+	EWB_TRACE_ASYN,		//!< ewbasyn library (asyn port driver)
+	EWB_TRACE_CONSOLE,	//!< Command consoles and string parameters
+	EWB_TRACE_NMODULES
+};
+
+// The module of the traces is selected by defining EWB_TRACE_MODULE
+// in the source file before including EWBTrace.h
+#if !defined(EWB_TRACE_MODULE)
+#define EWB_TRACE_MODULE EWB_TRACE_CORE
 #endif
 
 #if defined(NOTRACE)
@@ -41,18 +68,30 @@
 #endif
 
 #undef NOTRACE
-#if (DYN_TRACES==0)
-    #if (TRACE_LEVEL == TRACE_LEVEL_NO_TRACE)
-        #define NOTRACE
-    #endif
+#if (TRACE_LEVEL == TRACE_LEVEL_NO_TRACE)
+    #define NOTRACE
 #endif
 
 //------------------------------------------------------------------------------
 //         Global Macros
 //------------------------------------------------------------------------------
 
+#if defined(__GNUC__)
+#define TRACE_UNLIKELY(x) __builtin_expect(!!(x),0)
+#else
+#define TRACE_UNLIKELY(x) (x)
+#endif
 
-
+//------------------------------------------------------------------------------
+/// Return true when the trace of this level is output for the current module.
+/// When dynamic this is a single load & compare (the formatting is never
+/// performed when the level is disabled).
+//------------------------------------------------------------------------------
+#if (DYN_TRACES==1)
+#define TRACE_ENABLED(level) TRACE_UNLIKELY(ewbTraceLevels[EWB_TRACE_MODULE].load(std::memory_order_relaxed) >= (level))
+#else
+#define TRACE_ENABLED(level) (TRACE_LEVEL >= (level))
+#endif
 
 
 //------------------------------------------------------------------------------
@@ -64,6 +103,9 @@
 #if defined(NOTRACE)
 
 // Empty macro
+#define TRACE(level,...)        { }
+#define TRACE_P_VVDEBUG(...)    { }
+#define TRACE_P_VDEBUG(...)     { }
 #define TRACE_P_DEBUG(...)      { }
 #define TRACE_P_INFO(...)       { }
 #define TRACE_P_WARNING(...)    { }
@@ -74,27 +116,8 @@
 
 #define TRACE_FILE stderr
 
-#endif
-
-
-
-
-#if defined(DYN_TRACES_EDES)
-
-// Trace output depends on traceLevel value
-#define TRACE(level,prefix,...) { if (traceLevel >= level) { errlogPrintf(prefix __VA_ARGS__); } }
-
-
-#define TRACE_P_DEBUG(...)      TRACE(TRACE_LEVEL_DEBUG,   "-D- ", __VA_ARGS__)
-#define TRACE_P_INFO(...)       TRACE(TRACE_LEVEL_INFO,    "-I- ", __VA_ARGS__)
-#define TRACE_P_WARNING(...)    TRACE(TRACE_LEVEL_WARNING, "-W- ", __VA_ARGS__)
-#define TRACE_P_ERROR(...)      TRACE(TRACE_LEVEL_ERROR,   "-E- ", __VA_ARGS__)
-#define TRACE_P_FATAL(...)      { TRACE(TRACE_LEVEL_FATAL, "-F- ", __VA_ARGS__); while(1); }
-
-#else
-
-// Trace output depends on traceLevel value
-#define TRACE(level,...) { if (TRACE_LEVEL >= level) { errlogPrintf(__VA_ARGS__); } }
+// Trace output depends on the level of the module
+#define TRACE(level,...) { if (TRACE_ENABLED(level)) { errlogPrintf(__VA_ARGS__); } }
 
 #define END_PRINT errlogPrintf("\n")
 #define S(x) #x
@@ -107,35 +130,47 @@
 	#define MYLINE
 #endif
 
-#define TRACE_P_PRINT(lvlstr,...) { BEG_PRINT(lvlstr); errlogPrintf(MYLINE __VA_ARGS__); END_PRINT; }
+#define TRACE_P_PRINT(level,lvlstr,...) { if (TRACE_ENABLED(level)) { BEG_PRINT(lvlstr); errlogPrintf(MYLINE __VA_ARGS__); END_PRINT; } }
 
 // Trace compilation depends on TRACE_LEVEL value
+#if (TRACE_LEVEL >= TRACE_LEVEL_VVDEBUG)
+#define TRACE_P_VVDEBUG(...) TRACE_P_PRINT(TRACE_LEVEL_VVDEBUG,"-V- ",__VA_ARGS__)
+#else
+#define TRACE_P_VVDEBUG(...)    { }
+#endif
+
+#if (TRACE_LEVEL >= TRACE_LEVEL_VDEBUG)
+#define TRACE_P_VDEBUG(...) TRACE_P_PRINT(TRACE_LEVEL_VDEBUG,"-V- ",__VA_ARGS__)
+#else
+#define TRACE_P_VDEBUG(...)     { }
+#endif
+
 #if (TRACE_LEVEL >= TRACE_LEVEL_DEBUG)
-#define TRACE_P_DEBUG(...) TRACE_P_PRINT("-D- ",__VA_ARGS__)
+#define TRACE_P_DEBUG(...) TRACE_P_PRINT(TRACE_LEVEL_DEBUG,"-D- ",__VA_ARGS__)
 #else
 #define TRACE_P_DEBUG(...)      { }
 #endif
 
 #if (TRACE_LEVEL >= TRACE_LEVEL_INFO)
-#define TRACE_P_INFO(...)       TRACE_P_PRINT("-I- ",__VA_ARGS__)
+#define TRACE_P_INFO(...)       TRACE_P_PRINT(TRACE_LEVEL_INFO,"-I- ",__VA_ARGS__)
 #else
 #define TRACE_P_INFO(...)       { }
 #endif
 
 #if (TRACE_LEVEL >= TRACE_LEVEL_WARNING)
-#define TRACE_P_WARNING(...)    TRACE_P_PRINT("-W- ",__VA_ARGS__)
+#define TRACE_P_WARNING(...)    TRACE_P_PRINT(TRACE_LEVEL_WARNING,"-W- ",__VA_ARGS__)
 #else
 #define TRACE_P_WARNING(...)    { }
 #endif
 
 #if (TRACE_LEVEL >= TRACE_LEVEL_ERROR)
-#define TRACE_P_ERROR(...)     TRACE_P_PRINT("-E- ",__VA_ARGS__)
+#define TRACE_P_ERROR(...)     TRACE_P_PRINT(TRACE_LEVEL_ERROR,"-E- ",__VA_ARGS__)
 #else
 #define TRACE_P_ERROR(...)      { }
 #endif
 
 #if (TRACE_LEVEL >= TRACE_LEVEL_FATAL)
-#define TRACE_P_FATAL(...)      { TRACE_P_PRINT("-F- ",__VA_ARGS__) while(1); }
+#define TRACE_P_FATAL(...)      { TRACE_P_PRINT(TRACE_LEVEL_FATAL,"-F- ",__VA_ARGS__) while(1); }
 #else
 #define TRACE_P_FATAL(...)      { while(1); }
 #endif
@@ -149,13 +184,16 @@
 //------------------------------------------------------------------------------
 //         Exported variables
 //------------------------------------------------------------------------------
-// Depending on DYN_TRACES, traceLevel is a modifable runtime variable
-// or a define
-#if !defined(NOTRACE) && (DYN_TRACES == 1)
-    extern unsigned int traceLevel;
-#endif
+#include <atomic>
+
+//! Runtime trace level of each module (see \ref EWBTraceModule), set by the IOC shell while read by all the threads
+extern std::atomic<int> ewbTraceLevels[EWB_TRACE_NMODULES];
 
 #include <sstream>
+#include <cstddef>
+
+//! Size of the thread-local buffer used by EWBTrace::tls_format()
+#define EWBTRACE_TLS_BSIZE 512
 
 
 /**
@@ -173,6 +211,14 @@ class EWBTrace {
         }
 
         static std::string string_format(const std::string &fmt, ...);
+        static int buff_format(char *buff, size_t size, const char *fmt, ...);
+        static const char* tls_format(const char *fmt, ...);
+        static std::ostream& stream_format(std::ostream &o, const char *fmt, ...);
+
+        static bool setLevel(int module, int level);
+        static int getLevel(int module);
+        static int findModule(const char *name);
+        static const char* getModuleName(int module);
 
 
     private:
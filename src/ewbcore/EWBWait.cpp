@@ -0,0 +1,184 @@
+/*
+ * EWBWait.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBWait.h"
+
+#include "EWBBridge.h"
+#include "EWBPeriph.h"
+#include "EWBReg.h"
+#include "EWBField.h"
+#include "EWBHeatmap.h"
+#include "EWBTrace.h"
+
+#include <thread>
+#include <chrono>
+#include <algorithm>
+
+std::mutex EWBWait::mtx;
+std::map<EWBReg*,EWBWait::PollPtr> EWBWait::polls;
+std::atomic<uint32_t> EWBWait::nspins(4);
+std::atomic<uint32_t> EWBWait::nyields(16);
+std::atomic<uint32_t> EWBWait::sleep_min_us(10);
+std::atomic<uint32_t> EWBWait::sleep_max_us(1000);
+std::atomic<uint64_t> EWBWait::nwaits(0);
+std::atomic<uint64_t> EWBWait::nreads(0);
+std::atomic<uint64_t> EWBWait::nshared(0);
+std::atomic<uint64_t> EWBWait::ntimeouts(0);
+
+/**
+ * Wait until the value of a field meets a condition
+ *
+ * \param[in] pFld The field.
+ * \param[in] pred The condition on the raw value of the field (called with the internal lock, keep it short).
+ * \param[in] timeout_us The maximum time to wait (us).
+ * \param[out] pRes If not NULL, the last value and the bus usage of the wait.
+ * \return true if the condition was met, false on timeout or when the read failed.
+ */
+bool EWBWait::waitFor(EWBField *pFld, const Predicate &pred, uint32_t timeout_us, Result *pRes)
+{
+	TRACE_CHECK_PTR(pFld,false);
+	return wait(pFld->getReg(),pFld,pred,timeout_us,pRes);
+}
+
+/**
+ * Wait until the value of a register meets a condition
+ *
+ * \copydetails waitFor(EWBField*,const Predicate&,uint32_t,Result*)
+ */
+bool EWBWait::waitFor(EWBReg *pReg, const Predicate &pred, uint32_t timeout_us, Result *pRes)
+{
+	return wait(pReg,NULL,pred,timeout_us,pRes);
+}
+
+/**
+ * Configure the backoff between the reads
+ *
+ * The waits in progress use the new values at their next read.
+ *
+ * \param[in] nspins The number of reads performed back to back.
+ * \param[in] nyields The number of reads performed after yielding the CPU.
+ * \param[in] sleep_min_us The first sleep between the next reads (doubled at each read).
+ * \param[in] sleep_max_us The maximum sleep between two reads.
+ */
+void EWBWait::setBackoff(uint32_t nspins, uint32_t nyields, uint32_t sleep_min_us, uint32_t sleep_max_us)
+{
+	sleep_min_us=std::max(sleep_min_us,1U);
+	EWBWait::nspins=nspins;
+	EWBWait::nyields=nyields;
+	EWBWait::sleep_min_us=sleep_min_us;
+	EWBWait::sleep_max_us=std::max(sleep_max_us,sleep_min_us);
+}
+
+/**
+ * Wait between two reads of a poll (never after t_end)
+ */
+void EWBWait::backoff(uint32_t niter, uint64_t t_end)
+{
+	uint32_t ns=nspins, ny=nyields;
+	if(niter<ns) return;
+	if(niter-ns<ny)
+	{
+		std::this_thread::yield();
+		return;
+	}
+
+	uint32_t n=std::min(niter-ns-ny,31U);
+	uint64_t us=std::min((uint64_t)sleep_min_us.load()<<n,(uint64_t)sleep_max_us.load());
+	uint64_t now=EWBBridgeStats::now_ns();
+	if(now>=t_end) return;
+	std::this_thread::sleep_for(std::chrono::nanoseconds(std::min(us*1000,t_end-now)));
+}
+
+/**
+ * Wait on a register, the first waiter polls it for all the others
+ */
+bool EWBWait::wait(EWBReg *pReg, const EWBField *pFld, const Predicate &pred, uint32_t timeout_us, Result *pRes)
+{
+	TRACE_CHECK_PTR(pReg,false);
+	EWBBridge *pBgd;
+	uint32_t addr;
+	TRACE_CHECK_VA(pReg->resolve(&pBgd,&addr),false,"%s is not valid",pReg->getCName());
+	TRACE_CHECK_VA(pBgd->inCycle()==false,false,"%s: can not wait inside a cycle",pReg->getCName());
+	uint32_t mask=(pFld)?pFld->getMask():0xFFFFFFFF;
+	uint64_t t0=EWBBridgeStats::now_ns(), t_end=t0+(uint64_t)timeout_us*1000;
+	Result res={ 0, 0, 0, 0 };
+	bool ret=false, done=false, poller=false;
+	uint32_t niter=0;
+
+	std::unique_lock<std::mutex> lock(mtx);
+	PollPtr &ref=polls[pReg];
+	if(ref) nshared++;
+	else ref=PollPtr(new Poll());
+	PollPtr p=ref;
+	p->nwaiters++;
+	nwaits++;
+
+	//Only the values read after the beginning of the wait are checked
+	uint64_t seen=p->seq;
+	while(!done)
+	{
+		if(p->polling==false) poller=p->polling=true;
+		if(poller)
+		{
+			lock.unlock();
+			uint32_t val=0;
+			uint64_t t1=(EWBHeatmap::isEnabled())?EWBBridgeStats::now_ns():0;
+			bool ok=pBgd->mem_access(addr,&val,false);
+			if(t1) EWBHeatmap::getInstance().record(pReg,addr,1,0,EWBBridgeStats::now_ns()-t1);
+			lock.lock();
+			p->value=val;
+			p->ok=ok;
+			p->seq++;
+			res.nreads++;
+			nreads++;
+			p->cv.notify_all();
+		}
+		else
+		{
+			uint64_t now=EWBBridgeStats::now_ns();
+			if(now<t_end) p->cv.wait_for(lock,std::chrono::nanoseconds(t_end-now),[&]() { return p->seq!=seen || !p->polling; });
+		}
+
+		if(p->seq!=seen)
+		{
+			seen=p->seq;
+			res.nvalues++;
+			if(pFld) pFld->regCvt(&res.value,&p->value,true);
+			else res.value=p->value;
+			if(p->ok==false) done=true;
+			else if(pred(res.value))
+			{
+				pReg->data=(pReg->data & ~mask) | (p->value & mask);
+				ret=done=true;
+			}
+		}
+		if(!done && EWBBridgeStats::now_ns()>=t_end)
+		{
+			ntimeouts++;
+			done=true;
+		}
+		if(!done && poller)
+		{
+			lock.unlock();
+			backoff(niter++,t_end);
+			lock.lock();
+		}
+	}
+
+	//Another waiter takes over the poll
+	if(poller)
+	{
+		p->polling=false;
+		p->cv.notify_all();
+	}
+	if(--p->nwaiters==0) polls.erase(pReg);
+	lock.unlock();
+
+	res.wait_ns=EWBBridgeStats::now_ns()-t0;
+	if(pRes) *pRes=res;
+	if(ret==false) TRACE_P_DEBUG("%s: wait failed after %d us (value=0x%x)",pReg->getCName(),(int)(res.wait_ns/1000),res.value);
+	return ret;
+}
@@ -0,0 +1,86 @@
+/*
+ * EWBWait.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef EWBWAIT_H_
+#define EWBWAIT_H_
+
+#include <stdint.h>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+class EWBReg;
+class EWBField;
+
+/**
+ * Wait until a field (or a register) of the device meets a condition
+ *
+ * The value is polled with an adaptive backoff: the first reads are
+ * performed back to back (spin), then the thread yields between them and
+ * finally sleeps with a delay that doubles up to a maximum. The timeout
+ * is checked after each read so that a wait never lasts more than the
+ * timeout plus one access.
+ *
+ * The waits on the same register share the same poll: only one thread
+ * reads the register and each value read is checked by all the waiters.
+ *
+ * \note A wait is refused inside a cycle of the bridge, its reads would
+ * only be performed at closeCycle().
+ *
+ * \code
+ * //Wait at most 10ms for the end of the reset
+ * if(!EWBWait::waitFor(pFldReset,[](uint32_t v) { return v==0; },10000)) error();
+ * \endcode
+ */
+class EWBWait {
+public:
+	//! Condition on the raw value of the field (or the register)
+	typedef std::function<bool(uint32_t)> Predicate;
+
+	//! Result of a wait
+	struct Result {
+		uint32_t value;		//!< Last value of the field
+		uint32_t nreads;	//!< Number of reads performed by this wait
+		uint32_t nvalues;	//!< Number of values checked (including the ones read by other waits)
+		uint64_t wait_ns;	//!< Duration of the wait
+	};
+
+	static bool waitFor(EWBField *pFld, const Predicate &pred, uint32_t timeout_us, Result *pRes=NULL);
+	static bool waitFor(EWBReg *pReg, const Predicate &pred, uint32_t timeout_us, Result *pRes=NULL);
+
+	static void setBackoff(uint32_t nspins, uint32_t nyields, uint32_t sleep_min_us, uint32_t sleep_max_us);
+
+	static uint64_t getNWaits() { return nwaits; }			//!< Number of waits
+	static uint64_t getNReads() { return nreads; }			//!< Number of reads performed by the waits
+	static uint64_t getNShared() { return nshared; }		//!< Number of waits that joined the poll of another
+	static uint64_t getNTimeouts() { return ntimeouts; }	//!< Number of waits that timed out
+
+private:
+	//! Poll of a register shared by its waiters
+	struct Poll {
+		Poll(): value(0), ok(true), seq(0), polling(false), nwaiters(0) {}
+		uint32_t value;		//!< Last value read
+		bool ok;			//!< Status of the last read
+		uint64_t seq;		//!< Number of values read
+		bool polling;		//!< true while a waiter is polling the register
+		int nwaiters;		//!< Number of threads waiting on this register
+		std::condition_variable cv;	//!< Notified at each new value
+	};
+	typedef std::shared_ptr<Poll> PollPtr;
+
+	static bool wait(EWBReg *pReg, const EWBField *pFld, const Predicate &pred, uint32_t timeout_us, Result *pRes);
+	static void backoff(uint32_t niter, uint64_t t_end);
+
+	static std::mutex mtx;					//!< Protect the polls
+	static std::map<EWBReg*,PollPtr> polls;	//!< Polls in progress
+	static std::atomic<uint32_t> nspins, nyields, sleep_min_us, sleep_max_us;	//!< Backoff (see setBackoff())
+	static std::atomic<uint64_t> nwaits, nreads, nshared, ntimeouts;
+};
+
+#endif /* EWBWAIT_H_ */
@@ -0,0 +1,118 @@
+/*
+ * ewbd.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Local Wishbone access daemon: owns a bridge and shares it
+ * with the local processes using EWBMemDaemonCon.
+ *
+ * Usage:
+ * 		ewbd [-s socket] [-v level] bridge
+ *
+ * Where bridge is one of:
+ * 		- x1052:<idPCIe>
+ * 		- mmio:<resource file or /dev/uioN>[@wb_base]
+ * 		- eb:<udp/host/port>
+ * 		- ram
+ */
+
+#include "EWBDaemon.h"
+#include "EWBBgdRAM.h"
+#include "EWBBgdMMIO.h"
+#include "EWBBgdEtherbone.h"
+#ifndef EWBPD_NO_X1052
+#include "EWBBgdX1052.h"
+#endif
+
+#define EWB_TRACE_MODULE EWB_TRACE_BRIDGE
+#include "EWBTrace.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <csignal>
+#include <unistd.h>
+
+static volatile sig_atomic_t quit=0;
+
+static void on_signal(int /*sig*/)
+{
+	quit=1;
+}
+
+static void usage(const char *prog)
+{
+	fprintf(stderr,"Usage: %s [-s socket] [-v level] bridge\n\n",prog);
+	fprintf(stderr,"  -s socket   path of the Unix socket (default: %s)\n",EWBD_SOCKET);
+	fprintf(stderr,"  -v level    trace level (0..7)\n");
+	fprintf(stderr,"  bridge      x1052:<id>, mmio:<file>[@wb_base], eb:<udp/host/port> or ram\n");
+}
+
+/**
+ * Create the bridge from its description
+ */
+static EWBBridge* createBridge(const std::string &desc)
+{
+	size_t pos=desc.find(':');
+	std::string type=desc.substr(0,pos), arg=(pos==std::string::npos)?"":desc.substr(pos+1);
+
+	if(type=="ram") return new EWBMemRAMCon();
+	if(type=="eb") return new EWBEtherboneCon(arg);
+	if(type=="mmio")
+	{
+		uint32_t base=0;
+		if((pos=arg.find('@'))!=std::string::npos)
+		{
+			base=strtoul(arg.substr(pos+1).c_str(),NULL,0);
+			arg=arg.substr(0,pos);
+		}
+		return new EWBMemMMIOCon(arg,0,base);
+	}
+#ifndef EWBPD_NO_X1052
+	if(type=="x1052") return new EWBMemX1052Con(atoi(arg.c_str()));
+#endif
+	return NULL;
+}
+
+int main(int argc, char **argv)
+{
+	std::string path=EWBD_SOCKET;
+	int opt;
+
+	while((opt=getopt(argc,argv,"s:v:h"))!=-1)
+	{
+		switch(opt)
+		{
+		case 's': path=optarg; break;
+		case 'v': EWBTrace::setLevel(EWB_TRACE_NMODULES,atoi(optarg)); break;
+		default: usage(argv[0]); return 1;
+		}
+	}
+	if(optind>=argc) { usage(argv[0]); return 1; }
+
+	EWBBridge *pBridge=createBridge(argv[optind]);
+	if(pBridge==NULL || pBridge->isValid()==false)
+	{
+		TRACE_P_ERROR("Can not open the bridge %s",argv[optind]);
+		delete pBridge;
+		return 2;
+	}
+
+	EWBDaemon daemon(pBridge,path);
+	if(daemon.isValid()==false)
+	{
+		delete pBridge;
+		return 3;
+	}
+
+	signal(SIGINT,on_signal);
+	signal(SIGTERM,on_signal);
+	while(quit==0)
+	{
+		if(daemon.runOnce(200)<0) break;
+	}
+
+	TRACE_P_INFO("%d rounds, %d ops, %d reads coalesced",(int)daemon.getNRounds(),(int)daemon.getNOps(),(int)daemon.getNCoalesced());
+	pBridge->report(std::cout,1);
+	delete pBridge;
+	return 0;
+}
@@ -0,0 +1,111 @@
+/*
+ * EWBAccessPlanner_test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBAccessPlanner.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(EWBAccessPlanner,SinglesOnly)
+{
+	//Without block and with equal costs only singles are used
+	EWBAccessPlanner p1(EWBLatencyModel::singles());
+	EWBAccessPlanner p2(EWBLatencyModel(0,0,0,0,0x8000));
+	for(uint32_t a=0;a<0x20;a+=4) { p1.add(a); p2.add(a); }
+	p1.add(0x4);
+	EXPECT_EQ(8,p1.size());
+
+	std::vector<EWBAccessPlanner::Access> plan=p1.plan(false);
+	ASSERT_EQ(8,plan.size());
+	for(size_t i=0;i<plan.size();i++) EXPECT_FALSE(plan[i].block);
+	EXPECT_EQ(8,p2.plan(true).size());
+}
+
+TEST(EWBAccessPlanner,X1052)
+{
+	//2us per single, a block of <=0x80 bytes costs 10.64us
+	EWBAccessPlanner p(EWBLatencyModel::X1052());
+	uint64_t cost=0;
+
+	//Four registers are cheaper one by one
+	for(uint32_t a=0x100;a<0x110;a+=4) p.add(a);
+	std::vector<EWBAccessPlanner::Access> plan=p.plan(false,&cost);
+	EXPECT_EQ(4,plan.size());
+	EXPECT_EQ(8000,cost);
+
+	//But not eight
+	for(uint32_t a=0x110;a<0x120;a+=4) p.add(a);
+	plan=p.plan(false,&cost);
+	ASSERT_EQ(1,plan.size());
+	EXPECT_TRUE(plan[0].block);
+	EXPECT_EQ(0x100,plan[0].addr);
+	EXPECT_EQ(0x20,plan[0].nsize);
+	EXPECT_LT(cost,p.getSinglesCost(false));
+
+	//Far registers are kept alone
+	p.add(0x4000);
+	plan=p.plan(false);
+	ASSERT_EQ(2,plan.size());
+	EXPECT_FALSE(plan[1].block);
+	EXPECT_EQ(0x4000,plan[1].addr);
+
+	//The writes are never padded to the minimum size
+	plan=p.plan(true);
+	EXPECT_EQ(9,plan.size());
+}
+
+TEST(EWBAccessPlanner,Holes)
+{
+	EWBLatencyModel m(3000,4000,0,0,0x1000);
+	EWBAccessPlanner p(m);
+	p.add(0x0); p.add(0x4); p.add(0x10); p.add(0x14);
+
+	//The read covers the hole, the write does not
+	std::vector<EWBAccessPlanner::Access> plan=p.plan(false);
+	ASSERT_EQ(1,plan.size());
+	EXPECT_EQ(0x18,plan[0].nsize);
+	plan=p.plan(true);
+	ASSERT_EQ(2,plan.size());
+	EXPECT_EQ(0x10,plan[1].addr);
+	EXPECT_EQ(0x8,plan[1].nsize);
+
+	//An excluded address splits the read
+	p.exclude(0x8);
+	plan=p.plan(false);
+	ASSERT_EQ(2,plan.size());
+	EXPECT_TRUE(plan[0].block);
+	EXPECT_EQ(0x8,plan[0].nsize);
+
+	//A single address is never in a block
+	p.add(0x4,true);
+	plan=p.plan(false);
+	ASSERT_EQ(3,plan.size());
+	EXPECT_FALSE(plan[0].block);
+	EXPECT_FALSE(plan[1].block);
+	EXPECT_TRUE(plan[2].block);
+}
+
+TEST(EWBAccessPlanner,LargePeriph)
+{
+	//The blocks are extended up to their maximum size
+	EWBLatencyModel m=EWBLatencyModel::X1052();
+	EWBAccessPlanner p(m);
+	for(uint32_t a=0;a<0x40000;a+=4) p.add(a);
+	p.exclude(0x40000);
+	uint64_t cost=0;
+	std::vector<EWBAccessPlanner::Access> plan=p.plan(false,&cost);
+	ASSERT_EQ(8,plan.size());
+	for(size_t i=0;i<plan.size();i++)
+	{
+		EXPECT_TRUE(plan[i].block);
+		EXPECT_EQ(i*0x8000,plan[i].addr);
+		EXPECT_EQ(0x8000,plan[i].nsize);
+	}
+	EXPECT_EQ(8*m.cost(true,0x8000,false),cost);
+	EXPECT_EQ(8,p.plan(true).size());
+}
+
+} // namespace
@@ -0,0 +1,405 @@
+/*
+ * EWBBgdEtherbone_test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBBgdEtherbone.h"
+#include "EWBBgdRAM.h"
+#include "EWBFakeEtherbone.h"
+#include "EWBBus.h"
+#include "EWBPeriph.h"
+#include "EWBReg.h"
+#include "EWBField.h"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+TEST(EWBEtherboneCon,Single)
+{
+	EWBMemRAMCon ram;
+	EWBFakeEtherbone srv(&ram);
+	EWBEtherboneCon eb(srv.getURL());
+	uint32_t val=0xCAFE;
+
+	ASSERT_TRUE(eb.isValid());
+	EXPECT_EQ(EWBBridge::ETHERBONE,eb.getType());
+
+	EXPECT_TRUE(eb.mem_access(0x100,&val,true));
+	EXPECT_EQ(0xCAFE,ram.peek(0x100));
+
+	ram.poke(0x104,0xBEEF);
+	EXPECT_TRUE(eb.mem_access(0x104,&val,false));
+	EXPECT_EQ(0xBEEF,val);
+	EXPECT_EQ(2,eb.getStats().getCount(EWBBridgeStats::SINGLE_W)+eb.getStats().getCount(EWBBridgeStats::SINGLE_R));
+}
+
+TEST(EWBEtherboneCon,Cycle)
+{
+	EWBMemRAMCon ram;
+	EWBFakeEtherbone srv(&ram);
+	EWBEtherboneCon eb(srv.getURL());
+	uint32_t wval[300], rval[300];
+	ASSERT_TRUE(eb.isValid());
+
+	for(int i=0;i<300;i++) ram.poke(0x8000+i*12,i);
+
+	//Mix writes and reads to scattered addresses
+	uint64_t npkts=eb.getNPackets();
+	EXPECT_TRUE(eb.openCycle());
+	for(int i=0;i<300;i++)
+	{
+		wval[i]=0x1000+i;
+		rval[i]=0;
+		EXPECT_TRUE(eb.mem_access(0x4000+i*4,&wval[i],true));
+		EXPECT_TRUE(eb.mem_access(0x8000+i*12,&rval[i],false));
+	}
+	EXPECT_EQ(0,rval[299]);	//Nothing done yet
+	EXPECT_TRUE(eb.closeCycle());
+
+	for(int i=0;i<300;i++)
+	{
+		EXPECT_EQ(0x1000+i,ram.peek(0x4000+i*4));
+		EXPECT_EQ(i,rval[i]);
+	}
+	//600 accesses packed in a few packets
+	EXPECT_GE(5,eb.getNPackets()-npkts);
+	EXPECT_EQ(300,eb.getStats().getCount(EWBBridgeStats::SINGLE_R));
+}
+
+TEST(EWBEtherboneCon,CycleOwner)
+{
+	EWBMemRAMCon ram;
+	EWBFakeEtherbone srv(&ram);
+	EWBEtherboneCon eb(srv.getURL());
+	ASSERT_TRUE(eb.isValid());
+
+	//The access of another thread waits for the end of the cycle
+	std::atomic<bool> done(false), other(true);
+	uint32_t val=0;
+	EXPECT_FALSE(eb.inCycle());
+	EXPECT_TRUE(eb.openCycle());
+	EXPECT_TRUE(eb.inCycle());
+	uint32_t wval=0x55;
+	EXPECT_TRUE(eb.mem_access(0x200,&wval,true));
+	std::thread th([&]() { other=eb.inCycle(); eb.mem_access(0x200,&val,false); done=true; });
+	usleep(20000);
+	EXPECT_FALSE(done);
+	EXPECT_TRUE(eb.closeCycle());
+	th.join();
+	EXPECT_EQ(0x55,val);
+	EXPECT_FALSE(other);	//The cycle is only seen by its owner
+	EXPECT_FALSE(eb.inCycle());
+
+	//and the cycle can only be closed once
+	EXPECT_FALSE(eb.closeCycle());
+}
+
+TEST(EWBEtherboneCon,BlockInCycleConcurrent)
+{
+	//Leaked if the threads are stuck, so that the test fails instead of hanging
+	EWBMemRAMCon *pRAM=new EWBMemRAMCon();
+	EWBFakeEtherbone *pSrv=new EWBFakeEtherbone(pRAM);
+	EWBEtherboneCon *pEB=new EWBEtherboneCon(pSrv->getURL(),0x400);
+	ASSERT_TRUE(pEB->isValid());
+
+	//A transfers blocks inside its cycle while B leases the buffer or uses its own
+	std::atomic<int> na(0), nb(0);
+	std::atomic<bool> go(false);
+	std::thread tha([&]() {
+		uint32_t val=0x1, wbuff[64]={ 0 };
+		while(!go) std::this_thread::yield();
+		for(int i=0;i<200;i++)
+		{
+			pEB->openCycle();
+			pEB->mem_access(0x0,&val,true);
+			usleep(100);
+			pEB->mem_block_xfer(0x100,sizeof(wbuff),wbuff,true);
+			pEB->closeCycle();
+			na++;
+		}
+	});
+	std::thread thb([&]() {
+		uint32_t rbuff[64];
+		while(!go) std::this_thread::yield();
+		for(int i=0;i<200;i++)
+		{
+			if(i%2) pEB->mem_block_xfer(0x100,sizeof(rbuff),rbuff,false);
+			else
+			{
+				//The buffer is used (i.e. filled) between the lease and the access
+				EWBBridge::BlockLease lease(pEB,false);
+				usleep(100);
+				lease.access(0x100,sizeof(rbuff));
+			}
+			nb++;
+		}
+	});
+
+	go=true;
+	for(int i=0;i<1000 && (na<200 || nb<200);i++) usleep(10000);
+	ASSERT_EQ(200,na);
+	ASSERT_EQ(200,nb);
+	tha.join();
+	thb.join();
+	delete pEB;
+	delete pSrv;
+	delete pRAM;
+}
+
+TEST(EWBEtherboneCon,Block)
+{
+	EWBMemRAMCon ram;
+	EWBFakeEtherbone srv(&ram);
+	EWBEtherboneCon eb(srv.getURL());
+	uint32_t *pData32, nwords=8192/4;
+	ASSERT_TRUE(eb.isValid());
+	eb.setWindow(4);
+
+	ASSERT_LE(8192,eb.get_block_buffer(&pData32,true));
+	for(uint32_t i=0;i<nwords;i++) pData32[i]=~i;
+	EXPECT_TRUE(eb.mem_block_access(0x10000,nwords*4,true));
+	for(uint32_t i=0;i<nwords;i++) ASSERT_EQ(~i,ram.peek(0x10000+i*4));
+
+	memset(pData32,0,nwords*4);
+	EXPECT_TRUE(eb.mem_block_access(0x10000,nwords*4,false));
+	for(uint32_t i=0;i<nwords;i++) ASSERT_EQ(~i,pData32[i]);
+}
+
+TEST(EWBEtherboneCon,Retry)
+{
+	EWBMemRAMCon ram;
+	EWBFakeEtherbone srv(&ram);
+	EWBEtherboneCon eb(srv.getURL());
+	uint32_t val=0;
+	ASSERT_TRUE(eb.isValid());
+	eb.setTimeout(20,2);
+
+	ram.poke(0x0,0x55);
+	srv.drop=1;
+	EXPECT_TRUE(eb.mem_access(0x0,&val,false));
+	EXPECT_EQ(0x55,val);
+	EXPECT_EQ(1,eb.getStats().getRetries(EWBBridgeStats::SINGLE_R));
+
+	srv.drop=10;
+	EXPECT_FALSE(eb.mem_access(0x0,&val,false));
+}
+
+//! RAM with an address that can not be accessed
+class EWBFaultyRAM: public EWBMemRAMCon {
+public:
+	bool mem_access(uint32_t addr, uint32_t *data, bool to_dev)
+	{
+		if(addr==0xBAD0) return false;
+		return EWBMemRAMCon::mem_access(addr,data,to_dev);
+	}
+};
+
+TEST(EWBEtherboneCon,AccessErrors)
+{
+	EWBFaultyRAM ram;
+	EWBFakeEtherbone srv(&ram);
+	EWBEtherboneCon eb(srv.getURL());
+	uint32_t val=0, rval[100];
+	ASSERT_TRUE(eb.isValid());
+
+	EXPECT_FALSE(eb.mem_access(0xBAD0,&val,false));
+
+	//The error stays in the shift register but is not part of the next cycles
+	for(int i=0;i<100;i++) ram.poke(0x1000+i*4,i);
+	EXPECT_TRUE(eb.openCycle());
+	for(int i=0;i<40;i++) EXPECT_TRUE(eb.mem_access(0x1000+i*4,&rval[i],false));
+	EXPECT_TRUE(eb.closeCycle());
+	EXPECT_EQ(39,rval[39]);
+	val=0x55;
+	EXPECT_TRUE(eb.mem_access(0x2000,&val,true));
+
+	//An error in the middle of a cycle (checked by an intermediate status read)
+	EXPECT_TRUE(eb.openCycle());
+	for(int i=0;i<100;i++) EXPECT_TRUE(eb.mem_access((i==10)?0xBAD0:0x1000+i*4,&rval[i],false));
+	EXPECT_FALSE(eb.closeCycle());
+	EXPECT_EQ(99,rval[99]);
+
+	EXPECT_TRUE(eb.mem_access(0x1000,&val,false));
+	EXPECT_EQ(0,val);
+}
+
+TEST(EWBEtherboneCon,RetryLostPacket)
+{
+	EWBMemRAMCon ram;
+	EWBFakeEtherbone srv(&ram);
+	EWBEtherboneCon eb(srv.getURL());
+	uint32_t rval[64];
+	ASSERT_TRUE(eb.isValid());
+	eb.setMTU(64);
+	eb.setWindow(64);
+	eb.setTimeout(20,2);
+
+	for(int i=0;i<64;i++) ram.poke(0x8000+i*12,i);
+
+	//Only the lost packet is sent again
+	uint64_t npkts=eb.getNPackets();
+	EXPECT_TRUE(eb.openCycle());
+	for(int i=0;i<64;i++) EXPECT_TRUE(eb.mem_access(0x8000+i*12,&rval[i],false));
+	EXPECT_TRUE(eb.closeCycle());
+	uint64_t nsent=eb.getNPackets()-npkts;
+	ASSERT_GT(nsent,2u);
+
+	srv.drop=1;
+	npkts=eb.getNPackets();
+	EXPECT_TRUE(eb.openCycle());
+	for(int i=0;i<64;i++) { rval[i]=0; EXPECT_TRUE(eb.mem_access(0x8000+i*12,&rval[i],false)); }
+	EXPECT_TRUE(eb.closeCycle());
+	EXPECT_EQ(nsent+1,eb.getNPackets()-npkts);
+	for(int i=0;i<64;i++) ASSERT_EQ((uint32_t)i,rval[i]);
+}
+
+TEST(EWBEtherboneCon,LostWrites)
+{
+	EWBMemRAMCon ram;
+	EWBFakeEtherbone srv(&ram);
+	EWBEtherboneCon eb(srv.getURL());
+	uint32_t wval[32];
+	ASSERT_TRUE(eb.isValid());
+	eb.setMTU(64);
+	eb.setWindow(8);
+	eb.setTimeout(20,2);
+
+	//W(A)=1 and W(A)=2 end in different packets, the writes are never reordered
+	for(int i=0;i<32;i++) wval[i]=i+1;
+	uint64_t npkts=eb.getNPackets();
+	EXPECT_TRUE(eb.openCycle());
+	for(int i=0;i<32;i++) EXPECT_TRUE(eb.mem_access((i%16==0)?0x0:0x100+i*8,&wval[(i%16==0)?i/16:i],true));
+	EXPECT_TRUE(eb.closeCycle());
+	EXPECT_EQ(2,ram.peek(0x0));
+	uint64_t nsent=eb.getNPackets()-npkts;
+	ASSERT_GT(nsent,2u);
+
+	//A lost packet with writes fails the cycle without being sent again
+	ram.poke(0x0,0);
+	srv.drop=1;
+	npkts=eb.getNPackets();
+	EXPECT_TRUE(eb.openCycle());
+	for(int i=0;i<32;i++) EXPECT_TRUE(eb.mem_access((i%16==0)?0x0:0x100+i*8,&wval[(i%16==0)?i/16:i],true));
+	EXPECT_FALSE(eb.closeCycle());
+	EXPECT_EQ(1,eb.getNPackets()-npkts);
+	EXPECT_EQ(0,ram.peek(0x0));
+	EXPECT_EQ(0,eb.getStats().getRetries(EWBBridgeStats::SINGLE_W));
+}
+
+TEST(EWBEtherboneCon,PeriphSync)
+{
+	EWBMemRAMCon ram;
+	EWBFakeEtherbone srv(&ram);
+	EWBEtherboneCon eb(srv.getURL());
+	EWBBus bus(&eb,0x10000);
+	EWBPeriph *pP = new EWBPeriph(&bus,"prh",0x100,0x1,0x2);
+	bus.appendPeriph(pP);
+	for(int i=0;i<64;i++)
+	{
+		ram.poke(0x10100+i*4,i*3);
+		new EWBReg(pP,"r"+std::to_string(i),i*4);
+	}
+
+	//The 64 reads of the peripheral are packed in one packet
+	uint64_t npkts=eb.getNPackets();
+	EXPECT_TRUE(((EWBSync*)pP)->sync(EWBSync::EWB_AM_R));
+	EXPECT_EQ(1,eb.getNPackets()-npkts);
+	EXPECT_EQ(63*3,pP->getReg(63*4)->getData());
+
+	//A field can not be written inside a cycle (its read-modify-write needs the value)
+	EWBField *pF=new EWBField(pP->getReg(0x8),"f",8,8);
+	uint32_t val=0x12;
+	pF->convert(&val,false);
+	EXPECT_TRUE(eb.openCycle());
+	EXPECT_FALSE(pF->sync(EWBSync::EWB_AM_W));
+	EXPECT_TRUE(eb.closeCycle());
+	EXPECT_EQ(6,ram.peek(0x10108));
+	EXPECT_TRUE(pF->sync(EWBSync::EWB_AM_W));
+	EXPECT_EQ(0x1206,ram.peek(0x10108));
+}
+
+TEST(EWBEtherboneCon,PlannedSyncConcurrentDMA)
+{
+	//Leaked if the threads are stuck, so that the test fails instead of hanging
+	EWBMemRAMCon *pRAM=new EWBMemRAMCon();
+	EWBFakeEtherbone *pSrv=new EWBFakeEtherbone(pRAM);
+	EWBEtherboneCon *pEB=new EWBEtherboneCon(pSrv->getURL());
+	EWBBus *pBus=new EWBBus(pEB,0x10000);
+	EWBPeriph *pA = new EWBPeriph(pBus,"prhA",0x100,0x1,0x2);
+	EWBPeriph *pB = new EWBPeriph(pBus,"prhB",0x1000,0x1,0x2);
+	pBus->appendPeriph(pA);
+	pBus->appendPeriph(pB);
+	for(int i=0;i<64;i++)
+	{
+		new EWBReg(pA,"r"+std::to_string(i),i*4);
+		new EWBReg(pB,"r"+std::to_string(i),i*4);
+	}
+	pEB->setCostModel(EWBLatencyModel::X1052());
+
+	//The planned writes of A transfer blocks inside a cycle while B leases the buffer
+	std::atomic<int> na(0), nb(0);
+	std::atomic<bool> go(false);
+	std::thread tha([&]() {
+		while(!go) std::this_thread::yield();
+		for(int i=0;i<100;i++) { ((EWBSync*)pA)->sync(EWBSync::EWB_AM_W); na++; }
+	});
+	std::thread thb([&]() {
+		while(!go) std::this_thread::yield();
+		for(int i=0;i<100;i++) { pB->sync(EWBSync::EWB_AM_RW,EWB_NODE_MEMBCK_OWNADDR); nb++; }
+	});
+
+	go=true;
+	for(int i=0;i<1000 && (na<100 || nb<100);i++) usleep(10000);
+	ASSERT_EQ(100,na);
+	ASSERT_EQ(100,nb);
+	tha.join();
+	thb.join();
+	EXPECT_LE(200,pEB->getStats().getCount(EWBBridgeStats::BLOCK_W));	//Blocks of A and B
+	delete pBus;
+	delete pEB;
+	delete pSrv;
+	delete pRAM;
+}
+
+TEST(EWBEtherboneCon,ChunkedSyncInCycle)
+{
+	EWBMemRAMCon ram;
+	EWBFakeEtherbone srv(&ram);
+	EWBEtherboneCon eb(srv.getURL(),0x100);
+	EWBBus bus(&eb,0x10000);
+	EWBPeriph *pP = new EWBPeriph(&bus,"prh",0x1000,0x1,0x2);
+	bus.appendPeriph(pP);
+	for(int i=0;i<256;i++)
+	{
+		ram.poke(0x11000+i*4,i*7);
+		new EWBReg(pP,"r"+std::to_string(i),i*4);
+	}
+
+	//The chunks are transfered by the caller that owns the cycle
+	EXPECT_TRUE(eb.openCycle());
+	EXPECT_TRUE(pP->sync(EWBSync::EWB_AM_R,EWB_NODE_MEMBCK_OWNADDR));
+	EXPECT_TRUE(pP->sync(EWBSync::EWB_AM_W,EWB_NODE_MEMBCK_OWNADDR));
+	EXPECT_TRUE(eb.closeCycle());
+	for(int i=0;i<256;i++) ASSERT_EQ((uint32_t)i*7,pP->getReg(i*4)->getData());
+}
+
+TEST(EWBEtherboneCon,NoDevice)
+{
+	EWBMemRAMCon ram;
+	uint16_t port;
+	{
+		EWBFakeEtherbone srv(&ram);
+		port=srv.getPort();
+	}
+	EWBEtherboneCon eb("127.0.0.1:"+std::to_string(port));
+	uint32_t val;
+	EXPECT_FALSE(eb.isValid());
+	EXPECT_FALSE(eb.mem_access(0x0,&val,false));
+}
+
+} //namespace
@@ -0,0 +1,88 @@
+/*
+ * EWBBgdMMIO_test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBBgdMMIO.h"
+#include "gtest/gtest.h"
+
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+namespace {
+
+/**
+ * Stand-in of a PCI BAR using a memfd
+ */
+class EWBMemMMIOConTest : public ::testing::Test {
+protected:
+	enum { BAR_SIZE=0x10000 };
+
+	virtual void SetUp()
+	{
+		fd=syscall(SYS_memfd_create,"bar0",0);
+		ASSERT_LE(0,fd);
+		ASSERT_EQ(0,ftruncate(fd,BAR_SIZE));
+		pBar=(uint32_t*)mmap(NULL,BAR_SIZE,PROT_READ | PROT_WRITE,MAP_SHARED,fd,0);
+		ASSERT_NE(MAP_FAILED,(void*)pBar);
+	}
+
+	virtual void TearDown()
+	{
+		munmap(pBar,BAR_SIZE);
+		close(fd);
+	}
+
+	int fd;
+	uint32_t *pBar;	//!< Device side view of the BAR
+};
+
+TEST_F(EWBMemMMIOConTest,Single)
+{
+	EWBMemMMIOCon bar(fd,BAR_SIZE,"memfd",0x80000);
+	uint32_t val=0x12345678;
+
+	ASSERT_TRUE(bar.isValid());
+	EXPECT_EQ(EWBBridge::RAWRABBIT,bar.getType());
+
+	EXPECT_TRUE(bar.mem_access(0x80010,&val,true));
+	EXPECT_EQ(0x12345678,pBar[0x10/4]);
+
+	pBar[0xFFFC/4]=0xCAFE;
+	EXPECT_TRUE(bar.mem_access(0x8FFFC,&val,false));
+	EXPECT_EQ(0xCAFE,val);
+
+	//Outside of the BAR
+	EXPECT_FALSE(bar.mem_access(0x90000,&val,false));
+	EXPECT_FALSE(bar.mem_access(0x7FFFC,&val,false));
+}
+
+TEST_F(EWBMemMMIOConTest,Block)
+{
+	EWBMemMMIOCon bar(fd,BAR_SIZE,"memfd");
+	uint32_t *pData32;
+	ASSERT_TRUE(bar.isValid());
+
+	ASSERT_LE(0x1000,bar.get_block_buffer(&pData32,true));
+	for(int i=0;i<0x400;i++) pData32[i]=i*7;
+	EXPECT_TRUE(bar.mem_block_access(0x1000,0x1000,true));
+	for(int i=0;i<0x400;i++) ASSERT_EQ(i*7,pBar[0x400+i]);
+
+	for(int i=0;i<0x400;i++) pBar[0x800+i]=~i;
+	EXPECT_TRUE(bar.mem_block_access(0x2000,0x1000,false));
+	for(int i=0;i<0x400;i++) ASSERT_EQ(~i,pData32[i]);
+
+	EXPECT_FALSE(bar.mem_block_access(0xF000,0x2000,false));
+}
+
+TEST(EWBMemMMIOCon,NoFile)
+{
+	EWBMemMMIOCon bar("/sys/bus/pci/devices/none/resource0");
+	uint32_t val;
+	EXPECT_FALSE(bar.isValid());
+	EXPECT_FALSE(bar.mem_access(0x0,&val,false));
+}
+
+} //namespace
@@ -0,0 +1,151 @@
+/*
+ * EWBBgdRAM_test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBBgdRAM.h"
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+
+TEST(EWBMemRAMCon,Single)
+{
+	EWBMemRAMCon ram("ram",0xDEADBEEF);
+	uint32_t val=0;
+
+	EXPECT_EQ(EWBBridge::RAM,ram.getType());
+	EXPECT_TRUE(ram.mem_access(0x1000,&val,false));
+	EXPECT_EQ(0xDEADBEEF,val);
+
+	val=0x12345678;
+	EXPECT_TRUE(ram.mem_access(0x1004,&val,true));
+	EXPECT_EQ(0x12345678,ram.peek(0x1004));
+	EXPECT_EQ(0xDEADBEEF,ram.peek(0x1008));
+	EXPECT_EQ(1,ram.getNPages());
+
+	ram.poke(0xFFFFFFFC,0xCAFE);
+	ram.poke(0x80000000,0xFACE);
+	EXPECT_EQ(0xCAFE,ram.peek(0xFFFFFFFC));
+	EXPECT_EQ(0xFACE,ram.peek(0x80000000));
+	EXPECT_EQ(3,ram.getNPages());
+
+	ram.clear();
+	EXPECT_EQ(0xDEADBEEF,ram.peek(0x1004));
+}
+
+TEST(EWBMemRAMCon,Block)
+{
+	EWBMemRAMCon ram;
+	uint32_t *pData32;
+	uint32_t bsize=ram.get_block_buffer(&pData32,true);
+	ASSERT_TRUE(pData32!=NULL);
+	EXPECT_EQ(0x8000,bsize);
+
+	//Write across a page boundary
+	for(int i=0;i<64;i++) pData32[i]=i;
+	EXPECT_TRUE(ram.mem_block_access(0x1F80,64*4,true));
+	EXPECT_EQ(2,ram.getNPages());
+	EXPECT_EQ(0,ram.peek(0x1F80));
+	EXPECT_EQ(31,ram.peek(0x1FFC));
+	EXPECT_EQ(32,ram.peek(0x2000));
+
+	//Read back
+	memset(pData32,0xFF,64*4);
+	EXPECT_TRUE(ram.mem_block_access(0x1F80,64*4,false));
+	for(int i=0;i<64;i++) EXPECT_EQ(i,pData32[i]);
+
+	//Too big for the buffer
+	EXPECT_FALSE(ram.mem_block_access(0x0,bsize+4,false));
+
+	EXPECT_EQ(1,ram.getStats().getCount(EWBBridgeStats::BLOCK_W));
+	EXPECT_EQ(2,ram.getStats().getCount(EWBBridgeStats::BLOCK_R));
+	EXPECT_EQ(1,ram.getStats().getErrors(EWBBridgeStats::BLOCK_R));
+}
+
+TEST(EWBMemRAMCon,Latency)
+{
+	EWBMemRAMCon ram;
+	uint32_t val=0, *pData32;
+	EWBLatencyModel x1052=EWBLatencyModel::X1052();
+
+	ram.setLatencyModel(x1052);
+	EXPECT_EQ(0,ram.getSimTime());
+
+	EXPECT_TRUE(ram.mem_access(0x0,&val,false));
+	EXPECT_EQ(x1052.op_ns,ram.getSimTime());
+
+	//Small blocks are padded to the minimum DMA size
+	ram.resetSimTime();
+	ram.get_block_buffer(&pData32,false);
+	EXPECT_TRUE(ram.mem_block_access(0x0,4,false));
+	EXPECT_EQ(x1052.cost(true,x1052.blk_minb,false),ram.getSimTime());
+
+	//A block of 16 registers must be cheaper than 16 singles
+	EXPECT_LT(x1052.cost(true,16*4,false),16*x1052.cost(false,4,false));
+
+	//Spin mode really waits
+	x1052.mode=EWBLatencyModel::SPIN;
+	ram.setLatencyModel(x1052);
+	uint64_t t0=EWBBridgeStats::now_ns();
+	EXPECT_TRUE(ram.mem_access(0x0,&val,false));
+	EXPECT_GE(EWBBridgeStats::now_ns()-t0,x1052.op_ns);
+}
+
+TEST(EWBMemRAMCon,Concurrent)
+{
+	//Each thread owns a range written with singles and read back by blocks
+	EWBMemRAMCon ram;
+	ram.setLatencyModel(EWBLatencyModel(0,0,0,0,0x100));
+	std::vector<std::thread> ths;
+	bool rets[4]={ false };
+	for(int t=0;t<4;t++)
+	{
+		ths.push_back(std::thread([&ram,&rets,t]() {
+			bool ok=true;
+			uint32_t base=0x10000*t, buff[0x200];
+			for(uint32_t i=0;i<0x200;i++)
+			{
+				uint32_t val=(t<<16)|i;
+				ok &= ram.mem_access(base+i*4,&val,true);
+			}
+			ok &= ram.mem_block_xfer(base,sizeof(buff),buff,false);
+			for(uint32_t i=0;i<0x200;i++) ok &= (buff[i]==((t<<16)|i));
+
+			//The internal buffer is leased
+			EWBBridge::BlockLease lease(&ram,false);
+			ok &= lease.access(base,0x100);
+			ok &= (lease.get()[0x3F]==(uint32_t)((t<<16)|0x3F));
+			rets[t]=ok;
+		}));
+	}
+	for(size_t i=0;i<ths.size();i++) ths[i].join();
+
+	for(int t=0;t<4;t++) EXPECT_TRUE(rets[t]);
+	EXPECT_EQ(4*0x200,ram.getStats().getCount(EWBBridgeStats::SINGLE_W));
+	EXPECT_EQ(4*(8+1),ram.getStats().getCount(EWBBridgeStats::BLOCK_R));
+	EXPECT_FALSE(ram.isBlockBusy());
+}
+
+TEST(EWBMemRAMCon,Calibrate)
+{
+	//The cost model follows the simulated latency
+	EWBMemRAMCon ram;
+	ram.setLatencyModel(EWBLatencyModel(20000,50000,100,0,0x1000,EWBLatencyModel::ACCOUNT));
+	EXPECT_EQ(20000,ram.getCostModel().op_ns);
+
+	//and the probe measures it again with the simulated time
+	ram.setCostModel(EWBLatencyModel(1,0,0,0,0x1000));
+	EXPECT_TRUE(ram.calibrate(0x0,0x1000,4));
+	const EWBLatencyModel &m=ram.getCostModel();
+	EXPECT_EQ(20000,m.op_ns);
+	EXPECT_EQ(50000,m.blk_op_ns);
+	EXPECT_FLOAT_EQ(100,m.byte_ns);
+	EXPECT_EQ(0x1000,m.blk_maxb);
+}
+
+} //namespace
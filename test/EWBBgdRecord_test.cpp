@@ -0,0 +1,174 @@
+/*
+ * EWBBgdRecord_test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBBgdRecord.h"
+#include "EWBBgdRAM.h"
+#include "EWBBus.h"
+#include "EWBPeriph.h"
+#include "EWBReg.h"
+#include "gtest/gtest.h"
+
+#include <cstdlib>
+#include <unistd.h>
+
+namespace {
+
+/**
+ * Temporary log file removed at the end of the test
+ */
+struct TmpLog {
+	TmpLog()
+	{
+		char tmp[]="/tmp/ewb_record_XXXXXX";
+		int fd=mkstemp(tmp);
+		if(fd>=0) close(fd);
+		fname=tmp;
+	}
+	~TmpLog() { unlink(fname.c_str()); }
+	std::string fname;
+};
+
+/**
+ * Record a workload on a RAM image: singles, a cycle and blocks
+ */
+static void recordWorkload(const std::string &fname, int sleep_ms=0)
+{
+	EWBMemRAMCon ram;
+	EWBMemRecordCon rec(&ram,fname);
+	uint32_t val, *pData32;
+	ASSERT_TRUE(rec.isValid());
+	EXPECT_EQ(EWBBridge::PROXY,rec.getType());
+
+	for(int i=0;i<16;i++) ram.poke(0x1000+i*4,0x100+i);
+
+	val=0xCAFE;
+	EXPECT_TRUE(rec.mem_access(0x2000,&val,true));
+	EXPECT_TRUE(rec.mem_access(0x1000,&val,false));
+	EXPECT_EQ(0x100,val);
+	if(sleep_ms) usleep(sleep_ms*1000);
+
+	uint32_t rval[4];
+	EXPECT_TRUE(rec.openCycle());
+	for(int i=0;i<4;i++) EXPECT_TRUE(rec.mem_access(0x1004+i*4,&rval[i],false));
+	EXPECT_TRUE(rec.closeCycle());
+
+	rec.get_block_buffer(&pData32,false);
+	EXPECT_TRUE(rec.mem_block_access(0x1000,16*4,false));
+	EXPECT_EQ(0x10F,pData32[15]);
+
+	uint32_t big[64];
+	for(int i=0;i<64;i++) big[i]=i;
+	EXPECT_TRUE(rec.mem_block_xfer(0x3000,sizeof(big),big,true));
+	EXPECT_EQ(63,ram.peek(0x30FC));
+
+	EXPECT_EQ(8,rec.getNEntries());
+}
+
+TEST(EWBMemRecordCon,Replay)
+{
+	TmpLog log;
+	recordWorkload(log.fname);
+
+	EWBMemReplayCon rep(log.fname);
+	uint32_t val, *pData32;
+	ASSERT_TRUE(rep.isValid());
+	EXPECT_EQ(8,rep.getNEntries());
+
+	val=0xCAFE;
+	EXPECT_TRUE(rep.mem_access(0x2000,&val,true));
+	EXPECT_TRUE(rep.mem_access(0x1000,&val,false));
+	EXPECT_EQ(0x100,val);
+	for(int i=0;i<4;i++)
+	{
+		EXPECT_TRUE(rep.mem_access(0x1004+i*4,&val,false));
+		EXPECT_EQ(0x101+i,val);
+	}
+	rep.get_block_buffer(&pData32,false);
+	EXPECT_TRUE(rep.mem_block_access(0x1000,16*4,false));
+	EXPECT_EQ(0x10F,pData32[15]);
+
+	uint32_t big[64];
+	for(int i=0;i<64;i++) big[i]=i;
+	big[10]=0;
+	EXPECT_TRUE(rep.mem_block_xfer(0x3000,sizeof(big),big,true));
+
+	EXPECT_TRUE(rep.isDone());
+	EXPECT_EQ(8,rep.getNMatches());
+	EXPECT_EQ(0,rep.getNMisses());
+	EXPECT_EQ(1,rep.getNMismatches());
+}
+
+TEST(EWBMemRecordCon,OtherStrategy)
+{
+	TmpLog log;
+	recordWorkload(log.fname);
+
+	//Replay the workload reading a peripheral with one block
+	EWBMemReplayCon rep(log.fname);
+	EWBBus bus(&rep,0x0);
+	EWBPeriph *pP = new EWBPeriph(&bus,"prh",0x1000,0x1,0x2);
+	bus.appendPeriph(pP);
+	for(int i=0;i<5;i++) new EWBReg(pP,"r"+std::to_string(i),i*4);
+
+	uint32_t val=0xCAFE;
+	EXPECT_TRUE(rep.mem_access(0x2000,&val,true));
+	EXPECT_TRUE(rep.mem_access(0x1000,&val,false));
+	EXPECT_TRUE(pP->sync(EWBSync::EWB_AM_R,EWB_NODE_MEMBCK_OWNADDR));
+	EXPECT_EQ(1,rep.getNMisses());
+	for(int i=0;i<5;i++) EXPECT_EQ(0x100+i,pP->getReg(i*4)->getData());
+}
+
+TEST(EWBMemRecordCon,BlockInCycle)
+{
+	TmpLog log;
+	EWBMemRAMCon ram;
+	EWBMemRecordCon rec(&ram,log.fname);
+	uint32_t val=0, big[16];
+	ASSERT_TRUE(rec.isValid());
+	for(int i=0;i<16;i++) ram.poke(0x1000+i*4,0x100+i);
+
+	//The block is written at once, the single when its value is known
+	EXPECT_TRUE(rec.openCycle());
+	EXPECT_TRUE(rec.mem_access(0x1004,&val,false));
+	EXPECT_TRUE(rec.mem_block_xfer(0x1000,sizeof(big),big,false));
+	EXPECT_EQ(1,rec.getNEntries());
+	EXPECT_TRUE(rec.closeCycle());
+	EXPECT_EQ(2,rec.getNEntries());
+	rec.flush();
+
+	EWBMemReplayCon rep(log.fname);
+	EXPECT_EQ(2,rep.getNEntries());
+	EXPECT_TRUE(rep.mem_access(0x1004,&val,false));
+	EXPECT_EQ(0x101,val);
+}
+
+TEST(EWBMemRecordCon,RealTime)
+{
+	TmpLog log;
+	recordWorkload(log.fname,50);
+	uint32_t val=0xCAFE;
+
+	EWBMemReplayCon rep(log.fname,true);
+	EXPECT_LE(50000000,rep.getDuration());
+
+	uint64_t t0=EWBBridgeStats::now_ns();
+	EXPECT_TRUE(rep.mem_access(0x2000,&val,true));
+	EXPECT_TRUE(rep.mem_access(0x1000,&val,false));
+	EXPECT_TRUE(rep.mem_access(0x1004,&val,false));
+	EXPECT_LE(50000000,EWBBridgeStats::now_ns()-t0);
+
+	//As fast as possible
+	rep.rewind();
+	rep.setRealTime(false);
+	val=0xCAFE;
+	t0=EWBBridgeStats::now_ns();
+	EXPECT_TRUE(rep.mem_access(0x2000,&val,true));
+	EXPECT_TRUE(rep.mem_access(0x1000,&val,false));
+	EXPECT_TRUE(rep.mem_access(0x1004,&val,false));
+	EXPECT_GT(50000000,EWBBridgeStats::now_ns()-t0);
+}
+
+} //namespace
@@ -0,0 +1,162 @@
+/*
+ * EWBBridgeDedup_test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBBridgeDedup.h"
+#include "EWBBgdRAM.h"
+#include "EWBBus.h"
+#include "EWBPeriph.h"
+#include "EWBReg.h"
+#include "EWBField.h"
+#include "gtest/gtest.h"
+
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <unistd.h>
+
+namespace {
+
+TEST(EWBBridgeDedup,SingleFlight)
+{
+	//Each read takes 5ms so that the concurrent reads overlap
+	EWBMemRAMCon ram;
+	ram.setLatencyModel(EWBLatencyModel(5000000,0,0,0,0x8000,EWBLatencyModel::SLEEP));
+	ram.poke(0x100,0x1234);
+	EWBBridgeDedup dd(&ram);
+
+	std::vector<std::thread> ths;
+	uint32_t vals[4]={ 0 };
+	bool rets[4]={ false };
+	for(int i=0;i<4;i++)
+	{
+		ths.push_back(std::thread([&,i]() { rets[i]=dd.mem_access(0x100,&vals[i],false); }));
+	}
+	for(size_t i=0;i<ths.size();i++) ths[i].join();
+
+	for(int i=0;i<4;i++)
+	{
+		EXPECT_TRUE(rets[i]);
+		EXPECT_EQ(0x1234,vals[i]);
+	}
+	EXPECT_EQ(1,ram.getStats().getCount(EWBBridgeStats::SINGLE_R));
+	EXPECT_EQ(1,dd.getNForwarded());
+	EXPECT_EQ(3,dd.getNShared());
+
+	//Without window the next read access the device
+	EXPECT_TRUE(dd.mem_access(0x100,&vals[0],false));
+	EXPECT_EQ(2,ram.getStats().getCount(EWBBridgeStats::SINGLE_R));
+	EXPECT_EQ(0,dd.getNFresh());
+}
+
+TEST(EWBBridgeDedup,Window)
+{
+	EWBMemRAMCon ram;
+	EWBBridgeDedup dd(&ram,1000000);
+	EXPECT_EQ(1000000,dd.getWindow());
+
+	//Four fields of the same register read it only once
+	EWBBus bus(&dd,0x0);
+	EWBPeriph *pP = new EWBPeriph(&bus,"prh",0x100,0x1,0x2);
+	bus.appendPeriph(pP);
+	EWBReg *pR = new EWBReg(pP,"status",0x0);
+	EWBField *pF[4];
+	for(int i=0;i<4;i++) pF[i]=new EWBField(pR,"bit",1,i);
+	ram.poke(0x100,0xA);
+	for(int i=0;i<4;i++) EXPECT_TRUE(pF[i]->sync(EWBSync::EWB_AM_R));
+	EXPECT_EQ(0xA,pR->getData());
+	EXPECT_EQ(1,ram.getStats().getCount(EWBBridgeStats::SINGLE_R));
+	EXPECT_EQ(3,dd.getNFresh());
+
+	//A write invalidates the previous read
+	uint32_t val=0x5;
+	EXPECT_TRUE(dd.mem_access(0x100,&val,true));
+	EXPECT_TRUE(dd.mem_access(0x100,&val,false));
+	EXPECT_EQ(0x5,val);
+	EXPECT_EQ(2,ram.getStats().getCount(EWBBridgeStats::SINGLE_R));
+
+	//So does a block write
+	std::vector<uint32_t> buff(4,0x7);
+	EXPECT_TRUE(dd.mem_block_xfer(0xF8,0x10,&buff[0],true));
+	EXPECT_TRUE(dd.mem_access(0x100,&val,false));
+	EXPECT_EQ(0x7,val);
+	EXPECT_EQ(3,ram.getStats().getCount(EWBBridgeStats::SINGLE_R));
+
+	//The reads in a cycle are not deduplicated
+	EXPECT_TRUE(dd.openCycle());
+	EXPECT_TRUE(dd.mem_access(0x100,&val,false));
+	EXPECT_TRUE(dd.closeCycle());
+	EXPECT_EQ(4,ram.getStats().getCount(EWBBridgeStats::SINGLE_R));
+
+	//and the window can be reset
+	EXPECT_TRUE(dd.mem_access(0x100,&val,false));
+	dd.invalidate();
+	EXPECT_TRUE(dd.mem_access(0x100,&val,false));
+	EXPECT_EQ(6,ram.getStats().getCount(EWBBridgeStats::SINGLE_R));
+}
+
+/**
+ * Bridge whose single writes wait for a signal before reaching the target
+ */
+class EWBSlowWrites: public EWBBridgeProxy {
+public:
+	EWBSlowWrites(EWBBridge *pTarget): EWBBridgeProxy(pTarget), writing(false), go(false) {};
+	bool mem_access(uint32_t addr, uint32_t *data, bool to_dev)
+	{
+		if(to_dev)
+		{
+			writing=true;
+			while(!go) usleep(100);
+		}
+		return pTarget->mem_access(addr,data,to_dev);
+	}
+	std::atomic<bool> writing, go;
+};
+
+TEST(EWBBridgeDedup,ReadDuringWrite)
+{
+	EWBMemRAMCon ram;
+	EWBSlowWrites slow(&ram);
+	EWBBridgeDedup dd(&slow,1000000);
+	ram.poke(0x100,0x1);
+
+	//A read performed while the write is in flight sees the previous value
+	uint32_t wval=0x2, val=0;
+	std::thread th([&]() { dd.mem_access(0x100,&wval,true); });
+	while(!slow.writing) usleep(100);
+	EXPECT_TRUE(dd.mem_access(0x100,&val,false));
+	EXPECT_EQ(0x1,val);
+	slow.go=true;
+	th.join();
+
+	//but it is not served after the end of the write
+	EXPECT_TRUE(dd.mem_access(0x100,&val,false));
+	EXPECT_EQ(0x2,val);
+}
+
+TEST(EWBBridgeDedup,CycleOfOtherThread)
+{
+	EWBMemRAMCon ram;
+	EWBBridgeDedup dd(&ram,1000000);
+	uint32_t val;
+
+	//The cycle of a thread does not disable the window of the others
+	EXPECT_TRUE(dd.openCycle());
+	std::thread th([&]() {
+		dd.mem_access(0x100,&val,false);
+		dd.mem_access(0x100,&val,false);
+	});
+	th.join();
+	EXPECT_EQ(1,dd.getNFresh());
+
+	//The writes of the cycle invalidate the reads when it is closed
+	val=0x3;
+	EXPECT_TRUE(dd.mem_access(0x104,&val,true));
+	EXPECT_TRUE(dd.closeCycle());
+	EXPECT_TRUE(dd.mem_access(0x100,&val,false));
+	EXPECT_EQ(2,ram.getStats().getCount(EWBBridgeStats::SINGLE_R));
+}
+
+} // namespace
@@ -0,0 +1,93 @@
+/*
+ * EWBBridgeQoS_test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBBridgeQoS.h"
+#include "EWBBgdRAM.h"
+#include "gtest/gtest.h"
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <sstream>
+
+namespace {
+
+TEST(EWBBridgeQoS,Forward)
+{
+	EWBMemRAMCon ram;
+	EWBBridgeQoS qos(&ram,0x100,0x1000);
+	uint32_t val=0x1234, *pData32;
+
+	EXPECT_TRUE(qos.isValid());
+	EXPECT_TRUE(qos.mem_access(0x10,&val,true));
+	EXPECT_EQ(0x1234,ram.peek(0x10));
+
+	//The block buffer is split in chunks
+	ASSERT_EQ(0x1000,qos.get_block_buffer(&pData32,true));
+	for(int i=0;i<0x400;i++) pData32[i]=i;
+	EXPECT_TRUE(qos.mem_block_access(0x1000,0x1000,true));
+	EXPECT_EQ(0x3FF,ram.peek(0x1FFC));
+	EXPECT_EQ(16,qos.getLaneStats(EWBBridgeQoS::LANE_BULK).count);
+	EXPECT_FALSE(qos.mem_block_access(0x1000,0x1004,true));
+
+	std::vector<uint32_t> buff(0x300);
+	EXPECT_TRUE(qos.mem_block_xfer(0x1000,0xC00,&buff[0],false));
+	EXPECT_EQ(0x2FF,buff[0x2FF]);
+
+	//Cycles can be nested with singles (same thread)
+	EXPECT_TRUE(qos.openCycle());
+	EXPECT_TRUE(qos.mem_access(0x10,&val,false));
+	EXPECT_TRUE(qos.openCycle());
+	EXPECT_TRUE(qos.closeCycle());
+	EXPECT_TRUE(qos.closeCycle());
+	EXPECT_EQ(1,qos.getLaneStats(EWBBridgeQoS::LANE_READ).count);
+
+	//A Scope forces the lane
+	{
+		EWBBridgeQoS::Scope scope(EWBBridgeQoS::LANE_BULK);
+		EXPECT_TRUE(qos.mem_access(0x10,&val,false));
+	}
+	EXPECT_TRUE(qos.mem_access(0x10,&val,false));
+	EXPECT_EQ(2,qos.getLaneStats(EWBBridgeQoS::LANE_READ).count);
+	EXPECT_EQ(1+16+12,qos.getLaneStats(EWBBridgeQoS::LANE_BULK).count);
+	EXPECT_EQ(1,qos.getLaneStats(EWBBridgeQoS::LANE_WRITE).count);
+
+	std::stringstream ss;
+	qos.printLanes(ss);
+	EXPECT_NE(std::string::npos,ss.str().find("bulk"));
+}
+
+TEST(EWBBridgeQoS,BoundedWriteLatency)
+{
+	//Each chunk of 4KB takes 2ms: the scan of 64KB takes 32ms
+	EWBMemRAMCon ram;
+	ram.setLatencyModel(EWBLatencyModel(0,2000000,0,0,0x8000,EWBLatencyModel::SLEEP));
+	EWBBridgeQoS qos(&ram,0x1000);
+
+	std::atomic<bool> done(false);
+	std::vector<uint32_t> buff(0x10000/4);
+	std::thread scan([&]() {
+		qos.mem_block_xfer(0x0,0x10000,&buff[0],false);
+		done=true;
+	});
+
+	//A write in the middle of the scan waits only for the current chunk
+	std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	uint32_t val=0xABCD;
+	uint64_t t0=EWBBridgeStats::now_ns();
+	EXPECT_TRUE(qos.mem_access(0x20000,&val,true));
+	uint64_t ns=EWBBridgeStats::now_ns()-t0;
+	EXPECT_FALSE(done);
+	scan.join();
+
+	EXPECT_EQ(0xABCD,ram.peek(0x20000));
+	EXPECT_LT(ns,10000000);
+	EXPECT_LE(1,qos.getNPreempted());
+	EXPECT_EQ(16,qos.getLaneStats(EWBBridgeQoS::LANE_BULK).count);
+	EXPECT_GE(qos.getLaneStats(EWBBridgeQoS::LANE_WRITE).max_ns,qos.getLaneStats(EWBBridgeQoS::LANE_WRITE).wait_ns);
+}
+
+} // namespace
@@ -0,0 +1,143 @@
+/*
+ * EWBBridgeStats_test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBBridgeStats.h"
+#include "EWBBgdRAM.h"
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+TEST(EWBHistogram,Buckets)
+{
+	//Small values are exact
+	for(uint64_t v=0;v<EWBHistogram::NSUB;v++)
+	{
+		EXPECT_EQ(v,EWBHistogram::lowest(EWBHistogram::index(v)));
+		EXPECT_EQ(v,EWBHistogram::highest(EWBHistogram::index(v)));
+	}
+
+	//Every value is inside its bucket with a bounded relative error
+	uint64_t vals[] = { 8, 9, 15, 16, 17, 1000, 123456, 999999999ULL, 0xFFFFFFFFFFFFFFFFULL };
+	for(size_t i=0;i<sizeof(vals)/sizeof(uint64_t);i++)
+	{
+		int idx=EWBHistogram::index(vals[i]);
+		ASSERT_LT(idx,EWBHistogram::NBUCKETS);
+		EXPECT_LE(EWBHistogram::lowest(idx),vals[i]);
+		EXPECT_GE(EWBHistogram::highest(idx),vals[i]);
+		EXPECT_LE((double)(EWBHistogram::highest(idx)-EWBHistogram::lowest(idx)),
+				vals[i]/(double)EWBHistogram::NSUB);
+	}
+	EXPECT_EQ(EWBHistogram::NBUCKETS-1,EWBHistogram::index(0xFFFFFFFFFFFFFFFFULL));
+}
+
+TEST(EWBHistogram,Percentile)
+{
+	EWBHistogram h;
+	EXPECT_EQ(0,h.getPercentile(50));
+
+	for(uint64_t v=1;v<=1000;v++) h.record(v*1000);
+	EXPECT_EQ(1000,h.getCount());
+	EXPECT_EQ(1000,h.getMin());
+	EXPECT_EQ(1000000,h.getMax());
+	EXPECT_DOUBLE_EQ(500500.0,h.getMean());
+
+	EXPECT_NEAR(500000,h.getPercentile(50),500000/EWBHistogram::NSUB);
+	EXPECT_NEAR(990000,h.getPercentile(99),990000/EWBHistogram::NSUB);
+	EXPECT_EQ(1000000,h.getPercentile(100));
+
+	h.reset();
+	EXPECT_EQ(0,h.getCount());
+	EXPECT_EQ(0,h.getMax());
+}
+
+TEST(EWBBridgeStats,Probe)
+{
+	EWBBridgeStats s;
+	{
+		EWBBridgeStats::Probe p(s,EWBBridgeStats::SINGLE_R,4);
+		EXPECT_TRUE(p.done(true));
+	}
+	{
+		EWBBridgeStats::Probe p(s,EWBBridgeStats::BLOCK_W,256);
+		EXPECT_FALSE(p.done(false));
+	}
+	{
+		//Early return without done() is an error
+		EWBBridgeStats::Probe p(s,EWBBridgeStats::SINGLE_R,4);
+	}
+	s.addRetry(EWBBridgeStats::SINGLE_R);
+
+	EXPECT_EQ(2,s.getCount(EWBBridgeStats::SINGLE_R));
+	EXPECT_EQ(1,s.getErrors(EWBBridgeStats::SINGLE_R));
+	EXPECT_EQ(1,s.getRetries(EWBBridgeStats::SINGLE_R));
+	EXPECT_EQ(4,s.getBytes(EWBBridgeStats::SINGLE_R));
+	EXPECT_EQ(1,s.getCount(EWBBridgeStats::BLOCK_W));
+	EXPECT_EQ(0,s.getBytes(EWBBridgeStats::BLOCK_W));
+	EXPECT_EQ(0,s.getCount(EWBBridgeStats::SINGLE_W));
+
+	std::stringstream ss;
+	s.print(ss,1);
+	EXPECT_NE(std::string::npos,ss.str().find("single-R"));
+
+	//Disabled statistics do not record anything
+	s.reset();
+	s.setEnabled(false);
+	{
+		EWBBridgeStats::Probe p(s,EWBBridgeStats::SINGLE_W,4);
+		p.done(true);
+	}
+	EXPECT_EQ(0,s.getCount(EWBBridgeStats::SINGLE_W));
+}
+
+TEST(EWBBridgeStats,Concurrent)
+{
+	//The recording threads are not serialized but no transaction is lost
+	EWBBridgeStats s;
+	std::vector<std::thread> ths;
+	for(int t=0;t<4;t++)
+	{
+		ths.push_back(std::thread([&s,t]() {
+			for(int i=1;i<=10000;i++) s.record(EWBBridgeStats::SINGLE_R,4,(i%10)!=0,t*10000+i);
+		}));
+	}
+	for(size_t t=0;t<ths.size();t++) ths[t].join();
+
+	const EWBHistogram &h=s.getHisto(EWBBridgeStats::SINGLE_R);
+	EXPECT_EQ(40000,h.getCount());
+	EXPECT_EQ(4000,s.getErrors(EWBBridgeStats::SINGLE_R));
+	EXPECT_EQ(36000*4,s.getBytes(EWBBridgeStats::SINGLE_R));
+	EXPECT_EQ(1,h.getMin());
+	EXPECT_EQ(40000,h.getMax());
+	EXPECT_DOUBLE_EQ(20000.5,h.getMean());
+}
+
+TEST(EWBBridgeStats,Instances)
+{
+	//The bridges are registered and listed by several threads
+	EWBMemRAMCon ram("stats_ram");
+	std::vector<std::thread> ths;
+	for(int t=0;t<4;t++)
+	{
+		ths.push_back(std::thread([]() {
+			for(int i=0;i<200;i++) { EWBMemRAMCon tmp("stats_tmp"); }
+		}));
+	}
+	int nfound=0;
+	for(int i=0;i<200;i++)
+	{
+		EWBBridge::forEachInstance([&nfound](EWBBridge *pBgd) { if(pBgd->getName()=="stats_ram") nfound++; });
+	}
+	for(size_t t=0;t<ths.size();t++) ths[t].join();
+	EXPECT_EQ(200,nfound);
+	EXPECT_EQ(&ram,EWBBridge::find("stats_ram"));
+	EXPECT_TRUE(EWBBridge::find("stats_tmp")==NULL);
+}
+
+}
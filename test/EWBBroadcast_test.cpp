@@ -0,0 +1,102 @@
+/*
+ * EWBBroadcast_test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBBroadcast.h"
+
+#include "EWBBus.h"
+#include "EWBPeriph.h"
+#include "EWBReg.h"
+#include "EWBField.h"
+#include "EWBBgdRAM.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+//! A board with the same layout in each slot
+struct Board {
+	EWBMemRAMCon ram;
+	EWBBus bus;
+	Board(bool withField=true): bus(&ram,0x20000)
+	{
+		EWBBus *pSub=new EWBBus(&ram,0x1000,&bus);
+		EWBPeriph *pP=new EWBPeriph(pSub,"wrpc",0x100,0x1,0x2);
+		pSub->appendPeriph(pP);
+		EWBReg *pR=new EWBReg(pP,"ctrl",0x4);
+		new EWBField(pR,"mode",4,0);
+		if(withField) new EWBField(pR,"enable",1,8);
+	}
+};
+
+TEST(EWBBroadcast,FindField)
+{
+	Board b;
+	EWBField *pFld=EWBBroadcast::findField(&b.bus,"wrpc.ctrl.enable");
+	ASSERT_TRUE(pFld!=NULL);
+	EXPECT_EQ("enable",pFld->getName());
+	EXPECT_EQ(0x1104,pFld->getReg()->getOffset(true));
+	EXPECT_EQ(NULL,EWBBroadcast::findField(&b.bus,"wrpc.ctrl.none"));
+	EXPECT_EQ(NULL,EWBBroadcast::findField(&b.bus,"wrpc.none.enable"));
+	EXPECT_EQ(NULL,EWBBroadcast::findField(&b.bus,"none.ctrl.enable"));
+	EXPECT_EQ(NULL,EWBBroadcast::findField(&b.bus,"wrpc.ctrl"));
+}
+
+TEST(EWBBroadcast,Write)
+{
+	Board b1, b2, b3(false);
+	EWBBroadcast grp;
+	EXPECT_TRUE(grp.add(&b1.bus,"slot1"));
+	EXPECT_TRUE(grp.add(&b2.bus));
+	EXPECT_TRUE(grp.add(&b3.bus,"slot3"));
+	EXPECT_FALSE(grp.add(&b1.bus));
+	EXPECT_EQ(3,grp.size());
+
+	b1.ram.poke(0x1104,0x5);
+	b2.ram.poke(0x1104,0x7);
+	std::vector<EWBBroadcast::Result> res=grp.write("wrpc.ctrl.enable",1U);
+	ASSERT_EQ(3,res.size());
+	EXPECT_EQ("slot1",res[0].name);
+	EXPECT_EQ("#1",res[1].name);
+	EXPECT_EQ(EWBBroadcast::OK,res[0].status);
+	EXPECT_EQ(EWBBroadcast::OK,res[1].status);
+	EXPECT_EQ(EWBBroadcast::NOT_FOUND,res[2].status);
+	EXPECT_FALSE(EWBBroadcast::isOK(res));
+
+	//Only the field is modified on each board
+	EXPECT_EQ(0x105,b1.ram.peek(0x1104));
+	EXPECT_EQ(0x107,b2.ram.peek(0x1104));
+	EXPECT_EQ(0x0,b3.ram.peek(0x1104));
+
+	res=grp.write("wrpc.ctrl.mode",3.0f,EWBSync::EWB_AM_RW);
+	EXPECT_TRUE(EWBBroadcast::isOK(res));
+	EXPECT_EQ(0x103,b1.ram.peek(0x1104));
+	EXPECT_EQ(0x3,b3.ram.peek(0x1104));
+	EXPECT_STREQ("not found",EWBBroadcast::getStatusName(EWBBroadcast::NOT_FOUND));
+}
+
+TEST(EWBBroadcast,Concurrent)
+{
+	//A field write (read-modify-write) takes 10ms per board
+	Board b[4];
+	EWBBroadcast grp;
+	for(int i=0;i<4;i++)
+	{
+		b[i].ram.setLatencyModel(EWBLatencyModel(5000000,0,0,0,0x8000,EWBLatencyModel::SLEEP));
+		grp.add(&b[i].bus);
+	}
+
+	uint64_t t0=EWBBridgeStats::now_ns();
+	EXPECT_TRUE(EWBBroadcast::isOK(grp.write("wrpc.ctrl.mode",0x9U)));
+	uint64_t ns=EWBBridgeStats::now_ns()-t0;
+	EXPECT_LT(ns,30000000);
+
+	grp.setConcurrent(false);
+	t0=EWBBridgeStats::now_ns();
+	EXPECT_TRUE(EWBBroadcast::isOK(grp.write("wrpc.ctrl.mode",0xAU)));
+	EXPECT_GE(EWBBridgeStats::now_ns()-t0,40000000);
+	for(int i=0;i<4;i++) EXPECT_EQ(0xA,b[i].ram.peek(0x1104));
+}
+
+} // namespace
@@ -0,0 +1,97 @@
+/*
+ * EWBBufferPool_test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBBufferPool.h"
+#include "EWBBgdRAM.h"
+#include "gtest/gtest.h"
+
+#include <thread>
+#include <vector>
+
+namespace {
+
+TEST(EWBBufferPool,Lease)
+{
+	EWBBufferPool pool;
+	uint32_t *pFirst;
+	{
+		EWBBufferPool::Lease a(pool,100), b(pool,0x1001);
+		ASSERT_TRUE(a.get()!=NULL);
+		ASSERT_TRUE(b.get()!=NULL);
+		EXPECT_EQ(0x1000,a.size());
+		EXPECT_EQ(0x2000,b.size());
+		EXPECT_EQ(0,((uintptr_t)a.get()) & 0xFFF);
+		EXPECT_EQ(0,((uintptr_t)b.get()) & 0xFFF);
+		EXPECT_EQ(2,pool.getNLeased());
+		EXPECT_EQ(0,pool.getNFree());
+		pFirst=a.get();
+	}
+	EXPECT_EQ(0,pool.getNLeased());
+	EXPECT_EQ(2,pool.getNFree());
+
+	//A released buffer is reused without allocation
+	uint64_t nalloc=pool.getAllocated();
+	EWBBufferPool::Lease c(pool,0x800);
+	EXPECT_EQ(pFirst,c.get());
+	EXPECT_EQ(nalloc,pool.getAllocated());
+
+	//Only the leased buffers can be released
+	uint32_t val;
+	pool.release(&val);
+	EXPECT_EQ(1,pool.getNLeased());
+}
+
+TEST(EWBBufferPool,Huge)
+{
+	EWBBufferPool pool(true);
+	EXPECT_TRUE(pool.isHuge());
+	EWBBufferPool::Lease a(pool,0x10000);
+	ASSERT_TRUE(a.get()!=NULL);
+	a.get()[0x3FFF]=0x1234;
+
+	//A hugepage is split in several buffers (fall back to a single buffer)
+	if(pool.getNHugePages()>0)
+	{
+		EXPECT_EQ(EWB_BUFFPOOL_HUGEB,pool.getAllocated());
+		EXPECT_EQ(EWB_BUFFPOOL_HUGEB/0x10000-1,pool.getNFree());
+	}
+	else
+	{
+		EXPECT_EQ(0x10000,pool.getAllocated());
+		EXPECT_EQ(0,pool.getNFree());
+	}
+}
+
+TEST(EWBBufferPool,Concurrent)
+{
+	//Each block transfer takes 5ms
+	EWBMemRAMCon ram;
+	ram.setLatencyModel(EWBLatencyModel(0,5000000,0,0,0x8000,EWBLatencyModel::SLEEP));
+	EWBBufferPool pool;
+
+	std::vector<std::thread> ths;
+	bool rets[4]={ false };
+	uint64_t t0=EWBBridgeStats::now_ns();
+	for(int i=0;i<4;i++)
+	{
+		ths.push_back(std::thread([&,i]() {
+			EWBBufferPool::Lease buff(pool,0x1000);
+			for(int k=0;k<0x400;k++) buff.get()[k]=i;
+			rets[i]=ram.mem_block_xfer(0x1000*i,0x1000,buff.get(),true);
+		}));
+	}
+	for(size_t i=0;i<ths.size();i++) ths[i].join();
+	EXPECT_LT(EWBBridgeStats::now_ns()-t0,15000000);
+
+	for(int i=0;i<4;i++)
+	{
+		EXPECT_TRUE(rets[i]);
+		EXPECT_EQ(i,ram.peek(0x1000*i+0xFFC));
+	}
+	EXPECT_EQ(4,pool.getNFree());
+}
+
+} // namespace
@@ -6,3 +6,84 @@
  */
 
 #include "EWBBus.h"
+
+#include "EWBPeriph.h"
+#include "EWBReg.h"
+#include "EWBField.h"
+#include "EWBBgdRAM.h"
+#include "EWBBridgeProxy.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+//! A RAM bridge that can be disconnected
+class EWBMemRAMConTest: public EWBMemRAMCon {
+public:
+	EWBMemRAMConTest(): valid(true), nchecks(0) {}
+	virtual bool isValid() { nchecks++; return valid; }
+	bool valid;
+	int nchecks;
+};
+
+TEST(EWBBus,Freeze)
+{
+	EWBMemRAMConTest ram;
+	EWBBus bus(&ram,0x0);
+	EWBBus *pSub=new EWBBus(&ram,0x1000,&bus);
+	EWBPeriph *pP=new EWBPeriph(pSub,"dev",0x100,0x1,0x2);
+	pSub->appendPeriph(pP);
+	EWBReg *pReg=new EWBReg(pP,"reg",0x8);
+	EWBField *pFld=new EWBField(pReg,"fld",8,0);
+	EXPECT_EQ(0x1108,pReg->getOffset(true));
+
+	//The tree is checked once
+	EXPECT_TRUE(bus.freeze());
+	EXPECT_TRUE(pReg->isFrozen());
+	EXPECT_EQ(0x1108,pReg->getOffset(true));
+	ram.nchecks=0;
+	ram.poke(0x1108,0x12);
+	EXPECT_TRUE(pFld->sync(EWBSync::EWB_AM_R));
+	EXPECT_TRUE(pReg->sync(EWBSync::EWB_AM_R));
+	EXPECT_EQ(0x12,pReg->getData());
+	EXPECT_EQ(0,ram.nchecks);
+
+	//The registers are validated again after a reconnection
+	ram.valid=false;
+	ram.bumpGeneration();
+	EXPECT_FALSE(pReg->sync(EWBSync::EWB_AM_R));
+	ram.valid=true;
+	EXPECT_TRUE(pReg->sync(EWBSync::EWB_AM_R));
+	ram.nchecks=0;
+	EXPECT_TRUE(pReg->sync(EWBSync::EWB_AM_R));
+	EXPECT_EQ(0,ram.nchecks);
+
+	//Without freeze the tree is checked at each access
+	bus.unfreeze();
+	EXPECT_FALSE(pReg->isFrozen());
+	EXPECT_TRUE(pReg->sync(EWBSync::EWB_AM_R));
+	EXPECT_LT(0,ram.nchecks);
+	ram.valid=false;
+	EXPECT_FALSE(bus.freeze());
+	EXPECT_FALSE(pReg->isFrozen());
+}
+
+TEST(EWBBus,FreezeProxy)
+{
+	//A proxy shares the generation of its target
+	EWBMemRAMConTest ram;
+	EWBBridgeProxy proxy(&ram);
+	EWBBus bus(&proxy,0x0);
+	EWBPeriph *pP=new EWBPeriph(&bus,"dev",0x100,0x1,0x2);
+	bus.appendPeriph(pP);
+	EWBReg *pReg=new EWBReg(pP,"reg",0x8);
+	EXPECT_TRUE(bus.freeze());
+
+	ram.valid=false;
+	ram.bumpGeneration();
+	EXPECT_EQ(ram.getGeneration(),proxy.getGeneration());
+	EXPECT_FALSE(pReg->sync(EWBSync::EWB_AM_R));
+	ram.valid=true;
+	EXPECT_TRUE(pReg->sync(EWBSync::EWB_AM_R));
+}
+
+} // namespace
@@ -0,0 +1,208 @@
+/*
+ * EWBDaemon_test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBDaemon.h"
+#include "EWBBgdDaemon.h"
+#include "EWBBgdRAM.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+namespace {
+
+#define EWBD_TEST_SOCKET "/tmp/ewbd_test.sock"
+
+TEST(EWBDaemon,Clients)
+{
+	EWBMemRAMCon ram;
+	EWBDaemon d(&ram,EWBD_TEST_SOCKET);
+	ASSERT_TRUE(d.isValid());
+	ASSERT_TRUE(d.start());
+
+	EWBMemDaemonCon c1(EWBD_TEST_SOCKET), c2(EWBD_TEST_SOCKET);
+	ASSERT_TRUE(c1.isValid());
+	ASSERT_TRUE(c2.isValid());
+	EXPECT_EQ(EWBBridge::DAEMON,c1.getType());
+
+	uint32_t val=0x1234;
+	EXPECT_TRUE(c1.mem_access(0x100,&val,true));
+	EXPECT_EQ(0x1234,ram.peek(0x100));
+	val=0;
+	EXPECT_TRUE(c2.mem_access(0x100,&val,false));
+	EXPECT_EQ(0x1234,val);
+
+	//Batch: the read sees the previous write of the same client
+	uint32_t r[3];
+	EXPECT_TRUE(c1.openCycle());
+	val=0x55;
+	EXPECT_TRUE(c1.mem_access(0x200,&val,true));
+	val=0x66;	//The value was copied when queued
+	EXPECT_TRUE(c1.mem_access(0x200,&r[0],false));
+	EXPECT_TRUE(c1.mem_access(0x204,&val,true));
+	EXPECT_TRUE(c1.mem_access(0x204,&r[1],false));
+	EXPECT_TRUE(c1.mem_access(0x100,&r[2],false));
+	EXPECT_TRUE(c1.closeCycle());
+	EXPECT_EQ(0x55,r[0]);
+	EXPECT_EQ(0x66,r[1]);
+	EXPECT_EQ(0x1234,r[2]);
+
+	//Block bigger than the client buffer
+	std::vector<uint32_t> blk(0x8000);
+	for(size_t i=0;i<blk.size();i++) blk[i]=i;
+	EXPECT_TRUE(c2.mem_block_xfer(0x10000,blk.size()*4,&blk[0],true));
+	EXPECT_EQ(0x7FFF,ram.peek(0x10000+0x7FFF*4));
+	std::vector<uint32_t> rblk(blk.size());
+	EXPECT_TRUE(c1.mem_block_xfer(0x10000,rblk.size()*4,&rblk[0],false));
+	EXPECT_TRUE(blk==rblk);
+
+	uint32_t *pData32;
+	c1.get_block_buffer(&pData32,false);
+	EXPECT_TRUE(c1.mem_block_access(0x10000,0x100,false));
+	EXPECT_EQ(0x3F,pData32[0x3F]);
+
+	d.stop();
+	EXPECT_EQ(2,d.getNClients());
+}
+
+TEST(EWBDaemon,LargeReply)
+{
+	EWBMemRAMCon ram;
+	EWBDaemon d(&ram,EWBD_TEST_SOCKET);
+	ASSERT_TRUE(d.isValid());
+	ASSERT_TRUE(d.start());
+	EWBMemDaemonCon c1(EWBD_TEST_SOCKET), c2(EWBD_TEST_SOCKET);
+	ASSERT_TRUE(c1.isValid());
+
+	//The replies bigger than the socket buffer are sent in several rounds
+	std::vector<uint32_t> blk(0x100000);	//4 MiB
+	for(size_t i=0;i<blk.size();i++) blk[i]=i*3;
+	EXPECT_TRUE(c1.mem_block_xfer(0x100000,blk.size()*4,&blk[0],true));
+	for(uint32_t nsize=0x100000;nsize<=blk.size()*4;nsize*=2)
+	{
+		std::vector<uint32_t> rblk(nsize/4);
+		ASSERT_TRUE(c1.mem_block_xfer(0x100000,nsize,&rblk[0],false));
+		EXPECT_TRUE(std::equal(rblk.begin(),rblk.end(),blk.begin()));
+	}
+
+	//The other clients are still served
+	uint32_t val=0;
+	EXPECT_TRUE(c2.mem_access(0x100000+0x10*4,&val,false));
+	EXPECT_EQ(0x30,val);
+	EXPECT_TRUE(c1.mem_access(0x100000+0x20*4,&val,false));
+	EXPECT_EQ(0x60,val);
+	d.stop();
+	EXPECT_EQ(2,d.getNClients());
+}
+
+TEST(EWBDaemon,Coalescing)
+{
+	EWBMemRAMCon ram;
+	EWBDaemon d(&ram,EWBD_TEST_SOCKET);
+	ASSERT_TRUE(d.isValid());
+	for(int i=0;i<8;i++) ram.poke(0x1000+i*4,i+1);
+
+	//Both clients read the same registers in the same round
+	EWBMemDaemonCon c1(EWBD_TEST_SOCKET), c2(EWBD_TEST_SOCKET);
+	uint32_t r1[8], r2[8];
+	bool ret1=false, ret2=false;
+	std::atomic<int> ndone(0);
+	std::thread t1([&]() {
+		c1.openCycle();
+		for(int i=0;i<8;i++) c1.mem_access(0x1000+i*4,&r1[i],false);
+		ret1=c1.closeCycle();
+		ndone++;
+	});
+	std::thread t2([&]() {
+		c2.openCycle();
+		for(int i=0;i<8;i++) c2.mem_access(0x1000+i*4,&r2[i],false);
+		ret2=c2.closeCycle();
+		ndone++;
+	});
+	usleep(50000);
+	for(int i=0;i<100 && ndone<2;i++) d.runOnce(10);
+	t1.join();
+	t2.join();
+
+	EXPECT_TRUE(ret1);
+	EXPECT_TRUE(ret2);
+	for(int i=0;i<8;i++)
+	{
+		EXPECT_EQ(i+1,r1[i]);
+		EXPECT_EQ(i+1,r2[i]);
+	}
+	EXPECT_EQ(1,d.getNRounds());
+	EXPECT_EQ(8,d.getNCoalesced());
+	EXPECT_EQ(8,ram.getStats().getCount(EWBBridgeStats::SINGLE_R));
+}
+
+/**
+ * Send a raw request to the daemon and return the number of errors of the reply (-1: closed)
+ */
+static int rawRequest(int fd, const std::vector<EWBDaemonOp> &ops, uint32_t size)
+{
+	EWBDaemonHdr hdr={ EWBD_MAGIC, (uint32_t)ops.size(), size };
+	std::vector<uint8_t> req(sizeof(hdr)+ops.size()*sizeof(EWBDaemonOp));
+	memcpy(&req[0],&hdr,sizeof(hdr));
+	if(ops.size()) memcpy(&req[sizeof(hdr)],&ops[0],ops.size()*sizeof(EWBDaemonOp));
+	if(send(fd,&req[0],req.size(),MSG_NOSIGNAL)!=(ssize_t)req.size()) return -1;
+	if(recv(fd,&hdr,sizeof(hdr),MSG_WAITALL)!=sizeof(hdr)) return -1;
+	std::vector<uint8_t> rdata(hdr.size+1);
+	if(hdr.size && recv(fd,&rdata[0],hdr.size,MSG_WAITALL)!=(ssize_t)hdr.size) return -1;
+	return hdr.nops;
+}
+
+TEST(EWBDaemon,BadRequests)
+{
+	EWBMemRAMCon ram;
+	EWBDaemon d(&ram,EWBD_TEST_SOCKET);
+	ASSERT_TRUE(d.isValid());
+	ASSERT_TRUE(d.start());
+
+	struct sockaddr_un sa;
+	memset(&sa,0,sizeof(sa));
+	sa.sun_family=AF_UNIX;
+	strncpy(sa.sun_path,EWBD_TEST_SOCKET,sizeof(sa.sun_path)-1);
+	int fd=socket(AF_UNIX,SOCK_STREAM,0);
+	ASSERT_EQ(0,connect(fd,(struct sockaddr*)&sa,sizeof(sa)));
+
+	//Singles of another size and empty blocks are refused before any access
+	std::vector<EWBDaemonOp> ops(1);
+	ops[0].type=EWBDaemonOp::READ;
+	ops[0].addr=0x100;
+	ops[0].nsize=0;
+	EXPECT_EQ(1,rawRequest(fd,ops,sizeof(EWBDaemonOp)));
+	ops[0].type=EWBDaemonOp::WRITE;
+	EXPECT_EQ(1,rawRequest(fd,ops,sizeof(EWBDaemonOp)));
+	ops[0].type=EWBDaemonOp::BLOCK_READ;
+	EXPECT_EQ(1,rawRequest(fd,ops,sizeof(EWBDaemonOp)));
+	ops[0].nsize=8;	//Missing data of the write
+	ops[0].type=EWBDaemonOp::BLOCK_WRITE;
+	EXPECT_EQ(1,rawRequest(fd,ops,sizeof(EWBDaemonOp)));
+	EXPECT_EQ(0,ram.getStats().getCount(EWBBridgeStats::SINGLE_R)+ram.getStats().getCount(EWBBridgeStats::SINGLE_W));
+
+	ops[0].type=EWBDaemonOp::READ;
+	ops[0].nsize=4;
+	EXPECT_EQ(0,rawRequest(fd,ops,sizeof(EWBDaemonOp)));
+
+	//The client announcing a too big payload is dropped
+	EXPECT_EQ(-1,rawRequest(fd,ops,EWBD_MAXPAYLOAD+1));
+	close(fd);
+	d.stop();
+}
+
+TEST(EWBDaemon,NoDaemon)
+{
+	EWBMemDaemonCon c("/tmp/ewbd_none.sock");
+	uint32_t val;
+	EXPECT_FALSE(c.isValid());
+	EXPECT_FALSE(c.mem_access(0x0,&val,false));
+}
+
+} //namespace
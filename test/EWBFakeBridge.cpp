@@ -0,0 +1,47 @@
+/*
+ * EWBFakeBridge.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBFakeBridge.h"
+
+EWBFakeBridge::EWBFakeBridge()
+:EWBBridge(EWBBridge::TFILE,"Fake"), nreads(0), nwrites(0), nblocks(0)
+{
+}
+
+EWBFakeBridge::~EWBFakeBridge()
+{
+}
+
+bool EWBFakeBridge::mem_access(uint32_t addr, uint32_t *data, bool to_dev)
+{
+	if(to_dev) { mem[addr]=*data; nwrites++; }
+	else { *data=peek(addr); nreads++; }
+	return true;
+}
+
+uint32_t EWBFakeBridge::get_block_buffer(uint32_t **hBuff, bool /*to_dev*/)
+{
+	*hBuff=buff;
+	return sizeof(buff);
+}
+
+bool EWBFakeBridge::mem_block_access(uint32_t dev_addr, uint32_t nsize, bool to_dev)
+{
+	if(nsize>sizeof(buff)) return false;
+	for(uint32_t i=0;i<nsize/sizeof(uint32_t);i++)
+	{
+		if(to_dev) mem[dev_addr+i*4]=buff[i];
+		else buff[i]=peek(dev_addr+i*4);
+	}
+	nblocks++;
+	return true;
+}
+
+uint32_t EWBFakeBridge::peek(uint32_t addr) const
+{
+	std::map<uint32_t,uint32_t>::const_iterator ii=mem.find(addr);
+	return (ii!=mem.end())?ii->second:0;
+}
@@ -0,0 +1,40 @@
+/*
+ * EWBFakeBridge.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef EWBFAKEBRIDGE_H_
+#define EWBFAKEBRIDGE_H_
+
+#include <map>
+#include <EWBBridge.h>
+
+/**
+ * Class to test the sync of the tree without device
+ *
+ * The memory is a simple map and each access is counted.
+ */
+class EWBFakeBridge: public EWBBridge {
+public:
+	EWBFakeBridge();
+	virtual ~EWBFakeBridge();
+
+	bool isValid() { return true; }
+	bool mem_access(uint32_t addr, uint32_t *data, bool to_dev);
+	uint32_t get_block_buffer(uint32_t **hBuff, bool to_dev);
+	bool mem_block_access(uint32_t dev_addr, uint32_t nsize, bool to_dev);
+
+	uint32_t peek(uint32_t addr) const;
+	void poke(uint32_t addr, uint32_t data) { mem[addr]=data; }
+
+	int nreads;		//!< Number of single reads
+	int nwrites;	//!< Number of single writes
+	int nblocks;	//!< Number of block accesses
+
+private:
+	std::map<uint32_t,uint32_t> mem;
+	uint32_t buff[1024];
+};
+
+#endif /* EWBFAKEBRIDGE_H_ */
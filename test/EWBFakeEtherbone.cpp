@@ -0,0 +1,142 @@
+/*
+ * EWBFakeEtherbone.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBFakeEtherbone.h"
+#include "EWBBgdEtherbone.h"
+#include "EWBTrace.h"
+
+#include <cstring>
+#include <unistd.h>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+typedef EWBEtherboneCon EB;
+
+static uint32_t get32(const uint8_t *p)
+{
+	uint32_t val;
+	memcpy(&val,p,4);
+	return ntohl(val);
+}
+
+static uint8_t* put32(uint8_t *p, uint32_t val)
+{
+	val=htonl(val);
+	memcpy(p,&val,4);
+	return p+4;
+}
+
+EWBFakeEtherbone::EWBFakeEtherbone(EWBBridge *pTarget)
+: drop(0), npackets(0), pTarget(pTarget), port(0), esr(0), stop(false)
+{
+	struct sockaddr_in addr;
+	socklen_t len=sizeof(addr);
+	memset(&addr,0,sizeof(addr));
+	addr.sin_family=AF_INET;
+	addr.sin_addr.s_addr=htonl(INADDR_LOOPBACK);
+
+	sock=socket(AF_INET,SOCK_DGRAM,0);
+	bind(sock,(struct sockaddr*)&addr,sizeof(addr));
+	getsockname(sock,(struct sockaddr*)&addr,&len);
+	port=ntohs(addr.sin_port);
+
+	th=std::thread(&EWBFakeEtherbone::run,this);
+}
+
+EWBFakeEtherbone::~EWBFakeEtherbone()
+{
+	stop=true;
+	th.join();
+	close(sock);
+}
+
+std::string EWBFakeEtherbone::getURL() const
+{
+	return EWBTrace::string_format("udp/127.0.0.1/%d",port);
+}
+
+void EWBFakeEtherbone::run()
+{
+	uint8_t req[0x10000], rep[0x10000];
+	struct sockaddr_in from;
+
+	while(stop==false)
+	{
+		struct pollfd pfd={ sock, POLLIN, 0 };
+		if(poll(&pfd,1,10)<=0) continue;
+
+		socklen_t len=sizeof(from);
+		ssize_t n=recvfrom(sock,req,sizeof(req),0,(struct sockaddr*)&from,&len);
+		if(n<4) continue;
+		if(drop>0) { drop--; continue; }
+
+		size_t nrep=process(req,n,rep);
+		if(nrep) sendto(sock,rep,nrep,0,(struct sockaddr*)&from,len);
+		npackets++;
+	}
+}
+
+/**
+ * Execute a request and encode its reply
+ */
+size_t EWBFakeEtherbone::process(const uint8_t *req, size_t n, uint8_t *rep)
+{
+	const uint8_t *p=req+4, *end=req+n;
+	uint8_t *r=rep;
+
+	if(get32(req)>>16!=EB::EB_MAGIC) return 0;
+	r=put32(r,(EB::EB_MAGIC<<16) | (EB::EB_VER<<12) | EB::EB_W32);
+	if(req[2] & EB::EB_PF)
+	{
+		rep[2] |= EB::EB_PR;
+		return put32(r,0)-rep;
+	}
+
+	while(p+4<=end)
+	{
+		uint8_t flags=p[0], be=p[1], nw=p[2], nr=p[3];
+		p+=4;
+		if(nw>0)
+		{
+			uint32_t base=get32(p);
+			for(int k=0;k<nw;k++)
+			{
+				uint32_t val=get32(p+4+k*4);
+				if(flags & EB::REC_WCA) continue;
+				bool ok=pTarget->mem_access(base+((flags & EB::REC_WFF)?0:k*4),&val,true);
+				esr=(esr<<1) | ((ok)?0:1);
+			}
+			p+=4+nw*4;
+		}
+		if(nr>0)
+		{
+			*r++=((flags & EB::REC_BCA)?EB::REC_WCA:0) | ((flags & EB::REC_RFF)?EB::REC_WFF:0) | (flags & EB::REC_CYC);
+			*r++=be;
+			*r++=nr;
+			*r++=0;
+			r=put32(r,get32(p));
+			for(int k=0;k<nr;k++)
+			{
+				uint32_t addr=get32(p+4+k*4), val=0;
+				if(flags & EB::REC_RCA)
+				{
+					//The config reads do not shift the error register, nor clear it
+					if(addr==0x0) val=esr>>32;
+					else if(addr==0x4) val=(uint32_t)esr;
+				}
+				else
+				{
+					bool ok=pTarget->mem_access(addr,&val,false);
+					esr=(esr<<1) | ((ok)?0:1);
+				}
+				r=put32(r,val);
+			}
+			p+=4+nr*4;
+		}
+	}
+	return r-rep;
+}
@@ -0,0 +1,43 @@
+/*
+ * EWBFakeEtherbone.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef EWBFAKEETHERBONE_H_
+#define EWBFAKEETHERBONE_H_
+
+#include <EWBBridge.h>
+#include <thread>
+#include <atomic>
+
+/**
+ * Local Etherbone (UDP) responder to test the EWBEtherboneCon
+ *
+ * The requests are served by a thread on 127.0.0.1 using the given
+ * bridge (i.e. a RAM image).
+ */
+class EWBFakeEtherbone {
+public:
+	EWBFakeEtherbone(EWBBridge *pTarget);
+	virtual ~EWBFakeEtherbone();
+
+	uint16_t getPort() const { return port; }
+	std::string getURL() const;
+
+	std::atomic<int> drop;		//!< Number of next requests to drop
+	std::atomic<int> npackets;	//!< Number of requests served
+
+private:
+	void run();
+	size_t process(const uint8_t *req, size_t n, uint8_t *rep);
+
+	EWBBridge *pTarget;
+	int sock;
+	uint16_t port;
+	uint64_t esr;		//!< Error shift register (bit 0: error of the last wishbone operation)
+	std::atomic<bool> stop;
+	std::thread th;
+};
+
+#endif /* EWBFAKEETHERBONE_H_ */
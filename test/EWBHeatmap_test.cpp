@@ -0,0 +1,74 @@
+/*
+ * EWBHeatmap_test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBHeatmap.h"
+
+#include "EWBBus.h"
+#include "EWBPeriph.h"
+#include "EWBReg.h"
+#include "EWBField.h"
+#include "EWBFakeBridge.h"
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+namespace {
+
+TEST(EWBHeatmap,Record)
+{
+	EWBFakeBridge b;
+	EWBBus bus(&b,0x10000);
+	EWBPeriph *pP = new EWBPeriph(&bus,"prh",0x100,0x1,0x2);
+	bus.appendPeriph(pP);
+	EWBReg *pR1 = new EWBReg(pP,"r1",0x0);
+	EWBReg *pR2 = new EWBReg(pP,"r2",0x4);
+	EWBField *pF = new EWBField(pR2,"f",4,0);
+
+	EWBHeatmap &h=EWBHeatmap::getInstance();
+	h.reset();
+
+	//Nothing is recorded while disabled
+	EXPECT_FALSE(EWBHeatmap::isEnabled());
+	EXPECT_TRUE(pR1->sync(EWBSync::EWB_AM_R));
+	EXPECT_EQ(0,h.getEntry(0x10100).reads);
+
+	EWBHeatmap::setEnabled(true);
+	EXPECT_TRUE(pR1->sync(EWBSync::EWB_AM_RW));
+	EXPECT_TRUE(pR1->sync(EWBSync::EWB_AM_R));
+
+	uint32_t val=5;
+	pF->convert(&val,false);
+	EXPECT_TRUE(pF->sync(EWBSync::EWB_AM_W));	//Modify the register
+	EXPECT_TRUE(pF->sync(EWBSync::EWB_AM_W));	//Same value: no-op
+	EXPECT_TRUE(pF->sync(EWBSync::EWB_AM_W));	//Same value: no-op
+	EWBHeatmap::setEnabled(false);
+
+	EWBHeatmap::Entry e1=h.getEntry(0x10100);
+	EXPECT_EQ("prh.r1",e1.name);
+	EXPECT_EQ(2,e1.reads);
+	EXPECT_EQ(1,e1.writes);
+	EXPECT_EQ(0,e1.fld_writes);
+
+	EWBHeatmap::Entry e2=h.getEntry(0x10104);
+	EXPECT_EQ("prh.r2",e2.name);
+	EXPECT_EQ(3,e2.reads);
+	EXPECT_EQ(1,e2.writes);
+	EXPECT_EQ(3,e2.fld_writes);
+	EXPECT_EQ(2,e2.fld_noops);
+	EXPECT_EQ(5,b.peek(0x10104));
+
+	std::vector<std::pair<uint32_t,EWBHeatmap::Entry> > top=h.getHottest(1);
+	ASSERT_EQ(1,top.size());
+
+	std::stringstream ss;
+	h.print(ss);
+	EXPECT_NE(std::string::npos,ss.str().find("2/3 no-op field writes"));
+
+	h.reset();
+	EXPECT_EQ(0,h.getEntry(0x10104).reads);
+}
+
+}
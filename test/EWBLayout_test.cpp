@@ -0,0 +1,106 @@
+/*
+ * EWBLayout_test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBLayout.h"
+
+#include "EWBBus.h"
+#include "EWBPeriph.h"
+#include "EWBReg.h"
+#include "EWBField.h"
+#include "EWBBgdRAM.h"
+#include "gtest/gtest.h"
+#include "files/wbtest.h"
+
+namespace {
+
+//! Describe the CSR and DAC registers of the test peripheral
+static void fillLayout(EWBLayout *pL)
+{
+	ASSERT_TRUE(pL->addReg(WB2_REG_ARGS(TEST,CSR)));
+	ASSERT_TRUE(pL->addField(WB2_FIELD_ARGS(TEST,CSR,RST)));
+	ASSERT_TRUE(pL->addField(WB2_FIELD_ARGS(TEST,CSR,ENABLE)));
+	ASSERT_TRUE(pL->addField(WB2_FIELD_ARGS(TEST,CSR,NUMBER)));
+	ASSERT_TRUE(pL->addReg(WB2_REG_ARGS(TEST,DAC)));
+	ASSERT_TRUE(pL->addField(WB2_FIELD_ARGS(TEST,DAC,I)));
+	ASSERT_TRUE(pL->addField(WB2_FIELD_ARGS(TEST,DAC,Q)));
+}
+
+TEST(EWBLayout,Shared)
+{
+	EWBMemRAMCon ram;
+	EWBBus bus(&ram,0x0);
+	//The registry is global: each run (--gtest_repeat) uses its own type
+	static int nruns=0;
+	std::string type="test_shared"+std::to_string(nruns++);
+	EWBLayoutPtr pL=EWBLayout::get(type);
+	EXPECT_EQ(pL,EWBLayout::get(type));
+	ASSERT_TRUE(pL->isEmpty());
+	fillLayout(pL.get());
+
+	EWBPeriph *pP[4];
+	for(int i=0;i<4;i++)
+	{
+		pP[i]=new EWBPeriph(&bus,"chan",0x100*i,0x1,0x2);
+		bus.appendPeriph(pP[i]);
+		EXPECT_TRUE(pL->instantiate(pP[i]));
+	}
+	EXPECT_EQ(4,pL->getNInstances());
+	EXPECT_TRUE(pL->isSealed());
+
+	//The instances only differ by their offset and their data
+	EWBReg *pDac0=pP[0]->getReg(WB2_TEST_REG_DAC), *pDac3=pP[3]->getReg(WB2_TEST_REG_DAC);
+	ASSERT_TRUE(pDac0!=NULL);
+	ASSERT_TRUE(pDac3!=NULL);
+	EXPECT_EQ(pDac0->getLayout(),pDac3->getLayout());
+	EXPECT_EQ(&pDac0->getName(),&pDac3->getName());
+	EXPECT_EQ(0x4,pDac0->getOffset(true));
+	EXPECT_EQ(0x304,pDac3->getOffset(true));
+	ASSERT_EQ(2,pDac3->getFields().size());
+	EWBField *pI0=pDac0->getFields()[0], *pI3=pDac3->getFields()[0];
+	EXPECT_EQ(&pI0->layout(),&pI3->layout());
+	EXPECT_EQ(WB2_TEST_DAC_I_MASK,pI3->getMask());
+
+	//The conversions are the ones of a field created alone
+	EWBField fI(NULL,WB2_FIELD_ARGS(TEST,DAC,I));
+	EXPECT_EQ(fI.getType(),pI3->getType());
+	EXPECT_EQ(fI.getAccessMode(),pI3->getAccessMode());
+	float val=-1.25f, fval;
+	uint32_t data=0, rdata;
+	fI.regCvt(&val,&data,false);
+	ram.poke(0x304,data);
+	EXPECT_TRUE(pDac3->sync(EWBSync::EWB_AM_R));
+	EXPECT_EQ(0,pDac0->getData());
+	EXPECT_TRUE(pI3->convert(&fval,true));
+	EXPECT_FLOAT_EQ(-1.25f,fval);
+	val=100.f;
+	fI.regCvt(&val,&data,false);
+	EXPECT_TRUE(pI0->convert(&val,false));
+	rdata=pDac0->getData();
+	EXPECT_EQ(data & WB2_TEST_DAC_I_MASK,rdata & WB2_TEST_DAC_I_MASK);
+}
+
+TEST(EWBLayout,Errors)
+{
+	EWBMemRAMCon ram;
+	EWBBus bus(&ram,0x0);
+	EWBLayout l("test_errors");
+
+	//The fields are added to the last register without overlapping
+	EXPECT_FALSE(l.addField(WB2_FIELD_ARGS(TEST,CSR,RST)));
+	fillLayout(&l);
+	EXPECT_FALSE(l.addField(WB2_FIELD_ARGS(TEST,DAC,Q)));
+	EXPECT_FALSE(l.addReg(WB2_REG_ARGS(TEST,CSR)));
+
+	//The layout can not be modified once instantiated
+	EWBPeriph *pP=new EWBPeriph(&bus,"chan",0x0,0x1,0x2);
+	bus.appendPeriph(pP);
+	EXPECT_TRUE(l.instantiate(pP));
+	EXPECT_FALSE(l.addReg("other",0x10));
+	EXPECT_EQ(2,l.getRegs().size());
+	EXPECT_FALSE(l.instantiate(NULL));
+}
+
+} // namespace
@@ -0,0 +1,239 @@
+/*
+ * EWBMirror_test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBMirror.h"
+
+#include "EWBBus.h"
+#include "EWBPeriph.h"
+#include "EWBReg.h"
+#include "EWBField.h"
+#include "EWBBgdRAM.h"
+#include "gtest/gtest.h"
+
+#include <thread>
+#include <atomic>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+namespace {
+
+TEST(EWBMirror,Layout)
+{
+	EWBMemRAMCon ram;
+	EWBBus bus(&ram,0x10000);
+	EWBBus *pSub = new EWBBus(&ram,0x20000,&bus);
+	EWBPeriph *pP1 = new EWBPeriph(&bus,"p1",0x100,0x1,0x2);
+	EWBPeriph *pP2 = new EWBPeriph(pSub,"p2",0x0,0x1,0x3);
+	bus.appendPeriph(pP1);
+	pSub->appendPeriph(pP2);
+	new EWBReg(pP1,"r0",0x0);
+	new EWBReg(pP1,"r1",0x8);
+	new EWBReg(pP2,"ctrl",0x4);
+
+	EWBMirror m(&bus,"ewb_test_layout");
+	ASSERT_TRUE(m.isValid());
+	EXPECT_EQ("/ewb_test_layout",m.getName());
+
+	EWBMirrorReader rd("/ewb_test_layout");
+	ASSERT_TRUE(rd.isValid());
+	EXPECT_EQ(2,rd.getNPeriphs());
+	EXPECT_EQ(3,rd.getNRegs());
+	EXPECT_STREQ("p2",rd.getPeriph(1)->name);
+	EXPECT_EQ(0x20000,rd.getPeriph(1)->addr);
+
+	int r=rd.findReg("p1","r1");
+	ASSERT_EQ(1,r);
+	EXPECT_EQ(0x10108,rd.getReg(r)->addr);
+	EXPECT_EQ(0,rd.getReg(r)->periph);
+	EXPECT_EQ(2,rd.findReg("p2","ctrl"));
+	EXPECT_EQ(-1,rd.findReg("p2","none"));
+	EXPECT_EQ(-1,rd.findPeriph("none"));
+	EXPECT_EQ(NULL,rd.getReg(3));
+
+	EXPECT_FALSE(EWBMirrorReader("/ewb_test_none").isValid());
+}
+
+TEST(EWBMirror,Publish)
+{
+	EWBMemRAMCon ram;
+	EWBBus bus(&ram,0x10000);
+	EWBPeriph *pP = new EWBPeriph(&bus,"prh",0x100,0x1,0x2);
+	bus.appendPeriph(pP);
+	EWBReg *pR0 = new EWBReg(pP,"r0",0x0);
+	EWBReg *pR1 = new EWBReg(pP,"r1",0x4);
+	EWBField *pF = new EWBField(pR1,"f",8,4);
+
+	EWBMirror m(&bus,"/ewb_test_publish");
+	EWBMirrorReader rd("/ewb_test_publish");
+	ASSERT_TRUE(rd.isValid());
+	uint32_t vals[4]={ 0 };
+	uint64_t stamp=0;
+
+	//Nothing is published until the mirror is attached
+	ram.poke(0x10100,0x11);
+	ram.poke(0x10104,0x220);
+	EXPECT_TRUE(pP->sync(EWBSync::EWB_AM_R));
+	EXPECT_EQ(2,rd.read(0,vals,4,&stamp));
+	EXPECT_EQ(0,vals[0]);
+	EXPECT_EQ(0,stamp);
+
+	bus.setMirror(&m);
+	EXPECT_EQ(&m,pP->getMirror());
+	EXPECT_TRUE(pP->sync(EWBSync::EWB_AM_R));
+	EXPECT_EQ(2,rd.read(0,vals,4,&stamp));
+	EXPECT_EQ(0x11,vals[0]);
+	EXPECT_EQ(0x220,vals[1]);
+	EXPECT_NE(0,stamp);
+
+	//Register, field and block sync
+	ram.poke(0x10100,0x33);
+	EXPECT_TRUE(pR0->sync(EWBSync::EWB_AM_R));
+	EXPECT_TRUE(rd.readReg(0,vals));
+	EXPECT_EQ(0x33,vals[0]);
+
+	ram.poke(0x10104,0x440);
+	EXPECT_TRUE(pF->sync(EWBSync::EWB_AM_R));
+	EXPECT_TRUE(rd.readReg(1,vals));
+	EXPECT_EQ(0x440,vals[0]);
+
+	ram.poke(0x10100,0x55);
+	EXPECT_TRUE(pP->sync(EWBSync::EWB_AM_R,EWB_NODE_MEMBCK_OWNADDR));
+	EXPECT_EQ(1,rd.read(0,vals,1));
+	EXPECT_EQ(0x55,vals[0]);
+	EXPECT_FALSE(rd.readReg(2,vals));
+}
+
+TEST(EWBMirror,AppendedRegs)
+{
+	EWBMemRAMCon ram;
+	EWBBus bus(&ram,0x10000);
+	EWBPeriph *pP1 = new EWBPeriph(&bus,"p1",0x100,0x1,0x2);
+	EWBPeriph *pP2 = new EWBPeriph(&bus,"p2",0x200,0x1,0x3);
+	bus.appendPeriph(pP1);
+	bus.appendPeriph(pP2);
+	new EWBReg(pP1,"r0",0x0);
+	new EWBReg(pP1,"r2",0x8);
+	new EWBReg(pP2,"r0",0x0);
+
+	EWBMirror m(&bus,"/ewb_test_appended");
+	EWBMirrorReader rd("/ewb_test_appended");
+	ASSERT_TRUE(rd.isValid());
+	bus.setMirror(&m);
+
+	//The registers appended after the creation (between and after) are skipped
+	new EWBReg(pP1,"r1",0x4);
+	for(int i=0;i<8;i++) new EWBReg(pP1,"x"+std::to_string(i),0x10+i*4);
+	for(int i=0;i<0x30;i+=4) ram.poke(0x10100+i,0x100+i);
+	ram.poke(0x10200,0x77);
+	EXPECT_TRUE(pP2->sync(EWBSync::EWB_AM_R));
+	EXPECT_TRUE(pP1->sync(EWBSync::EWB_AM_R));
+
+	uint32_t vals[4]={ 0 };
+	EXPECT_EQ(2,rd.read(0,vals,4));
+	EXPECT_EQ(0x100,vals[0]);
+	EXPECT_EQ(0x108,vals[1]);
+	EXPECT_EQ(1,rd.read(1,vals,4));
+	EXPECT_EQ(0x77,vals[0]);
+}
+
+TEST(EWBMirror,CachedMirror)
+{
+	EWBMemRAMCon ram;
+	EWBBus bus(&ram,0x10000);
+	EWBBus *pSub = new EWBBus(&ram,0x20000,&bus);
+	EWBPeriph *pP1 = new EWBPeriph(&bus,"p1",0x100,0x1,0x2);
+	bus.appendPeriph(pP1);
+	new EWBReg(pP1,"r0",0x0);
+
+	EWBMirror m(&bus,"/ewb_test_cached");
+	EWBMirror m2(&bus,"/ewb_test_cached2");
+	bus.setMirror(&m);
+	EXPECT_EQ(&m,pP1->getMirror());
+
+	//The peripherals added afterward and those of the sub-buses get it too
+	EWBPeriph *pP2 = new EWBPeriph(pSub,"p2",0x0,0x1,0x3);
+	pSub->appendPeriph(pP2);
+	EXPECT_EQ(&m,pP2->getMirror());
+	pSub->setMirror(&m2);
+	EXPECT_EQ(&m2,pP2->getMirror());
+	bus.setMirror(NULL);
+	EXPECT_EQ(NULL,pP1->getMirror());
+	EXPECT_EQ(&m2,pP2->getMirror());
+	pSub->setMirror(NULL);
+	EXPECT_EQ(NULL,pP2->getMirror());
+}
+
+TEST(EWBMirror,LockedSlot)
+{
+	EWBMemRAMCon ram;
+	EWBBus bus(&ram,0x0);
+	EWBPeriph *pP = new EWBPeriph(&bus,"prh",0x0,0x1,0x2);
+	bus.appendPeriph(pP);
+	new EWBReg(pP,"r",0x0);
+
+	EWBMirror m(&bus,"/ewb_test_locked");
+	EWBMirrorReader rd("/ewb_test_locked");
+	ASSERT_TRUE(rd.isValid());
+	uint32_t val;
+	EXPECT_TRUE(rd.readReg(0,&val));
+
+	//A writer died during an update: the readers give up
+	int fd=shm_open("/ewb_test_locked",O_RDWR,0);
+	ASSERT_LE(0,fd);
+	uint8_t *pBase=(uint8_t*)mmap(NULL,m.getSize(),PROT_READ | PROT_WRITE,MAP_SHARED,fd,0);
+	close(fd);
+	ASSERT_NE(MAP_FAILED,pBase);
+	EWBMirrorSlot *pSlot=(EWBMirrorSlot*)(pBase+rd.getPeriph(0)->slot_off);
+	pSlot->seq|=1;
+	EXPECT_FALSE(rd.readReg(0,&val));
+	EXPECT_EQ(-1,rd.read(0,&val,1));
+	pSlot->seq++;
+	EXPECT_TRUE(rd.readReg(0,&val));
+	munmap(pBase,m.getSize());
+}
+
+TEST(EWBMirror,Seqlock)
+{
+	EWBMemRAMCon ram;
+	EWBBus bus(&ram,0x0);
+	EWBPeriph *pP = new EWBPeriph(&bus,"prh",0x0,0x1,0x2);
+	bus.appendPeriph(pP);
+	for(int i=0;i<64;i++) new EWBReg(pP,"r",i*4);
+
+	EWBMirror m(&bus,"/ewb_test_seqlock");
+	bus.setMirror(&m);
+	EWBMirrorReader rd("/ewb_test_seqlock");
+	ASSERT_TRUE(rd.isValid());
+
+	//The writer sets all the registers to the same value
+	std::atomic<bool> done(false);
+	std::thread th([&]() {
+		for(uint32_t k=1;k<=2000;k++)
+		{
+			for(int i=0;i<64;i++) ram.poke(i*4,k);
+			pP->sync(EWBSync::EWB_AM_R,EWB_NODE_MEMBCK_OWNADDR);
+		}
+		done=true;
+	});
+
+	//so a reader must never see a mix of values
+	int ntorn=0, nreads=0;
+	uint32_t vals[64];
+	while(!done)
+	{
+		ASSERT_EQ(64,rd.read(0,vals,64));
+		for(int i=1;i<64;i++) if(vals[i]!=vals[0]) { ntorn++; break; }
+		nreads++;
+	}
+	th.join();
+	EXPECT_EQ(0,ntorn);
+	EXPECT_LT(0,nreads);
+	ASSERT_EQ(64,rd.read(0,vals,64));
+	EXPECT_EQ(2000,vals[63]);
+}
+
+} // namespace
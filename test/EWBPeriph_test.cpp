@@ -9,9 +9,70 @@
 
 #include "EWBReg.h"
 #include "EWBField.h"
+#include "EWBBgdRAM.h"
 #include "gtest/gtest.h"
 #include "files/wbtest.h"
 
+#include <unistd.h>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+
+/**
+ * Latency model where a block access waits (up to 5s) until a block access
+ * of each direction has started, so that they must overlap.
+ */
+class EWBLatchModel: public EWBLatencyModel {
+public:
+	EWBLatchModel() : EWBLatencyModel(0,0,0,0,0x8000), nstarted(0) {};
+	uint64_t cost(bool block, uint32_t /*nbytes*/, bool /*to_dev*/) const
+	{
+		if(block==false) return 0;
+		std::unique_lock<std::mutex> lock(mtx);
+		nstarted++;
+		cv.notify_all();
+		cv.wait_for(lock,std::chrono::seconds(5),[this]() { return nstarted>=2; });
+		return 0;
+	}
+private:
+	mutable std::mutex mtx;
+	mutable std::condition_variable cv;
+	mutable int nstarted;
+};
+
+//! X1052 model that keeps the kind of the accesses (block or single) in order
+class EWBOrderModel: public EWBLatencyModel {
+public:
+	EWBOrderModel() : EWBLatencyModel(EWBLatencyModel::X1052()) {};
+	uint64_t cost(bool block, uint32_t nbytes, bool to_dev) const
+	{
+		blocks.push_back(block);
+		return EWBLatencyModel::cost(block,nbytes,to_dev);
+	}
+	mutable std::vector<bool> blocks;
+};
+
+//! Model that keeps the threads that performed the block writes
+class EWBWriterModel: public EWBLatencyModel {
+public:
+	uint64_t cost(bool block, uint32_t /*nbytes*/, bool to_dev) const
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		if(block && to_dev) writers.push_back(std::this_thread::get_id());
+		return 0;
+	}
+	mutable std::mutex mtx;
+	mutable std::vector<std::thread::id> writers;
+};
+
+//! RAM where the calling thread can pretend to be in a cycle
+class EWBCycleRAM: public EWBMemRAMCon {
+public:
+	EWBCycleRAM() : cycle(false) {};
+	bool inCycle() const { return cycle; }
+	bool cycle;
+};
+
 TEST(EWBPeriph,SimpleConstructor)
 {
 	EWBPeriph p(NULL,WB2_TEST_PERIPH_PREFIX,0x40000000,0x1234567,0xABCDEF);
@@ -65,7 +126,7 @@ TEST(EWBPeriph,BadRegOffset)
 
 TEST(EWBPeriph,TreeStructure)
 {
-	EWBPeriph *pP = new EWBPeriph(NULL,WB2_PRH_ARGS(TEST,0x60000000));
+	EWBPeriph *pP = new EWBPeriph(NULL,WB2_PRH_ARGS_OFFSET(TEST,0x60000000));
 
 	EWBReg *pRFix = new EWBReg(pP,WB2_REG_ARGS(TEST,BFIXED));
 	EWBField *pRFixF2 = new EWBField(pRFix,WB2_FIELD_ARGS(TEST,BFIXED,SIGN1));
@@ -120,3 +181,267 @@ TEST(EWBPeriph,TreeStructure)
 
 	delete pP;
 }
+
+TEST(EWBPeriph,ChunkedBlockSync)
+{
+	EWBMemRAMCon ram;
+	EWBBus bus(&ram,0x10000);
+	EWBPeriph *pP = new EWBPeriph(&bus,WB2_TEST_PERIPH_PREFIX,0x1000,0x1,0x2);
+	bus.appendPeriph(pP);
+
+	//Bridge buffer of 1KiB for a peripheral of 4KiB (with holes)
+	ram.setLatencyModel(EWBLatencyModel(0,0,0,0,0x400));
+	for(int i=0;i<1024;i+=3)
+	{
+		new EWBReg(pP,"r"+std::to_string(i),i*4);
+		ram.poke(0x11000+i*4,i*5);
+	}
+	ASSERT_EQ(0xFFC,pP->getLastReg()->getOffset(false));
+
+	EXPECT_TRUE(pP->sync(EWBSync::EWB_AM_R,EWB_NODE_MEMBCK_OWNADDR));
+	EXPECT_EQ(4,ram.getStats().getCount(EWBBridgeStats::BLOCK_R));
+	for(int i=0;i<1024;i+=3) ASSERT_EQ(i*5,pP->getReg(i*4)->getData());
+
+	ram.clear();
+	EXPECT_TRUE(pP->sync(EWBSync::EWB_AM_W,EWB_NODE_MEMBCK_OWNADDR));
+	EXPECT_EQ(4,ram.getStats().getCount(EWBBridgeStats::BLOCK_W));
+	for(int i=0;i<1024;i+=3) ASSERT_EQ(i*5,ram.peek(0x11000+i*4));
+}
+
+TEST(EWBPeriph,ReadAhead)
+{
+	EWBMemRAMCon ram;
+	EWBBus bus(&ram,0x10000);
+	EWBPeriph *pP = new EWBPeriph(&bus,WB2_TEST_PERIPH_PREFIX,0x1000,0x1,0x2);
+	bus.appendPeriph(pP);
+	EWBReg *pR[32];
+	for(int i=0;i<32;i++)
+	{
+		pR[i]=new EWBReg(pP,"r"+std::to_string(i),i*4);
+		ram.poke(0x11000+i*4,0x100+i);
+	}
+	EWBField *pF=new EWBField(pR[5],"fld",8,0);
+
+	EXPECT_FALSE(pP->setReadAhead(48));
+	EXPECT_TRUE(pP->setReadAhead(64,1000000));
+	EXPECT_EQ(64,pP->getReadAhead());
+
+	//The 16 registers of the first window are read with one block
+	for(int i=0;i<16;i++)
+	{
+		EXPECT_TRUE(pR[i]->sync(EWBSync::EWB_AM_R));
+		EXPECT_EQ(0x100+i,pR[i]->getData());
+	}
+	EXPECT_TRUE(pF->sync(EWBSync::EWB_AM_R));
+	EXPECT_EQ(0x05,pF->getU32());
+	EXPECT_EQ(1,ram.getStats().getCount(EWBBridgeStats::BLOCK_R));
+	EXPECT_EQ(0,ram.getStats().getCount(EWBBridgeStats::SINGLE_R));
+	EXPECT_EQ(16,pP->getReadAheadHits());
+
+	//A write invalidates the window
+	uint32_t val=0xAA;
+	EXPECT_TRUE(pF->convert(&val,false));
+	EXPECT_TRUE(pF->sync(EWBSync::EWB_AM_W));
+	EXPECT_EQ(0x1AA,ram.peek(0x11014));
+	ram.poke(0x11004,0x55);
+	EXPECT_TRUE(pR[1]->sync(EWBSync::EWB_AM_R));
+	EXPECT_EQ(0x55,pR[1]->getData());
+	EXPECT_EQ(2,pP->getReadAheadFetches());
+
+	//A volatile register is read alone and prevents the read-ahead of its window
+	pR[20]->setVolatile();
+	EXPECT_TRUE(pR[17]->sync(EWBSync::EWB_AM_R));
+	EXPECT_TRUE(pR[20]->sync(EWBSync::EWB_AM_R));
+	EXPECT_EQ(0x114,pR[20]->getData());
+	EXPECT_EQ(1+2,ram.getStats().getCount(EWBBridgeStats::SINGLE_R));	//With the read of the field write
+	EXPECT_EQ(2,pP->getReadAheadFetches());
+
+	//The window is not used by the sync of the whole peripheral
+	EXPECT_TRUE(pP->sync(EWBSync::EWB_AM_R));
+	EXPECT_EQ(3+32,ram.getStats().getCount(EWBBridgeStats::SINGLE_R));
+
+	//and it expires
+	EXPECT_TRUE(pP->setReadAhead(64,0));
+	EXPECT_TRUE(pR[0]->sync(EWBSync::EWB_AM_R));
+	usleep(10);
+	EXPECT_TRUE(pR[1]->sync(EWBSync::EWB_AM_R));
+	EXPECT_EQ(4,pP->getReadAheadFetches());
+}
+
+TEST(EWBPeriph,PlannedSync)
+{
+	EWBMemRAMCon ram;
+	ram.setLatencyModel(EWBLatencyModel::X1052());
+	EWBBus bus(&ram,0x10000);
+	EWBPeriph *pP = new EWBPeriph(&bus,WB2_TEST_PERIPH_PREFIX,0x1000,0x1,0x2);
+	bus.appendPeriph(pP);
+	EWBReg *pR[56];
+	for(int i=0;i<56;i++)
+	{
+		pR[i]=new EWBReg(pP,"r"+std::to_string(i),(i<48)?i*4:0x400+i*4);
+		ram.poke(0x11000+pR[i]->getOffset(),0x100+i);
+	}
+	pR[2]->setVolatile();
+
+	//One block for 3-55 (cheaper than two, even with the hole), the first registers alone
+	EXPECT_TRUE(pP->sync(EWBSync::EWB_AM_R));
+	for(int i=0;i<56;i++) EXPECT_EQ(0x100+i,pR[i]->getData());
+	EXPECT_EQ(1,ram.getStats().getCount(EWBBridgeStats::BLOCK_R));
+	EXPECT_EQ(3,ram.getStats().getCount(EWBBridgeStats::SINGLE_R));
+
+	//The writes are never padded: no block for the 8 last registers
+	ram.clear();
+	EXPECT_TRUE(pP->sync(EWBSync::EWB_AM_W));
+	for(int i=0;i<56;i++) EXPECT_EQ(0x100+i,ram.peek(0x11000+pR[i]->getOffset()));
+	EXPECT_EQ(1,ram.getStats().getCount(EWBBridgeStats::BLOCK_W));
+	EXPECT_EQ(3+8,ram.getStats().getCount(EWBBridgeStats::SINGLE_W));
+
+	//The plans are kept until the registers change
+	EXPECT_EQ(2,pP->getNPlans());
+	EXPECT_TRUE(pP->sync(EWBSync::EWB_AM_RW));
+	EXPECT_EQ(2,pP->getNPlans());
+	pR[2]->setVolatile(false);
+	EXPECT_TRUE(pP->sync(EWBSync::EWB_AM_R));
+	EXPECT_EQ(3,pP->getNPlans());
+	EXPECT_EQ(3,ram.getStats().getCount(EWBBridgeStats::BLOCK_R));
+	EXPECT_EQ(6,ram.getStats().getCount(EWBBridgeStats::SINGLE_R));
+	pR[2]->setVolatile();
+	EXPECT_TRUE(pP->sync(EWBSync::EWB_AM_R));
+	EXPECT_EQ(4,pP->getNPlans());
+	EXPECT_EQ(9,ram.getStats().getCount(EWBBridgeStats::SINGLE_R));
+
+	//Any set of registers
+	std::vector<EWBReg*> regs;
+	regs.push_back(pR[47]);
+	regs.push_back(pR[48]);
+	ram.poke(0x11000+pR[48]->getOffset(),0x55);
+	EXPECT_TRUE(EWBPeriph::syncRegs(regs,EWBSync::EWB_AM_R));
+	EXPECT_EQ(0x55,pR[48]->getData());
+	EXPECT_EQ(9+2,ram.getStats().getCount(EWBBridgeStats::SINGLE_R));
+
+	//A custom cost model is used by the planner, the writes follow the addresses
+	EWBOrderModel order;
+	ram.setLatencyModel(&order);
+	EXPECT_EQ(&order,&ram.getCostModel());
+	EXPECT_TRUE(pP->sync(EWBSync::EWB_AM_W));
+	EXPECT_EQ(5,pP->getNPlans());
+	order.blocks.clear();
+	EXPECT_TRUE(pP->sync(EWBSync::EWB_AM_W));
+	EXPECT_EQ(5,pP->getNPlans());
+	bool blocks[]={ false, false, false, true, false, false, false, false, false, false, false, false };
+	EXPECT_EQ(std::vector<bool>(blocks,blocks+12),order.blocks);
+	ram.setLatencyModel((EWBLatencyModel*)NULL);
+}
+
+TEST(EWBPeriph,PlannedSyncPeriphBoundary)
+{
+	EWBMemRAMCon ram;
+	ram.setLatencyModel(EWBLatencyModel::X1052());
+	EWBBus bus(&ram,0x10000);
+	EWBPeriph *pA = new EWBPeriph(&bus,"A",0x100,0x1,0x2);
+	EWBPeriph *pB = new EWBPeriph(&bus,"B",0x180,0x1,0x3);
+	EWBPeriph *pC = new EWBPeriph(&bus,"C",0x200,0x1,0x4);
+	bus.appendPeriph(pA);
+	bus.appendPeriph(pB);
+	bus.appendPeriph(pC);
+	std::vector<EWBReg*> regs;
+	for(int i=0;i<8;i++)
+	{
+		regs.push_back(new EWBReg(pA,"a"+std::to_string(i),i*4));
+		regs.push_back(new EWBReg(pC,"c"+std::to_string(i),i*4));
+		ram.poke(0x10100+i*4,0x100+i);
+		ram.poke(0x10200+i*4,0x200+i);
+	}
+	EWBReg *pFifo = new EWBReg(pB,"fifo",0x0);
+	pFifo->setVolatile();
+
+	//One block by peripheral, nothing of B is read
+	EXPECT_TRUE(EWBPeriph::syncRegs(regs,EWBSync::EWB_AM_R));
+	for(int i=0;i<8;i++)
+	{
+		EXPECT_EQ(0x100+i,pA->getReg(i*4)->getData());
+		EXPECT_EQ(0x200+i,pC->getReg(i*4)->getData());
+	}
+	EXPECT_EQ(2,ram.getStats().getCount(EWBBridgeStats::BLOCK_R));
+	EXPECT_EQ(0,ram.getStats().getCount(EWBBridgeStats::SINGLE_R));
+	EXPECT_EQ(2*8*4,ram.getStats().getBytes(EWBBridgeStats::BLOCK_R));
+	ram.setLatencyModel((EWBLatencyModel*)NULL);
+}
+
+TEST(EWBPeriph,DuplexBlockSync)
+{
+	EWBMemRAMCon ram;
+	EWBBus bus(&ram,0x10000);
+	EWBPeriph *pCfg = new EWBPeriph(&bus,"cfg",0x1000,0x1,0x2);
+	EWBPeriph *pStat = new EWBPeriph(&bus,"stat",0x2000,0x1,0x3);
+	bus.appendPeriph(pCfg);
+	bus.appendPeriph(pStat);
+	EWBField *pF[16];
+	for(int i=0;i<16;i++)
+	{
+		pF[i]=new EWBField(new EWBReg(pCfg,"c"+std::to_string(i),i*4),"v",32,0);
+		uint32_t val=0x100+i;
+		pF[i]->convert(&val,false);
+		new EWBReg(pStat,"s"+std::to_string(i),i*4);
+		ram.poke(0x12000+i*4,0x200+i);
+	}
+	std::vector<EWBPeriph*> wr(1,pCfg), rd(1,pStat);
+
+	//Without duplex the write is performed before the read
+	EXPECT_TRUE(EWBPeriph::syncBlocks(wr,rd));
+	EXPECT_EQ(0,ram.getNOverlaps());
+	EXPECT_EQ(0x10F,ram.peek(0x1103C));
+	EXPECT_EQ(0x20F,pStat->getReg(0x3C)->getData());
+
+	//With duplex they overlap: the first block access waits for the other one
+	EWBLatchModel latch;
+	ram.setLatencyModel(&latch);
+	ram.setDuplex();
+	EXPECT_TRUE(ram.isDuplex());
+	ram.poke(0x1203C,0x30F);
+	EXPECT_TRUE(EWBPeriph::syncBlocks(wr,rd));
+	EXPECT_EQ(1,ram.getNOverlaps());
+	EXPECT_EQ(0x30F,pStat->getReg(0x3C)->getData());
+	EXPECT_EQ(2,ram.getStats().getCount(EWBBridgeStats::BLOCK_W));
+	EXPECT_EQ(2,ram.getStats().getCount(EWBBridgeStats::BLOCK_R));
+	ram.setLatencyModel((EWBLatencyModel*)NULL);
+
+	//A peripheral written and read is read after its write
+	ram.poke(0x11000,0);
+	rd.push_back(pCfg);
+	EXPECT_TRUE(EWBPeriph::syncBlocks(wr,rd));
+	EXPECT_EQ(0x100,pCfg->getReg(0x0)->getData());
+}
+
+TEST(EWBPeriph,BlockSyncWorker)
+{
+	EWBCycleRAM ram;
+	EWBWriterModel model;
+	ram.setLatencyModel(&model);
+	ram.setDuplex();
+	EWBBus bus(&ram,0x10000);
+	EWBPeriph *pCfg = new EWBPeriph(&bus,"cfg",0x1000,0x1,0x2);
+	EWBPeriph *pStat = new EWBPeriph(&bus,"stat",0x2000,0x1,0x3);
+	bus.appendPeriph(pCfg);
+	bus.appendPeriph(pStat);
+	for(int i=0;i<4;i++)
+	{
+		new EWBReg(pCfg,"c"+std::to_string(i),i*4);
+		new EWBReg(pStat,"s"+std::to_string(i),i*4);
+	}
+	std::vector<EWBPeriph*> wr(1,pCfg), rd(1,pStat);
+
+	//The writes are performed by the same worker at each call
+	EXPECT_TRUE(EWBPeriph::syncBlocks(wr,rd));
+	EXPECT_TRUE(EWBPeriph::syncBlocks(wr,rd));
+	ASSERT_EQ(2,model.writers.size());
+	EXPECT_NE(std::this_thread::get_id(),model.writers[0]);
+	EXPECT_EQ(model.writers[0],model.writers[1]);
+
+	//but by the caller inside its cycle
+	ram.cycle=true;
+	EXPECT_TRUE(EWBPeriph::syncBlocks(wr,rd));
+	ASSERT_EQ(3,model.writers.size());
+	EXPECT_EQ(std::this_thread::get_id(),model.writers[2]);
+	ram.setLatencyModel((EWBLatencyModel*)NULL);
+}
@@ -0,0 +1,237 @@
+/*
+ * EWBSequence_test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBSequence.h"
+
+#include "EWBBus.h"
+#include "EWBPeriph.h"
+#include "EWBReg.h"
+#include "EWBField.h"
+#include "EWBBgdRAM.h"
+#include "EWBDaemon.h"
+#include "EWBBgdDaemon.h"
+#include "gtest/gtest.h"
+
+#include <thread>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+namespace {
+
+#define EWBD_TEST_SOCKET "/tmp/ewbd_seq_test.sock"
+
+//! A peripheral with a control and a status register
+struct Device {
+	EWBBus bus;
+	EWBPeriph *pP;
+	EWBReg *pCtrl, *pStat, *pData;
+	EWBField *pReset, *pMode, *pReady;
+	Device(EWBBridge *pBgd): bus(pBgd,0x0)
+	{
+		pP=new EWBPeriph(&bus,"dev",0x100,0x1,0x2);
+		bus.appendPeriph(pP);
+		pCtrl=new EWBReg(pP,"ctrl",0x0);
+		pReset=new EWBField(pCtrl,"reset",1,0);
+		pMode=new EWBField(pCtrl,"mode",4,4);
+		pStat=new EWBReg(pP,"stat",0x4);
+		pReady=new EWBField(pStat,"ready",1,8);
+		pData=new EWBReg(pP,"data",0x8);
+	}
+};
+
+TEST(EWBSequence,Local)
+{
+	EWBMemRAMCon ram;
+	Device dev(&ram);
+	ram.poke(0x100,0xF000);
+	ram.poke(0x108,0x1234);
+
+	//The device is ready 2ms after the reset
+	std::thread th([&ram]() { usleep(2000); ram.poke(0x104,0x100); });
+	EWBSequence seq;
+	seq.write(dev.pReset,1).write(dev.pMode,0x5).poll(dev.pReady,1,500000)
+		.write(dev.pData,0xABCD).read(dev.pData).delay(100).write(dev.pReset,0);
+	EXPECT_EQ(7,seq.size());
+	EXPECT_FALSE(seq.isCompiled());
+	EXPECT_TRUE(seq.run());
+	th.join();
+	EXPECT_TRUE(seq.isCompiled());
+	EXPECT_EQ(&ram,seq.getBridge());
+
+	//Only the bits of the fields are modified
+	EXPECT_EQ(0xF050,ram.peek(0x100));
+	EXPECT_EQ(0xABCD,ram.peek(0x108));
+	ASSERT_EQ(2,seq.getData().size());
+	EXPECT_EQ(0x100,seq.getData()[0]);
+	EXPECT_EQ(0xABCD,seq.getData()[1]);
+	EXPECT_EQ(0x100,dev.pStat->getData());
+	EXPECT_EQ(0xABCD,dev.pData->getData());
+	EXPECT_EQ(0x50,dev.pCtrl->getData());
+
+	//The compiled sequence is reused
+	const std::vector<EWBSeqOp> &ops=seq.getOps();
+	ASSERT_EQ(7,ops.size());
+	EXPECT_EQ(EWBSeqOp::WRITE_MASK,ops[1].type);
+	EXPECT_EQ(0x100,ops[1].addr);
+	EXPECT_EQ(0xF0,ops[1].mask);
+	EXPECT_EQ(0x50,ops[1].value);
+	EXPECT_EQ(0x104,ops[2].addr);
+	EXPECT_EQ(0x100,ops[2].value);
+	ram.poke(0x108,0);
+	EXPECT_TRUE(seq.run());
+	EXPECT_EQ(0xABCD,ram.peek(0x108));
+
+	//until the bridge reconnects
+	ram.bumpGeneration();
+	EXPECT_FALSE(seq.isCompiled());
+	ram.poke(0x108,0);
+	EXPECT_TRUE(seq.run());
+	EXPECT_TRUE(seq.isCompiled());
+	EXPECT_EQ(0xABCD,ram.peek(0x108));
+}
+
+TEST(EWBSequence,Errors)
+{
+	EWBMemRAMCon ram, ram2;
+	Device dev(&ram), dev2(&ram2);
+
+	//The poll times out and the next steps are not executed
+	EWBSequence seq;
+	seq.poll(dev.pReady,1,1000).write(dev.pData,0x1);
+	EXPECT_FALSE(seq.run());
+	EXPECT_EQ(0x0,ram.peek(0x108));
+
+	//The handles must be valid and on the same bridge
+	seq.clear();
+	seq.write(dev.pData,0x1).write(dev2.pData,0x2);
+	EXPECT_FALSE(seq.compile());
+	seq.clear();
+	seq.read((EWBReg*)NULL);
+	EXPECT_FALSE(seq.run());
+	seq.clear();
+	EXPECT_TRUE(seq.delay(10).run());
+}
+
+TEST(EWBSequence,OnlyDelays)
+{
+	//Without a bridge the delays are waited locally
+	EWBSequence seq;
+	seq.delay(20000).delay(30000);
+	uint64_t t0=EWBBridgeStats::now_ns();
+	EXPECT_TRUE(seq.run());
+	EXPECT_LE(50000000,EWBBridgeStats::now_ns()-t0);
+	EXPECT_EQ(NULL,seq.getBridge());
+}
+
+TEST(EWBSequence,Daemon)
+{
+	EWBMemRAMCon ram;
+	EWBDaemon d(&ram,EWBD_TEST_SOCKET);
+	ASSERT_TRUE(d.start());
+	EWBMemDaemonCon con(EWBD_TEST_SOCKET);
+	ASSERT_TRUE(con.isValid());
+	Device dev(&con);
+	ram.poke(0x104,0x100);
+
+	EWBSequence seq;
+	seq.write(dev.pMode,0x3).poll(dev.pReady,1,100000).write(dev.pData,0x77).read(dev.pCtrl);
+	EXPECT_TRUE(seq.run());
+	EXPECT_EQ(0x30,ram.peek(0x100));
+	EXPECT_EQ(0x77,ram.peek(0x108));
+	EXPECT_EQ(0x30,dev.pCtrl->getData());
+
+	//The whole sequence was executed by the daemon
+	EXPECT_EQ(1,d.getNSequences());
+	EXPECT_EQ(1,d.getNRounds());
+
+	//A failing sequence is reported to the client
+	seq.clear();
+	seq.poll(dev.pReady,0,1000);
+	EXPECT_FALSE(seq.run());
+	EXPECT_TRUE(con.isValid());
+	d.stop();
+}
+
+TEST(EWBSequence,DaemonNotBlocked)
+{
+	EWBMemRAMCon ram;
+	EWBDaemon d(&ram,EWBD_TEST_SOCKET);
+	ASSERT_TRUE(d.start());
+	EWBMemDaemonCon c1(EWBD_TEST_SOCKET), c2(EWBD_TEST_SOCKET);
+	ASSERT_TRUE(c1.isValid());
+	ASSERT_TRUE(c2.isValid());
+	Device dev(&c1);
+
+	//The first client waits (up to 5s) for a bit that is only set by the second one
+	bool ret=false;
+	EWBSequence seq;
+	seq.poll(dev.pReady,1,5000000).write(dev.pData,0x77);
+	std::thread th([&]() { ret=seq.run(); });
+	for(int i=0;i<1000 && ram.getStats().getCount(EWBBridgeStats::SINGLE_R)==0;i++) usleep(1000);
+
+	uint32_t val=0x100;
+	EXPECT_TRUE(c2.mem_access(0x104,&val,true));
+	th.join();
+	EXPECT_TRUE(ret);
+	EXPECT_EQ(0x77,ram.peek(0x108));
+	EXPECT_EQ(1,d.getNSequences());
+
+	//The first client is served again after its sequence
+	val=0;
+	EXPECT_TRUE(c1.mem_access(0x108,&val,false));
+	EXPECT_EQ(0x77,val);
+	d.stop();
+}
+
+TEST(EWBSequence,DaemonClientGone)
+{
+	EWBMemRAMCon ram;
+	EWBDaemon d(&ram,EWBD_TEST_SOCKET);
+	ASSERT_TRUE(d.start());
+	ram.poke(0x108,0x55);
+
+	//A client sends a long POLL sequence and disconnects during it
+	struct sockaddr_un addr;
+	memset(&addr,0,sizeof(addr));
+	addr.sun_family=AF_UNIX;
+	strncpy(addr.sun_path,EWBD_TEST_SOCKET,sizeof(addr.sun_path)-1);
+	int fd=socket(AF_UNIX,SOCK_STREAM,0);
+	ASSERT_EQ(0,connect(fd,(struct sockaddr*)&addr,sizeof(addr)));
+	EWBSeqOp step={ EWBSeqOp::POLL, 0x104, 0x100, 0x100, 5000000 };
+	EWBDaemonOp op={ EWBDaemonOp::SEQUENCE, 0, sizeof(step) };
+	EWBDaemonHdr hdr={ EWBD_MAGIC, 1, sizeof(op)+sizeof(step) };
+	std::vector<uint8_t> req((uint8_t*)&hdr,(uint8_t*)&hdr+sizeof(hdr));
+	req.insert(req.end(),(uint8_t*)&op,(uint8_t*)&op+sizeof(op));
+	req.insert(req.end(),(uint8_t*)&step,(uint8_t*)&step+sizeof(step));
+	ASSERT_EQ((ssize_t)req.size(),send(fd,&req[0],req.size(),0));
+	for(int i=0;i<1000 && ram.getStats().getCount(EWBBridgeStats::SINGLE_R)==0;i++) usleep(1000);
+	close(fd);
+	usleep(20000);
+
+	//A new client (that might get the same socket) is not replied the finished sequence
+	EWBMemDaemonCon con(EWBD_TEST_SOCKET);
+	ASSERT_TRUE(con.isValid());
+	uint32_t val=0;
+	EXPECT_TRUE(con.mem_access(0x108,&val,false));
+	EXPECT_EQ(0x55,val);
+	ram.poke(0x104,0x100);
+	for(int i=0;i<1000 && d.getNSequences()==0;i++) usleep(1000);
+	EXPECT_EQ(1,d.getNSequences());
+	usleep(20000);
+
+	val=0;
+	EXPECT_TRUE(con.mem_access(0x108,&val,false));
+	EXPECT_EQ(0x55,val);
+	val=0;
+	EXPECT_TRUE(con.mem_access(0x108,&val,false));
+	EXPECT_EQ(0x55,val);
+	d.stop();
+	EXPECT_EQ(1,d.getNClients());
+}
+
+} // namespace
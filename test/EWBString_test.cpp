@@ -0,0 +1,88 @@
+/*
+ * EWBString_test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBString.h"
+
+#include "EWBBus.h"
+#include "EWBPeriph.h"
+#include "EWBReg.h"
+#include "EWBField.h"
+#include "EWBBgdRAM.h"
+#include "gtest/gtest.h"
+#include "files/wbtest.h"
+
+#include <thread>
+#include <vector>
+
+namespace {
+
+TEST(EWBString,Intern)
+{
+	EWBString a("ewbstring_test_a"), b(std::string("ewbstring_test_a")), c("ewbstring_test_c"), e;
+	EXPECT_TRUE(a==b);
+	EXPECT_TRUE(a!=c);
+	EXPECT_EQ(&a.str(),&b.str());
+	EXPECT_EQ(a.id(),b.id());
+	EXPECT_EQ("ewbstring_test_a",a.str());
+	EXPECT_TRUE(e.empty());
+	EXPECT_TRUE(e==EWBString((const char*)NULL));
+
+	//The lookup does not add the string
+	size_t n=EWBString::getNStrings();
+	EWBString f;
+	EXPECT_FALSE(EWBString::find("ewbstring_test_unknown",&f));
+	EXPECT_TRUE(EWBString::find("ewbstring_test_c",&f));
+	EXPECT_TRUE(f==c);
+	EXPECT_EQ(n,EWBString::getNStrings());
+}
+
+TEST(EWBString,Concurrent)
+{
+	std::vector<std::thread> ths;
+	const void *ids[4]={ NULL };
+	for(int i=0;i<4;i++)
+	{
+		ths.push_back(std::thread([&ids,i]() {
+			for(int k=0;k<1000;k++) EWBString s("ewbstring_conc_"+std::to_string(k));
+			ids[i]=EWBString("ewbstring_conc_999").id();
+		}));
+	}
+	for(size_t i=0;i<ths.size();i++) ths[i].join();
+	for(int i=1;i<4;i++) EXPECT_EQ(ids[0],ids[i]);
+}
+
+TEST(EWBString,Tree)
+{
+	EWBMemRAMCon ram;
+	EWBBus bus(&ram,0x0);
+	EWBPeriph *pP[2];
+	EWBReg *pReg[2];
+	for(int i=0;i<2;i++)
+	{
+		pP[i]=new EWBPeriph(&bus,"strdev",0x100*i,0x1,0x2);
+		bus.appendPeriph(pP[i]);
+		pReg[i]=new EWBReg(pP[i],WB2_REG_ARGS(TEST,CSR));
+		new EWBField(pReg[i],WB2_FIELD_ARGS(TEST,CSR,RST));
+		new EWBField(pReg[i],WB2_FIELD_ARGS(TEST,CSR,NUMBER));
+	}
+
+	//The names and descriptions are stored once
+	EXPECT_EQ(&pP[0]->getName(),&pP[1]->getName());
+	EXPECT_EQ(&pReg[0]->getDesc(),&pReg[1]->getDesc());
+	EXPECT_EQ(&pReg[0]->getFields()[WB2_TEST_CSR_NUMBER_INDEX]->getDesc(),&pReg[1]->getFields()[WB2_TEST_CSR_NUMBER_INDEX]->getDesc());
+
+	//The lookups by name
+	const EWBField *pFld=pReg[1]->getField(WB2_TEST_CSR_NUMBER_PREFIX);
+	ASSERT_TRUE(pFld!=NULL);
+	EXPECT_EQ(pReg[1]->getFields()[WB2_TEST_CSR_NUMBER_INDEX],pFld);
+	EXPECT_EQ(pFld,pReg[1]->getField(EWBString(WB2_TEST_CSR_NUMBER_PREFIX)));
+	EXPECT_EQ(NULL,pReg[1]->getField("ewbstring_no_field"));
+	EXPECT_EQ(pP[0],bus.findPeriph("strdev"));
+	EXPECT_EQ(pP[0],bus.findPeriph(pP[1]->getNameId()));
+	EXPECT_EQ(NULL,bus.findPeriph("ewbstring_no_periph"));
+}
+
+} // namespace
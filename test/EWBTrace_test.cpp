@@ -5,5 +5,82 @@
  *      Author: Benoit Rat (benoit<AT>sevensols.com)
  */
 
+#define EWB_TRACE_MODULE EWB_TRACE_BRIDGE
 #include "EWBTrace.h"
+#include "gtest/gtest.h"
 
+#include <cstring>
+
+namespace {
+
+TEST(EWBTrace,Modules)
+{
+	EXPECT_EQ(EWB_TRACE_CORE,EWBTrace::findModule("core"));
+	EXPECT_EQ(EWB_TRACE_BRIDGE,EWBTrace::findModule("bridge"));
+	EXPECT_EQ(EWB_TRACE_ASYN,EWBTrace::findModule("asyn"));
+	EXPECT_EQ(EWB_TRACE_CONSOLE,EWBTrace::findModule("console"));
+	EXPECT_EQ(EWB_TRACE_NMODULES,EWBTrace::findModule("all"));
+	EXPECT_EQ(-1,EWBTrace::findModule("unknown"));
+	EXPECT_EQ(-1,EWBTrace::findModule(NULL));
+
+	EXPECT_STREQ("bridge",EWBTrace::getModuleName(EWB_TRACE_BRIDGE));
+	EXPECT_EQ(NULL,EWBTrace::getModuleName(EWB_TRACE_NMODULES));
+}
+
+TEST(EWBTrace,RuntimeLevel)
+{
+	EXPECT_EQ(TRACE_LEVEL_DEFAULT,EWBTrace::getLevel(EWB_TRACE_BRIDGE));
+	EXPECT_FALSE(TRACE_ENABLED(TRACE_LEVEL_VDEBUG));
+
+	//Only the bridge module is verbose
+	EXPECT_TRUE(EWBTrace::setLevel(EWB_TRACE_BRIDGE,TRACE_LEVEL_VDEBUG));
+	EXPECT_EQ(TRACE_LEVEL_VDEBUG,EWBTrace::getLevel(EWB_TRACE_BRIDGE));
+	EXPECT_EQ(TRACE_LEVEL_DEFAULT,EWBTrace::getLevel(EWB_TRACE_CORE));
+	EXPECT_TRUE(TRACE_ENABLED(TRACE_LEVEL_VDEBUG));
+	EXPECT_FALSE(TRACE_ENABLED(TRACE_LEVEL_VVDEBUG));
+
+	//Bad values are rejected
+	EXPECT_FALSE(EWBTrace::setLevel(EWB_TRACE_BRIDGE,TRACE_LEVEL_VVDEBUG+1));
+	EXPECT_FALSE(EWBTrace::setLevel(-1,TRACE_LEVEL_INFO));
+	EXPECT_EQ(-1,EWBTrace::getLevel(EWB_TRACE_NMODULES));
+
+	//The arguments are not evaluated when the level is disabled
+	int count=0;
+	EXPECT_TRUE(EWBTrace::setLevel(EWB_TRACE_NMODULES,TRACE_LEVEL_NO_TRACE));
+	TRACE_P_WARNING("count=%d",++count);
+	EXPECT_EQ(0,count);
+	EXPECT_EQ(TRACE_LEVEL_NO_TRACE,EWBTrace::getLevel(EWB_TRACE_CORE));
+
+	EXPECT_TRUE(EWBTrace::setLevel(EWB_TRACE_NMODULES,TRACE_LEVEL_DEFAULT));
+	EXPECT_FALSE(TRACE_ENABLED(TRACE_LEVEL_VDEBUG));
+}
+
+TEST(EWBTrace,Format)
+{
+	char buff[16];
+	EXPECT_EQ(10,EWBTrace::buff_format(buff,sizeof(buff),"0x%08X",0xCAFE));
+	EXPECT_STREQ("0x0000CAFE",buff);
+
+	//Truncated in the caller buffer
+	EXPECT_EQ(15,EWBTrace::buff_format(buff,sizeof(buff),"%s","0123456789ABCDEFGHIJ"));
+	EXPECT_STREQ("0123456789ABCDE",buff);
+
+	//Thread-local buffer is reused
+	const char *p1=EWBTrace::tls_format("%d-%s",12,"ab");
+	EXPECT_STREQ("12-ab",p1);
+	const char *p2=EWBTrace::tls_format("%x",255);
+	EXPECT_EQ(p1,p2);
+	EXPECT_STREQ("ff",p2);
+
+	//Longer than the internal buffers
+	std::string big(EWBTRACE_TLS_BSIZE*2,'x');
+	EXPECT_EQ(big+"!",EWBTrace::string_format("%s%c",big.c_str(),'!'));
+	EXPECT_EQ(EWBTRACE_TLS_BSIZE-1,strlen(EWBTrace::tls_format("%s",big.c_str())));
+
+	std::stringstream ss;
+	EWBTrace::stream_format(ss,"@0x%08X",0x10) << " " ;
+	EWBTrace::stream_format(ss,"%s",big.c_str());
+	EXPECT_EQ("@0x00000010 "+big,ss.str());
+}
+
+}
@@ -0,0 +1,130 @@
+/*
+ * EWBWait_test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "EWBWait.h"
+
+#include "EWBBus.h"
+#include "EWBPeriph.h"
+#include "EWBReg.h"
+#include "EWBField.h"
+#include "EWBBgdRAM.h"
+#include "EWBBgdEtherbone.h"
+#include "EWBFakeEtherbone.h"
+#include "gtest/gtest.h"
+
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+
+//! A peripheral with a status register of 4 bits
+struct Device {
+	EWBBus bus;
+	EWBReg *pStat;
+	EWBField *pBits[4];
+	Device(EWBBridge *pBgd): bus(pBgd,0x0)
+	{
+		EWBPeriph *pP=new EWBPeriph(&bus,"dev",0x100,0x1,0x2);
+		bus.appendPeriph(pP);
+		pStat=new EWBReg(pP,"stat",0x4);
+		for(int i=0;i<4;i++) pBits[i]=new EWBField(pStat,"bit",1,i);
+	}
+};
+
+TEST(EWBWait,Field)
+{
+	EWBMemRAMCon ram;
+	Device dev(&ram);
+	ram.poke(0x104,0x10);
+
+	std::thread th([&ram]() { usleep(3000); ram.poke(0x104,0x14); });
+	EWBWait::Result res;
+	EXPECT_TRUE(EWBWait::waitFor(dev.pBits[2],[](uint32_t v) { return v==1; },500000,&res));
+	th.join();
+	EXPECT_EQ(1,res.value);
+	EXPECT_EQ(res.nreads,res.nvalues);
+	EXPECT_EQ(res.nreads,ram.getStats().getCount(EWBBridgeStats::SINGLE_R));
+	EXPECT_GE(res.wait_ns,2000000);
+	EXPECT_EQ(0x4,dev.pStat->getData());
+
+	//The register can be used directly
+	EXPECT_TRUE(EWBWait::waitFor(dev.pStat,[](uint32_t v) { return v==0x14; },1000,&res));
+	EXPECT_EQ(0x14,res.value);
+	EXPECT_EQ(1,res.nreads);
+}
+
+TEST(EWBWait,InCycle)
+{
+	EWBMemRAMCon ram;
+	EWBFakeEtherbone srv(&ram);
+	EWBEtherboneCon eb(srv.getURL());
+	ASSERT_TRUE(eb.isValid());
+	Device dev(&eb);
+	ram.poke(0x104,0x1);
+
+	//The reads of a cycle are only performed at its end
+	uint64_t nreads=EWBWait::getNReads();
+	EXPECT_TRUE(eb.openCycle());
+	EXPECT_FALSE(EWBWait::waitFor(dev.pBits[0],[](uint32_t v) { return v==1; },1000));
+	EXPECT_TRUE(eb.closeCycle());
+	EXPECT_EQ(nreads,EWBWait::getNReads());
+	EXPECT_TRUE(EWBWait::waitFor(dev.pBits[0],[](uint32_t v) { return v==1; },100000));
+}
+
+TEST(EWBWait,Timeout)
+{
+	EWBMemRAMCon ram;
+	Device dev(&ram);
+	uint64_t ntimeouts=EWBWait::getNTimeouts();
+
+	//The backoff limits the number of reads
+	EWBWait::Result res;
+	EXPECT_FALSE(EWBWait::waitFor(dev.pBits[0],[](uint32_t v) { return v==1; },20000,&res));
+	EXPECT_EQ(ntimeouts+1,EWBWait::getNTimeouts());
+	EXPECT_GE(res.wait_ns,20000000);
+	EXPECT_LT(res.wait_ns,200000000);
+	EXPECT_LT(res.nreads,100);
+	EXPECT_EQ(0,res.value);
+
+	//Only spins: the timeout is still respected
+	EWBWait::setBackoff(1000000,0,10,1000);
+	EXPECT_FALSE(EWBWait::waitFor(dev.pBits[0],[](uint32_t v) { return v==1; },2000,&res));
+	EXPECT_LT(res.wait_ns,100000000);
+	EXPECT_GT(res.nreads,100);
+	EWBWait::setBackoff(4,16,10,1000);
+}
+
+TEST(EWBWait,Shared)
+{
+	EWBMemRAMCon ram;
+	Device dev(&ram);
+	uint64_t nshared=EWBWait::getNShared();
+
+	//Four waits on the bits of the same register
+	std::vector<std::thread> ths;
+	EWBWait::Result res[4];
+	bool rets[4]={ false };
+	for(int i=0;i<4;i++)
+	{
+		ths.push_back(std::thread([&,i]() { rets[i]=EWBWait::waitFor(dev.pBits[i],[](uint32_t v) { return v==1; },500000,&res[i]); }));
+	}
+	usleep(10000);
+	ram.poke(0x104,0xF);
+	for(size_t i=0;i<ths.size();i++) ths[i].join();
+
+	uint32_t nreads=0;
+	for(int i=0;i<4;i++)
+	{
+		EXPECT_TRUE(rets[i]);
+		EXPECT_GE(res[i].nvalues,1);
+		nreads+=res[i].nreads;
+	}
+	EXPECT_EQ(nreads,ram.getStats().getCount(EWBBridgeStats::SINGLE_R));
+	EXPECT_EQ(nshared+3,EWBWait::getNShared());
+}
+
+} // namespace
@@ -0,0 +1,253 @@
+/*
+ * ewb_bench.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Micro-benchmarks of the ewbcore hot paths using google-benchmark.
+ *
+ * Usage:
+ * 		make bench
+ * 		./ewb_bench --benchmark_filter=RegCvt
+ */
+
+#include "EWBTrace.h"
+#include "EWBBus.h"
+#include "EWBPeriph.h"
+#include "EWBReg.h"
+#include "EWBField.h"
+#include "EWBBgdRAM.h"
+#include "files/wbtest.h"
+
+#include <benchmark/benchmark.h>
+#include <sstream>
+
+namespace {
+
+//! Number of registers of the peripheral used by the sync benchmarks
+const int NREGS=64;
+
+/**
+ * Peripheral of NREGS registers (4 fields each) on a RAM bridge
+ */
+struct BenchTree {
+	EWBMemRAMCon bridge;
+	EWBBus bus;
+	EWBPeriph *pPrh;
+
+	BenchTree(): bus(&bridge,0x10000)
+	{
+		pPrh=new EWBPeriph(&bus,WB2_TEST_PERIPH_PREFIX,0x2000,WB2_TEST_PERIPH_VENID,WB2_TEST_PERIPH_DEVID);
+		bus.appendPeriph(pPrh);
+		char name[16];
+		for(int i=0;i<NREGS;i++)
+		{
+			snprintf(name,sizeof(name),"reg%02d",i);
+			EWBReg *pReg=new EWBReg(pPrh,name,i*4);
+			new EWBField(pReg,"u",8,0);
+			new EWBField(pReg,"sign1",8,8,EWBSync::EWB_AM_RW,"",EWBParam::EWBF_TM_SIGN_MSB);
+			new EWBField(pReg,"sign2",8,16,EWBSync::EWB_AM_RW,"",EWBParam::EWBF_TM_SIGN_2COMP);
+			new EWBField(pReg,"fixed",8,24,EWBSync::EWB_AM_RW,"",EWBParam::EWBF_TM_SIGN_2COMP,4);
+		}
+	}
+};
+
+//------------------------------------------------------------------------------
+
+/**
+ * Convert a float to/from a register for each EWBParam::Type
+ * (range(0): signess, range(1): number of fractional bits)
+ */
+void BM_RegCvtFloat(benchmark::State& state)
+{
+	EWBField f(NULL,"f",16,8,EWBSync::EWB_AM_RW,"",state.range(0),state.range(1));
+	uint32_t reg=0;
+	float val=-3.25f, rbk;
+	for (auto _ : state)
+	{
+		f.regCvt(&val,&reg,false);
+		f.regCvt(&rbk,&reg,true);
+		benchmark::DoNotOptimize(rbk);
+	}
+	state.SetLabel(EWBTrace::tls_format("type=0x%02x",f.getType()));
+}
+BENCHMARK(BM_RegCvtFloat)
+	->Args({EWBParam::EWBF_TM_SIGN_UNSIGNED,0})		//EWBF_32U
+	->Args({EWBParam::EWBF_TM_SIGN_MSB,0})			//EWBF_32I
+	->Args({EWBParam::EWBF_TM_SIGN_2COMP,0})		//EWBF_32I2C
+	->Args({EWBParam::EWBF_TM_SIGN_UNSIGNED,4})		//EWBF_32FPU
+	->Args({EWBParam::EWBF_TM_SIGN_MSB,4})			//EWBF_32FP
+	->Args({EWBParam::EWBF_TM_SIGN_2COMP,4});		//EWBF_32F2C
+
+/**
+ * Convert an integer to/from a register (same for all types)
+ */
+void BM_RegCvtU32(benchmark::State& state)
+{
+	EWBField f(NULL,"f",16,8);
+	uint32_t reg=0, val=0x1234, rbk;
+	for (auto _ : state)
+	{
+		f.regCvt(&val,&reg,false);
+		f.regCvt(&rbk,&reg,true);
+		benchmark::DoNotOptimize(rbk);
+	}
+}
+BENCHMARK(BM_RegCvtU32);
+
+//------------------------------------------------------------------------------
+
+void BM_PeriphGetReg(benchmark::State& state)
+{
+	BenchTree t;
+	uint32_t off=0;
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(t.pPrh->getReg(off));
+		off=(off+4)%(NREGS*4);
+	}
+}
+BENCHMARK(BM_PeriphGetReg);
+
+void BM_RegGetField(benchmark::State& state)
+{
+	BenchTree t;
+	const EWBReg *pReg=t.pPrh->getReg(0);
+	const std::string name("fixed"); //Last field
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(pReg->getField(name));
+	}
+}
+BENCHMARK(BM_RegGetField);
+
+//------------------------------------------------------------------------------
+
+void BM_RegSync(benchmark::State& state)
+{
+	BenchTree t;
+	EWBReg *pReg=t.pPrh->getReg(0);
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(pReg->sync(EWBSync::EWB_AM_R));
+	}
+}
+BENCHMARK(BM_RegSync);
+
+void BM_FieldSyncWrite(benchmark::State& state)
+{
+	BenchTree t;
+	EWBField *pFld=t.pPrh->getReg(0)->getFields()[0];
+	uint32_t val=0;
+	for (auto _ : state)
+	{
+		val++;
+		pFld->convert(&val,false);
+		benchmark::DoNotOptimize(pFld->sync(EWBSync::EWB_AM_W));
+	}
+}
+BENCHMARK(BM_FieldSyncWrite);
+
+/**
+ * Sync the full peripheral with single accesses
+ */
+void BM_PeriphSyncSingle(benchmark::State& state)
+{
+	BenchTree t;
+	EWBSync *pSync=t.pPrh; //Use the virtual sync(amode)
+	t.bridge.setCostModel(EWBLatencyModel::singles()); //The planner never uses a block
+	EWBSync::AMode amode=(EWBSync::AMode)state.range(0);
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(pSync->sync(amode));
+	}
+	state.SetItemsProcessed(state.iterations()*NREGS);
+}
+BENCHMARK(BM_PeriphSyncSingle)->Arg(EWBSync::EWB_AM_R)->Arg(EWBSync::EWB_AM_W);
+
+/**
+ * Sync the full peripheral with one block access
+ */
+void BM_PeriphSyncBlock(benchmark::State& state)
+{
+	BenchTree t;
+	EWBSync::AMode amode=(EWBSync::AMode)state.range(0);
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(t.pPrh->sync(amode,EWB_NODE_MEMBCK_OWNADDR));
+	}
+	state.SetItemsProcessed(state.iterations()*NREGS);
+}
+BENCHMARK(BM_PeriphSyncBlock)->Arg(EWBSync::EWB_AM_R)->Arg(EWBSync::EWB_AM_W);
+
+/**
+ * Simulated bus time of a peripheral sync using the X1052 latency model
+ * (range(0): access mode, range(1): 1 for block access)
+ *
+ * The single variant plans with a cost model without block, otherwise
+ * the planner would also choose a block for sync(amode).
+ */
+void BM_PeriphSyncX1052(benchmark::State& state)
+{
+	BenchTree t;
+	EWBSync::AMode amode=(EWBSync::AMode)state.range(0);
+	bool block=state.range(1);
+	t.bridge.setLatencyModel(EWBLatencyModel::X1052());
+	if(block==false) t.bridge.setCostModel(EWBLatencyModel::singles());
+	for (auto _ : state)
+	{
+		if(block) benchmark::DoNotOptimize(t.pPrh->sync(amode,EWB_NODE_MEMBCK_OWNADDR));
+		else benchmark::DoNotOptimize(((EWBSync*)t.pPrh)->sync(amode));
+	}
+	state.counters["bus_us"]=benchmark::Counter(t.bridge.getSimTime()/1000.0,benchmark::Counter::kAvgIterations);
+	state.SetItemsProcessed(state.iterations()*NREGS);
+}
+BENCHMARK(BM_PeriphSyncX1052)->Args({EWBSync::EWB_AM_R,0})->Args({EWBSync::EWB_AM_R,1})
+	->Args({EWBSync::EWB_AM_W,0})->Args({EWBSync::EWB_AM_W,1});
+
+//------------------------------------------------------------------------------
+
+void BM_StringFormat(benchmark::State& state)
+{
+	for (auto _ : state)
+	{
+		std::string s=EWBTrace::string_format("@0x%08X (%s) : 0x%x",0x1234,"reg",0xCAFE);
+		benchmark::DoNotOptimize(s);
+	}
+}
+BENCHMARK(BM_StringFormat);
+
+void BM_BuffFormat(benchmark::State& state)
+{
+	char buff[64];
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(EWBTrace::buff_format(buff,sizeof(buff),"@0x%08X (%s) : 0x%x",0x1234,"reg",0xCAFE));
+	}
+}
+BENCHMARK(BM_BuffFormat);
+
+void BM_PeriphPrint(benchmark::State& state)
+{
+	BenchTree t;
+	std::stringstream ss;
+	for (auto _ : state)
+	{
+		ss.str("");
+		t.pPrh->print(ss);
+	}
+	state.SetItemsProcessed(state.iterations()*NREGS*5);
+}
+BENCHMARK(BM_PeriphPrint);
+
+}
+
+int main(int argc, char** argv)
+{
+	//Only keep the warnings so that we do not measure the traces
+	EWBTrace::setLevel(EWB_TRACE_NMODULES,TRACE_LEVEL_WARNING);
+
+	::benchmark::Initialize(&argc, argv);
+	if (::benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+	::benchmark::RunSpecifiedBenchmarks();
+	return 0;
+}